@@ -0,0 +1,433 @@
+/* This file is part of C++ State Machine Framework.
+ *
+ * C++ State Machine Framework is free software: you can redistribute it and/or modify it under the
+ * terms of the GNU Lesser General Public License as published by the Free Software Foundation,
+ * either version 3 of the License, or (at your option) any later version.
+ *
+ * C++ State Machine Framework is distributed in the hope that it will be useful, but WITHOUT ANY
+ * WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR
+ * PURPOSE. See the GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License along with C++ State
+ * Machine Framework. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+/*!
+ * \file
+ *
+ * Contains a small fixed-size delegate type used for state machine actions and guard conditions
+ */
+
+#pragma once
+
+// C++ State Machine Framework includes
+
+// Qt includes
+
+// System includes
+#include <cstddef>
+#include <new>
+#include <type_traits>
+#include <utility>
+
+// Forward declarations
+
+// Macros
+
+// -------------------------------------------------------------------------------------------------
+
+namespace CppStateMachineFramework
+{
+
+template<typename Signature>
+class Delegate;
+
+/*!
+ * This class holds a callable object (a fixed-size replacement for std::function)
+ *
+ * Callables that fit into the internal buffer (for example a member method pointer together with
+ * its instance or a lambda with a few captures) are stored inline so no memory is allocated when
+ * the delegate is created and invoking the delegate is a single indirect call. Larger callables are
+ * stored on the heap.
+ *
+ * \tparam  R       Return type
+ * \tparam  Args    Argument types
+ */
+template<typename R, typename... Args>
+class Delegate<R(Args...)>
+{
+private:
+    //! Checks if the callable object can be invoked with the delegate arguments
+    template<typename F, typename = void>
+    struct IsCallable : std::false_type
+    {
+    };
+
+    //! Checks if the callable object can be invoked with the delegate arguments
+    template<typename F>
+    struct IsCallable<F, std::enable_if_t<
+            std::is_void<R>::value ||
+            std::is_convertible<decltype(std::declval<F &>()(std::declval<Args>()...)), R>::value>>
+        : std::true_type
+    {
+    };
+
+    //! Holds a method pointer together with the instance on which it is called
+    template<typename T>
+    struct BoundMethod
+    {
+        //! Calls the method with the delegate arguments
+        R operator()(Args... args) const
+        {
+            return (instance->*method)(std::forward<Args>(args)...);
+        }
+
+        //! Holds the instance
+        T *instance;
+
+        //! Holds the method
+        R (T::*method)(Args...);
+    };
+
+    //! Holds a method pointer without arguments together with the instance on which it is called
+    template<typename T>
+    struct BoundMethodWithoutArguments
+    {
+        //! Calls the method and ignores the delegate arguments
+        R operator()(Args...) const
+        {
+            return (instance->*method)();
+        }
+
+        //! Holds the instance
+        T *instance;
+
+        //! Holds the method
+        R (T::*method)();
+    };
+
+public:
+    //! Size of the internal buffer for the callables that are stored inline
+    static constexpr std::size_t BufferSize = 4U * sizeof(void *);
+
+public:
+    //! Constructor (empty delegate)
+    Delegate() noexcept
+        : m_invoke(nullptr),
+          m_manager(nullptr)
+    {
+    }
+
+    //! Constructor (empty delegate)
+    Delegate(std::nullptr_t) noexcept
+        : Delegate()
+    {
+    }
+
+    /*!
+     * Constructor
+     *
+     * \param   callable    Callable object
+     *
+     * \note    An empty function pointer or std::function results in an empty delegate
+     */
+    template<typename F,
+             typename = std::enable_if_t<(!std::is_same<std::decay_t<F>, Delegate>::value) &&
+                                         IsCallable<std::decay_t<F>>::value>>
+    Delegate(F &&callable)
+        : Delegate()
+    {
+        using Callable = std::decay_t<F>;
+
+        if (isNull(callable))
+        {
+            return;
+        }
+
+        Manager<Callable>::create(&m_buffer,
+                                  std::forward<F>(callable),
+                                  std::integral_constant<bool, Manager<Callable>::IsInline>());
+        m_invoke = &Manager<Callable>::invoke;
+        m_manager = &Manager<Callable>::manage;
+    }
+
+    /*!
+     * Constructor
+     *
+     * \param   instance    Instance on which the method is called
+     * \param   method      Method with the same arguments as the delegate
+     */
+    template<typename T>
+    Delegate(T *instance, R (T::*method)(Args...))
+        : Delegate(BoundMethod<T>{instance, method})
+    {
+    }
+
+    /*!
+     * Constructor
+     *
+     * \param   instance    Instance on which the method is called
+     * \param   method      Method without arguments (the delegate arguments are ignored)
+     */
+    template<typename T, typename U = T, typename = std::enable_if_t<sizeof...(Args) != 0U, U>>
+    Delegate(T *instance, R (T::*method)())
+        : Delegate(BoundMethodWithoutArguments<T>{instance, method})
+    {
+    }
+
+    //! Copy constructor
+    Delegate(const Delegate &other)
+        : m_invoke(other.m_invoke),
+          m_manager(other.m_manager)
+    {
+        if (m_manager != nullptr)
+        {
+            m_manager(Operation::Copy, &m_buffer, &other.m_buffer);
+        }
+    }
+
+    //! Move constructor
+    Delegate(Delegate &&other) noexcept
+        : m_invoke(other.m_invoke),
+          m_manager(other.m_manager)
+    {
+        if (m_manager != nullptr)
+        {
+            m_manager(Operation::Move, &m_buffer, &other.m_buffer);
+            other.m_invoke = nullptr;
+            other.m_manager = nullptr;
+        }
+    }
+
+    //! Destructor
+    ~Delegate()
+    {
+        reset();
+    }
+
+    //! Copy assignment operator
+    Delegate &operator=(const Delegate &other)
+    {
+        if (this != &other)
+        {
+            Delegate copy(other);
+            *this = std::move(copy);
+        }
+
+        return *this;
+    }
+
+    //! Move assignment operator
+    Delegate &operator=(Delegate &&other) noexcept
+    {
+        if (this != &other)
+        {
+            reset();
+
+            if (other.m_manager != nullptr)
+            {
+                other.m_manager(Operation::Move, &m_buffer, &other.m_buffer);
+                m_invoke = other.m_invoke;
+                m_manager = other.m_manager;
+                other.m_invoke = nullptr;
+                other.m_manager = nullptr;
+            }
+        }
+
+        return *this;
+    }
+
+    //! Assignment operator (clears the delegate)
+    Delegate &operator=(std::nullptr_t) noexcept
+    {
+        reset();
+        return *this;
+    }
+
+    /*!
+     * Checks if the delegate holds a callable object
+     *
+     * \retval  true    Delegate holds a callable object
+     * \retval  false   Delegate is empty
+     */
+    explicit operator bool() const noexcept
+    {
+        return (m_invoke != nullptr);
+    }
+
+    /*!
+     * Invokes the callable object
+     *
+     * \param   args    Arguments
+     *
+     * \return  Return value of the callable object
+     *
+     * \note    The delegate must not be empty
+     */
+    R operator()(Args... args) const
+    {
+        return m_invoke(&m_buffer, std::forward<Args>(args)...);
+    }
+
+private:
+    //! Holds the storage for the callable object
+    using Buffer = std::aligned_storage_t<BufferSize, alignof(std::max_align_t)>;
+
+    //! Enumerates the operations executed by the manager of the callable object
+    enum class Operation
+    {
+        Copy,
+        Move,
+        Destroy
+    };
+
+    //! Holds the methods for managing and invoking a specific type of the callable object
+    template<typename F>
+    struct Manager
+    {
+        //! Checks if the callable object is stored inline
+        static constexpr bool IsInline = (sizeof(F) <= BufferSize) &&
+                                         (alignof(F) <= alignof(Buffer)) &&
+                                         std::is_nothrow_move_constructible<F>::value;
+
+        //! Gets the callable object from the buffer
+        static F *get(const void *buffer)
+        {
+            return IsInline ? static_cast<F *>(const_cast<void *>(buffer))
+                            : *static_cast<F * const *>(buffer);
+        }
+
+        //! Invokes the callable object
+        static R invoke(const void *buffer, Args... args)
+        {
+            return (*get(buffer))(std::forward<Args>(args)...);
+        }
+
+        //! Copies, moves or destroys the callable object
+        static void manage(Operation operation, void *destination, const void *source)
+        {
+            switch (operation)
+            {
+                case Operation::Copy:
+                {
+                    copy(destination, source, std::integral_constant<bool, IsInline>());
+                    break;
+                }
+
+                case Operation::Move:
+                {
+                    move(destination, source, std::integral_constant<bool, IsInline>());
+                    break;
+                }
+
+                case Operation::Destroy:
+                {
+                    destroy(destination, std::integral_constant<bool, IsInline>());
+                    break;
+                }
+            }
+        }
+
+        //! Creates an inline callable object
+        template<typename G>
+        static void create(void *buffer, G &&callable, std::true_type)
+        {
+            new (buffer) F(std::forward<G>(callable));
+        }
+
+        //! Creates a heap allocated callable object
+        template<typename G>
+        static void create(void *buffer, G &&callable, std::false_type)
+        {
+            *static_cast<F **>(buffer) = new F(std::forward<G>(callable));
+        }
+
+        //! Copies an inline callable object
+        static void copy(void *destination, const void *source, std::true_type)
+        {
+            new (destination) F(*get(source));
+        }
+
+        //! Copies a heap allocated callable object
+        static void copy(void *destination, const void *source, std::false_type)
+        {
+            *static_cast<F **>(destination) = new F(*get(source));
+        }
+
+        //! Moves an inline callable object
+        static void move(void *destination, const void *source, std::true_type)
+        {
+            F *sourceCallable = get(source);
+            new (destination) F(std::move(*sourceCallable));
+            sourceCallable->~F();
+        }
+
+        //! Moves a heap allocated callable object
+        static void move(void *destination, const void *source, std::false_type)
+        {
+            *static_cast<F **>(destination) = get(source);
+        }
+
+        //! Destroys an inline callable object
+        static void destroy(void *buffer, std::true_type)
+        {
+            get(buffer)->~F();
+        }
+
+        //! Destroys a heap allocated callable object
+        static void destroy(void *buffer, std::false_type)
+        {
+            delete get(buffer);
+        }
+    };
+
+private:
+    //! Checks if the callable object is empty
+    template<typename F>
+    static bool isNull(const F &callable)
+    {
+        return isNull(callable, 0);
+    }
+
+    //! Checks if the callable object is empty (callable objects comparable to nullptr)
+    template<typename F>
+    static auto isNull(const F &callable, int) -> decltype(bool(callable == nullptr))
+    {
+        return (callable == nullptr);
+    }
+
+    //! Checks if the callable object is empty (other callable objects are never empty)
+    template<typename F>
+    static bool isNull(const F &, long)
+    {
+        return false;
+    }
+
+    //! Destroys the callable object
+    void reset() noexcept
+    {
+        if (m_manager != nullptr)
+        {
+            m_manager(Operation::Destroy, &m_buffer, nullptr);
+            m_invoke = nullptr;
+            m_manager = nullptr;
+        }
+    }
+
+private:
+    //! Holds the callable object (or a pointer to it if it is stored on the heap)
+    Buffer m_buffer;
+
+    //! Holds the method that invokes the callable object
+    R (*m_invoke)(const void *buffer, Args... args);
+
+    //! Holds the method that copies, moves or destroys the callable object
+    void (*m_manager)(Operation operation, void *destination, const void *source);
+};
+
+// -------------------------------------------------------------------------------------------------
+
+template<typename R, typename... Args>
+constexpr std::size_t Delegate<R(Args...)>::BufferSize;
+
+} // namespace CppStateMachineFramework
@@ -22,40 +22,179 @@
 
 // C++ State Machine Framework includes
 #include <CppStateMachineFramework/CppStateMachineFrameworkExport.hpp>
+#include <CppStateMachineFramework/EventNameRegistry.hpp>
 
 // Qt includes
 #include <QtCore/QString>
 
 // System includes
+#include <cstddef>
+#include <cstdint>
 #include <memory>
+#include <new>
+#include <type_traits>
 
 // Forward declarations
 
 // Macros
 
+/*!
+ * Maximum size (in bytes) of an event parameter's value that can be stored inline in an event
+ * (larger values are stored on the heap)
+ */
+#ifndef CPPSTATEMACHINEFRAMEWORK_EVENT_PARAMETER_INLINE_SIZE
+#define CPPSTATEMACHINEFRAMEWORK_EVENT_PARAMETER_INLINE_SIZE 32
+#endif
+
 // -------------------------------------------------------------------------------------------------
 
 namespace CppStateMachineFramework
 {
 
+//! Type alias for an event parameter type ID
+using EventParameterTypeId = const void *;
+
+// -------------------------------------------------------------------------------------------------
+
+/*!
+ * Gets the type ID of an event parameter type
+ *
+ * \tparam  T   Event parameter type
+ *
+ * \return  Type ID (address of a per-type token)
+ */
+template<typename T>
+inline EventParameterTypeId eventParameterTypeId()
+{
+    static const char s_token = 0;
+    return &s_token;
+}
+
+// -------------------------------------------------------------------------------------------------
+
+class Event;
+
 //! This is an interface for an event parameter
 class CPPSTATEMACHINEFRAMEWORK_EXPORT IEventParameter
 {
 public:
+    //! Constructor
+    IEventParameter()
+        : m_typeId(nullptr)
+    {
+    }
+
     //! Destructor
     virtual ~IEventParameter() = default;
+
+    /*!
+     * Gets the type ID of the event parameter
+     *
+     * \return  Type ID or nullptr if the type ID is not set
+     */
+    EventParameterTypeId typeId() const
+    {
+        return m_typeId;
+    }
+
+protected:
+    /*!
+     * Constructor
+     *
+     * \param   typeId  Type ID of the event parameter
+     */
+    explicit IEventParameter(EventParameterTypeId typeId)
+        : m_typeId(typeId)
+    {
+    }
+
+    /*!
+     * Moves the event parameter to the buffer and destroys this instance
+     *
+     * \param   buffer  Buffer to move the event parameter to
+     *
+     * \return  Moved event parameter
+     *
+     * \note    This method is only used for event parameters that are stored inline in an event
+     */
+    virtual IEventParameter *relocate(void *buffer) noexcept
+    {
+        static_cast<void>(buffer);
+        return nullptr;
+    }
+
+private:
+    //! Holds the type ID
+    EventParameterTypeId m_typeId;
+
+    friend class Event;
 };
 
 // -------------------------------------------------------------------------------------------------
 
-//! This class holds the event
+template<typename T>
+class EventParameter;
+
+//! Checks if the type is an EventParameter<T> class template specialization
+template<typename T>
+struct IsEventParameter : std::false_type
+{
+};
+
+//! Checks if the type is an EventParameter<T> class template specialization
+template<typename T>
+struct IsEventParameter<EventParameter<T>> : std::true_type
+{
+};
+
+//! Checks if the type is an event parameter type other than an EventParameter<T> specialization
+template<typename T>
+struct IsOtherEventParameter
+        : std::integral_constant<bool,
+                                 std::is_base_of<IEventParameter, T>::value &&
+                                 (!IsEventParameter<std::remove_cv_t<T>>::value)>
+{
+};
+
+// -------------------------------------------------------------------------------------------------
+
+/*!
+ * This class holds the event
+ *
+ * Event parameters created with EventParameter<T>::create() are stored on the heap. An event
+ * parameter passed to the event by value is stored inline in the event (without a heap allocation)
+ * if its value is not larger than CPPSTATEMACHINEFRAMEWORK_EVENT_PARAMETER_INLINE_SIZE bytes and it
+ * can be moved without throwing an exception.
+ */
 class CPPSTATEMACHINEFRAMEWORK_EXPORT Event
 {
+public:
+    //! Size of the buffer for the event parameters stored inline in the event
+    static constexpr std::size_t InlineParameterBufferSize =
+            CPPSTATEMACHINEFRAMEWORK_EVENT_PARAMETER_INLINE_SIZE + (2U * sizeof(void *));
+
+    /*!
+     * Checks if the event parameter can be stored inline in the event
+     *
+     * \tparam  P   Event parameter type
+     */
+    template<typename P>
+    static constexpr bool canStoreParameterInline()
+    {
+        return (sizeof(P) <= InlineParameterBufferSize) &&
+               (alignof(P) <= alignof(ParameterBuffer)) &&
+               std::is_nothrow_move_constructible<P>::value;
+    }
+
 public:
     /*!
      * Constructor
      *
      * \param   name    Event name
+     *
+     * \note    The event gets the ID of the name from the EventNameRegistry. A name that is not
+     *          registered (not used by any state machine definition) is not added to the registry,
+     *          the event then holds its own copy of the name and its ID is UnregisteredEventId.
      */
     Event(const QString &name);
 
@@ -64,23 +203,99 @@ public:
      *
      * \param   name        Event name
      * \param   parameter   Event parameter
+     *
+     * \note    The event name is looked up the same way as in Event(const QString &)
      */
     Event(const QString &name, std::unique_ptr<IEventParameter> &&parameter);
 
+    /*!
+     * Constructor
+     *
+     * \param   id  Event ID (registered event name)
+     *
+     * \note    An event ID that is not registered results in an event with an empty name
+     */
+    explicit Event(EventId id);
+
+    /*!
+     * Constructor
+     *
+     * \param   id          Event ID (registered event name)
+     * \param   parameter   Event parameter
+     *
+     * \note    An event ID that is not registered results in an event with an empty name
+     */
+    Event(EventId id, std::unique_ptr<IEventParameter> &&parameter);
+
+    /*!
+     * Constructor
+     *
+     * \param   name        Event name
+     * \param   parameter   Event parameter (stored inline if possible)
+     *
+     * \note    The event name is looked up the same way as in Event(const QString &)
+     */
+    template<typename T>
+    Event(const QString &name, EventParameter<T> &&parameter)
+        : Event(name)
+    {
+        setParameter(std::move(parameter));
+    }
+
+    /*!
+     * Constructor
+     *
+     * \param   id          Event ID (registered event name)
+     * \param   parameter   Event parameter (stored inline if possible)
+     *
+     * \note    An event ID that is not registered results in an event with an empty name
+     */
+    template<typename T>
+    Event(EventId id, EventParameter<T> &&parameter)
+        : Event(id)
+    {
+        setParameter(std::move(parameter));
+    }
+
+    /*!
+     * Constructor for other event parameter types passed by value is disabled
+     *
+     * \note    Only the EventParameter<T> part of a derived event parameter would be stored, so
+     *          derived event parameters have to be passed with a std::unique_ptr instead
+     */
+    template<typename P, typename = std::enable_if_t<IsOtherEventParameter<P>::value>>
+    Event(const QString &name, P &&parameter) = delete;
+
+    /*!
+     * Constructor for other event parameter types passed by value is disabled
+     *
+     * \note    Only the EventParameter<T> part of a derived event parameter would be stored, so
+     *          derived event parameters have to be passed with a std::unique_ptr instead
+     */
+    template<typename P, typename = std::enable_if_t<IsOtherEventParameter<P>::value>>
+    Event(EventId id, P &&parameter) = delete;
+
     //! Copy constructor is disabled
     Event(const Event &) = delete;
 
-    //! Move constructor
-    Event(Event &&) noexcept = default;
+    /*!
+     * Move constructor
+     *
+     * \note    The moved-from event is left without a name if its name was not registered
+     */
+    Event(Event &&other) noexcept;
 
     //! Destructor
-    virtual ~Event() = default;
+    virtual ~Event();
 
     //! Copy assignment operator is disabled
     Event &operator=(const Event &) = delete;
 
     //! Move assignment operator
-    Event &operator=(Event &&) noexcept = default;
+    Event &operator=(Event &&other) noexcept;
+
+    //! Gets the event's ID
+    EventId id() const;
 
     //! Gets the event's name
     const QString &name() const;
@@ -96,14 +311,77 @@ public:
     //! Gets the event's parameter
     const IEventParameter *parameter() const;
 
-    //! Gets the event's parameter
+    /*!
+     * Sets the event's parameter
+     *
+     * \param   parameter   Event parameter (stored inline if possible)
+     *
+     * \note    The previous parameter of the event is destroyed
+     */
+    template<typename T>
+    void setParameter(EventParameter<T> &&parameter)
+    {
+        destroyParameter();
+        storeParameter(std::move(parameter),
+                       std::integral_constant<bool,
+                                              canStoreParameterInline<EventParameter<T>>()>());
+    }
+
+    /*!
+     * Checks if the event's parameter is stored inline in the event
+     *
+     * \retval  true    Event parameter is stored inline
+     * \retval  false   Event parameter is stored on the heap or the event does not have a parameter
+     */
+    bool isParameterInline() const;
+
+    /*!
+     * Gets the event's parameter
+     *
+     * \tparam  T   Event parameter type
+     *
+     * \return  Event parameter or nullptr if the event does not have a parameter of the type T
+     *
+     * \note    The parameter's type ID is checked first (constant time) and a dynamic cast is used
+     *          only if it does not match. The type ID is not unique across module boundaries (for
+     *          example a parameter created in a shared library with hidden symbol visibility).
+     */
     template<typename T>
     const T *parameter() const
     {
         static_assert(std::is_base_of<IEventParameter, T>::value,
                       "T must be derived from IEventParameter");
 
-        return dynamic_cast<const T*>(m_parameter.get());
+        if (m_parameter == nullptr)
+        {
+            return nullptr;
+        }
+
+        if (m_parameter->typeId() == eventParameterTypeId<T>())
+        {
+            return static_cast<const T*>(m_parameter);
+        }
+
+        return dynamic_cast<const T*>(m_parameter);
+    }
+
+    /*!
+     * Gets the event's parameter without checking its type
+     *
+     * \tparam  T   Event parameter type
+     *
+     * \return  Event parameter or nullptr if the event does not have a parameter
+     *
+     * \note    The caller must already know the parameter's type (for example from the event ID),
+     *          accessing a parameter of a different type results in undefined behavior
+     */
+    template<typename T>
+    const T *parameterUnsafe() const
+    {
+        static_assert(std::is_base_of<IEventParameter, T>::value,
+                      "T must be derived from IEventParameter");
+
+        return static_cast<const T*>(m_parameter);
     }
 
     //! Gets the event's parameter
@@ -113,18 +391,61 @@ public:
     template<typename T>
     T *parameter()
     {
-        static_assert(std::is_base_of<IEventParameter, T>::value,
-                      "T must be derived from IEventParameter");
+        return const_cast<T *>(static_cast<const Event *>(this)->parameter<T>());
+    }
+
+    //! \copydoc parameterUnsafe() const
+    template<typename T>
+    T *parameterUnsafe()
+    {
+        return const_cast<T *>(static_cast<const Event *>(this)->parameterUnsafe<T>());
+    }
+
+private:
+    //! Holds the storage for an event parameter stored inline in the event
+    using ParameterBuffer = std::aligned_storage_t<InlineParameterBufferSize,
+                                                   alignof(std::uint64_t)>;
+
+private:
+    //! Stores the event parameter inline
+    template<typename P>
+    void storeParameter(P &&parameter, std::true_type)
+    {
+        m_parameter = new (&m_parameterBuffer) P(std::move(parameter));
+        m_parameterInline = true;
+    }
 
-        return dynamic_cast<T*>(m_parameter.get());
+    //! Stores the event parameter on the heap
+    template<typename P>
+    void storeParameter(P &&parameter, std::false_type)
+    {
+        m_parameter = new P(std::move(parameter));
     }
 
+    //! Takes the parameter from the other event (this event must not have a parameter)
+    void takeParameter(Event &other) noexcept;
+
+    //! Destroys the event's parameter
+    void destroyParameter() noexcept;
+
+    //! Releases the event's name if it is owned by the event
+    void releaseName() noexcept;
+
 private:
-    //! Event's name
-    QString m_name;
+    //! Event's ID
+    EventId m_id;
 
-    //! Event's name
-    std::unique_ptr<IEventParameter> m_parameter;
+    //! Flag indicating that the event's parameter is stored inline
+    bool m_parameterInline;
+
+    //! Event's name (owned by the EventNameRegistry or by the event for UnregisteredEventId)
+    const QString *m_name;
+
+    //! Event's parameter (points to the inline buffer or to a heap allocated parameter)
+    IEventParameter *m_parameter;
+
+    //! Holds the event's parameter if it is stored inline
+    ParameterBuffer m_parameterBuffer;
 };
 
 // -------------------------------------------------------------------------------------------------
@@ -143,7 +464,7 @@ public:
      * \param   value   Event parameter's value
      */
     EventParameter(const T &value)
-        : IEventParameter(),
+        : IEventParameter(eventParameterTypeId<EventParameter<T>>()),
           m_value(value)
     {
         static_assert(std::is_copy_constructible<T>::value, "Value cannot be copied");
@@ -155,7 +476,7 @@ public:
      * \param   value   Event parameter's value
      */
     EventParameter(T &&value)
-        : IEventParameter(),
+        : IEventParameter(eventParameterTypeId<EventParameter<T>>()),
           m_value(std::move(value))
     {
         static_assert(std::is_move_constructible<T>::value, "Value cannot be moved");
@@ -216,6 +537,46 @@ public:
         return std::make_unique<EventParameter<T>>(std::move(value));
     }
 
+protected:
+    /*!
+     * Constructor for derived event parameter types which have their own type ID
+     *
+     * \param   typeId  Type ID of the event parameter
+     * \param   value   Event parameter's value
+     *
+     * \note    Event::parameter() finds such an event parameter as EventParameter<T> with a dynamic
+     *          cast
+     */
+    EventParameter(EventParameterTypeId typeId, T &&value)
+        : IEventParameter(typeId),
+          m_value(std::move(value))
+    {
+        static_assert(std::is_move_constructible<T>::value, "Value cannot be moved");
+    }
+
+    //! \copydoc IEventParameter::relocate()
+    IEventParameter *relocate(void *buffer) noexcept override
+    {
+        return relocate(buffer,
+                        std::integral_constant<bool,
+                                               Event::canStoreParameterInline<EventParameter>()>());
+    }
+
+private:
+    //! Moves an event parameter that can be stored inline to the buffer
+    IEventParameter *relocate(void *buffer, std::true_type) noexcept
+    {
+        auto *parameter = new (buffer) EventParameter(std::move(*this));
+        this->~EventParameter();
+        return parameter;
+    }
+
+    //! Event parameters that cannot be stored inline are never moved
+    IEventParameter *relocate(void *, std::false_type) noexcept
+    {
+        return nullptr;
+    }
+
 private:
     //! Holds the value
     T m_value;
@@ -0,0 +1,446 @@
+/* This file is part of C++ State Machine Framework.
+ *
+ * C++ State Machine Framework is free software: you can redistribute it and/or modify it under the
+ * terms of the GNU Lesser General Public License as published by the Free Software Foundation,
+ * either version 3 of the License, or (at your option) any later version.
+ *
+ * C++ State Machine Framework is distributed in the hope that it will be useful, but WITHOUT ANY
+ * WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR
+ * PURPOSE. See the GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License along with C++ State
+ * Machine Framework. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+/*!
+ * \file
+ *
+ * Contains an append-only journal of the events stored in memory-mapped segment files
+ */
+
+#pragma once
+
+// C++ State Machine Framework includes
+#include <CppStateMachineFramework/Delegate.hpp>
+#include <CppStateMachineFramework/Event.hpp>
+#include <CppStateMachineFramework/EventParameterSerializer.hpp>
+
+// Qt includes
+#include <QtCore/QByteArray>
+#include <QtCore/QMutex>
+#include <QtCore/QString>
+#include <QtCore/QStringList>
+#include <QtCore/QWaitCondition>
+
+// System includes
+#include <atomic>
+#include <cstdint>
+#include <memory>
+#include <thread>
+#include <utility>
+#include <vector>
+
+// Forward declarations
+class QFile;
+
+// Macros
+
+// -------------------------------------------------------------------------------------------------
+
+namespace CppStateMachineFramework
+{
+
+/*!
+ * This class holds an append-only journal of the events stored in memory-mapped segment files
+ *
+ * Each appended event gets the next sequence number and its record (the event name and the
+ * serialized parameter) is copied to the current segment file, which is mapped to memory, so
+ * appending an event does not make any system calls. A commit thread flushes the appended records
+ * to the disk in batches (group commit) either periodically or when enough data is pending, so the
+ * producers never wait for the disk. It also prepares the next segment file in advance.
+ *
+ * The journal also holds a checkpoint: the sequence number of the last processed event. A state
+ * machine instance with a journal (see StateMachineInstance::setJournal()) appends the events that
+ * are added to the back of its event queue, moves the checkpoint after each processed event and,
+ * when it is started, replays the events after the checkpoint into its event queue. Recovery after
+ * a crash is thus only a matter of opening the journal and starting a new instance with it.
+ *
+ * Each segment holds the names of its events and the type names of their parameters so the journal
+ * does not depend on the event IDs of the process that wrote it. Parameters are written with the
+ * serializers registered in the EventParameterSerializer.
+ *
+ * \note    All appended events survive a crash of the process as the memory-mapped data is kept by
+ *          the operating system. After a crash of the operating system the events appended after
+ *          the last commit can be lost, use sync() to wait for the commit.
+ *
+ * \note    Events are recovered at least once: an event that was being processed when the process
+ *          crashed is replayed again.
+ */
+class CPPSTATEMACHINEFRAMEWORK_EXPORT EventJournal
+{
+public:
+    //! Default size of a segment file in bytes
+    static constexpr qint64 DefaultSegmentSize = 64 * 1024 * 1024;
+
+    //! Minimum size of a segment file in bytes
+    static constexpr qint64 MinimumSegmentSize = 4096;
+
+    //! Default interval of the commits in milliseconds
+    static constexpr int DefaultCommitInterval = 10;
+
+public:
+    /*!
+     * Constructor
+     *
+     * \param   segmentSize     Size of a segment file in bytes (at least MinimumSegmentSize)
+     * \param   commitInterval  Maximum time in milliseconds between the commits
+     */
+    explicit EventJournal(qint64 segmentSize = DefaultSegmentSize,
+                          int commitInterval = DefaultCommitInterval);
+
+    //! Copy constructor is disabled
+    EventJournal(const EventJournal &) = delete;
+
+    //! Move constructor is disabled
+    EventJournal(EventJournal &&) = delete;
+
+    //! Destructor (closes the journal)
+    ~EventJournal();
+
+    //! Copy assignment operator is disabled
+    EventJournal &operator=(const EventJournal &) = delete;
+
+    //! Move assignment operator is disabled
+    EventJournal &operator=(EventJournal &&) = delete;
+
+    /*!
+     * Gets the size of a segment file
+     *
+     * \return  Size in bytes
+     */
+    qint64 segmentSize() const;
+
+    /*!
+     * Gets the maximum time between the commits
+     *
+     * \return  Time in milliseconds
+     */
+    int commitInterval() const;
+
+    /*!
+     * Checks if the journal is open
+     *
+     * \retval  true    Open
+     * \retval  false   Closed
+     */
+    bool isOpen() const;
+
+    /*!
+     * Gets the directory of the journal
+     *
+     * \return  Directory or an empty string if the journal is closed
+     */
+    QString directory() const;
+
+    /*!
+     * Opens the journal
+     *
+     * \param   directory   Directory with the segment files (it is created if needed)
+     *
+     * \retval  true    Success
+     * \retval  false   Failure (journal already open, the files cannot be created)
+     *
+     * The existing segments are scanned up to the first incomplete or damaged record, the appended
+     * events continue after the last valid event. The events are always appended to a new segment.
+     */
+    bool open(const QString &directory);
+
+    /*!
+     * Closes the journal
+     *
+     * \retval  true    Success
+     * \retval  false   Failure (journal already closed)
+     *
+     * All appended events and the checkpoint are committed before the files are closed.
+     *
+     * \note    The journal must not be closed while a started state machine instance uses it.
+     */
+    bool close();
+
+    /*!
+     * Gets the sequence number of the last appended event
+     *
+     * \return  Sequence number (zero if no events were appended yet)
+     */
+    std::uint64_t lastSequence() const;
+
+    /*!
+     * Gets the sequence number of the last committed event
+     *
+     * \return  Sequence number (all events up to it were flushed to the disk)
+     */
+    std::uint64_t committedSequence() const;
+
+    /*!
+     * Gets the checkpoint
+     *
+     * \return  Sequence number of the last processed event
+     */
+    std::uint64_t checkpoint() const;
+
+    /*!
+     * Appends the event
+     *
+     * \param   event   Event
+     *
+     * \return  Sequence number of the event or zero on failure (journal is closed, event name is
+     *          not registered, no serializer is registered for the event parameter's type, segment
+     *          file cannot be created)
+     *
+     * \note    This method can be called from any thread, it never waits for the disk
+     */
+    std::uint64_t append(const Event &event);
+
+    /*!
+     * Sets the checkpoint
+     *
+     * \param   sequence    Sequence number of the last processed event (the checkpoint is never
+     *                      moved backwards)
+     *
+     * \note    This method must be called only from a single thread (the thread that processes the
+     *          events) and only while the journal is open
+     */
+    void setCheckpoint(std::uint64_t sequence);
+
+    /*!
+     * Commits the events appended so far and waits until they are flushed to the disk
+     *
+     * \retval  true    Success
+     * \retval  false   Failure (journal is closed)
+     */
+    bool sync();
+
+    /*!
+     * Reads the events from the journal
+     *
+     * \param   fromSequence    Sequence number of the first event to read
+     * \param   handler         Function which is called for each event (it returns false to stop
+     *                          the reading)
+     *
+     * \retval  true    Success
+     * \retval  false   Failure (journal is closed, the first event is no longer in the journal, an
+     *                  event name or parameter cannot be read)
+     */
+    bool replay(std::uint64_t fromSequence,
+                const Delegate<bool(std::uint64_t sequence, Event &&event)> &handler) const;
+
+    /*!
+     * Removes the segment files whose events are all processed
+     *
+     * \return  Number of removed segment files (negative on failure)
+     *
+     * \note    The current segment is never removed
+     */
+    int removeProcessedSegments();
+
+private:
+    //! Holds a memory-mapped segment file
+    struct Segment
+    {
+        //! Holds the file
+        std::unique_ptr<QFile> file;
+
+        //! Holds the mapped contents of the file
+        uchar *data = nullptr;
+
+        //! Holds the number of the segment (its position in the journal)
+        std::uint64_t number = 0U;
+
+        //! Holds the sequence number of the first event in the segment
+        std::uint64_t firstSequence = 0U;
+
+        //! Holds the offset after the last appended record
+        qint64 writeOffset = 0;
+
+        //! Holds the offset up to which the records are committed (used by the commit thread)
+        qint64 committedOffset = 0;
+    };
+
+    //! Holds the information about a segment file found in the directory
+    struct SegmentInfo
+    {
+        //! Holds the path of the file
+        QString path;
+
+        //! Holds the number of the segment
+        std::uint64_t number;
+
+        //! Holds the sequence number of the first event in the segment
+        std::uint64_t firstSequence;
+    };
+
+private:
+    /*!
+     * Lists the segment files in the directory
+     *
+     * \param[out]  unusedPaths     Optional output for the paths of the files that were created but
+     *                              never used (their header is not valid)
+     *
+     * \return  Segment files with a valid header ordered by their numbers
+     */
+    std::vector<SegmentInfo> listSegments(QStringList *unusedPaths = nullptr) const;
+
+    /*!
+     * Creates a segment file
+     *
+     * \param   number  Number of the segment
+     *
+     * \return  Segment or nullptr on failure
+     */
+    std::unique_ptr<Segment> createSegment(std::uint64_t number) const;
+
+    /*!
+     * Closes the segment file
+     *
+     * \param   segment     Segment
+     * \param   remove      Remove the file after it is closed
+     */
+    void closeSegment(Segment *segment, bool remove) const;
+
+    /*!
+     * Makes the next segment the current segment (the append mutex must be locked)
+     *
+     * \retval  true    Success
+     * \retval  false   Failure (segment file cannot be created)
+     */
+    bool startNextSegment();
+
+    /*!
+     * Writes the record to the current segment (the append mutex must be locked)
+     *
+     * \param   payload     Record's payload
+     */
+    void writeRecord(const QByteArray &payload);
+
+    /*!
+     * Gets the serializer of the event parameter's type (the append mutex must be locked)
+     *
+     * \param   parameter   Event parameter
+     *
+     * \return  Serializer or nullptr if the type is not registered
+     */
+    const EventParameterSerializer::Handler *parameterSerializer(const IEventParameter &parameter);
+
+    /*!
+     * Gets the index of the event parameter type in the table of the current segment and writes the
+     * type name to the segment if needed (the append mutex must be locked)
+     *
+     * \param   handler     Serializer of the event parameter type
+     *
+     * \return  Index of the type
+     */
+    std::uint16_t segmentParameterTypeIndex(const EventParameterSerializer::Handler *handler);
+
+    //! Wakes up the commit thread to commit immediately
+    void requestCommit();
+
+    //! Runs the commit thread
+    void runCommitThread();
+
+    //! Flushes the appended records and the checkpoint to the disk
+    void commit();
+
+    //! Creates the segment file which replaces the current segment when it fills
+    void prepareNextSegment();
+
+private:
+    //! Holds the size of a segment file
+    const qint64 m_segmentSize;
+
+    //! Holds the maximum time between the commits
+    const int m_commitInterval;
+
+    //! Holds the mutex used to make opening and closing of the journal thread safe
+    mutable QMutex m_apiMutex;
+
+    //! Holds the directory of the journal
+    QString m_directory;
+
+    //! Holds the open flag
+    std::atomic<bool> m_open;
+
+    //! Holds the mutex used to make appending of the events thread safe
+    mutable QMutex m_appendMutex;
+
+    //! Holds the segment to which the events are appended
+    std::unique_ptr<Segment> m_segment;
+
+    //! Holds the segment prepared by the commit thread to replace the current segment when it fills
+    std::unique_ptr<Segment> m_nextSegment;
+
+    //! Holds the full segments that are not committed yet
+    std::vector<std::unique_ptr<Segment>> m_retiredSegments;
+
+    //! Holds the number of the next segment file to create
+    std::uint64_t m_nextSegmentNumber;
+
+    //! Holds the flags of the event IDs whose names are written to the current segment
+    std::vector<bool> m_segmentEventNames;
+
+    //! Holds the serializers of the event parameter types written to the current segment
+    std::vector<const EventParameterSerializer::Handler *> m_segmentParameterTypes;
+
+    //! Holds the serializers of the event parameter type IDs that were already looked up
+    std::vector<std::pair<EventParameterTypeId, const EventParameterSerializer::Handler *>>
+            m_parameterSerializers;
+
+    //! Holds the buffer in which the records are serialized
+    QByteArray m_recordBuffer;
+
+    //! Holds the buffer in which the table records are serialized
+    QByteArray m_tableBuffer;
+
+    //! Holds the number of bytes appended since the last commit was requested
+    qint64 m_uncommittedSize;
+
+    //! Holds the sequence number of the last appended event
+    std::atomic<std::uint64_t> m_lastSequence;
+
+    //! Holds the checkpoint file
+    std::unique_ptr<QFile> m_checkpointFile;
+
+    //! Holds the mapped contents of the checkpoint file
+    uchar *m_checkpointData;
+
+    //! Holds the checkpoint
+    std::atomic<std::uint64_t> m_checkpoint;
+
+    //! Holds the sequence number of the last committed event
+    std::atomic<std::uint64_t> m_committedSequence;
+
+    //! Holds the mutex used to synchronize with the commit thread
+    QMutex m_commitMutex;
+
+    //! Holds the condition used to wake up the commit thread
+    QWaitCondition m_commitRequested;
+
+    //! Holds the condition used to wake up the threads waiting for a commit
+    QWaitCondition m_commitFinished;
+
+    //! Holds the flag which is set when an immediate commit is requested
+    bool m_commitPending;
+
+    //! Holds the flag which is set while the commit thread commits
+    bool m_committing;
+
+    //! Holds the number of finished commits
+    std::uint64_t m_commitCount;
+
+    //! Holds the flag which is set when the commit thread has to stop
+    bool m_stopCommitThread;
+
+    //! Holds the commit thread
+    std::thread m_commitThread;
+};
+
+} // namespace CppStateMachineFramework
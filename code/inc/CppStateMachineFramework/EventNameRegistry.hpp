@@ -0,0 +1,117 @@
+/* This file is part of C++ State Machine Framework.
+ *
+ * C++ State Machine Framework is free software: you can redistribute it and/or modify it under the
+ * terms of the GNU Lesser General Public License as published by the Free Software Foundation,
+ * either version 3 of the License, or (at your option) any later version.
+ *
+ * C++ State Machine Framework is distributed in the hope that it will be useful, but WITHOUT ANY
+ * WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR
+ * PURPOSE. See the GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License along with C++ State
+ * Machine Framework. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+/*!
+ * \file
+ *
+ * Contains a registry for interning event names
+ */
+
+#pragma once
+
+// C++ State Machine Framework includes
+#include <CppStateMachineFramework/CppStateMachineFrameworkExport.hpp>
+
+// Qt includes
+#include <QtCore/QString>
+
+// System includes
+#include <cstdint>
+
+// Forward declarations
+
+// Macros
+
+// -------------------------------------------------------------------------------------------------
+
+namespace CppStateMachineFramework
+{
+
+//! Type alias for an interned event name
+using EventId = std::uint32_t;
+
+//! Event ID that does not represent any event name
+constexpr EventId InvalidEventId = 0U;
+
+//! Event ID of an event whose name is not registered (the event holds its own copy of the name)
+constexpr EventId UnregisteredEventId = 0xFFFFFFFFU;
+
+// -------------------------------------------------------------------------------------------------
+
+/*!
+ * This class holds a process-wide registry of event names
+ *
+ * Each registered event name is mapped to a dense integer ID (starting with 1) which stays the same
+ * for the lifetime of the process. Event names cannot be unregistered.
+ *
+ * \note    Looking up the name of a registered event ID is lock-free. Looking up the ID of an event
+ *          name requires hashing of the name and it is served from a small per-thread cache, only a
+ *          cache miss and registering a name lock the registry.
+ */
+class CPPSTATEMACHINEFRAMEWORK_EXPORT EventNameRegistry
+{
+public:
+    /*!
+     * Registers an event name
+     *
+     * \param   name    Event name
+     *
+     * \return  ID of the event name or InvalidEventId for an empty name
+     *
+     * If the event name is already registered then its existing ID is returned.
+     */
+    static EventId registerName(const QString &name);
+
+    /*!
+     * Gets the ID of a registered event name
+     *
+     * \param   name    Event name
+     *
+     * \return  ID of the event name or InvalidEventId if the event name is not registered
+     *
+     * \note    Unlike registerName() this method does not add the event name to the registry, so it
+     *          can be used for names from an untrusted source without growing the registry.
+     */
+    static EventId id(const QString &name);
+
+    /*!
+     * Gets the name of a registered event ID
+     *
+     * \param   id  Event ID
+     *
+     * \return  Event name or an empty string if the event ID is not registered
+     *
+     * \note    The returned reference stays valid for the lifetime of the process.
+     */
+    static const QString &name(EventId id);
+
+    /*!
+     * Checks if the specified event ID is registered
+     *
+     * \param   id  Event ID
+     *
+     * \retval  true    Event ID is registered
+     * \retval  false   Event ID is not registered
+     */
+    static bool isRegistered(EventId id);
+
+    /*!
+     * Gets the number of registered event names
+     *
+     * \return  Number of registered event names (also the highest registered event ID)
+     */
+    static std::uint32_t count();
+};
+
+} // namespace CppStateMachineFramework
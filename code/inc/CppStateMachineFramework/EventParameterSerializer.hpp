@@ -0,0 +1,398 @@
+/* This file is part of C++ State Machine Framework.
+ *
+ * C++ State Machine Framework is free software: you can redistribute it and/or modify it under the
+ * terms of the GNU Lesser General Public License as published by the Free Software Foundation,
+ * either version 3 of the License, or (at your option) any later version.
+ *
+ * C++ State Machine Framework is distributed in the hope that it will be useful, but WITHOUT ANY
+ * WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR
+ * PURPOSE. See the GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License along with C++ State
+ * Machine Framework. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+/*!
+ * \file
+ *
+ * Contains the binary serialization of the events and their parameters
+ */
+
+#pragma once
+
+// C++ State Machine Framework includes
+#include <CppStateMachineFramework/Delegate.hpp>
+#include <CppStateMachineFramework/Event.hpp>
+
+// Qt includes
+#include <QtCore/QByteArray>
+#include <QtCore/QString>
+
+// System includes
+#include <cstdint>
+#include <cstring>
+#include <type_traits>
+
+// Forward declarations
+
+// Macros
+
+// -------------------------------------------------------------------------------------------------
+
+namespace CppStateMachineFramework
+{
+
+/*!
+ * This class appends binary data to a byte array
+ *
+ * Values are written in the native byte order without any padding.
+ */
+class CPPSTATEMACHINEFRAMEWORK_EXPORT BinaryWriter
+{
+public:
+    /*!
+     * Constructor
+     *
+     * \param   data    Byte array to which the data is appended
+     */
+    explicit BinaryWriter(QByteArray *data)
+        : m_data(data)
+    {
+    }
+
+    //! Gets the number of bytes in the byte array
+    int size() const
+    {
+        return m_data->size();
+    }
+
+    /*!
+     * Appends the bytes
+     *
+     * \param   data    Bytes
+     * \param   size    Number of bytes
+     */
+    void writeBytes(const void *data, const int size)
+    {
+        m_data->append(static_cast<const char *>(data), size);
+    }
+
+    /*!
+     * Appends the value
+     *
+     * \tparam  T   Trivially copyable value type
+     *
+     * \param   value   Value
+     */
+    template<typename T>
+    void writeValue(const T &value)
+    {
+        static_assert(std::is_trivially_copyable<T>::value, "T must be trivially copyable");
+
+        writeBytes(&value, static_cast<int>(sizeof(T)));
+    }
+
+    /*!
+     * Overwrites a value that was already appended
+     *
+     * \tparam  T   Trivially copyable value type
+     *
+     * \param   position    Position of the value in the byte array
+     * \param   value       Value
+     */
+    template<typename T>
+    void overwriteValue(const int position, const T &value)
+    {
+        static_assert(std::is_trivially_copyable<T>::value, "T must be trivially copyable");
+
+        std::memcpy(m_data->data() + position, &value, sizeof(T));
+    }
+
+    /*!
+     * Appends the string (its length followed by its UTF-8 encoding)
+     *
+     * \param   value   String
+     */
+    void writeString(const QString &value);
+
+private:
+    //! Holds the byte array
+    QByteArray *m_data;
+};
+
+// -------------------------------------------------------------------------------------------------
+
+/*!
+ * This class reads binary data written by the BinaryWriter
+ *
+ * All read methods fail (without changing the output) if there is not enough data left.
+ */
+class CPPSTATEMACHINEFRAMEWORK_EXPORT BinaryReader
+{
+public:
+    /*!
+     * Constructor
+     *
+     * \param   data    Data (it must stay valid for the lifetime of the reader)
+     * \param   size    Number of bytes
+     */
+    BinaryReader(const char *data, const std::size_t size)
+        : m_position(data),
+          m_end(data + size)
+    {
+    }
+
+    //! Gets the number of bytes left to read
+    std::size_t remaining() const
+    {
+        return static_cast<std::size_t>(m_end - m_position);
+    }
+
+    //! Checks if all of the data was read
+    bool atEnd() const
+    {
+        return (m_position == m_end);
+    }
+
+    //! Gets the position of the next byte to read
+    const char *position() const
+    {
+        return m_position;
+    }
+
+    /*!
+     * Skips the bytes
+     *
+     * \param   size    Number of bytes
+     *
+     * \retval  true    Success
+     * \retval  false   Failure (not enough data)
+     */
+    bool skip(const std::size_t size)
+    {
+        if (size > remaining())
+        {
+            return false;
+        }
+
+        m_position += size;
+        return true;
+    }
+
+    /*!
+     * Reads the bytes
+     *
+     * \param[out]  data    Output for the bytes
+     * \param       size    Number of bytes
+     *
+     * \retval  true    Success
+     * \retval  false   Failure (not enough data)
+     */
+    bool readBytes(void *data, const std::size_t size)
+    {
+        if (size > remaining())
+        {
+            return false;
+        }
+
+        std::memcpy(data, m_position, size);
+        m_position += size;
+        return true;
+    }
+
+    /*!
+     * Reads the value
+     *
+     * \tparam  T   Trivially copyable value type
+     *
+     * \param[out]  value   Output for the value
+     *
+     * \retval  true    Success
+     * \retval  false   Failure (not enough data)
+     */
+    template<typename T>
+    bool readValue(T *value)
+    {
+        static_assert(std::is_trivially_copyable<T>::value, "T must be trivially copyable");
+
+        return readBytes(value, sizeof(T));
+    }
+
+    /*!
+     * Reads the string written with BinaryWriter::writeString()
+     *
+     * \param[out]  value   Output for the string
+     *
+     * \retval  true    Success
+     * \retval  false   Failure (not enough data)
+     */
+    bool readString(QString *value);
+
+private:
+    //! Holds the position of the next byte to read
+    const char *m_position;
+
+    //! Holds the end of the data
+    const char *m_end;
+};
+
+// -------------------------------------------------------------------------------------------------
+
+/*!
+ * This class holds a process-wide registry of the serializers of the event parameters
+ *
+ * A serializer is registered for each EventParameter<T> type under a type name which identifies the
+ * type in the serialized data, so the data can be read by another process (which registered the
+ * same type names) regardless of the order of the registration. Serializers cannot be unregistered.
+ *
+ * \note    Registration and lookup require locking, so the users are expected to look up a
+ *          serializer once for each parameter type they come across and not for each event.
+ */
+class CPPSTATEMACHINEFRAMEWORK_EXPORT EventParameterSerializer
+{
+public:
+    //! Holds the serialization functions of an event parameter type
+    struct Handler
+    {
+        //! Holds the type name
+        QString typeName;
+
+        //! Holds the type ID
+        EventParameterTypeId typeId;
+
+        //! Holds the function which checks if the event parameter is of the type
+        Delegate<bool(const IEventParameter &parameter)> isType;
+
+        //! Holds the function which writes the event parameter's value
+        Delegate<void(const IEventParameter &parameter, BinaryWriter *writer)> serialize;
+
+        //! Holds the function which reads the event parameter's value and sets it to the event
+        Delegate<bool(BinaryReader *reader, Event *event)> deserialize;
+    };
+
+public:
+    /*!
+     * Registers the serializer of the EventParameter<T> type
+     *
+     * \tparam  T   Data type of the event parameter's value (it must be default constructible)
+     *
+     * \param   typeName    Type name
+     * \param   serialize   Function which writes the value
+     * \param   deserialize Function which reads the value
+     *
+     * \retval  true    Success
+     * \retval  false   Failure (empty type name, type or type name already registered)
+     *
+     * \note    Deserialized events store the parameter inline if possible (see Event) so reading
+     *          them does not allocate any memory for small parameter types
+     */
+    template<typename T>
+    static bool registerType(const QString &typeName,
+                             Delegate<void(const T &value, BinaryWriter *writer)> serialize,
+                             Delegate<bool(BinaryReader *reader, T *value)> deserialize)
+    {
+        static_assert(std::is_default_constructible<T>::value, "T must be default constructible");
+
+        Handler handler;
+        handler.typeName = typeName;
+        handler.typeId = eventParameterTypeId<EventParameter<T>>();
+        handler.isType = [](const IEventParameter &parameter)
+        {
+            return (dynamic_cast<const EventParameter<T> *>(&parameter) != nullptr);
+        };
+        handler.serialize = [serialize](const IEventParameter &parameter, BinaryWriter *writer)
+        {
+            serialize(static_cast<const EventParameter<T> &>(parameter).value(), writer);
+        };
+        handler.deserialize = [deserialize](BinaryReader *reader, Event *event)
+        {
+            T value {};
+
+            if (!deserialize(reader, &value))
+            {
+                return false;
+            }
+
+            event->setParameter(EventParameter<T>(std::move(value)));
+            return true;
+        };
+
+        return registerHandler(std::move(handler));
+    }
+
+    /*!
+     * Registers the serializer of the EventParameter<T> type which copies the value's bytes
+     *
+     * \tparam  T   Trivially copyable data type of the event parameter's value
+     *
+     * \param   typeName    Type name
+     *
+     * \retval  true    Success
+     * \retval  false   Failure (empty type name, type or type name already registered)
+     */
+    template<typename T>
+    static bool registerType(const QString &typeName)
+    {
+        static_assert(std::is_trivially_copyable<T>::value, "T must be trivially copyable");
+
+        return registerType<T>(typeName,
+                               [](const T &value, BinaryWriter *writer)
+        {
+            writer->writeValue(value);
+        },
+                               [](BinaryReader *reader, T *value)
+        {
+            return reader->readValue(value);
+        });
+    }
+
+    /*!
+     * Gets the serializer of the event parameter type
+     *
+     * \param   typeId  Type ID of the event parameter
+     *
+     * \return  Serializer or nullptr if the type is not registered
+     *
+     * \note    The returned serializer stays valid for the lifetime of the process
+     */
+    static const Handler *handler(EventParameterTypeId typeId);
+
+    /*!
+     * Gets the serializer of the event parameter's type
+     *
+     * \param   parameter   Event parameter
+     *
+     * \return  Serializer or nullptr if the type is not registered
+     *
+     * \note    The serializer is looked up by the parameter's type ID first. If that fails the
+     *          registered types are checked with a dynamic cast, because the type ID of a
+     *          parameter created in another module (for example a shared library with hidden
+     *          symbol visibility) can differ from the registered one.
+     * \note    The returned serializer stays valid for the lifetime of the process
+     */
+    static const Handler *handler(const IEventParameter &parameter);
+
+    /*!
+     * Gets the serializer of the event parameter type
+     *
+     * \param   typeName    Type name
+     *
+     * \return  Serializer or nullptr if the type name is not registered
+     *
+     * \note    The returned serializer stays valid for the lifetime of the process
+     */
+    static const Handler *handlerByTypeName(const QString &typeName);
+
+private:
+    /*!
+     * Registers the serializer
+     *
+     * \param   handler     Serializer
+     *
+     * \retval  true    Success
+     * \retval  false   Failure (empty type name, type or type name already registered)
+     */
+    static bool registerHandler(Handler &&handler);
+};
+
+} // namespace CppStateMachineFramework
@@ -0,0 +1,186 @@
+/* This file is part of C++ State Machine Framework.
+ *
+ * C++ State Machine Framework is free software: you can redistribute it and/or modify it under the
+ * terms of the GNU Lesser General Public License as published by the Free Software Foundation,
+ * either version 3 of the License, or (at your option) any later version.
+ *
+ * C++ State Machine Framework is distributed in the hope that it will be useful, but WITHOUT ANY
+ * WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR
+ * PURPOSE. See the GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License along with C++ State
+ * Machine Framework. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+/*!
+ * \file
+ *
+ * Contains a pool of memory blocks used for storing queued events
+ */
+
+#pragma once
+
+// C++ State Machine Framework includes
+#include <CppStateMachineFramework/CppStateMachineFrameworkExport.hpp>
+
+// Qt includes
+
+// System includes
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <new>
+
+// Forward declarations
+
+// Macros
+
+// -------------------------------------------------------------------------------------------------
+
+namespace CppStateMachineFramework
+{
+
+/*!
+ * This class holds a pool of fixed-size memory blocks
+ *
+ * Released blocks are kept in the pool (up to its capacity) and reused by the next allocations so
+ * that a steady stream of events does not allocate any memory after a warm-up. The free blocks are
+ * held in a bounded lock-free multi-producer multi-consumer queue so blocks can be allocated and
+ * released from any thread without locking. The pool holds the nodes of the lock-free event queue,
+ * the locked event queue keeps its events in a ring buffer instead.
+ *
+ * \note    An allocation can miss the pool while a concurrent release of a block is still in
+ *          progress, in which case the block is taken from the heap.
+ */
+class CPPSTATEMACHINEFRAMEWORK_EXPORT EventPool
+{
+public:
+    //! Holds the pool statistics
+    struct Statistics
+    {
+        //! Number of allocations served from the pool
+        std::uint64_t hits = 0U;
+
+        //! Number of allocations that needed a new block from the heap
+        std::uint64_t misses = 0U;
+
+        //! Highest number of blocks that were allocated at the same time
+        std::int64_t highWaterMark = 0;
+    };
+
+public:
+    /*!
+     * Constructor
+     *
+     * \param   blockSize   Size of the memory blocks (in bytes)
+     * \param   capacity    Maximum number of free blocks held in the pool (rounded up to a power of
+     *                      two, zero disables the pooling)
+     */
+    EventPool(std::size_t blockSize, int capacity);
+
+    //! Copy constructor is disabled
+    EventPool(const EventPool &) = delete;
+
+    //! Move constructor is disabled
+    EventPool(EventPool &&) = delete;
+
+    //! Destructor
+    ~EventPool();
+
+    //! Copy assignment operator is disabled
+    EventPool &operator=(const EventPool &) = delete;
+
+    //! Move assignment operator is disabled
+    EventPool &operator=(EventPool &&) = delete;
+
+    //! Gets the size of the memory blocks
+    std::size_t blockSize() const;
+
+    //! Gets the maximum number of free blocks held in the pool
+    int capacity() const;
+
+    /*!
+     * Allocates a memory block
+     *
+     * \return  Memory block (from the pool if available, otherwise from the heap)
+     *
+     * \note    This method can be called from any thread
+     */
+    void *allocate();
+
+    /*!
+     * Releases the memory block
+     *
+     * \param   block   Memory block allocated with allocate()
+     *
+     * \note    The block is returned to the pool if the pool is not full, otherwise it is freed.
+     *          This method can be called from any thread.
+     */
+    void release(void *block);
+
+    /*!
+     * Gets the pool statistics
+     *
+     * \return  Pool statistics
+     */
+    Statistics statistics() const;
+
+private:
+    //! Holds a cell of the free block queue
+    struct Cell
+    {
+        //! Holds the sequence number used to synchronize the access to the cell
+        std::atomic<std::size_t> sequence;
+
+        //! Holds the free block
+        void *block;
+    };
+
+private:
+    /*!
+     * Puts a free block in the pool
+     *
+     * \retval  true    Success
+     * \retval  false   Failure (pool is full)
+     */
+    bool push(void *block);
+
+    /*!
+     * Takes a free block from the pool
+     *
+     * \retval  true    Success
+     * \retval  false   Failure (pool is empty)
+     */
+    bool pop(void **block);
+
+private:
+    //! Holds the size of the memory blocks
+    const std::size_t m_blockSize;
+
+    //! Holds the number of cells in the free block queue (zero or a power of two)
+    const std::size_t m_cellCount;
+
+    //! Holds the free block queue
+    std::unique_ptr<Cell[]> m_cells;
+
+    //! Holds the position at which the next free block is put
+    std::atomic<std::size_t> m_pushPosition;
+
+    //! Holds the position from which the next free block is taken
+    std::atomic<std::size_t> m_popPosition;
+
+    //! Holds the number of allocations served from the pool
+    std::atomic<std::uint64_t> m_hits;
+
+    //! Holds the number of allocations that needed a new block from the heap
+    std::atomic<std::uint64_t> m_misses;
+
+    //! Holds the number of blocks that are currently allocated
+    std::atomic<std::int64_t> m_allocatedCount;
+
+    //! Holds the highest number of blocks that were allocated at the same time
+    std::atomic<std::int64_t> m_highWaterMark;
+};
+
+} // namespace CppStateMachineFramework
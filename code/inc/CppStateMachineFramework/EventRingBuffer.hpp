@@ -0,0 +1,186 @@
+/* This file is part of C++ State Machine Framework.
+ *
+ * C++ State Machine Framework is free software: you can redistribute it and/or modify it under the
+ * terms of the GNU Lesser General Public License as published by the Free Software Foundation,
+ * either version 3 of the License, or (at your option) any later version.
+ *
+ * C++ State Machine Framework is distributed in the hope that it will be useful, but WITHOUT ANY
+ * WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR
+ * PURPOSE. See the GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License along with C++ State
+ * Machine Framework. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+/*!
+ * \file
+ *
+ * Contains a double-ended event queue stored in a ring buffer
+ */
+
+#pragma once
+
+// C++ State Machine Framework includes
+#include <CppStateMachineFramework/Event.hpp>
+
+// Qt includes
+
+// System includes
+#include <vector>
+
+// Forward declarations
+
+// Macros
+
+// -------------------------------------------------------------------------------------------------
+
+namespace CppStateMachineFramework
+{
+
+/*!
+ * This class holds a double-ended event queue stored in a ring buffer
+ *
+ * The events are stored in a single contiguous buffer whose capacity is a power of two so that the
+ * position of an event in the buffer is found with a mask instead of a division. The buffer grows
+ * (its capacity is doubled) only when an event is added to a full queue, so a queue whose capacity
+ * was reserved up front does not allocate any memory when events are added or taken.
+ *
+ * \note    The class is not thread safe.
+ */
+class CPPSTATEMACHINEFRAMEWORK_EXPORT EventRingBuffer
+{
+public:
+    //! Constructor
+    EventRingBuffer();
+
+    //! Copy constructor is disabled
+    EventRingBuffer(const EventRingBuffer &) = delete;
+
+    //! Move constructor
+    EventRingBuffer(EventRingBuffer &&other) noexcept;
+
+    //! Destructor
+    ~EventRingBuffer() = default;
+
+    //! Copy assignment operator is disabled
+    EventRingBuffer &operator=(const EventRingBuffer &) = delete;
+
+    //! Move assignment operator
+    EventRingBuffer &operator=(EventRingBuffer &&other) noexcept;
+
+    /*!
+     * Checks if the queue is empty
+     *
+     * \retval  true    Queue is empty
+     * \retval  false   Queue is not empty
+     */
+    bool isEmpty() const;
+
+    /*!
+     * Gets the number of events in the queue
+     *
+     * \return  Number of events
+     */
+    std::size_t size() const;
+
+    /*!
+     * Gets the number of events that can be held in the queue without growing the buffer
+     *
+     * \return  Capacity
+     */
+    std::size_t capacity() const;
+
+    /*!
+     * Grows the buffer so that it can hold at least the given number of events
+     *
+     * \param   capacity    Capacity (rounded up to a power of two)
+     */
+    void reserve(std::size_t capacity);
+
+    /*!
+     * Gets the event at the front of the queue
+     *
+     * \return  Event
+     *
+     * \note    The queue must not be empty
+     */
+    Event &front();
+
+    /*!
+     * Gets the event at the position in the queue
+     *
+     * \param   index   Position in the queue (counted from the front)
+     *
+     * \return  Event
+     *
+     * \note    The position must be smaller than the size of the queue
+     */
+    Event &operator[](std::size_t index);
+
+    /*!
+     * Adds an event to the front of the queue
+     *
+     * \param   event   Event
+     */
+    void pushFront(Event &&event);
+
+    /*!
+     * Adds an event to the back of the queue
+     *
+     * \param   event   Event
+     */
+    void pushBack(Event &&event);
+
+    /*!
+     * Removes the events from the front of the queue
+     *
+     * \param   count   Number of events (must not be larger than the size of the queue)
+     */
+    void popFront(std::size_t count = 1U);
+
+    /*!
+     * Removes the events from the back of the queue
+     *
+     * \param   count   Number of events (must not be larger than the size of the queue)
+     */
+    void popBack(std::size_t count = 1U);
+
+    /*!
+     * Moves all events from the other queue to the position in this queue
+     *
+     * \param   index   Position in the queue (counted from the front, at most the queue size)
+     * \param   other   Queue whose events are moved (it is empty afterwards)
+     *
+     * \note    Only the events on the shorter side of the position are moved, so inserting the
+     *          events at the front or at the back of the queue does not depend on its size
+     */
+    void insert(std::size_t index, EventRingBuffer &other);
+
+    //! Removes all events from the queue (the buffer is kept)
+    void clear();
+
+private:
+    /*!
+     * Gets the event in the buffer
+     *
+     * \param   index   Position in the queue (counted from the front)
+     *
+     * \return  Event
+     */
+    Event &slot(std::size_t index);
+
+    //! Grows the buffer if the queue is full
+    void growIfFull();
+
+private:
+    //! Holds the buffer (unused slots hold invalid events)
+    std::vector<Event> m_buffer;
+
+    //! Holds the position of the front of the queue in the buffer
+    std::size_t m_head;
+
+    //! Holds the number of events in the queue
+    std::size_t m_size;
+};
+
+} // namespace CppStateMachineFramework
@@ -0,0 +1,198 @@
+/* This file is part of C++ State Machine Framework.
+ *
+ * C++ State Machine Framework is free software: you can redistribute it and/or modify it under the
+ * terms of the GNU Lesser General Public License as published by the Free Software Foundation,
+ * either version 3 of the License, or (at your option) any later version.
+ *
+ * C++ State Machine Framework is distributed in the hope that it will be useful, but WITHOUT ANY
+ * WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR
+ * PURPOSE. See the GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License along with C++ State
+ * Machine Framework. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+/*!
+ * \file
+ *
+ * Contains a lock-free multi-producer single-consumer event queue
+ */
+
+#pragma once
+
+// C++ State Machine Framework includes
+#include <CppStateMachineFramework/Event.hpp>
+#include <CppStateMachineFramework/EventPool.hpp>
+
+// Qt includes
+
+// System includes
+#include <atomic>
+
+// Forward declarations
+
+// Macros
+
+// -------------------------------------------------------------------------------------------------
+
+namespace CppStateMachineFramework
+{
+
+/*!
+ * This class holds a lock-free multi-producer single-consumer event queue
+ *
+ * The queue is an intrusive linked list of nodes. Producers append a node with a single atomic
+ * exchange of the head pointer so they never block each other or the consumer. The consumer takes
+ * the events from the tail of the list without any atomic read-modify-write operations.
+ *
+ * \note    Events can be added from any thread but they can be taken only from a single (consumer)
+ *          thread at a time.
+ *
+ * \note    An event whose addition is still in progress (the producer was preempted between the
+ *          exchange of the head pointer and linking of the previous node) is not yet visible to the
+ *          consumer, it becomes visible as soon as the producer finishes the addition.
+ *
+ * \note    The nodes are allocated from an event pool so that a steady stream of events does not
+ *          allocate any memory after a warm-up.
+ */
+class CPPSTATEMACHINEFRAMEWORK_EXPORT MpscEventQueue
+{
+public:
+    //! Default capacity of the node pool
+    static constexpr int DefaultPoolCapacity = 256;
+
+public:
+    /*!
+     * Constructor
+     *
+     * \param   poolCapacity    Maximum number of free nodes held in the node pool
+     */
+    explicit MpscEventQueue(int poolCapacity = DefaultPoolCapacity);
+
+    //! Copy constructor is disabled
+    MpscEventQueue(const MpscEventQueue &) = delete;
+
+    //! Move constructor is disabled
+    MpscEventQueue(MpscEventQueue &&) = delete;
+
+    //! Destructor
+    ~MpscEventQueue();
+
+    //! Copy assignment operator is disabled
+    MpscEventQueue &operator=(const MpscEventQueue &) = delete;
+
+    //! Move assignment operator is disabled
+    MpscEventQueue &operator=(MpscEventQueue &&) = delete;
+
+    /*!
+     * Checks if the queue is empty
+     *
+     * \retval  true    Queue is empty
+     * \retval  false   Queue is not empty
+     *
+     * \note    This method must be called only from the consumer thread. It checks the same link as
+     *          takeNext() so an event whose addition is still in progress is not seen by either.
+     */
+    bool isEmpty() const;
+
+    /*!
+     * Adds an event to the back of the queue
+     *
+     * \param   event   Event
+     *
+     * \note    This method can be called from any thread
+     */
+    void push(Event &&event);
+
+    /*!
+     * Takes the event from the front of the queue
+     *
+     * \param[out]  event   Output for the event
+     *
+     * \retval  true    Success
+     * \retval  false   Failure (queue is empty)
+     *
+     * \note    This method must be called only from the consumer thread
+     */
+    bool takeNext(Event *event);
+
+    /*!
+     * Visits the events in the queue (from the front to the back) without taking them
+     *
+     * \param   visitor     Function which is called with each event
+     *
+     * \note    This method must be called only from the consumer thread. Events added during the
+     *          visit may or may not be visited.
+     */
+    template<typename Visitor>
+    void forEach(Visitor visitor) const
+    {
+        for (const Node *node = m_tail->next.load(std::memory_order_acquire);
+             node != nullptr;
+             node = node->next.load(std::memory_order_acquire))
+        {
+            visitor(node->event);
+        }
+    }
+
+    /*!
+     * Removes all events from the queue
+     *
+     * \note    This method must be called only from the consumer thread
+     */
+    void clear();
+
+    /*!
+     * Gets the statistics of the node pool
+     *
+     * \return  Node pool statistics
+     */
+    EventPool::Statistics poolStatistics() const;
+
+private:
+    //! Holds a node of the queue
+    struct Node
+    {
+        //! Constructor
+        explicit Node(Event &&nodeEvent)
+            : next(nullptr),
+              event(std::move(nodeEvent))
+        {
+        }
+
+        //! Holds the next (newer) node
+        std::atomic<Node *> next;
+
+        //! Holds the event
+        Event event;
+    };
+
+private:
+    /*!
+     * Creates a node
+     *
+     * \param   event   Event
+     *
+     * \return  New node
+     */
+    Node *createNode(Event &&event);
+
+    /*!
+     * Destroys the node
+     *
+     * \param   node    Node
+     */
+    void destroyNode(Node *node);
+
+private:
+    //! Holds the pool from which the nodes are allocated
+    EventPool m_nodePool;
+
+    //! Holds the last added node (modified by the producers)
+    std::atomic<Node *> m_head;
+
+    //! Holds the node before the next event in the queue (modified only by the consumer)
+    Node *m_tail;
+};
+
+} // namespace CppStateMachineFramework
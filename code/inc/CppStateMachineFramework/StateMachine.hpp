@@ -21,15 +21,12 @@
 #pragma once
 
 // C++ State Machine Framework includes
-#include <CppStateMachineFramework/HashFunctions.hpp>
-#include <CppStateMachineFramework/StateMachineMethods.hpp>
+#include <CppStateMachineFramework/StateMachineInstance.hpp>
 
 // Qt includes
 #include <QtCore/QMutex>
 
 // System includes
-#include <deque>
-#include <unordered_map>
 
 // Forward declarations
 
@@ -40,22 +37,33 @@
 namespace CppStateMachineFramework
 {
 
-//! This class holds the state machine
+/*!
+ * This class holds the state machine
+ *
+ * The state machine combines its own state machine definition with a single state machine instance.
+ * To run many instances of the same state machine use StateMachineDefinition and
+ * StateMachineInstance directly.
+ */
 class CPPSTATEMACHINEFRAMEWORK_EXPORT StateMachine
 {
 public:
-    //! Enumerates the validation states
-    enum class ValidationStatus
-    {
-        //! Validation was not executed or the state machine was changed after last validation
-        Unvalidated,
+    //! Type alias for the validation states
+    using ValidationStatus = StateMachineDefinition::ValidationStatus;
+
+    //! Type alias for the event queue modes
+    using EventQueueMode = StateMachineInstance::EventQueueMode;
+
+    //! Type alias for the coalescing policies
+    using CoalescingPolicy = StateMachineInstance::CoalescingPolicy;
 
-        //! State machine is valid (validation was successful)
-        Valid,
+    //! Type alias for the backpressure policies
+    using BackpressurePolicy = StateMachineInstance::BackpressurePolicy;
 
-        //! State machine is not valid (validation failed)
-        Invalid
-    };
+    //! Type alias for the backpressure statistics
+    using BackpressureStatistics = StateMachineInstance::BackpressureStatistics;
+
+    //! Type alias for the execution modes
+    using ExecutionMode = StateMachineInstance::ExecutionMode;
 
 public:
     //! Constructor
@@ -92,6 +100,333 @@ public:
      */
     bool validate();
 
+    /*!
+     * Gets the event queue mode
+     *
+     * \return  Event queue mode
+     */
+    EventQueueMode eventQueueMode() const;
+
+    /*!
+     * Sets the event queue mode
+     *
+     * \param   mode    Event queue mode
+     *
+     * \retval  true    Success
+     * \retval  false   Failure (state machine not stopped or the lock-free event queue mode was
+     *                  requested while a coalescing policy, an event queue capacity or a
+     *                  backpressure policy other than the default one is set)
+     *
+     * \see StateMachineInstance::setEventQueueMode()
+     */
+    bool setEventQueueMode(EventQueueMode mode);
+
+    /*!
+     * Gets the execution mode
+     *
+     * \return  Execution mode
+     */
+    ExecutionMode executionMode() const;
+
+    /*!
+     * Sets the execution mode
+     *
+     * \param   mode    Execution mode
+     *
+     * \retval  true    Success
+     * \retval  false   Failure (state machine not stopped)
+     *
+     * \note    In the single-owner execution mode the configuration methods are not synchronized
+     *          either, they must be called only from the owner thread
+     *
+     * \see StateMachineInstance::setExecutionMode()
+     */
+    bool setExecutionMode(ExecutionMode mode);
+
+    /*!
+     * Gets the state machine instance which uses the state machine definition
+     *
+     * \return  State machine instance
+     *
+     * \note    This can be used to add the state machine to a StateMachineExecutor
+     */
+    StateMachineInstance &instance();
+
+    /*!
+     * Gets the maximum number of events that poll() takes from the event queue at once
+     *
+     * \return  Poll batch size (zero means that the whole event queue is taken at once)
+     */
+    int pollBatchSize() const;
+
+    /*!
+     * Sets the maximum number of events that poll() takes from the event queue at once
+     *
+     * \param   batchSize   Poll batch size (zero means that the whole event queue is taken at once)
+     *
+     * \retval  true    Success
+     * \retval  false   Failure (negative batch size)
+     *
+     * \see StateMachineInstance::setPollBatchSize()
+     */
+    bool setPollBatchSize(int batchSize);
+
+    /*!
+     * Gets the maximum number of free memory blocks held in each of the event pools
+     *
+     * \return  Event pool capacity
+     */
+    int eventPoolCapacity() const;
+
+    /*!
+     * Sets the maximum number of free memory blocks held in each of the event pools
+     *
+     * \param   capacity    Event pool capacity (zero disables the pooling)
+     *
+     * \retval  true    Success
+     * \retval  false   Failure (negative capacity, state machine not stopped)
+     *
+     * \see StateMachineInstance::setEventPoolCapacity()
+     */
+    bool setEventPoolCapacity(int capacity);
+
+    /*!
+     * Gets the combined statistics of the event pools
+     *
+     * \return  Event pool statistics
+     *
+     * \see StateMachineInstance::eventPoolStatistics()
+     */
+    EventPool::Statistics eventPoolStatistics() const;
+
+    /*!
+     * Gets the maximum number of times waitForEvents() checks for events before it blocks
+     *
+     * \return  Wait spin count
+     */
+    int waitSpinCount() const;
+
+    /*!
+     * Sets the maximum number of times waitForEvents() checks for events before it blocks
+     *
+     * \param   spinCount   Wait spin count (zero means that the thread blocks immediately)
+     *
+     * \retval  true    Success
+     * \retval  false   Failure (negative spin count)
+     *
+     * \see StateMachineInstance::setWaitSpinCount()
+     */
+    bool setWaitSpinCount(int spinCount);
+
+    /*!
+     * Gets the timing wheel used for the delayed events
+     *
+     * \return  Timing wheel or nullptr if the default timing wheel is used
+     */
+    std::shared_ptr<TimerWheel> timerWheel() const;
+
+    /*!
+     * Sets the timing wheel used for the delayed events
+     *
+     * \param   timerWheel  Timing wheel (nullptr means the default timing wheel)
+     *
+     * \retval  true    Success
+     * \retval  false   Failure (state machine is started)
+     *
+     * \see StateMachineInstance::setTimerWheel()
+     */
+    bool setTimerWheel(std::shared_ptr<TimerWheel> timerWheel);
+
+    /*!
+     * Gets the maximum number of pending events in the event queue
+     *
+     * \return  Event queue capacity (zero means unbounded)
+     */
+    int eventQueueCapacity() const;
+
+    /*!
+     * Sets the maximum number of pending events in the event queue
+     *
+     * \param   capacity    Event queue capacity (zero means unbounded)
+     *
+     * \retval  true    Success
+     * \retval  false   Failure (negative capacity, state machine not stopped or a non-zero
+     *                  capacity in the lock-free event queue mode)
+     *
+     * \see StateMachineInstance::setEventQueueCapacity()
+     */
+    bool setEventQueueCapacity(int capacity);
+
+    /*!
+     * Gets the policy applied when an event is added to the back of a full event queue
+     *
+     * \return  Backpressure policy
+     */
+    BackpressurePolicy backpressurePolicy() const;
+
+    /*!
+     * Gets the time for which the producer is blocked with the blocking backpressure policy
+     *
+     * \return  Timeout in milliseconds (negative value means no timeout)
+     */
+    int backpressureTimeout() const;
+
+    /*!
+     * Sets the policy applied when an event is added to the back of a full event queue
+     *
+     * \param   policy      Backpressure policy
+     * \param   timeout     Time for which the producer is blocked with the blocking policy (in
+     *                      milliseconds, negative value means no timeout)
+     *
+     * \retval  true    Success
+     * \retval  false   Failure (state machine not stopped or a policy other than the default one
+     *                  in the lock-free event queue mode)
+     *
+     * \see StateMachineInstance::setBackpressurePolicy()
+     */
+    bool setBackpressurePolicy(BackpressurePolicy policy, int timeout = -1);
+
+    /*!
+     * Gets the backpressure statistics
+     *
+     * \return  Backpressure statistics
+     */
+    BackpressureStatistics backpressureStatistics() const;
+
+    /*!
+     * Checks if the runtime metrics are enabled
+     *
+     * \retval  true    Enabled
+     * \retval  false   Disabled
+     */
+    bool metricsEnabled() const;
+
+    /*!
+     * Enables or disables the runtime metrics
+     *
+     * \param   enabled     Metrics are recorded
+     *
+     * \retval  true    Success
+     * \retval  false   Failure (state machine is started)
+     *
+     * \see StateMachineInstance::setMetricsEnabled()
+     */
+    bool setMetricsEnabled(bool enabled);
+
+    /*!
+     * Gets a copy of the runtime metrics
+     *
+     * \return  Metrics (empty if the metrics are disabled or the state machine was not started yet)
+     *
+     * \see StateMachineInstance::metrics()
+     */
+    StateMachineMetrics::Snapshot metrics() const;
+
+    //! Clears the runtime metrics
+    void resetMetrics();
+
+    /*!
+     * Gets the observer of the event processing
+     *
+     * \return  Observer or nullptr if no observer is set
+     */
+    std::shared_ptr<IStateMachineObserver> observer() const;
+
+    /*!
+     * Sets the observer of the event processing
+     *
+     * \param   observer    Observer (nullptr removes the observer)
+     *
+     * \retval  true    Success
+     * \retval  false   Failure (state machine is started)
+     *
+     * \see StateMachineInstance::setObserver()
+     */
+    bool setObserver(std::shared_ptr<IStateMachineObserver> observer);
+
+    /*!
+     * Gets the ID under which the processed events are written to the flight recorder
+     *
+     * \return  Machine ID or 0 if the events are not recorded
+     */
+    std::uint64_t traceMachineId() const;
+
+    /*!
+     * Sets the ID under which the processed events are written to the flight recorder
+     *
+     * \param   machineId   Machine ID (0 disables the recording)
+     *
+     * \retval  true    Success
+     * \retval  false   Failure (state machine is started)
+     *
+     * \see StateMachineInstance::setTraceMachineId()
+     */
+    bool setTraceMachineId(std::uint64_t machineId);
+
+    /*!
+     * Gets the journal of the events
+     *
+     * \return  Journal or nullptr if the events are not journaled
+     */
+    std::shared_ptr<EventJournal> journal() const;
+
+    /*!
+     * Sets the journal of the events
+     *
+     * \param   journal     Journal (nullptr disables the journaling)
+     *
+     * \retval  true    Success
+     * \retval  false   Failure (state machine is started, lock-free event queue mode or an event
+     *                  coalescing policy is set)
+     *
+     * \see StateMachineInstance::setJournal()
+     */
+    bool setJournal(std::shared_ptr<EventJournal> journal);
+
+    /*!
+     * Takes a snapshot of the state machine
+     *
+     * \return  Snapshot or an empty byte array on failure
+     *
+     * \see StateMachineInstance::snapshot()
+     */
+    QByteArray snapshot();
+
+    /*!
+     * Restores the state machine from the snapshot
+     *
+     * \param   snapshot    Snapshot taken with snapshot()
+     *
+     * \retval  true    Success
+     * \retval  false   Failure
+     *
+     * \see StateMachineInstance::restore()
+     */
+    bool restore(const QByteArray &snapshot);
+
+    /*!
+     * Gets the coalescing policy of the event
+     *
+     * \param   eventName   Event name
+     *
+     * \return  Coalescing policy
+     */
+    CoalescingPolicy eventCoalescingPolicy(const QString &eventName) const;
+
+    /*!
+     * Sets the coalescing policy of the event
+     *
+     * \param   eventName   Event name
+     * \param   policy      Coalescing policy
+     *
+     * \retval  true    Success
+     * \retval  false   Failure (empty event name, state machine not stopped or lock-free event
+     *                  queue mode)
+     *
+     * \see StateMachineInstance::setEventCoalescingPolicy()
+     */
+    bool setEventCoalescingPolicy(const QString &eventName, CoalescingPolicy policy);
+
     /*!
      * Checks if the state machine is started
      *
@@ -196,6 +531,21 @@ public:
         return addEventToFront(Event(eventName, std::move(eventParameter)));
     }
 
+    /*!
+     * Adds an event to the front of the event queue
+     *
+     * \param   eventId         Event ID (registered event name)
+     * \param   eventParameter  Event parameter
+     *
+     * \retval  true    Success
+     * \retval  false   Failure (invalid event ID, state machine not started)
+     */
+    inline bool addEventToFront(EventId eventId,
+                                std::unique_ptr<IEventParameter> &&eventParameter = {})
+    {
+        return addEventToFront(Event(eventId, std::move(eventParameter)));
+    }
+
     /*!
      * Adds an event to the back of the event queue
      *
@@ -221,6 +571,124 @@ public:
         return addEventToBack(Event(eventName, std::move(eventParameter)));
     }
 
+    /*!
+     * Adds an event to the back of the event queue
+     *
+     * \param   eventId         Event ID (registered event name)
+     * \param   eventParameter  Event parameter
+     *
+     * \retval  true    Success
+     * \retval  false   Failure (invalid event ID, state machine not started)
+     */
+    inline bool addEventToBack(EventId eventId,
+                               std::unique_ptr<IEventParameter> &&eventParameter = {})
+    {
+        return addEventToBack(Event(eventId, std::move(eventParameter)));
+    }
+
+    /*!
+     * Adds an event with the priority to the event queue
+     *
+     * \param   event       Event
+     * \param   priority    Event priority (from StateMachineInstance::NormalEventPriority to
+     *                      StateMachineInstance::HighestEventPriority)
+     *
+     * \retval  true    Success
+     * \retval  false   Failure (empty event name, invalid priority, state machine not started)
+     *
+     * \see StateMachineInstance::addEvent()
+     */
+    bool addEvent(Event &&event, int priority);
+
+    /*!
+     * Adds an event with the priority to the event queue
+     *
+     * \param   eventName       Event name
+     * \param   priority        Event priority
+     * \param   eventParameter  Event parameter
+     *
+     * \retval  true    Success
+     * \retval  false   Failure (empty event name, invalid priority, state machine not started)
+     */
+    inline bool addEvent(const QString &eventName,
+                         int priority,
+                         std::unique_ptr<IEventParameter> &&eventParameter = {})
+    {
+        return addEvent(Event(eventName, std::move(eventParameter)), priority);
+    }
+
+    /*!
+     * Adds an event to the event queue after the delay
+     *
+     * \param   delay       Delay in milliseconds
+     * \param   event       Event
+     * \param   priority    Event priority
+     *
+     * \return  Timer ID of the delayed event or InvalidTimerId on failure
+     *
+     * \see StateMachineInstance::addEventAfter()
+     */
+    TimerId addEventAfter(int delay,
+                          Event &&event,
+                          int priority = StateMachineInstance::NormalEventPriority);
+
+    /*!
+     * Adds an event to the event queue after the delay
+     *
+     * \param   delay           Delay in milliseconds
+     * \param   eventName       Event name
+     * \param   eventParameter  Event parameter
+     *
+     * \return  Timer ID of the delayed event or InvalidTimerId on failure
+     */
+    inline TimerId addEventAfter(int delay,
+                                 const QString &eventName,
+                                 std::unique_ptr<IEventParameter> &&eventParameter = {})
+    {
+        return addEventAfter(delay, Event(eventName, std::move(eventParameter)));
+    }
+
+    /*!
+     * Adds an event to the event queue after the delay unless the current state is exited first
+     *
+     * \param   delay       Delay in milliseconds
+     * \param   event       Event
+     * \param   priority    Event priority
+     *
+     * \return  Timer ID of the delayed event or InvalidTimerId on failure
+     *
+     * \see StateMachineInstance::addStateEventAfter()
+     */
+    TimerId addStateEventAfter(int delay,
+                               Event &&event,
+                               int priority = StateMachineInstance::NormalEventPriority);
+
+    /*!
+     * Adds an event to the event queue after the delay unless the current state is exited first
+     *
+     * \param   delay           Delay in milliseconds
+     * \param   eventName       Event name
+     * \param   eventParameter  Event parameter
+     *
+     * \return  Timer ID of the delayed event or InvalidTimerId on failure
+     */
+    inline TimerId addStateEventAfter(int delay,
+                                      const QString &eventName,
+                                      std::unique_ptr<IEventParameter> &&eventParameter = {})
+    {
+        return addStateEventAfter(delay, Event(eventName, std::move(eventParameter)));
+    }
+
+    /*!
+     * Cancels the delayed event
+     *
+     * \param   timerId     Timer ID of the delayed event
+     *
+     * \retval  true    Success
+     * \retval  false   Failure (event already added to the event queue or cancelled)
+     */
+    bool cancelDelayedEvent(TimerId timerId);
+
     /*!
      * Processes the next pending event
      *
@@ -237,6 +705,28 @@ public:
      */
     bool poll();
 
+    /*!
+     * Waits until there are pending events or the state machine is stopped
+     *
+     * \param   timeout     Timeout in milliseconds (negative value means no timeout)
+     *
+     * \retval  true    Pending events are available
+     * \retval  false   Failure (timeout, state machine not started)
+     *
+     * \see StateMachineInstance::waitForEvents()
+     */
+    bool waitForEvents(int timeout = -1);
+
+    /*!
+     * Processes the events until the state machine is stopped
+     *
+     * \retval  true    Success (state machine was stopped)
+     * \retval  false   Failure (state machine not started, failed to process pending events)
+     *
+     * \see StateMachineInstance::runUntilStopped()
+     */
+    bool runUntilStopped();
+
     /*!
      * Adds a new state to the state machine
      *
@@ -318,6 +808,8 @@ public:
      *
      * A state transition is the only way for the state machine to change the state machine state
      * from one state to another and it is triggered by the specified event.
+     *
+     * \note    The trigger's name gets registered in the EventNameRegistry
      */
     bool addStateTransition(const QString &fromState,
                             const QString &trigger,
@@ -342,6 +834,8 @@ public:
      *
      * A similar effect can be achieved by creating a self-transition (transition from one state to
      * itself) but in this case the state's exit and entry actions would be executed.
+     *
+     * \note    The trigger's name gets registered in the EventNameRegistry
      */
     bool addInternalTransition(const QString &state,
                                const QString &trigger,
@@ -390,166 +884,31 @@ public:
                               InternalTransitionAction action,
                               InternalTransitionGuardCondition guard = {});
 
-private:
-    //! Holds the initial transition data
-    struct InitialTransitionData
-    {
-        //! Holds the name of the initial state
-        QString state;
-
-        //! Holds an initial transition action method
-        InitialTransitionAction action;
-    };
-
-    //! Holds the state transition data
-    struct StateTransitionData
-    {
-        //! Holds the name of the state to transition to
-        QString state;
-
-        //! Holds an optional state transition guard method
-        StateTransitionGuardCondition guard;
-
-        //! Holds an optional state transition action method
-        StateTransitionAction action;
-    };
-
-    //! Holds the internal transition data
-    struct InternalTransitionData
-    {
-        //! Holds an optional internal transition guard method
-        InternalTransitionGuardCondition guard;
-
-        //! Holds an internal transition action method
-        InternalTransitionAction action;
-    };
-
-    //! Holds the state data
-    struct StateData
-    {
-        //! Holds an optional state entry action method
-        StateEntryAction entryAction;
-
-        //! Holds an optional state action method
-        StateAction stateAction;
-
-        //! Holds an optional state exit action method
-        StateExitAction exitAction;
-
-        /*!
-         * Holds the state's state transitions. The key contains the name of the event that triggers
-         * the transition and the value contains the state transition data.
-         */
-        std::unordered_map<QString, StateTransitionData> stateTransitions;
-
-        /*!
-         * Holds the state's internal transitions. The key contains the name of the event that
-         * triggers the transition and the value contains the state transition data.
-         */
-        std::unordered_map<QString, InternalTransitionData> internalTransitions;
-
-        //! Holds the state's optional default state transitions
-        std::unique_ptr<StateTransitionData> defaultStateTransition;
-
-        //! Holds the state's optional default internal transitions
-        std::unique_ptr<InternalTransitionData> defaultInternalTransition;
-    };
-
 private:
     /*!
-     * Stops the state machine
+     * Gets the state machine definition (a new definition is created if needed)
      *
-     * \retval  true    Success
-     * \retval  false   Failure (state machine already stopped)
+     * \return  State machine definition
      *
-     * \note    The only difference between stopInternal() and stop() is that stopInternal() assumes
-     *          that the mutex is already locked and stop() locks the mutex. This method is needed
-     *          just to be able to stop the state machine after the mutex was locked.
+     * \note    The definition will be missing only in a state machine that was moved from
      */
-    bool stopInternal();
+    StateMachineDefinition &definition();
 
     /*!
-     * Processes the event
-     *
-     * \param   event   Event to process
+     * Gets the mutex used to make the configuration API thread safe
      *
-     * \retval  true    Success
-     * \retval  false   Failure (invalid current state)
-     */
-    bool processEvent(Event &&event);
-
-    /*!
-     * Traverses from the specified state to all possible states from the configured transitions
-     *
-     * \param   stateName   Name of the state where the traversal will be started
-     *
-     * \param[in,out]   statesReached   Container for recording all the reached states
+     * \return  API mutex or nullptr in the single-owner execution mode
      */
-    void traverseStates(const QString &stateName, QSet<QString> *statesReached) const;
-
-    /*!
-     * Checks if the specified state is a final state
-     *
-     * \param   stateData   State data
-     *
-     * \retval  true    Specified state is a final state
-     * \retval  false   Specified state is not a final state
-     */
-    bool isFinalState(const StateData &stateData) const;
-
-    /*!
-     * Executes the initial transition
-     *
-     * \param   event   Event that triggered the transition
-     */
-    void executeInitialTransition(Event &&event);
-
-    /*!
-     * Executes the state transition
-     *
-     * \param   transitionData  Transition data
-     * \param   event           Event that triggered the transition
-     */
-    void executeStateTransition(const StateTransitionData &transitionData, Event &&event);
-
-    /*!
-     * Executes the internal transition
-     *
-     * \param   transitionData  Transition data
-     * \param   event           Event that triggered the transition
-     */
-    void executeInternalTransition(const InternalTransitionData &transitionData,
-                                   const Event &event);
+    QMutex *apiMutex() const;
 
 private:
-    //! Holds all states in the state machine
-    std::unordered_map<QString, StateData> m_states;
-
-    //! Holds the initial transition of the state machine
-    InitialTransitionData m_initialTransition;
-
-    //! Holds the validation status
-    ValidationStatus m_validationStatus;
-
-    //! Holds the started flag
-    bool m_started;
-
-    //! Holds the name of the current state of the state machine
-    QString m_currentState;
-
-    //! Holds the queued events
-    std::deque<Event> m_eventQueue;
-
-    //! Holds the event which triggered the transition to the final state
-    std::unique_ptr<Event> m_finalEvent;
-
-    //! Holds the mutex used to make access to the started flag thread safe
-    mutable QMutex m_startedMutex;
+    //! Holds the state machine definition
+    std::shared_ptr<StateMachineDefinition> m_definition;
 
-    //! Holds the mutex used to make access to the event queue thread safe
-    mutable QMutex m_eventQueueMutex;
+    //! Holds the state machine instance which uses the state machine definition
+    StateMachineInstance m_instance;
 
-    //! Holds the mutex used to make the API thread safe
+    //! Holds the mutex used to make the configuration API thread safe
     mutable QMutex m_apiMutex;
 };
 
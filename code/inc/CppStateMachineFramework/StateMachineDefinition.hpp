@@ -0,0 +1,507 @@
+/* This file is part of C++ State Machine Framework.
+ *
+ * C++ State Machine Framework is free software: you can redistribute it and/or modify it under the
+ * terms of the GNU Lesser General Public License as published by the Free Software Foundation,
+ * either version 3 of the License, or (at your option) any later version.
+ *
+ * C++ State Machine Framework is distributed in the hope that it will be useful, but WITHOUT ANY
+ * WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR
+ * PURPOSE. See the GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License along with C++ State
+ * Machine Framework. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+/*!
+ * \file
+ *
+ * Contains a class for a state machine definition
+ */
+
+#pragma once
+
+// C++ State Machine Framework includes
+#include <CppStateMachineFramework/HashFunctions.hpp>
+#include <CppStateMachineFramework/StateMachineMethods.hpp>
+
+// Qt includes
+
+// System includes
+#include <unordered_map>
+#include <vector>
+
+// Forward declarations
+
+// Macros
+
+// -------------------------------------------------------------------------------------------------
+
+namespace CppStateMachineFramework
+{
+
+/*!
+ * This class holds the definition of a state machine (states, transitions and their actions)
+ *
+ * A definition is configured with the builder methods and then validated. A valid definition can
+ * be shared (as a std::shared_ptr to a const definition) by any number of StateMachineInstance
+ * objects which hold only the runtime state of a state machine.
+ *
+ * \note    The builder methods are not thread safe and the definition must not be modified while it
+ *          is shared with any of the state machine instances.
+ */
+class CPPSTATEMACHINEFRAMEWORK_EXPORT StateMachineDefinition
+{
+public:
+    //! Enumerates the validation states
+    enum class ValidationStatus
+    {
+        //! Validation was not executed or the definition was changed after last validation
+        Unvalidated,
+
+        //! Definition is valid (validation was successful)
+        Valid,
+
+        //! Definition is not valid (validation failed)
+        Invalid
+    };
+
+    //! Holds the initial transition data
+    struct InitialTransitionData
+    {
+        //! Holds the index of the initial state (negative if not set)
+        int state;
+
+        //! Holds an initial transition action method
+        InitialTransitionAction action;
+    };
+
+    //! Holds the state transition data
+    struct StateTransitionData
+    {
+        //! Holds the index of the state to transition to
+        int state;
+
+        //! Holds an optional state transition guard method
+        StateTransitionGuardCondition guard;
+
+        //! Holds an optional state transition action method
+        StateTransitionAction action;
+
+        //! Holds the index of the transition in the definition (set by validate())
+        int index = -1;
+    };
+
+    //! Holds the internal transition data
+    struct InternalTransitionData
+    {
+        //! Holds an optional internal transition guard method
+        InternalTransitionGuardCondition guard;
+
+        //! Holds an internal transition action method
+        InternalTransitionAction action;
+
+        //! Holds the index of the transition in the definition (set by validate())
+        int index = -1;
+    };
+
+    //! Holds the information about a transition of a valid definition
+    struct TransitionInfo
+    {
+        //! Holds the index of the state to which the transition belongs to
+        int fromState;
+
+        //! Holds the ID of the event that triggers the transition (InvalidEventId for a default
+        //! transition)
+        EventId trigger;
+
+        //! Holds the index of the state to transition to (negative for an internal transition)
+        int toState;
+    };
+
+    //! Holds the state data
+    struct StateData
+    {
+        //! Holds the state's name
+        QString name;
+
+        //! Holds an optional state entry action method
+        StateEntryAction entryAction;
+
+        //! Holds an optional state action method
+        StateAction stateAction;
+
+        //! Holds an optional state exit action method
+        StateExitAction exitAction;
+
+        /*!
+         * Holds the state's state transitions. The key contains the ID of the event that triggers
+         * the transition and the value contains the state transition data.
+         */
+        std::unordered_map<EventId, StateTransitionData> stateTransitions;
+
+        /*!
+         * Holds the state's internal transitions. The key contains the ID of the event that
+         * triggers the transition and the value contains the state transition data.
+         */
+        std::unordered_map<EventId, InternalTransitionData> internalTransitions;
+
+        //! Holds the state's optional default state transitions
+        std::unique_ptr<StateTransitionData> defaultStateTransition;
+
+        //! Holds the state's optional default internal transitions
+        std::unique_ptr<InternalTransitionData> defaultInternalTransition;
+    };
+
+    /*!
+     * Holds an entry of the compiled transition table
+     *
+     * At most one of the transitions is set. If none of them is set then the event is ignored.
+     */
+    struct CompiledTransition
+    {
+        //! Holds the state transition to execute (or nullptr)
+        const StateTransitionData *stateTransition;
+
+        //! Holds the internal transition to execute (or nullptr)
+        const InternalTransitionData *internalTransition;
+    };
+
+public:
+    //! Constructor
+    StateMachineDefinition();
+
+    //! Copy constructor is disabled
+    StateMachineDefinition(const StateMachineDefinition &) = delete;
+
+    //! Move constructor
+    StateMachineDefinition(StateMachineDefinition &&other) = default;
+
+    //! Destructor
+    ~StateMachineDefinition() = default;
+
+    //! Copy assignment operator is disabled
+    StateMachineDefinition &operator=(const StateMachineDefinition &) = delete;
+
+    //! Move assignment operator
+    StateMachineDefinition &operator=(StateMachineDefinition &&other) = default;
+
+    /*!
+     * Gets the validation status of the definition
+     *
+     * \return  Validation status
+     */
+    ValidationStatus validationStatus() const;
+
+    /*!
+     * Validates the state and state transitions and compiles them into the transition table
+     *
+     * \retval  true    Success
+     * \retval  false   Failure (no states, no initial transition, invalid final states,
+     *                  unreachable states)
+     */
+    bool validate();
+
+    /*!
+     * Adds a new state to the definition
+     *
+     * \param   stateName   State name
+     *
+     * \retval  true    Success
+     * \retval  false   Failure (empty state name or duplicate state)
+     */
+    bool addState(const QString &stateName);
+
+    /*!
+     * Sets a state's entry action
+     *
+     * \param   stateName   State name
+     * \param   entryAction State entry action method
+     *
+     * \retval  true    Success
+     * \retval  false   Failure (empty action, state does not exit)
+     */
+    bool setStateEntryAction(const QString &stateName, StateEntryAction entryAction);
+
+    /*!
+     * Sets a state's state action
+     *
+     * \param   stateName   State name
+     * \param   stateAction State action method
+     *
+     * \retval  true    Success
+     * \retval  false   Failure (empty action, state does not exit)
+     */
+    bool setStateAction(const QString &stateName, StateAction stateAction);
+
+    /*!
+     * Sets a state's exit action
+     *
+     * \param   stateName   State name
+     * \param   exitAction  State exit action method
+     *
+     * \retval  true    Success
+     * \retval  false   Failure (empty action, state does not exit)
+     */
+    bool setStateExitAction(const QString &stateName, StateExitAction exitAction);
+
+    /*!
+     * Gets the initial state of the definition
+     *
+     * \return  State name
+     */
+    QString initialState() const;
+
+    /*!
+     * Sets an existing state as the initial state of the state machine
+     *
+     * \param   initialState    Name of an existing state to use as the initial state
+     * \param   action          Optional transition action method
+     *
+     * \retval  true    Success
+     * \retval  false   Failure (already set, state does not exit)
+     *
+     * \see StateMachine::setInitialTransition()
+     */
+    bool setInitialTransition(const QString &initialState, InitialTransitionAction action = {});
+
+    /*!
+     * Adds a new state transition
+     *
+     * \param   fromState   Name of the state to transition from
+     * \param   trigger     Name of the event that triggers the transition
+     * \param   toState     Name of the state to transition to
+     * \param   action      Optional state transition action method
+     * \param   guard       Optional state transition guard condition method
+     *
+     * \retval  true    Success
+     * \retval  false   Failure (invalid state or event names, duplicate transition)
+     *
+     * \see StateMachine::addStateTransition()
+     */
+    bool addStateTransition(const QString &fromState,
+                            const QString &trigger,
+                            const QString &toState,
+                            StateTransitionAction action = {},
+                            StateTransitionGuardCondition guard = {});
+
+    /*!
+     * Adds a new internal transition
+     *
+     * \param   state   Name of the state to which the transition belongs to
+     * \param   trigger Name of the event that triggers the transition
+     * \param   action  Internal transition action method
+     * \param   guard   Optional internal transition guard condition method
+     *
+     * \retval  true    Success
+     * \retval  false   Failure (invalid state or event names, missing action, duplicate transition)
+     *
+     * \see StateMachine::addInternalTransition()
+     */
+    bool addInternalTransition(const QString &state,
+                               const QString &trigger,
+                               InternalTransitionAction action = {},
+                               InternalTransitionGuardCondition guard = {});
+
+    /*!
+     * Sets the default state transition
+     *
+     * \param   fromState   Name of the state to transition from
+     * \param   toState     Name of the state to transition to
+     * \param   action      Optional state transition action method
+     * \param   guard       Optional state transition guard condition method
+     *
+     * \retval  true    Success
+     * \retval  false   Failure (invalid state or event names, already set)
+     *
+     * \see StateMachine::setDefaultTransition()
+     */
+    bool setDefaultTransition(const QString &fromState,
+                              const QString &toState,
+                              StateTransitionAction action = {},
+                              StateTransitionGuardCondition guard = {});
+
+    /*!
+     * Sets the default internal transition
+     *
+     * \param   state   Name of the state to which the transition belongs to
+     * \param   action  Internal transition action method
+     * \param   guard   Optional internal transition guard condition method
+     *
+     * \retval  true    Success
+     * \retval  false   Failure (invalid state name, missing action, already set)
+     *
+     * \see StateMachine::setDefaultTransition()
+     */
+    bool setDefaultTransition(const QString &state,
+                              InternalTransitionAction action,
+                              InternalTransitionGuardCondition guard = {});
+
+    /*!
+     * Gets the number of states
+     *
+     * \return  Number of states
+     */
+    int stateCount() const;
+
+    /*!
+     * Gets the index of the state
+     *
+     * \param   stateName   State name
+     *
+     * \return  State index or a negative value if the state does not exist
+     */
+    int stateIndex(const QString &stateName) const;
+
+    /*!
+     * Gets the data of the state
+     *
+     * \param   stateIndex  Index of an existing state
+     *
+     * \return  State data
+     */
+    const StateData &state(int stateIndex) const;
+
+    /*!
+     * Gets the initial transition
+     *
+     * \return  Initial transition data
+     */
+    const InitialTransitionData &initialTransition() const;
+
+    /*!
+     * Checks if the specified state is a final state
+     *
+     * \param   stateIndex  Index of an existing state
+     *
+     * \retval  true    Specified state is a final state
+     * \retval  false   Specified state is not a final state
+     */
+    bool isFinalState(int stateIndex) const;
+
+    /*!
+     * Finds the transition for the specified state and event in the compiled transition table
+     *
+     * \param   stateIndex  Index of an existing state
+     * \param   eventId     ID of the event
+     *
+     * \return  Compiled transition
+     *
+     * \note    This method can only be used on a valid definition
+     */
+    const CompiledTransition &findTransition(int stateIndex, EventId eventId) const;
+
+    /*!
+     * Gets the number of transitions (state, internal and default transitions of all states)
+     *
+     * \return  Number of transitions
+     *
+     * \note    This method can only be used on a valid definition
+     */
+    int transitionCount() const;
+
+    /*!
+     * Gets the information about the transition
+     *
+     * \param   transitionIndex     Index of an existing transition
+     *
+     * \return  Transition information
+     *
+     * \note    This method can only be used on a valid definition
+     */
+    const TransitionInfo &transitionInfo(int transitionIndex) const;
+
+private:
+    //! Holds an entry of a state's row in the sparse transition table
+    struct SparseTransition
+    {
+        //! Holds the column of the event that triggers the transition
+        int column;
+
+        //! Holds the transition
+        CompiledTransition transition;
+    };
+
+    /*!
+     * Maximum number of entries in the dense transition table (number of states multiplied by the
+     * number of events that trigger transitions). Larger state machines use a sparse table.
+     */
+    static constexpr std::size_t MaxDenseTransitionTableSize = 1U << 18U;
+
+private:
+    /*!
+     * Traverses from the specified state to all possible states from the configured transitions
+     *
+     * \param   stateIndex  Index of the state where the traversal will be started
+     *
+     * \param[in,out]   statesReached   Container for recording all the reached states (by index)
+     *
+     * \note    The traversal is iterative so the depth of the state graph is not limited by the
+     *          size of the call stack
+     */
+    void traverseStates(int stateIndex, std::vector<bool> *statesReached) const;
+
+    /*!
+     * Checks if the specified state is a final state
+     *
+     * \param   stateData   State data
+     *
+     * \retval  true    Specified state is a final state
+     * \retval  false   Specified state is not a final state
+     */
+    static bool isFinalState(const StateData &stateData);
+
+    /*!
+     * Compiles the states and their transitions into the transition table
+     *
+     * Each event that triggers at least one transition gets its own column in the table and each
+     * state gets its own row. Column 0 is used for all other events (default transitions). Each
+     * transition also gets its own index.
+     */
+    void compileTransitionTable();
+
+    //! Clears the compiled transition table
+    void clearTransitionTable();
+
+private:
+    //! Holds all states in the definition (the position in the container is the state's index)
+    std::vector<StateData> m_states;
+
+    //! Holds the indexes of all states in the definition
+    std::unordered_map<QString, int> m_stateIndexes;
+
+    //! Holds the initial transition of the state machine
+    InitialTransitionData m_initialTransition;
+
+    //! Holds the validation status
+    ValidationStatus m_validationStatus;
+
+    /*!
+     * Holds the column in the transition table for each event ID (column 0 is used for events that
+     * do not trigger any of the transitions)
+     */
+    std::vector<int> m_eventColumns;
+
+    //! Holds the number of columns in the transition table
+    int m_columnCount;
+
+    //! Holds the flag that defines if the dense or the sparse transition table is used
+    bool m_denseTransitionTable;
+
+    //! Holds the dense transition table (row is the state index, column is the event's column)
+    std::vector<CompiledTransition> m_transitionTable;
+
+    //! Holds the offsets of each state's row in the sparse transition table
+    std::vector<int> m_sparseRowOffsets;
+
+    //! Holds the sparse transition table (rows are sorted by the event's column)
+    std::vector<SparseTransition> m_sparseTransitions;
+
+    //! Holds the default transitions of each state for the sparse transition table
+    std::vector<CompiledTransition> m_defaultTransitions;
+
+    //! Holds the information about all transitions (the position in the container is the
+    //! transition's index)
+    std::vector<TransitionInfo> m_transitions;
+};
+
+} // namespace CppStateMachineFramework
@@ -0,0 +1,314 @@
+/* This file is part of C++ State Machine Framework.
+ *
+ * C++ State Machine Framework is free software: you can redistribute it and/or modify it under the
+ * terms of the GNU Lesser General Public License as published by the Free Software Foundation,
+ * either version 3 of the License, or (at your option) any later version.
+ *
+ * C++ State Machine Framework is distributed in the hope that it will be useful, but WITHOUT ANY
+ * WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR
+ * PURPOSE. See the GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License along with C++ State
+ * Machine Framework. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+/*!
+ * \file
+ *
+ * Contains a class for an executor that processes the events of state machine instances
+ */
+
+#pragma once
+
+// C++ State Machine Framework includes
+#include <CppStateMachineFramework/StateMachineInstance.hpp>
+
+// Qt includes
+#include <QtCore/QMutex>
+#include <QtCore/QWaitCondition>
+
+// System includes
+#include <atomic>
+#include <deque>
+#include <memory>
+#include <thread>
+#include <unordered_map>
+#include <vector>
+
+// Forward declarations
+
+// Macros
+
+// -------------------------------------------------------------------------------------------------
+
+namespace CppStateMachineFramework
+{
+
+/*!
+ * This class holds an executor that processes the events of state machine instances with a fixed
+ * pool of worker threads
+ *
+ * An instance added to the executor is scheduled for processing only when an event is added to its
+ * event queue, so idle instances do not use any processing time. Each scheduled instance is
+ * processed by exactly one worker at a time which keeps the events of an instance serialized, while
+ * different instances are processed in parallel. A worker processes up to a batch of events of an
+ * instance and then moves on to the next scheduled instance. Each worker has its own queue of
+ * scheduled instances and idle workers steal scheduled instances from the other workers.
+ *
+ * \note    The executor only processes the events, it does not execute the state actions (use
+ *          StateMachineInstance::poll() for that).
+ */
+class CPPSTATEMACHINEFRAMEWORK_EXPORT StateMachineExecutor
+{
+public:
+    //! Default maximum number of events processed for an instance before moving on
+    static constexpr int DefaultBatchSize = 64;
+
+public:
+    /*!
+     * Constructor
+     *
+     * \param   workerCount     Number of worker threads (zero means the number of hardware threads)
+     */
+    explicit StateMachineExecutor(int workerCount = 0);
+
+    //! Copy constructor is disabled
+    StateMachineExecutor(const StateMachineExecutor &) = delete;
+
+    //! Move constructor is disabled
+    StateMachineExecutor(StateMachineExecutor &&) = delete;
+
+    //! Destructor (stops the executor and removes all instances)
+    ~StateMachineExecutor();
+
+    //! Copy assignment operator is disabled
+    StateMachineExecutor &operator=(const StateMachineExecutor &) = delete;
+
+    //! Move assignment operator is disabled
+    StateMachineExecutor &operator=(StateMachineExecutor &&) = delete;
+
+    /*!
+     * Gets the number of worker threads
+     *
+     * \return  Number of worker threads
+     */
+    int workerCount() const;
+
+    /*!
+     * Gets the maximum number of events processed for an instance before moving on to the next
+     * scheduled instance
+     *
+     * \return  Batch size (zero means that all pending events are processed at once)
+     */
+    int batchSize() const;
+
+    /*!
+     * Sets the maximum number of events processed for an instance before moving on to the next
+     * scheduled instance
+     *
+     * \param   batchSize   Batch size (zero means that all pending events are processed at once)
+     *
+     * \retval  true    Success
+     * \retval  false   Failure (negative batch size)
+     */
+    bool setBatchSize(int batchSize);
+
+    /*!
+     * Checks if the executor is running
+     *
+     * \retval  true    Running
+     * \retval  false   Not running
+     */
+    bool isRunning() const;
+
+    /*!
+     * Starts the worker threads
+     *
+     * \retval  true    Success
+     * \retval  false   Failure (executor already running)
+     */
+    bool start();
+
+    /*!
+     * Stops the worker threads
+     *
+     * \retval  true    Success
+     * \retval  false   Failure (executor already stopped)
+     *
+     * \note    Instances that are being processed are processed until the end of the current batch.
+     *          Scheduled instances stay scheduled and are processed after the executor is started
+     *          again.
+     */
+    bool stop();
+
+    /*!
+     * Adds an instance to the executor
+     *
+     * \param   instance    State machine instance
+     *
+     * \retval  true    Success
+     * \retval  false   Failure (null instance, instance already added)
+     *
+     * \note    The executor sets the event notifier of the instance. Events can be added to the
+     *          instance from other threads while it is added.
+     */
+    bool addInstance(StateMachineInstance *instance);
+
+    /*!
+     * Removes an instance from the executor
+     *
+     * \param   instance    State machine instance
+     *
+     * \retval  true    Success
+     * \retval  false   Failure (instance not added)
+     *
+     * \note    The method waits until the instance is no longer being processed so it must not be
+     *          called from the actions of the instance. Events can be added to the instance from
+     *          other threads while it is removed, they stay pending after it is removed. An
+     *          instance must be removed from the executor before it is destroyed.
+     */
+    bool removeInstance(StateMachineInstance *instance);
+
+    /*!
+     * Waits until there are no scheduled instances and no instances are being processed
+     *
+     * \param   timeout     Timeout in milliseconds (negative value means no timeout)
+     *
+     * \retval  true    Success
+     * \retval  false   Failure (timeout, executor not running while instances are scheduled)
+     */
+    bool waitForIdle(int timeout = -1);
+
+private:
+    //! Enumerates the scheduling states of an instance
+    enum class EntryState
+    {
+        //! Instance is not scheduled
+        Idle,
+
+        //! Instance is in one of the worker queues
+        Scheduled,
+
+        //! Instance is being processed by a worker
+        Running,
+
+        //! Instance is being processed by a worker and an event was added in the meantime
+        RunningNotified,
+
+        //! Instance was removed from the executor
+        Removed
+    };
+
+    //! Holds an instance added to the executor
+    struct Entry
+    {
+        //! Constructor
+        explicit Entry(StateMachineInstance *entryInstance)
+            : instance(entryInstance),
+              state(EntryState::Idle)
+        {
+        }
+
+        //! Holds the instance
+        StateMachineInstance *instance;
+
+        //! Holds the scheduling state of the instance
+        std::atomic<EntryState> state;
+    };
+
+    //! Holds a worker
+    struct Worker
+    {
+        //! Holds the worker thread
+        std::thread thread;
+
+        //! Holds the mutex used to make access to the queue thread safe
+        QMutex mutex;
+
+        //! Holds the scheduled instances
+        std::deque<std::shared_ptr<Entry>> queue;
+    };
+
+private:
+    /*!
+     * Schedules the instance for processing (if it is not already scheduled)
+     *
+     * \param   entry   Entry of the instance
+     *
+     * \note    This method is called by the event notifier of the instance
+     */
+    void notify(const std::shared_ptr<Entry> &entry);
+
+    /*!
+     * Puts the instance in a worker queue (in the queue of the current worker if it is called from
+     * a worker thread)
+     *
+     * \param   entry   Entry of the instance
+     */
+    void enqueue(std::shared_ptr<Entry> entry);
+
+    /*!
+     * Takes the next scheduled instance (from the own queue first, then from the other workers)
+     *
+     * \param   workerIndex     Index of the worker
+     *
+     * \return  Entry of the instance or nullptr if no instance is scheduled
+     */
+    std::shared_ptr<Entry> takeNextEntry(std::size_t workerIndex);
+
+    /*!
+     * Processes a batch of events of the instance
+     *
+     * \param   entry   Entry of the instance
+     */
+    void processEntry(std::shared_ptr<Entry> entry);
+
+    //! Decrements the number of active instances and wakes up the waiters when it reaches zero
+    void releaseActiveEntry();
+
+    /*!
+     * Runs the worker
+     *
+     * \param   workerIndex     Index of the worker
+     */
+    void runWorker(std::size_t workerIndex);
+
+private:
+    //! Holds the workers
+    std::vector<std::unique_ptr<Worker>> m_workers;
+
+    //! Holds the maximum number of events processed for an instance before moving on
+    std::atomic<int> m_batchSize;
+
+    //! Holds the running flag
+    std::atomic<bool> m_running;
+
+    //! Holds the instances added to the executor
+    std::unordered_map<StateMachineInstance *, std::shared_ptr<Entry>> m_entries;
+
+    //! Holds the number of instances in the worker queues
+    std::atomic<int> m_queuedCount;
+
+    //! Holds the number of scheduled instances and instances that are being processed
+    std::atomic<int> m_activeCount;
+
+    //! Holds the number of workers that are waiting for scheduled instances
+    std::atomic<int> m_sleepingCount;
+
+    //! Holds the index of the worker queue into which the next instance is put from other threads
+    std::atomic<std::size_t> m_nextWorkerQueue;
+
+    //! Holds the mutex used to make the API thread safe
+    mutable QMutex m_apiMutex;
+
+    //! Holds the mutex used to wait for scheduled instances and for the idle state
+    QMutex m_waitMutex;
+
+    //! Holds the condition used to wake up the workers when an instance is scheduled
+    QWaitCondition m_workAvailable;
+
+    //! Holds the condition used to wake up the waiters when the executor becomes idle
+    QWaitCondition m_idle;
+};
+
+} // namespace CppStateMachineFramework
@@ -0,0 +1,1372 @@
+/* This file is part of C++ State Machine Framework.
+ *
+ * C++ State Machine Framework is free software: you can redistribute it and/or modify it under the
+ * terms of the GNU Lesser General Public License as published by the Free Software Foundation,
+ * either version 3 of the License, or (at your option) any later version.
+ *
+ * C++ State Machine Framework is distributed in the hope that it will be useful, but WITHOUT ANY
+ * WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR
+ * PURPOSE. See the GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License along with C++ State
+ * Machine Framework. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+/*!
+ * \file
+ *
+ * Contains a class for a state machine instance
+ */
+
+#pragma once
+
+// C++ State Machine Framework includes
+#include <CppStateMachineFramework/Delegate.hpp>
+#include <CppStateMachineFramework/EventJournal.hpp>
+#include <CppStateMachineFramework/EventPool.hpp>
+#include <CppStateMachineFramework/EventRingBuffer.hpp>
+#include <CppStateMachineFramework/MpscEventQueue.hpp>
+#include <CppStateMachineFramework/StateMachineDefinition.hpp>
+#include <CppStateMachineFramework/StateMachineMetrics.hpp>
+#include <CppStateMachineFramework/StateMachineObserver.hpp>
+#include <CppStateMachineFramework/TimerWheel.hpp>
+#include <CppStateMachineFramework/TraceRecorder.hpp>
+
+// Qt includes
+#include <QtCore/QMutex>
+#include <QtCore/QWaitCondition>
+
+// System includes
+#include <array>
+#include <atomic>
+#include <cstdint>
+#include <memory>
+#include <vector>
+
+// Forward declarations
+
+// Macros
+
+// -------------------------------------------------------------------------------------------------
+
+namespace CppStateMachineFramework
+{
+
+/*!
+ * This class holds the runtime state of a state machine
+ *
+ * An instance holds only a pointer to a (shared) state machine definition, the current state, the
+ * event queue and the final event. This makes it possible to create a large number of instances of
+ * the same state machine without copying the states, transitions and their actions. The state of
+ * the optional features (bounded event queue, coalescing, delayed events, metrics, observer,
+ * flight recorder and journal) is allocated only when the first of them is used.
+ */
+class CPPSTATEMACHINEFRAMEWORK_EXPORT StateMachineInstance
+{
+public:
+    //! Enumerates the event queue modes
+    enum class EventQueueMode
+    {
+        //! Event queue is protected by a mutex (default)
+        Locked,
+
+        /*!
+         * Events are added to the back of the event queue through a lock-free multi-producer
+         * single-consumer queue. Events can be added to the front of the event queue only from the
+         * thread that processes the events (for example from the actions).
+         */
+        LockFree
+    };
+
+    //! Enumerates the execution modes
+    enum class ExecutionMode
+    {
+        //! All methods can be called from any thread (default)
+        Locked,
+
+        /*!
+         * The state machine is owned by a single thread. Events can still be added to the back of
+         * the event queue from any thread (only the event queue is synchronized), all other methods
+         * must be called only from the owner thread. In combination with the lock-free event queue
+         * mode the events are processed without locking any mutex.
+         */
+        SingleOwner
+    };
+
+    //! Enumerates the coalescing policies of the events
+    enum class CoalescingPolicy
+    {
+        //! Events are not coalesced (default)
+        None,
+
+        //! A new event replaces the pending event with the same name at its position in the queue
+        ReplaceInPlace,
+
+        //! A new event replaces the pending event with the same name and is moved to the back
+        MoveToBack
+    };
+
+    //! Enumerates the policies applied when an event is added to the back of a full event queue
+    enum class BackpressurePolicy
+    {
+        //! Event is rejected (default)
+        Reject,
+
+        //! Producer is blocked until there is room in the event queue or until the timeout expires
+        Block,
+
+        //! Oldest event in the event queue is dropped to make room for the event
+        DropOldest,
+
+        //! Event is dropped
+        DropNewest
+    };
+
+    //! Holds the backpressure statistics
+    struct BackpressureStatistics
+    {
+        //! Number of events that were rejected (including the blocked events that timed out)
+        std::uint64_t rejected = 0U;
+
+        //! Number of events that were dropped
+        std::uint64_t dropped = 0U;
+
+        //! Number of times a producer was blocked because the event queue was full
+        std::uint64_t blocked = 0U;
+    };
+
+    //! Type alias for the notifier that is called after an event is added to the event queue
+    using EventNotifier = Delegate<void()>;
+
+public:
+    //! Default maximum number of events taken from the event queue at once in poll()
+    static constexpr int DefaultPollBatchSize = 64;
+
+    //! Default maximum number of free memory blocks held in each of the event pools
+    static constexpr int DefaultEventPoolCapacity = 256;
+
+    //! Default maximum number of times waitForEvents() checks for events before it blocks
+    static constexpr int DefaultWaitSpinCount = 0;
+
+    //! Default maximum number of pending events in the event queue (zero means unbounded)
+    static constexpr int DefaultEventQueueCapacity = 0;
+
+    //! Number of event priorities (priority lanes of the event queue)
+    static constexpr int EventPriorityCount = 4;
+
+    //! Priority of the events added to the back of the event queue (lowest priority)
+    static constexpr int NormalEventPriority = 0;
+
+    //! Highest event priority
+    static constexpr int HighestEventPriority = EventPriorityCount - 1;
+
+public:
+    /*!
+     * Constructor
+     *
+     * \param   definition  State machine definition
+     *
+     * \note    The instance can only be started if the definition is valid
+     */
+    explicit StateMachineInstance(std::shared_ptr<const StateMachineDefinition> definition = {});
+
+    //! Copy constructor is disabled
+    StateMachineInstance(const StateMachineInstance &) = delete;
+
+    /*!
+     * Move constructor
+     *
+     * \param   other   Instance to move
+     *
+     * \note    The pending delayed events of the moved instance are cancelled
+     */
+    StateMachineInstance(StateMachineInstance &&other) noexcept;
+
+    //! Destructor (cancels the pending delayed events)
+    ~StateMachineInstance();
+
+    //! Copy assignment operator is disabled
+    StateMachineInstance &operator=(const StateMachineInstance &) = delete;
+
+    /*!
+     * Move assignment operator
+     *
+     * \param   other   Instance to move
+     *
+     * \return  Reference to this instance
+     *
+     * \note    The pending delayed events of both instances are cancelled
+     */
+    StateMachineInstance &operator=(StateMachineInstance &&other) noexcept;
+
+    /*!
+     * Gets the state machine definition
+     *
+     * \return  State machine definition
+     */
+    const std::shared_ptr<const StateMachineDefinition> &definition() const;
+
+    /*!
+     * Gets the event queue mode
+     *
+     * \return  Event queue mode
+     */
+    EventQueueMode eventQueueMode() const;
+
+    /*!
+     * Sets the event queue mode
+     *
+     * \param   mode    Event queue mode
+     *
+     * \retval  true    Success
+     * \retval  false   Failure (state machine not stopped or the lock-free event queue mode was
+     *                  requested while a journal, a coalescing policy, an event queue capacity or a
+     *                  backpressure policy other than the default one is set)
+     *
+     * \note    Any pending events are discarded and this method must not be called concurrently
+     *          with adding of events
+     */
+    bool setEventQueueMode(EventQueueMode mode);
+
+    /*!
+     * Gets the execution mode
+     *
+     * \return  Execution mode
+     */
+    ExecutionMode executionMode() const;
+
+    /*!
+     * Sets the execution mode
+     *
+     * \param   mode    Execution mode
+     *
+     * \retval  true    Success
+     * \retval  false   Failure (state machine not stopped)
+     *
+     * \note    This method must not be called concurrently with any other method
+     */
+    bool setExecutionMode(ExecutionMode mode);
+
+    /*!
+     * Gets the maximum number of events that poll() takes from the event queue at once
+     *
+     * \return  Poll batch size (zero means that the whole event queue is taken at once)
+     */
+    int pollBatchSize() const;
+
+    /*!
+     * Sets the maximum number of events that poll() takes from the event queue at once
+     *
+     * \param   batchSize   Poll batch size (zero means that the whole event queue is taken at once)
+     *
+     * \retval  true    Success
+     * \retval  false   Failure (negative batch size)
+     *
+     * \note    Taking the events in batches reduces the contention on the event queue mutex. Events
+     *          added to the front of the event queue while a batch is being processed are always
+     *          processed before the rest of the batch. The batch size is only used in the locked
+     *          event queue mode.
+     */
+    bool setPollBatchSize(int batchSize);
+
+    /*!
+     * Gets the maximum number of free memory blocks held in each of the event pools
+     *
+     * \return  Event pool capacity
+     */
+    int eventPoolCapacity() const;
+
+    /*!
+     * Sets the maximum number of free memory blocks held in each of the event pools
+     *
+     * \param   capacity    Event pool capacity (zero disables the pooling)
+     *
+     * \retval  true    Success
+     * \retval  false   Failure (negative capacity, state machine not stopped)
+     *
+     * \note    The memory used for the nodes of the lock-free event queue is recycled through the
+     *          event pool so that a steady stream of events does not allocate any memory after a
+     *          warm-up. The locked event queue holds its events in a ring buffer and it does not
+     *          use the event pool. In the lock-free event queue mode any pending events are
+     *          discarded and this method must not be called concurrently with adding of events.
+     */
+    bool setEventPoolCapacity(int capacity);
+
+    /*!
+     * Gets the statistics of the event pool
+     *
+     * \return  Statistics of the lock-free event queue's node pool (all zero in the
+     *          EventQueueMode::Locked mode which does not use an event pool)
+     *
+     * \note    Misses that keep increasing while the state machine is processing a steady stream of
+     *          events indicate that the event pool capacity is too small
+     */
+    EventPool::Statistics eventPoolStatistics() const;
+
+    /*!
+     * Gets the maximum number of pending events in the event queue
+     *
+     * \return  Event queue capacity (zero means unbounded)
+     */
+    int eventQueueCapacity() const;
+
+    /*!
+     * Sets the maximum number of pending events in the event queue
+     *
+     * \param   capacity    Event queue capacity (zero means unbounded)
+     *
+     * \retval  true    Success
+     * \retval  false   Failure (negative capacity, state machine not stopped or a non-zero
+     *                  capacity in the lock-free event queue mode)
+     *
+     * \note    The memory for the events is allocated up front so that adding of events does not
+     *          allocate any memory. When an event is added to the back of a full event queue the
+     *          backpressure policy is applied. Events added to the front of the event queue (by the
+     *          thread that processes the events) are always added. Only the locked event queue can
+     *          be bounded and any pending events are discarded.
+     */
+    bool setEventQueueCapacity(int capacity);
+
+    /*!
+     * Gets the policy applied when an event is added to the back of a full event queue
+     *
+     * \return  Backpressure policy
+     */
+    BackpressurePolicy backpressurePolicy() const;
+
+    /*!
+     * Gets the time for which the producer is blocked with the blocking backpressure policy
+     *
+     * \return  Timeout in milliseconds (negative value means no timeout)
+     */
+    int backpressureTimeout() const;
+
+    /*!
+     * Sets the policy applied when an event is added to the back of a full event queue
+     *
+     * \param   policy      Backpressure policy
+     * \param   timeout     Time for which the producer is blocked with the blocking policy (in
+     *                      milliseconds, negative value means no timeout)
+     *
+     * \retval  true    Success
+     * \retval  false   Failure (state machine not stopped or a policy other than the default one
+     *                  in the lock-free event queue mode)
+     *
+     * \note    With the blocking policy the events must not be added to the back of the event queue
+     *          from the thread that processes the events as the thread would block itself.
+     */
+    bool setBackpressurePolicy(BackpressurePolicy policy, int timeout = -1);
+
+    /*!
+     * Gets the backpressure statistics
+     *
+     * \return  Backpressure statistics
+     */
+    BackpressureStatistics backpressureStatistics() const;
+
+    /*!
+     * Gets the coalescing policy of the event
+     *
+     * \param   eventName   Event name
+     *
+     * \return  Coalescing policy
+     */
+    CoalescingPolicy eventCoalescingPolicy(const QString &eventName) const;
+
+    /*!
+     * Sets the coalescing policy of the event
+     *
+     * \param   eventName   Event name
+     * \param   policy      Coalescing policy
+     *
+     * \retval  true    Success
+     * \retval  false   Failure (empty event name, state machine not stopped, journal is set or
+     *                  lock-free event queue mode)
+     *
+     * \note    When an event with a coalescing policy is added to the back of the event queue while
+     *          an event with the same name is still pending in the event queue then the pending
+     *          event is replaced in constant time. The size of the event queue is then bounded by
+     *          the number of such event names instead of the number of added events. Coalescing is
+     *          supported only in the locked event queue mode and only for events that were not yet
+     *          taken from the event queue for processing.
+     */
+    bool setEventCoalescingPolicy(const QString &eventName, CoalescingPolicy policy);
+
+    /*!
+     * Sets the notifier that is called after an event is added to the event queue
+     *
+     * \param   notifier    Event notifier (an empty notifier removes the notifier)
+     *
+     * \note    The notifier is called from the thread that added the event after the event was
+     *          added. This method can be called while events are added from other threads, a
+     *          thread that is already calling the previous notifier finishes that call.
+     */
+    void setEventNotifier(EventNotifier notifier);
+
+    /*!
+     * Gets the maximum number of times waitForEvents() checks for events before it blocks
+     *
+     * \return  Wait spin count
+     */
+    int waitSpinCount() const;
+
+    /*!
+     * Sets the maximum number of times waitForEvents() checks for events before it blocks
+     *
+     * \param   spinCount   Wait spin count (zero means that the thread blocks immediately)
+     *
+     * \retval  true    Success
+     * \retval  false   Failure (negative spin count)
+     *
+     * \note    Spinning lowers the latency of events that arrive shortly after the event queue
+     *          becomes empty at the cost of processing time. The number of checks adapts between
+     *          one and the spin count: it grows while events arrive during spinning and shrinks
+     *          while the thread has to block anyway.
+     */
+    bool setWaitSpinCount(int spinCount);
+
+    /*!
+     * Gets the timing wheel used for the delayed events
+     *
+     * \return  Timing wheel or nullptr if the default timing wheel is used
+     */
+    std::shared_ptr<TimerWheel> timerWheel() const;
+
+    /*!
+     * Sets the timing wheel used for the delayed events
+     *
+     * \param   timerWheel  Timing wheel (nullptr means the default timing wheel)
+     *
+     * \retval  true    Success
+     * \retval  false   Failure (state machine is started)
+     *
+     * \note    The timing wheel can be changed only while the state machine is stopped. The same
+     *          timing wheel can be shared by any number of instances.
+     */
+    bool setTimerWheel(std::shared_ptr<TimerWheel> timerWheel);
+
+    /*!
+     * Checks if the runtime metrics are enabled
+     *
+     * \retval  true    Enabled
+     * \retval  false   Disabled
+     */
+    bool metricsEnabled() const;
+
+    /*!
+     * Enables or disables the runtime metrics
+     *
+     * \param   enabled     Metrics are recorded
+     *
+     * \retval  true    Success
+     * \retval  false   Failure (state machine is started)
+     *
+     * \note    The metrics are cleared each time the state machine is started. Disabled metrics
+     *          cost a single branch on each hook point of the event processing.
+     */
+    bool setMetricsEnabled(bool enabled);
+
+    /*!
+     * Gets a copy of the runtime metrics
+     *
+     * \return  Metrics (empty if the metrics are disabled or the state machine was not started yet)
+     *
+     * \note    This method can be called from any thread, also while the events are processed
+     */
+    StateMachineMetrics::Snapshot metrics() const;
+
+    /*!
+     * Clears the runtime metrics
+     *
+     * \note    Metrics that are recorded concurrently can be partially cleared
+     */
+    void resetMetrics();
+
+    /*!
+     * Gets the observer of the event processing
+     *
+     * \return  Observer or nullptr if no observer is set
+     */
+    std::shared_ptr<IStateMachineObserver> observer() const;
+
+    /*!
+     * Sets the observer of the event processing
+     *
+     * \param   observer    Observer (nullptr removes the observer)
+     *
+     * \retval  true    Success
+     * \retval  false   Failure (state machine is started)
+     *
+     * \note    Without an observer each hook point costs a single branch. The same observer can be
+     *          set on any number of instances (its hooks get the observed instance).
+     */
+    bool setObserver(std::shared_ptr<IStateMachineObserver> observer);
+
+    /*!
+     * Gets the ID under which the processed events are written to the flight recorder
+     *
+     * \return  Machine ID or 0 if the events are not recorded
+     */
+    std::uint64_t traceMachineId() const;
+
+    /*!
+     * Sets the ID under which the processed events are written to the flight recorder
+     *
+     * \param   machineId   Machine ID (0 disables the recording)
+     *
+     * \retval  true    Success
+     * \retval  false   Failure (state machine is started)
+     *
+     * \note    See TraceRecorder for reading the records. Disabled recording costs a single branch
+     *          on each hook point of the event processing.
+     */
+    bool setTraceMachineId(std::uint64_t machineId);
+
+    /*!
+     * Gets the journal of the events
+     *
+     * \return  Journal or nullptr if the events are not journaled
+     */
+    std::shared_ptr<EventJournal> journal() const;
+
+    /*!
+     * Sets the journal of the events
+     *
+     * \param   journal     Journal (nullptr disables the journaling)
+     *
+     * \retval  true    Success
+     * \retval  false   Failure (state machine is started, lock-free event queue mode or an event
+     *                  coalescing policy is set)
+     *
+     * Each event added to the back of the normal priority lane is appended to the journal before
+     * it is added to the event queue (the event is rejected if it cannot be appended) and the
+     * journal's checkpoint is moved after each processed event. When the state machine is started
+     * the events after the checkpoint are replayed into the event queue, so a new instance started
+     * with the reopened journal continues where a crashed one stopped. The same happens for the
+     * events that were pending when the state machine was stopped.
+     *
+     * \note    The journal must be open when the state machine is started and it must not be used
+     *          by any other instance. Events added to the front of the event queue or to the higher
+     *          priority lanes are not journaled and events with a name that is not registered (see
+     *          Event) are rejected. Events are recovered at least once (see EventJournal).
+     */
+    bool setJournal(std::shared_ptr<EventJournal> journal);
+
+    /*!
+     * Takes a snapshot of the state machine
+     *
+     * \return  Snapshot or an empty byte array on failure (an event parameter type without a
+     *          registered serializer)
+     *
+     * The snapshot is a compact versioned binary blob which holds the started flag, the current
+     * state, the pending events (with their parameters and priorities) and the final event. Event
+     * names and parameter types are written once in tables (events refer to them by their index) so
+     * the snapshot can be restored also in another process. The parameters are written with the
+     * serializers registered in the EventParameterSerializer.
+     *
+     * \note    The pending delayed events are not included in the snapshot. In the lock-free event
+     *          queue mode this method must be called only from the thread that processes the
+     *          events.
+     */
+    QByteArray snapshot();
+
+    /*!
+     * Restores the state machine from the snapshot
+     *
+     * \param   snapshot    Snapshot taken with snapshot()
+     *
+     * \retval  true    Success
+     * \retval  false   Failure (state machine is started or not valid, a journal is set, invalid
+     *                  snapshot, unknown state or event parameter type)
+     *
+     * The state machine continues from the snapshot without executing any actions: it is started if
+     * it was started when the snapshot was taken and its pending events are replaced with the
+     * events from the snapshot (they are not subject to the event queue capacity).
+     *
+     * \note    The definition must have the states of the snapshot (states are matched by their
+     *          names). On failure the state machine is not changed.
+     */
+    bool restore(const QByteArray &snapshot);
+
+    /*!
+     * Checks if the state machine is started
+     *
+     * \retval  true    Started
+     * \retval  false   Not started
+     */
+    bool isStarted();
+
+    /*!
+     * Start the state machine
+     *
+     * \param   event   Startup event to use in the initial transition
+     *
+     * \retval  true    Success
+     * \retval  false   Failure (invalid startup event, state machine already started, the
+     *                  definition is not valid or the journal cannot be replayed)
+     *
+     * \note    With a journal (see setJournal()) the journaled events which were not processed yet
+     *          are added to the event queue before the initial transition.
+     */
+    bool start(Event &&event);
+
+    /*!
+     * Start the state machine
+     *
+     * \param   eventName       Name of the startup event to use in the initial transition
+     * \param   eventParameter  Event parameter for the startup event
+     *
+     * \retval  true    Success
+     * \retval  false   Failure (state machine already started or the definition is not valid)
+     */
+    inline bool start(const QString &eventName = QStringLiteral("Started"),
+                      std::unique_ptr<IEventParameter> &&eventParameter = {})
+    {
+        return start(Event(eventName, std::move(eventParameter)));
+    }
+
+    /*!
+     * Start the state machine
+     *
+     * \retval  true    Success
+     * \retval  false   Failure (state machine already stopped)
+     */
+    bool stop();
+
+    /*!
+     * Gets the name of the current state of the state machine
+     *
+     * \return  State name
+     */
+    QString currentState() const;
+
+    /*!
+     * Gets the index of the current state of the state machine
+     *
+     * \return  State index or a negative value if the current state is not set
+     */
+    int currentStateIndex() const;
+
+    /*!
+     * Checks if the state machine has reached a final state (current state is set to a final state)
+     *
+     * \retval  true    Final state was reached
+     * \retval  false   Final state not reached
+     */
+    bool finalStateReached() const;
+
+    /*!
+     * Checks if the state machine has a final event (event used in the transition to a final state)
+     *
+     * \retval  true    State machine has a final event
+     * \retval  false   State machine does not have a final event
+     */
+    bool hasFinalEvent() const;
+
+    /*!
+     * Takes the event which triggered the transition to the final state
+     *
+     * \return  Event or nullptr if final state was not reached
+     */
+    std::unique_ptr<Event> takeFinalEvent();
+
+    /*!
+     * Checks if the state machine has any pending events
+     *
+     * \retval  true    State machine has at least one pending event
+     * \retval  false   State machine has no pending events
+     *
+     * \note    In the lock-free event queue mode this method must be called only from the thread
+     *          that processes the events
+     */
+    bool hasPendingEvents() const;
+
+    /*!
+     * Adds an event to the front of the event queue
+     *
+     * \param   event   Event
+     *
+     * \retval  true    Success
+     * \retval  false   Failure (empty event name, state machine not started)
+     *
+     * \note    The event is processed before all other pending events (including the events with
+     *          the highest priority). In the lock-free event queue mode this method must be called
+     *          only from the thread that processes the events.
+     */
+    bool addEventToFront(Event &&event);
+
+    /*!
+     * Adds an event to the front of the event queue
+     *
+     * \param   eventName       Event name
+     * \param   eventParameter  Event parameter
+     *
+     * \retval  true    Success
+     * \retval  false   Failure (empty event name, state machine not started)
+     */
+    inline bool addEventToFront(const QString &eventName,
+                                std::unique_ptr<IEventParameter> &&eventParameter = {})
+    {
+        return addEventToFront(Event(eventName, std::move(eventParameter)));
+    }
+
+    /*!
+     * Adds an event to the front of the event queue
+     *
+     * \param   eventId         Event ID (registered event name)
+     * \param   eventParameter  Event parameter
+     *
+     * \retval  true    Success
+     * \retval  false   Failure (invalid event ID, state machine not started)
+     */
+    inline bool addEventToFront(EventId eventId,
+                                std::unique_ptr<IEventParameter> &&eventParameter = {})
+    {
+        return addEventToFront(Event(eventId, std::move(eventParameter)));
+    }
+
+    /*!
+     * Adds an event to the back of the event queue
+     *
+     * \param   event   Event
+     *
+     * \retval  true    Success
+     * \retval  false   Failure (empty event name, state machine not started)
+     */
+    bool addEventToBack(Event &&event);
+
+    /*!
+     * Adds an event to the back of the event queue
+     *
+     * \param   eventName       Event name
+     * \param   eventParameter  Event parameter
+     *
+     * \retval  true    Success
+     * \retval  false   Failure (empty event name, state machine not started)
+     */
+    inline bool addEventToBack(const QString &eventName,
+                               std::unique_ptr<IEventParameter> &&eventParameter = {})
+    {
+        return addEventToBack(Event(eventName, std::move(eventParameter)));
+    }
+
+    /*!
+     * Adds an event to the back of the event queue
+     *
+     * \param   eventId         Event ID (registered event name)
+     * \param   eventParameter  Event parameter
+     *
+     * \retval  true    Success
+     * \retval  false   Failure (invalid event ID, state machine not started)
+     */
+    inline bool addEventToBack(EventId eventId,
+                               std::unique_ptr<IEventParameter> &&eventParameter = {})
+    {
+        return addEventToBack(Event(eventId, std::move(eventParameter)));
+    }
+
+    /*!
+     * Adds an event with the priority to the event queue
+     *
+     * \param   event       Event
+     * \param   priority    Event priority (from NormalEventPriority to HighestEventPriority)
+     *
+     * \retval  true    Success
+     * \retval  false   Failure (empty event name, invalid priority, state machine not started)
+     *
+     * \note    Each priority has its own lane in the event queue. The events are always taken from
+     *          the highest priority lane that is not empty and the events with the same priority
+     *          are processed in the order in which they were added. Events with the normal priority
+     *          are added the same as with addEventToBack(), the higher priority lanes are not
+     *          bounded by the event queue capacity and their events are not coalesced. Higher
+     *          priority events added while poll() is processing a batch of events are processed
+     *          before the rest of the batch.
+     */
+    bool addEvent(Event &&event, int priority);
+
+    /*!
+     * Adds an event with the priority to the event queue
+     *
+     * \param   eventName       Event name
+     * \param   priority        Event priority (from NormalEventPriority to HighestEventPriority)
+     * \param   eventParameter  Event parameter
+     *
+     * \retval  true    Success
+     * \retval  false   Failure (empty event name, invalid priority, state machine not started)
+     */
+    inline bool addEvent(const QString &eventName,
+                         int priority,
+                         std::unique_ptr<IEventParameter> &&eventParameter = {})
+    {
+        return addEvent(Event(eventName, std::move(eventParameter)), priority);
+    }
+
+    /*!
+     * Adds an event to the event queue after the delay
+     *
+     * \param   delay       Delay in milliseconds
+     * \param   event       Event
+     * \param   priority    Event priority (from NormalEventPriority to HighestEventPriority)
+     *
+     * \return  Timer ID of the delayed event or InvalidTimerId on failure (negative delay, empty
+     *          event name, invalid priority, state machine not started)
+     *
+     * \note    The event is added by the timing wheel the same as with addEvent() except that the
+     *          blocking backpressure policy rejects the event instead of blocking. The pending
+     *          delayed events are cancelled when the state machine is stopped.
+     */
+    TimerId addEventAfter(int delay, Event &&event, int priority = NormalEventPriority);
+
+    /*!
+     * Adds an event to the event queue after the delay
+     *
+     * \param   delay           Delay in milliseconds
+     * \param   eventName       Event name
+     * \param   eventParameter  Event parameter
+     *
+     * \return  Timer ID of the delayed event or InvalidTimerId on failure (negative delay, empty
+     *          event name, state machine not started)
+     */
+    inline TimerId addEventAfter(int delay,
+                                 const QString &eventName,
+                                 std::unique_ptr<IEventParameter> &&eventParameter = {})
+    {
+        return addEventAfter(delay, Event(eventName, std::move(eventParameter)));
+    }
+
+    /*!
+     * Adds an event to the event queue after the delay unless the current state is exited first
+     *
+     * \param   delay       Delay in milliseconds
+     * \param   event       Event
+     * \param   priority    Event priority (from NormalEventPriority to HighestEventPriority)
+     *
+     * \return  Timer ID of the delayed event or InvalidTimerId on failure (negative delay, empty
+     *          event name, invalid priority, state machine not started)
+     *
+     * \note    The delayed event is cancelled after the exit action of the current state is
+     *          executed, so a state-scoped event added in the entry action of a state belongs to
+     *          that state. An event whose delay elapsed before the state was exited is already in
+     *          the event queue and it is not removed from it.
+     */
+    TimerId addStateEventAfter(int delay, Event &&event, int priority = NormalEventPriority);
+
+    /*!
+     * Adds an event to the event queue after the delay unless the current state is exited first
+     *
+     * \param   delay           Delay in milliseconds
+     * \param   eventName       Event name
+     * \param   eventParameter  Event parameter
+     *
+     * \return  Timer ID of the delayed event or InvalidTimerId on failure (negative delay, empty
+     *          event name, state machine not started)
+     */
+    inline TimerId addStateEventAfter(int delay,
+                                      const QString &eventName,
+                                      std::unique_ptr<IEventParameter> &&eventParameter = {})
+    {
+        return addStateEventAfter(delay, Event(eventName, std::move(eventParameter)));
+    }
+
+    /*!
+     * Cancels the delayed event
+     *
+     * \param   timerId     Timer ID of the delayed event
+     *
+     * \retval  true    Success
+     * \retval  false   Failure (event already added to the event queue or cancelled, invalid timer
+     *                  ID)
+     */
+    bool cancelDelayedEvent(TimerId timerId);
+
+    /*!
+     * Processes the next pending event
+     *
+     * \retval  true    Success
+     * \retval  false   Failure (state machine not started, empty event queue)
+     */
+    bool processNextEvent();
+
+    /*!
+     * Processes all pending events and executes the state action of the current state
+     *
+     * \retval  true    Success
+     * \retval  false   Failure (state machine not started, failed to process pending events)
+     */
+    bool poll();
+
+    /*!
+     * Waits until there are pending events or the state machine is stopped
+     *
+     * \param   timeout     Timeout in milliseconds (negative value means no timeout)
+     *
+     * \retval  true    Pending events are available
+     * \retval  false   Failure (timeout, state machine not started)
+     *
+     * \note    This method must be called only from the thread that processes the events
+     */
+    bool waitForEvents(int timeout = -1);
+
+    /*!
+     * Processes the events until the state machine is stopped
+     *
+     * \retval  true    Success (state machine was stopped)
+     * \retval  false   Failure (state machine not started, failed to process pending events)
+     *
+     * \note    The thread blocks while there are no pending events and each time events become
+     *          available they are processed with poll() (so the state action of the current state
+     *          is executed only after events are processed). The method returns after a final state
+     *          is reached or after stop() is called from any thread.
+     */
+    bool runUntilStopped();
+
+private:
+    //! Type alias for the state data
+    using StateData = StateMachineDefinition::StateData;
+
+    //! Type alias for the state transition data
+    using StateTransitionData = StateMachineDefinition::StateTransitionData;
+
+    //! Type alias for the internal transition data
+    using InternalTransitionData = StateMachineDefinition::InternalTransitionData;
+
+    //! Type alias for the event queue container
+    using EventQueue = EventRingBuffer;
+
+    //! Holds the state of the optional features
+    struct Extensions
+    {
+        //! Holds the maximum number of pending events in the event queue (zero means unbounded)
+        std::size_t eventQueueCapacity = 0U;
+
+        //! Holds the policy applied when an event is added to the back of a full event queue
+        BackpressurePolicy backpressurePolicy = BackpressurePolicy::Reject;
+
+        //! Holds the time for which the producer is blocked with the blocking backpressure policy
+        int backpressureTimeout = -1;
+
+        //! Holds the backpressure statistics
+        BackpressureStatistics backpressureStatistics;
+
+        //! Holds the number of producers that are blocked because the event queue is full
+        std::atomic<int> blockedProducerCount{0};
+
+        //! Holds the condition used to wake up the blocked producers when there is room in the
+        //! queue (it is created only when the BackpressurePolicy::Block policy is selected)
+        std::unique_ptr<QWaitCondition> eventQueueSpaceAvailable;
+
+        //! Holds the coalescing policies (indexed by the event ID)
+        std::vector<CoalescingPolicy> coalescingPolicies;
+
+        //! Holds the sequence numbers of the pending coalesced events (indexed by the event ID)
+        std::vector<std::int64_t> coalescedEventSequences;
+
+        //! Holds the timing wheel set for the delayed events (nullptr means the default one)
+        std::shared_ptr<TimerWheel> timerWheel;
+
+        //! Holds the timing wheel used for the delayed events (nullptr until the first delayed
+        //! event)
+        std::atomic<TimerWheel *> activeTimerWheel{nullptr};
+
+        //! Holds the flag which is set when a state-scoped delayed event is added
+        std::atomic<bool> stateTimersArmed{false};
+
+        //! Holds the flag which enables the runtime metrics
+        bool metricsEnabled = false;
+
+        //! Holds the runtime metrics (nullptr if disabled or not started yet, it is replaced and
+        //! read atomically as it can be read from any thread)
+        std::shared_ptr<StateMachineMetrics> metrics;
+
+        //! Holds the observer of the event processing (nullptr if no observer is set)
+        std::shared_ptr<IStateMachineObserver> observer;
+
+        //! Holds the ID under which the processed events are written to the flight recorder (0 if
+        //! the events are not recorded)
+        std::uint64_t traceMachineId = 0U;
+
+        //! Holds the journal of the events (nullptr if the events are not journaled)
+        std::shared_ptr<EventJournal> journal;
+
+        //! Holds the journal sequence number of the event before the front of the event queue at
+        //! start
+        std::uint64_t journalBase = 0U;
+
+        //! Holds the journal sequence number of the last event in the batch taken by poll()
+        std::uint64_t journalBatchEnd = 0U;
+
+        //! Holds the journal sequence number of the last event taken from the event queue
+        std::uint64_t journalSequence = 0U;
+    };
+
+    //! Timing wheel adds the delayed events with addDelayedEvent()
+    friend class TimerWheel;
+
+private:
+    /*!
+     * Gets the mutex used to make the API thread safe
+     *
+     * \return  API mutex or nullptr in the single-owner execution mode
+     */
+    QMutex *apiMutex() const;
+
+    /*!
+     * Gets the mutex used to make access to the started flag thread safe
+     *
+     * \return  Started mutex or nullptr in the single-owner execution mode
+     */
+    QMutex *startedMutex() const;
+
+    /*!
+     * Stops the state machine
+     *
+     * \retval  true    Success
+     * \retval  false   Failure (state machine already stopped)
+     *
+     * \note    The only difference between stopInternal() and stop() is that stopInternal() assumes
+     *          that the mutex is already locked and stop() locks the mutex. This method is needed
+     *          just to be able to stop the state machine after the mutex was locked.
+     */
+    bool stopInternal();
+
+    /*!
+     * Gets the state of the optional features and creates it on first use
+     *
+     * \return  State of the optional features
+     *
+     * \note    The event queue mutex must be locked
+     */
+    Extensions *createExtensions();
+
+    /*!
+     * Checks if the event can be added to the event queue
+     *
+     * \param   event   Event
+     *
+     * \retval  true    Event can be added
+     * \retval  false   Event cannot be added (empty event name, state machine not started)
+     */
+    bool checkNewEvent(const Event &event) const;
+
+    /*!
+     * Adds an event to the back of the event queue
+     *
+     * \param   event       Event
+     * \param   canBlock    Producer can be blocked by the blocking backpressure policy
+     *
+     * \retval  true    Success
+     * \retval  false   Failure (empty event name, state machine not started, event rejected)
+     */
+    bool addEventToBackInternal(Event &&event, bool canBlock);
+
+    /*!
+     * Gets the timing wheel used for the delayed events (the default timing wheel is set on first
+     * use)
+     *
+     * \return  Timing wheel
+     */
+    TimerWheel *activeTimerWheel();
+
+    /*!
+     * Arms a timer for the delayed event
+     *
+     * \param   delay           Delay in milliseconds
+     * \param   event           Event
+     * \param   priority        Event priority
+     * \param   stateScoped     Event is cancelled when the current state is exited
+     *
+     * \return  Timer ID or InvalidTimerId on failure
+     */
+    TimerId addDelayedEventTimer(int delay, Event &&event, int priority, bool stateScoped);
+
+    /*!
+     * Adds the delayed event to the event queue (called by the timing wheel when the delay elapsed)
+     *
+     * \param   event       Event
+     * \param   priority    Event priority
+     *
+     * \retval  true    Success
+     * \retval  false   Failure (state machine not started, event rejected)
+     */
+    bool addDelayedEvent(Event &&event, int priority);
+
+    //! Cancels all pending delayed events
+    void cancelDelayedEvents();
+
+    /*!
+     * Applies the backpressure policy if the event queue is full
+     *
+     * \param   startedLocker   Locker of the started mutex (it is unlocked while the producer is
+     *                          blocked)
+     * \param   canBlock        Producer can be blocked (otherwise it is rejected instead)
+     * \param   result          Output for the result of adding the event if it cannot be added
+     *
+     * \retval  true    Event can be added to the back of the event queue
+     * \retval  false   Event must not be added to the event queue (rejected or dropped)
+     *
+     * \note    The event queue mutex must be locked
+     */
+    bool applyBackpressure(QMutexLocker *startedLocker, bool canBlock, bool *result);
+
+    /*!
+     * Checks if any event has a coalescing policy
+     *
+     * \retval  true    At least one event has a coalescing policy
+     * \retval  false   No event has a coalescing policy
+     *
+     * \note    The API mutex must be locked
+     */
+    bool hasCoalescingPolicies() const;
+
+    /*!
+     * Checks if an event with a coalescing policy and the same ID is pending in the event queue
+     *
+     * \param   eventId     Event ID
+     *
+     * \retval  true    Event is pending
+     * \retval  false   Event is not pending
+     *
+     * \note    The event queue mutex must be locked
+     */
+    bool hasPendingCoalescedEvent(EventId eventId) const;
+
+    /*!
+     * Adds the event to the back of the event queue if it has a coalescing policy
+     *
+     * \param   event   Event
+     *
+     * \retval  true    Event was added (it either replaced the pending event or it was appended)
+     * \retval  false   Event has no coalescing policy (it was not added)
+     *
+     * \note    The event queue mutex must be locked
+     */
+    bool addCoalescedEvent(Event &event);
+
+    /*!
+     * Removes the events that were replaced by the events moved to the back of the event queue
+     *
+     * \note    The event queue mutex must be locked
+     */
+    void compactEventQueue();
+
+    /*!
+     * Marks the events as taken from the front of the event queue
+     *
+     * \param   count   Number of taken events
+     *
+     * \note    The event queue mutex must be locked and the events must still be in the event queue
+     */
+    void markEventsTaken(std::size_t count);
+
+    //! Clears the event queue (the event queue mutex must be locked)
+    void clearEventQueue();
+
+    /*!
+     * Adds the journaled events which were not processed yet to the event queue
+     *
+     * \retval  true    Success
+     * \retval  false   Failure (journal is not open or cannot be replayed)
+     *
+     * \note    The event queue mutex must be locked and the event queue must be empty
+     */
+    bool replayJournal();
+
+    //! Wakes up the producers that are blocked because the event queue is full (the event queue
+    //! mutex must be locked)
+    void wakeUpBlockedProducers();
+
+    //! Calls the event notifier (if it is set) and wakes up the waiting thread after an event was
+    //! added to the event queue
+    void notifyEventAdded();
+
+    //! Wakes up the thread that is waiting in waitForEvents() (if any)
+    void wakeUpWaiter();
+
+    /*!
+     * Adds the event to the priority lane
+     *
+     * \param   event       Event
+     * \param   priority    Event priority (higher than the normal priority)
+     * \param   toFront     Event is added to the front of the lane instead of to its back
+     *
+     * \retval  true    Success
+     * \retval  false   Failure (empty event name, state machine not started)
+     */
+    bool addPriorityEvent(Event &&event, int priority, bool toFront);
+
+    /*!
+     * Takes the next event from the highest priority lane that is not empty
+     *
+     * \param[out]  event   Output for the event
+     *
+     * \retval  true    Success
+     * \retval  false   Failure (all priority lanes are empty)
+     *
+     * \note    The event queue mutex must be locked
+     */
+    bool takeNextPriorityEvent(Event *event);
+
+    /*!
+     * Takes the next pending event from the event queue
+     *
+     * \param[out]  event   Output for the event
+     *
+     * \retval  true    Success
+     * \retval  false   Failure (empty event queue)
+     */
+    bool takeNextEvent(Event *event);
+
+    /*!
+     * Takes the next pending event from the current batch of events and takes the next batch of
+     * events from the event queue when the current batch is empty
+     *
+     * \param[out]  event   Output for the event
+     *
+     * \retval  true    Success
+     * \retval  false   Failure (empty event queue)
+     */
+    bool takeNextBatchedEvent(Event *event);
+
+    //! Returns the unprocessed events of the current batch to the event queue
+    void returnEventBatch();
+
+    /*!
+     * Visits the pending events in the order in which they will be processed
+     *
+     * \param   visitor     Function which is called with each event and its priority
+     *
+     * \note    The event queue mutex must be locked
+     */
+    void forEachPendingEvent(const Delegate<void(const Event &event, int priority)> &visitor);
+
+    /*!
+     * Processes the event
+     *
+     * \param   event   Event to process
+     *
+     * \retval  true    Success
+     * \retval  false   Failure (invalid current state)
+     */
+    bool processEvent(Event &&event);
+
+    /*!
+     * Executes the initial transition
+     *
+     * \param   event   Event that triggered the transition
+     */
+    void executeInitialTransition(Event &&event);
+
+    /*!
+     * Executes the state transition
+     *
+     * \param   transitionData  Transition data
+     * \param   event           Event that triggered the transition
+     * \param   trace           Flight recorder record of the event (nullptr if not recorded)
+     */
+    void executeStateTransition(const StateTransitionData &transitionData,
+                                Event &&event,
+                                TraceRecorder::Record *trace);
+
+    /*!
+     * Executes the internal transition
+     *
+     * \param   transitionData  Transition data
+     * \param   event           Event that triggered the transition
+     * \param   trace           Flight recorder record of the event (nullptr if not recorded)
+     */
+    void executeInternalTransition(const InternalTransitionData &transitionData,
+                                   const Event &event,
+                                   TraceRecorder::Record *trace);
+
+private:
+    //! Holds the state machine definition
+    std::shared_ptr<const StateMachineDefinition> m_definition;
+
+    //! Holds the started flag
+    std::atomic<bool> m_started;
+
+    //! Holds the execution mode
+    ExecutionMode m_executionMode;
+
+    //! Holds the index of the current state of the state machine (negative if not set)
+    int m_currentState;
+
+    //! Holds the maximum number of free memory blocks held in each of the event pools
+    int m_eventPoolCapacity;
+
+    /*!
+     * Holds the queued events with the normal priority (in the lock-free event queue mode it holds
+     * only the events added to the front of the event queue)
+     */
+    EventQueue m_eventQueue;
+
+    //! Holds the sequence number of the event at the front of the event queue
+    std::int64_t m_eventQueueHead;
+
+    //! Holds the number of events in the event queue that were replaced by coalesced events
+    std::size_t m_replacedEventCount;
+
+    //! Holds the higher priority lanes of the event queue (the normal priority lane is the event
+    //! queue itself)
+    std::array<EventQueue, EventPriorityCount - 1> m_priorityLanes;
+
+    //! Holds the mask of the priority lanes that are not empty (bit N is set for priority N + 1)
+    std::atomic<std::uint32_t> m_priorityLaneMask;
+
+    /*!
+     * Holds the number of events added to the front of the event queue or to the priority lanes
+     * since the last batch
+     */
+    std::atomic<int> m_priorityEventCount;
+
+    //! Holds the batch of events taken from the event queue that are being processed by poll()
+    EventQueue m_eventBatch;
+
+    //! Holds the maximum number of events that poll() takes from the event queue at once
+    int m_pollBatchSize;
+
+    //! Holds the lock-free event queue (only in the lock-free event queue mode)
+    std::unique_ptr<MpscEventQueue> m_lockFreeEventQueue;
+
+    //! Holds the event which triggered the transition to the final state
+    std::unique_ptr<Event> m_finalEvent;
+
+    //! Holds the notifier that is called after an event is added to the event queue (it is
+    //! replaced and read atomically as it can be changed while events are added)
+    std::shared_ptr<const EventNotifier> m_eventNotifier;
+
+    //! Holds the maximum number of times waitForEvents() checks for events before it blocks
+    int m_waitSpinCount;
+
+    //! Holds the number of times waitForEvents() currently checks for events before it blocks
+    int m_adaptiveSpinCount;
+
+    //! Holds the number of threads that are waiting in waitForEvents()
+    std::atomic<int> m_waiterCount;
+
+    /*!
+     * Holds the state of the optional features (nullptr until the first of them is used). It is
+     * owned by the instance and it is read atomically as the first delayed event can create it
+     * while the events are processed.
+     */
+    std::atomic<Extensions *> m_extensions;
+
+    //! Holds the mutex used to make access to the started flag thread safe (only in the locked
+    //! execution mode)
+    mutable QMutex m_startedMutex;
+
+    //! Holds the mutex used to make access to the event queue thread safe
+    mutable QMutex m_eventQueueMutex;
+
+    //! Holds the mutex used to make the API thread safe (only in the locked execution mode)
+    mutable QMutex m_apiMutex;
+
+    //! Holds the mutex used to wait for events
+    QMutex m_waitMutex;
+
+    //! Holds the condition used to wake up the waiting thread when events become available (it is
+    //! created by the first wait so that the construction of an instance does not allocate memory)
+    std::unique_ptr<QWaitCondition> m_eventsAvailable;
+};
+
+} // namespace CppStateMachineFramework
@@ -21,10 +21,10 @@
 #pragma once
 
 // C++ State Machine Framework includes
+#include <CppStateMachineFramework/Delegate.hpp>
 #include <CppStateMachineFramework/Event.hpp>
 
 // Qt includes
-#include <functional>
 
 // System includes
 
@@ -43,8 +43,8 @@ namespace CppStateMachineFramework
  * \param   trigger         Event that triggered the transition
  * \param   initialState    Name of the initial state
  */
-using InitialTransitionAction = std::function<void(const Event &trigger,
-                                                   const QString &initialState)>;
+using InitialTransitionAction = Delegate<void(const Event &trigger,
+                                              const QString &initialState)>;
 
 // -------------------------------------------------------------------------------------------------
 
@@ -55,9 +55,9 @@ using InitialTransitionAction = std::function<void(const Event &trigger,
  * \param   currentState    Name of the current state
  * \param   previousState   Name of the previous state
  */
-using StateEntryAction = std::function<void(const Event &trigger,
-                                            const QString &currentState,
-                                            const QString &previousState)>;
+using StateEntryAction = Delegate<void(const Event &trigger,
+                                       const QString &currentState,
+                                       const QString &previousState)>;
 
 // -------------------------------------------------------------------------------------------------
 
@@ -66,7 +66,7 @@ using StateEntryAction = std::function<void(const Event &trigger,
  *
  * \param   currentState    Name of the current state
  */
-using StateAction = std::function<void(const QString &currentState)>;
+using StateAction = Delegate<void(const QString &currentState)>;
 
 // -------------------------------------------------------------------------------------------------
 
@@ -77,9 +77,9 @@ using StateAction = std::function<void(const QString &currentState)>;
  * \param   currentState    Name of the current state
  * \param   nextState       Name of the next state
  */
-using StateExitAction = std::function<void(const Event &trigger,
-                                           const QString &currentState,
-                                           const QString &nextState)>;
+using StateExitAction = Delegate<void(const Event &trigger,
+                                      const QString &currentState,
+                                      const QString &nextState)>;
 
 // -------------------------------------------------------------------------------------------------
 
@@ -93,9 +93,9 @@ using StateExitAction = std::function<void(const Event &trigger,
  * \retval  true    Transition is allowed
  * \retval  false   Transition is not allowed
  */
-using StateTransitionGuardCondition = std::function<bool(const Event &trigger,
-                                                         const QString &currentState,
-                                                         const QString &nextState)>;
+using StateTransitionGuardCondition = Delegate<bool(const Event &trigger,
+                                                    const QString &currentState,
+                                                    const QString &nextState)>;
 
 // -------------------------------------------------------------------------------------------------
 
@@ -106,9 +106,9 @@ using StateTransitionGuardCondition = std::function<bool(const Event &trigger,
  * \param   currentState    Name of the current state
  * \param   nextState       Name of the next state
  */
-using StateTransitionAction = std::function<void(const Event &trigger,
-                                                 const QString &currentState,
-                                                 const QString &nextState)>;
+using StateTransitionAction = Delegate<void(const Event &trigger,
+                                            const QString &currentState,
+                                            const QString &nextState)>;
 
 // -------------------------------------------------------------------------------------------------
 
@@ -121,8 +121,8 @@ using StateTransitionAction = std::function<void(const Event &trigger,
  * \retval  true    Transition is allowed
  * \retval  false   Transition is not allowed
  */
-using InternalTransitionGuardCondition = std::function<bool(const Event &trigger,
-                                                            const QString &currentState)>;
+using InternalTransitionGuardCondition = Delegate<bool(const Event &trigger,
+                                                       const QString &currentState)>;
 
 // -------------------------------------------------------------------------------------------------
 
@@ -132,8 +132,8 @@ using InternalTransitionGuardCondition = std::function<bool(const Event &trigger
  * \param   trigger         Event that triggered the transition
  * \param   currentState    Name of the current state
  */
-using InternalTransitionAction = std::function<void(const Event &trigger,
-                                                    const QString &currentState)>;
+using InternalTransitionAction = Delegate<void(const Event &trigger,
+                                               const QString &currentState)>;
 
 // -------------------------------------------------------------------------------------------------
 
@@ -142,7 +142,7 @@ template<typename T>
 InitialTransitionAction createInitialTransitionAction(
         T *instance, void (T::*method)(const Event &, const QString &))
 {
-    return std::bind(method, instance, std::placeholders::_1, std::placeholders::_2);
+    return {instance, method};
 }
 
 // -------------------------------------------------------------------------------------------------
@@ -151,7 +151,7 @@ InitialTransitionAction createInitialTransitionAction(
 template<typename T>
 InitialTransitionAction createInitialTransitionAction(T *instance, void (T::*method)())
 {
-    return std::bind(method, instance);
+    return {instance, method};
 }
 
 // -------------------------------------------------------------------------------------------------
@@ -161,11 +161,7 @@ template<typename T>
 StateEntryAction createStateEntryAction(
         T *instance, void (T::*method)(const Event &, const QString &, const QString &))
 {
-    return std::bind(method,
-                     instance,
-                     std::placeholders::_1,
-                     std::placeholders::_2,
-                     std::placeholders::_3);
+    return {instance, method};
 }
 
 // -------------------------------------------------------------------------------------------------
@@ -174,7 +170,7 @@ StateEntryAction createStateEntryAction(
 template<typename T>
 StateEntryAction createStateEntryAction(T *instance, void (T::*method)())
 {
-    return std::bind(method, instance);
+    return {instance, method};
 }
 
 // -------------------------------------------------------------------------------------------------
@@ -183,7 +179,7 @@ StateEntryAction createStateEntryAction(T *instance, void (T::*method)())
 template<typename T>
 StateAction createStateAction(T *instance, void (T::*method)(const QString &))
 {
-    return std::bind(method, instance, std::placeholders::_1);
+    return {instance, method};
 }
 
 // -------------------------------------------------------------------------------------------------
@@ -192,7 +188,7 @@ StateAction createStateAction(T *instance, void (T::*method)(const QString &))
 template<typename T>
 StateAction createStateAction(T *instance, void (T::*method)())
 {
-    return std::bind(method, instance);
+    return {instance, method};
 }
 
 // -------------------------------------------------------------------------------------------------
@@ -202,11 +198,7 @@ template<typename T>
 StateExitAction createStateExitAction(
         T *instance, void (T::*method)(const Event &, const QString &, const QString &))
 {
-    return std::bind(method,
-                     instance,
-                     std::placeholders::_1,
-                     std::placeholders::_2,
-                     std::placeholders::_3);
+    return {instance, method};
 }
 
 // -------------------------------------------------------------------------------------------------
@@ -215,7 +207,7 @@ StateExitAction createStateExitAction(
 template<typename T>
 StateExitAction createStateExitAction(T *instance, void (T::*method)())
 {
-    return std::bind(method, instance);
+    return {instance, method};
 }
 
 // -------------------------------------------------------------------------------------------------
@@ -225,11 +217,7 @@ template<typename T>
 StateTransitionGuardCondition createStateTransitionGuardCondition(
         T *instance, bool (T::*method)(const Event &, const QString &, const QString &))
 {
-    return std::bind(method,
-                     instance,
-                     std::placeholders::_1,
-                     std::placeholders::_2,
-                     std::placeholders::_3);
+    return {instance, method};
 }
 
 // -------------------------------------------------------------------------------------------------
@@ -238,7 +226,7 @@ StateTransitionGuardCondition createStateTransitionGuardCondition(
 template<typename T>
 StateTransitionGuardCondition createStateTransitionGuardCondition(T *instance, bool (T::*method)())
 {
-    return std::bind(method, instance);
+    return {instance, method};
 }
 
 // -------------------------------------------------------------------------------------------------
@@ -248,11 +236,7 @@ template<typename T>
 StateTransitionAction createStateTransitionAction(
         T *instance, void (T::*method)(const Event &, const QString &, const QString &))
 {
-    return std::bind(method,
-                     instance,
-                     std::placeholders::_1,
-                     std::placeholders::_2,
-                     std::placeholders::_3);
+    return {instance, method};
 }
 
 // -------------------------------------------------------------------------------------------------
@@ -261,7 +245,7 @@ StateTransitionAction createStateTransitionAction(
 template<typename T>
 StateTransitionAction createStateTransitionAction(T *instance, void (T::*method)())
 {
-    return std::bind(method, instance);
+    return {instance, method};
 }
 
 // -------------------------------------------------------------------------------------------------
@@ -271,7 +255,7 @@ template<typename T>
 InternalTransitionGuardCondition createInternalTransitionGuardCondition(
         T *instance, bool (T::*method)(const Event &, const QString &))
 {
-    return std::bind(method, instance, std::placeholders::_1, std::placeholders::_2);
+    return {instance, method};
 }
 
 // -------------------------------------------------------------------------------------------------
@@ -281,7 +265,7 @@ template<typename T>
 InternalTransitionGuardCondition createInternalTransitionGuardCondition(
         T *instance, bool (T::*method)())
 {
-    return std::bind(method, instance);
+    return {instance, method};
 }
 
 // -------------------------------------------------------------------------------------------------
@@ -291,7 +275,7 @@ template<typename T>
 InternalTransitionAction createInternalTransitionAction(
         T *instance, void (T::*method)(const Event &, const QString &))
 {
-    return std::bind(method, instance, std::placeholders::_1, std::placeholders::_2);
+    return {instance, method};
 }
 
 // -------------------------------------------------------------------------------------------------
@@ -300,7 +284,7 @@ InternalTransitionAction createInternalTransitionAction(
 template<typename T>
 InternalTransitionAction createInternalTransitionAction(T *instance, void (T::*method)())
 {
-    return std::bind(method, instance);
+    return {instance, method};
 }
 
 } // namespace CppStateMachineFramework
@@ -0,0 +1,507 @@
+/* This file is part of C++ State Machine Framework.
+ *
+ * C++ State Machine Framework is free software: you can redistribute it and/or modify it under the
+ * terms of the GNU Lesser General Public License as published by the Free Software Foundation,
+ * either version 3 of the License, or (at your option) any later version.
+ *
+ * C++ State Machine Framework is distributed in the hope that it will be useful, but WITHOUT ANY
+ * WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR
+ * PURPOSE. See the GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License along with C++ State
+ * Machine Framework. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+/*!
+ * \file
+ *
+ * Contains the runtime metrics of a state machine instance
+ */
+
+#pragma once
+
+// C++ State Machine Framework includes
+#include <CppStateMachineFramework/StateMachineDefinition.hpp>
+
+// Qt includes
+#include <QtCore/QJsonObject>
+#include <QtCore/QString>
+
+// System includes
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <memory>
+#include <vector>
+
+// Forward declarations
+
+// Macros
+
+// -------------------------------------------------------------------------------------------------
+
+namespace CppStateMachineFramework
+{
+
+/*!
+ * This class holds a latency histogram with logarithmic buckets
+ *
+ * Latencies below 16 ns get a bucket each, larger latencies are put in 8 buckets per power of two
+ * so the relative error of a recorded value is at most 12.5% regardless of its magnitude (the same
+ * layout as a HDR histogram with one significant decimal digit). Latencies of 2^40 ns (about 18
+ * minutes) and more are put in the last bucket.
+ *
+ * \note    The histogram is recorded by a single thread at a time and can be read from any thread
+ */
+class CPPSTATEMACHINEFRAMEWORK_EXPORT LatencyHistogram
+{
+public:
+    //! Number of buckets
+    static constexpr int BucketCount = 304;
+
+    //! Holds a copy of the histogram
+    struct Snapshot
+    {
+        //! Number of recorded latencies
+        std::uint64_t count = 0U;
+
+        //! Sum of the recorded latencies in nanoseconds
+        std::uint64_t sum = 0U;
+
+        //! Highest recorded latency in nanoseconds
+        std::uint64_t max = 0U;
+
+        //! Number of recorded latencies in each bucket (empty if nothing was recorded)
+        std::vector<std::uint64_t> buckets;
+
+        /*!
+         * Gets the mean latency
+         *
+         * \return  Mean latency in nanoseconds (zero if nothing was recorded)
+         */
+        double mean() const;
+
+        /*!
+         * Gets the latency at the percentile
+         *
+         * \param   percentile  Percentile (from 0 to 100)
+         *
+         * \return  Upper bound of the bucket that holds the percentile in nanoseconds (limited to
+         *          the highest recorded latency, zero if nothing was recorded)
+         */
+        std::uint64_t percentile(double percentile) const;
+
+        /*!
+         * Converts the snapshot to JSON
+         *
+         * \return  JSON object with the count, sum, mean, max and the common percentiles
+         */
+        QJsonObject toJson() const;
+    };
+
+public:
+    //! Constructor
+    LatencyHistogram();
+
+    //! Copy constructor is disabled
+    LatencyHistogram(const LatencyHistogram &) = delete;
+
+    //! Move constructor is disabled
+    LatencyHistogram(LatencyHistogram &&) = delete;
+
+    //! Destructor
+    ~LatencyHistogram() = default;
+
+    //! Copy assignment operator is disabled
+    LatencyHistogram &operator=(const LatencyHistogram &) = delete;
+
+    //! Move assignment operator is disabled
+    LatencyHistogram &operator=(LatencyHistogram &&) = delete;
+
+    /*!
+     * Records the latency
+     *
+     * \param   latency     Latency in nanoseconds
+     */
+    inline void record(const std::uint64_t latency)
+    {
+        increment(&m_buckets[static_cast<std::size_t>(bucketIndex(latency))], 1U);
+        increment(&m_count, 1U);
+        increment(&m_sum, latency);
+
+        if (latency > m_max.load(std::memory_order_relaxed))
+        {
+            m_max.store(latency, std::memory_order_relaxed);
+        }
+    }
+
+    /*!
+     * Creates a copy of the histogram
+     *
+     * \return  Snapshot
+     */
+    Snapshot snapshot() const;
+
+    //! Clears the histogram
+    void reset();
+
+    /*!
+     * Gets the index of the bucket for the latency
+     *
+     * \param   latency     Latency in nanoseconds
+     *
+     * \return  Bucket index
+     */
+    static inline int bucketIndex(const std::uint64_t latency)
+    {
+        if (latency < LinearBucketCount)
+        {
+            return static_cast<int>(latency);
+        }
+
+        const int exponent = highestBit(latency);
+
+        if (exponent > MaxExponent)
+        {
+            return BucketCount - 1;
+        }
+
+        const auto subBucket = static_cast<int>((latency >> (exponent - SubBucketBits)) &
+                                                (SubBucketCount - 1U));
+
+        return LinearBucketCount + ((exponent - MinExponent) * SubBucketCount) + subBucket;
+    }
+
+    /*!
+     * Gets the highest latency that is put in the bucket
+     *
+     * \param   index   Bucket index
+     *
+     * \return  Latency in nanoseconds
+     */
+    static std::uint64_t bucketUpperBound(int index);
+
+    /*!
+     * Increments the counter
+     *
+     * \param   counter     Counter
+     * \param   value       Value to add
+     *
+     * \note    The counters are written by a single thread at a time so a relaxed load and store is
+     *          enough (it avoids the cost of an atomic read-modify-write instruction)
+     */
+    static inline void increment(std::atomic<std::uint64_t> *counter, const std::uint64_t value)
+    {
+        counter->store(counter->load(std::memory_order_relaxed) + value,
+                       std::memory_order_relaxed);
+    }
+
+private:
+    //! Number of bits of the sub-bucket index
+    static constexpr int SubBucketBits = 3;
+
+    //! Number of sub-buckets for each power of two
+    static constexpr std::uint64_t SubBucketCount = 1U << SubBucketBits;
+
+    //! Lowest power of two that is split into sub-buckets
+    static constexpr int MinExponent = SubBucketBits + 1;
+
+    //! Highest power of two that is split into sub-buckets
+    static constexpr int MaxExponent = 39;
+
+    //! Number of buckets that hold a single latency
+    static constexpr std::uint64_t LinearBucketCount = 1U << MinExponent;
+
+    /*!
+     * Gets the index of the highest set bit
+     *
+     * \param   value   Value (must not be zero)
+     *
+     * \return  Bit index
+     */
+    static inline int highestBit(std::uint64_t value)
+    {
+        int index = 0;
+
+        for (int shift = 32; shift > 0; shift /= 2)
+        {
+            if ((value >> static_cast<unsigned>(shift)) != 0U)
+            {
+                value >>= static_cast<unsigned>(shift);
+                index += shift;
+            }
+        }
+
+        return index;
+    }
+
+private:
+    //! Holds the number of recorded latencies in each bucket
+    std::array<std::atomic<std::uint64_t>, BucketCount> m_buckets;
+
+    //! Holds the number of recorded latencies
+    std::atomic<std::uint64_t> m_count;
+
+    //! Holds the sum of the recorded latencies
+    std::atomic<std::uint64_t> m_sum;
+
+    //! Holds the highest recorded latency
+    std::atomic<std::uint64_t> m_max;
+};
+
+// -------------------------------------------------------------------------------------------------
+
+/*!
+ * This class holds the runtime metrics of a state machine instance
+ *
+ * For each state it counts the entries, exits and ignored events (events without a transition in
+ * that state) and records the latencies of the entry and exit actions. For each transition it
+ * counts the executions and the rejections by the guard condition and records the latencies of the
+ * action. Histograms are created only for the actions that are set in the definition.
+ *
+ * The metrics are recorded by the thread that processes the events with relaxed atomic operations
+ * only, so a snapshot can be taken from any thread without blocking the processing of the events.
+ */
+class CPPSTATEMACHINEFRAMEWORK_EXPORT StateMachineMetrics
+{
+public:
+    //! Holds the metrics of a state
+    struct StateMetrics
+    {
+        //! State name
+        QString name;
+
+        //! Number of times the state was entered (including the initial transition)
+        std::uint64_t entered = 0U;
+
+        //! Number of times the state was exited
+        std::uint64_t exited = 0U;
+
+        //! Number of events that were ignored in the state (no transition for the event)
+        std::uint64_t ignoredEvents = 0U;
+
+        //! Latencies of the entry action
+        LatencyHistogram::Snapshot entryActionLatency;
+
+        //! Latencies of the exit action
+        LatencyHistogram::Snapshot exitActionLatency;
+    };
+
+    //! Holds the metrics of a transition
+    struct TransitionMetrics
+    {
+        //! Name of the state to which the transition belongs to
+        QString fromState;
+
+        //! Name of the event that triggers the transition (empty for a default transition)
+        QString trigger;
+
+        //! Name of the state to transition to (empty for an internal transition)
+        QString toState;
+
+        //! Number of times the transition was executed
+        std::uint64_t fired = 0U;
+
+        //! Number of times the transition was blocked by its guard condition
+        std::uint64_t guardRejected = 0U;
+
+        //! Latencies of the action
+        LatencyHistogram::Snapshot actionLatency;
+    };
+
+    //! Holds a copy of the metrics
+    struct Snapshot
+    {
+        //! Metrics of the states (in the order of the state indexes)
+        std::vector<StateMetrics> states;
+
+        //! Metrics of the transitions (in the order of the transition indexes)
+        std::vector<TransitionMetrics> transitions;
+
+        /*!
+         * Converts the snapshot to JSON
+         *
+         * \return  JSON object with the "states" and "transitions" arrays
+         */
+        QJsonObject toJson() const;
+    };
+
+    //! Type alias for the time point used for measuring the latencies
+    using TimePoint = std::chrono::steady_clock::time_point;
+
+public:
+    /*!
+     * Constructor
+     *
+     * \param   definition  Valid state machine definition
+     */
+    explicit StateMachineMetrics(std::shared_ptr<const StateMachineDefinition> definition);
+
+    //! Copy constructor is disabled
+    StateMachineMetrics(const StateMachineMetrics &) = delete;
+
+    //! Move constructor is disabled
+    StateMachineMetrics(StateMachineMetrics &&) = delete;
+
+    //! Destructor
+    ~StateMachineMetrics() = default;
+
+    //! Copy assignment operator is disabled
+    StateMachineMetrics &operator=(const StateMachineMetrics &) = delete;
+
+    //! Move assignment operator is disabled
+    StateMachineMetrics &operator=(StateMachineMetrics &&) = delete;
+
+    /*!
+     * Gets the current time for measuring the latency of an action
+     *
+     * \return  Time point
+     */
+    static inline TimePoint now()
+    {
+        return std::chrono::steady_clock::now();
+    }
+
+    /*!
+     * Records the entry of a state
+     *
+     * \param   stateIndex  State index
+     * \param   start       Time at which the entry action was started (ignored if the state has no
+     *                      entry action)
+     */
+    inline void recordEntry(const int stateIndex, const TimePoint start)
+    {
+        auto &state = m_states[static_cast<std::size_t>(stateIndex)];
+        LatencyHistogram::increment(&state.entered, 1U);
+        recordLatency(state.entryActionLatency, start);
+    }
+
+    /*!
+     * Records the exit of a state
+     *
+     * \param   stateIndex  State index
+     * \param   start       Time at which the exit action was started (ignored if the state has no
+     *                      exit action)
+     */
+    inline void recordExit(const int stateIndex, const TimePoint start)
+    {
+        auto &state = m_states[static_cast<std::size_t>(stateIndex)];
+        LatencyHistogram::increment(&state.exited, 1U);
+        recordLatency(state.exitActionLatency, start);
+    }
+
+    /*!
+     * Records an event that was ignored in a state
+     *
+     * \param   stateIndex  State index
+     */
+    inline void recordIgnoredEvent(const int stateIndex)
+    {
+        LatencyHistogram::increment(&m_states[static_cast<std::size_t>(stateIndex)].ignoredEvents,
+                                    1U);
+    }
+
+    /*!
+     * Records the execution of a transition
+     *
+     * \param   transitionIndex     Transition index
+     * \param   start               Time at which the action was started (ignored if the transition
+     *                              has no action)
+     */
+    inline void recordTransition(const int transitionIndex, const TimePoint start)
+    {
+        auto &transition = m_transitions[static_cast<std::size_t>(transitionIndex)];
+        LatencyHistogram::increment(&transition.fired, 1U);
+        recordLatency(transition.actionLatency, start);
+    }
+
+    /*!
+     * Records a transition that was blocked by its guard condition
+     *
+     * \param   transitionIndex     Transition index
+     */
+    inline void recordGuardRejection(const int transitionIndex)
+    {
+        LatencyHistogram::increment(
+                    &m_transitions[static_cast<std::size_t>(transitionIndex)].guardRejected, 1U);
+    }
+
+    /*!
+     * Creates a copy of the metrics
+     *
+     * \return  Snapshot
+     */
+    Snapshot snapshot() const;
+
+    //! Clears the metrics
+    void reset();
+
+private:
+    //! Holds the counters of a state
+    struct StateCounters
+    {
+        //! Holds the number of entries
+        std::atomic<std::uint64_t> entered;
+
+        //! Holds the number of exits
+        std::atomic<std::uint64_t> exited;
+
+        //! Holds the number of ignored events
+        std::atomic<std::uint64_t> ignoredEvents;
+
+        //! Holds the latencies of the entry action (nullptr if the state has no entry action)
+        LatencyHistogram *entryActionLatency;
+
+        //! Holds the latencies of the exit action (nullptr if the state has no exit action)
+        LatencyHistogram *exitActionLatency;
+    };
+
+    //! Holds the counters of a transition
+    struct TransitionCounters
+    {
+        //! Holds the number of executions
+        std::atomic<std::uint64_t> fired;
+
+        //! Holds the number of rejections by the guard condition
+        std::atomic<std::uint64_t> guardRejected;
+
+        //! Holds the latencies of the action (nullptr if the transition has no action)
+        LatencyHistogram *actionLatency;
+    };
+
+private:
+    /*!
+     * Records the latency of an action
+     *
+     * \param   histogram   Histogram (nullptr if there is no action)
+     * \param   start       Time at which the action was started
+     */
+    static inline void recordLatency(LatencyHistogram *histogram, const TimePoint start)
+    {
+        if (histogram != nullptr)
+        {
+            const auto latency =
+                    std::chrono::duration_cast<std::chrono::nanoseconds>(now() - start).count();
+            histogram->record(static_cast<std::uint64_t>(latency));
+        }
+    }
+
+private:
+    //! Holds the state machine definition
+    std::shared_ptr<const StateMachineDefinition> m_definition;
+
+    //! Holds the counters of each state
+    std::unique_ptr<StateCounters[]> m_states;
+
+    //! Holds the counters of each transition
+    std::unique_ptr<TransitionCounters[]> m_transitions;
+
+    //! Holds the histograms of all actions
+    std::unique_ptr<LatencyHistogram[]> m_histograms;
+
+    //! Holds the number of histograms
+    int m_histogramCount;
+};
+
+} // namespace CppStateMachineFramework
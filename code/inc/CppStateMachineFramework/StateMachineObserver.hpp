@@ -0,0 +1,138 @@
+/* This file is part of C++ State Machine Framework.
+ *
+ * C++ State Machine Framework is free software: you can redistribute it and/or modify it under the
+ * terms of the GNU Lesser General Public License as published by the Free Software Foundation,
+ * either version 3 of the License, or (at your option) any later version.
+ *
+ * C++ State Machine Framework is distributed in the hope that it will be useful, but WITHOUT ANY
+ * WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR
+ * PURPOSE. See the GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License along with C++ State
+ * Machine Framework. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+/*!
+ * \file
+ *
+ * Contains an interface for observing the event processing of a state machine instance
+ */
+
+#pragma once
+
+// C++ State Machine Framework includes
+#include <CppStateMachineFramework/Event.hpp>
+
+// Qt includes
+
+// System includes
+
+// Forward declarations
+namespace CppStateMachineFramework
+{
+class StateMachineInstance;
+}
+
+// Macros
+
+// -------------------------------------------------------------------------------------------------
+
+namespace CppStateMachineFramework
+{
+
+/*!
+ * This is an interface for observing the event processing of a state machine instance
+ *
+ * The hooks are called by the thread that processes the events, synchronously and in the order of
+ * the processing steps. States and transitions are identified by their indexes in the definition
+ * (see StateMachineDefinition::state() and StateMachineDefinition::transitionInfo()) and events by
+ * their IDs (see EventNameRegistry::name(), all events whose names are not used by any definition
+ * share UnregisteredEventId), so no strings are formatted on the hot path. All hooks have an empty
+ * default implementation so an observer needs to override only the hooks it uses.
+ *
+ * A state transition calls onExit(), onTransition() and onEntry() (and onFinal() if the next state
+ * is a final state). An internal transition calls only onTransition(). The initial transition calls
+ * only onEntry() (and onFinal()).
+ *
+ * \note    The hooks must not call the API of the observed instance
+ */
+class CPPSTATEMACHINEFRAMEWORK_EXPORT IStateMachineObserver
+{
+public:
+    //! Destructor
+    virtual ~IStateMachineObserver() = default;
+
+    /*!
+     * Called after an event is taken from the event queue and before it is processed
+     *
+     * \param   instance    State machine instance
+     * \param   stateIndex  Index of the current state
+     * \param   eventId     ID of the event
+     */
+    virtual void onEventDequeued(const StateMachineInstance &instance,
+                                 int stateIndex,
+                                 EventId eventId);
+
+    /*!
+     * Called when a transition is blocked by its guard condition
+     *
+     * \param   instance            State machine instance
+     * \param   transitionIndex     Index of the transition
+     * \param   eventId             ID of the event
+     */
+    virtual void onGuardRejected(const StateMachineInstance &instance,
+                                 int transitionIndex,
+                                 EventId eventId);
+
+    /*!
+     * Called after the exit action of a state is executed (or when the state is exited if it does
+     * not have an exit action)
+     *
+     * \param   instance    State machine instance
+     * \param   stateIndex  Index of the exited state
+     * \param   eventId     ID of the event
+     */
+    virtual void onExit(const StateMachineInstance &instance, int stateIndex, EventId eventId);
+
+    /*!
+     * Called after the action of a state or internal transition is executed (or when the
+     * transition is executed if it does not have an action)
+     *
+     * \param   instance            State machine instance
+     * \param   transitionIndex     Index of the transition
+     * \param   eventId             ID of the event
+     */
+    virtual void onTransition(const StateMachineInstance &instance,
+                              int transitionIndex,
+                              EventId eventId);
+
+    /*!
+     * Called after the entry action of a state is executed (or when the state is entered if it
+     * does not have an entry action)
+     *
+     * \param   instance    State machine instance
+     * \param   stateIndex  Index of the entered state
+     * \param   eventId     ID of the event
+     */
+    virtual void onEntry(const StateMachineInstance &instance, int stateIndex, EventId eventId);
+
+    /*!
+     * Called when a final state is reached (before the state machine is stopped)
+     *
+     * \param   instance    State machine instance
+     * \param   stateIndex  Index of the final state
+     * \param   eventId     ID of the event
+     */
+    virtual void onFinal(const StateMachineInstance &instance, int stateIndex, EventId eventId);
+
+    /*!
+     * Called when an event is ignored because the current state has no transition for it
+     *
+     * \param   instance    State machine instance
+     * \param   stateIndex  Index of the current state
+     * \param   eventId     ID of the event
+     */
+    virtual void onIgnored(const StateMachineInstance &instance, int stateIndex, EventId eventId);
+};
+
+} // namespace CppStateMachineFramework
@@ -0,0 +1,809 @@
+/* This file is part of C++ State Machine Framework.
+ *
+ * C++ State Machine Framework is free software: you can redistribute it and/or modify it under the
+ * terms of the GNU Lesser General Public License as published by the Free Software Foundation,
+ * either version 3 of the License, or (at your option) any later version.
+ *
+ * C++ State Machine Framework is distributed in the hope that it will be useful, but WITHOUT ANY
+ * WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR
+ * PURPOSE. See the GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License along with C++ State
+ * Machine Framework. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+/*!
+ * \file
+ *
+ * Contains a class template for a state machine that is defined and validated at compile time
+ */
+
+#pragma once
+
+// C++ State Machine Framework includes
+
+// Qt includes
+
+// System includes
+#include <cstddef>
+#include <tuple>
+#include <type_traits>
+#include <utility>
+
+// Forward declarations
+
+// Macros
+
+// -------------------------------------------------------------------------------------------------
+
+namespace CppStateMachineFramework
+{
+
+//! Action that does nothing (default action of the states and transitions)
+struct StaticNoAction
+{
+    //! Ignores the arguments
+    template<typename... Args>
+    void operator()(Args &&...) const
+    {
+    }
+};
+
+//! Guard condition that never blocks a transition (default guard condition of the transitions)
+struct StaticNoGuard
+{
+    //! Ignores the arguments and allows the transition
+    template<typename... Args>
+    bool operator()(Args &&...) const
+    {
+        return true;
+    }
+};
+
+//! Event type used for the default transitions (transitions taken for any other event)
+struct StaticAnyEvent
+{
+};
+
+//! Event passed to the initial transition's action and to the initial state's entry action
+struct StaticStartedEvent
+{
+};
+
+/*!
+ * This class template describes a state of a StaticStateMachine
+ *
+ * \tparam  Tag             Type that identifies the state
+ * \tparam  EntryAction     Entry action called with (Context &, const Event &)
+ * \tparam  ExitAction      Exit action called with (Context &, const Event &)
+ * \tparam  StateAction     State action called with (Context &)
+ *
+ * \note    The actions must be default constructible callable types (they are constructed at the
+ *          call site so that they can be inlined)
+ */
+template<typename Tag,
+         typename EntryAction = StaticNoAction,
+         typename ExitAction = StaticNoAction,
+         typename StateAction = StaticNoAction>
+struct StaticState
+{
+    //! Type that identifies the state
+    using StateTag = Tag;
+
+    //! Entry action
+    using Entry = EntryAction;
+
+    //! Exit action
+    using Exit = ExitAction;
+
+    //! State action
+    using Action = StateAction;
+};
+
+//! This class template holds the list of states of a StaticStateMachine
+template<typename... States>
+struct StaticStates
+{
+};
+
+/*!
+ * This class template describes the initial transition of a StaticStateMachine
+ *
+ * \tparam  Tag                 Type that identifies the initial state
+ * \tparam  TransitionAction    Action called with (Context &, const Event &)
+ */
+template<typename Tag, typename TransitionAction = StaticNoAction>
+struct StaticInitialTransition
+{
+    //! Type that identifies the initial state
+    using ToState = Tag;
+
+    //! Action of the transition
+    using Action = TransitionAction;
+};
+
+/*!
+ * This class template describes a state transition of a StaticStateMachine
+ *
+ * \tparam  From                Type that identifies the state from which to transition
+ * \tparam  Trigger             Type of the event that triggers the transition (StaticAnyEvent for
+ *                              the default transition of the state)
+ * \tparam  To                  Type that identifies the state to which to transition
+ * \tparam  TransitionAction    Action called with (Context &, const Event &)
+ * \tparam  GuardCondition      Guard condition called with (const Context &, const Event &)
+ */
+template<typename From,
+         typename Trigger,
+         typename To,
+         typename TransitionAction = StaticNoAction,
+         typename GuardCondition = StaticNoGuard>
+struct StaticStateTransition
+{
+    //! Flag that marks an internal transition
+    static constexpr bool IsInternal = false;
+
+    //! Type that identifies the state from which to transition
+    using FromState = From;
+
+    //! Type of the event that triggers the transition
+    using Event = Trigger;
+
+    //! Type that identifies the state to which to transition
+    using ToState = To;
+
+    //! Action of the transition
+    using Action = TransitionAction;
+
+    //! Guard condition of the transition
+    using Guard = GuardCondition;
+};
+
+/*!
+ * This class template describes an internal transition of a StaticStateMachine
+ *
+ * \tparam  State               Type that identifies the state
+ * \tparam  Trigger             Type of the event that triggers the transition (StaticAnyEvent for
+ *                              the default transition of the state)
+ * \tparam  TransitionAction    Action called with (Context &, const Event &)
+ * \tparam  GuardCondition      Guard condition called with (const Context &, const Event &)
+ */
+template<typename State,
+         typename Trigger,
+         typename TransitionAction,
+         typename GuardCondition = StaticNoGuard>
+struct StaticInternalTransition
+{
+    static_assert(!std::is_same<TransitionAction, StaticNoAction>::value,
+                  "An internal transition must have an action");
+
+    //! Flag that marks an internal transition
+    static constexpr bool IsInternal = true;
+
+    //! Type that identifies the state
+    using FromState = State;
+
+    //! Type of the event that triggers the transition
+    using Event = Trigger;
+
+    //! Type that identifies the state (an internal transition does not change the state)
+    using ToState = State;
+
+    //! Action of the transition
+    using Action = TransitionAction;
+
+    //! Guard condition of the transition
+    using Guard = GuardCondition;
+};
+
+//! This class template holds the list of transitions of a StaticStateMachine
+template<typename... Transitions>
+struct StaticTransitions
+{
+};
+
+template<typename Context, typename States, typename InitialTransition, typename Transitions>
+class StaticStateMachine;
+
+/*!
+ * This class template holds a state machine whose states, events and transitions are types
+ *
+ * The definition is validated at compile time with the same rules as StateMachine::validate()
+ * (existing states, no duplicate transitions, no state or exit actions in the final states and all
+ * states reachable from the initial state without following the default transitions). Processing
+ * an event is an indexed call through a table of per-state handlers where the transition for the
+ * event type is selected at compile time and its guard condition and actions are inlined. The order
+ * of the actions matches StateMachine: guard condition, exit action, transition action, entry
+ * action and then the final state detection. For each state and event an internal transition is
+ * checked first, then a state transition and then the default transitions (triggered by
+ * StaticAnyEvent).
+ *
+ * \tparam  Context             Type of the object that is passed to all actions
+ * \tparam  StateList           StaticState types
+ * \tparam  InitialTransition   StaticInitialTransition type
+ * \tparam  TransitionList      StaticStateTransition and StaticInternalTransition types
+ *
+ * \note    The state machine processes the events immediately and it is not thread safe. There is
+ *          no event queue, events added from the actions must be queued by the context.
+ */
+template<typename Context,
+         typename... StateList,
+         typename InitialTransition,
+         typename... TransitionList>
+class StaticStateMachine<Context,
+                         StaticStates<StateList...>,
+                         InitialTransition,
+                         StaticTransitions<TransitionList...>>
+{
+public:
+    //! Number of states
+    static constexpr int StateCount = static_cast<int>(sizeof...(StateList));
+
+    //! Number of transitions
+    static constexpr int TransitionCount = static_cast<int>(sizeof...(TransitionList));
+
+public:
+    //! Constructor
+    StaticStateMachine()
+        : m_context(),
+          m_currentState(-1),
+          m_started(false)
+    {
+        checkDefinition();
+    }
+
+    /*!
+     * Constructor
+     *
+     * \param   context     Context that is passed to all actions
+     */
+    explicit StaticStateMachine(Context context)
+        : m_context(std::move(context)),
+          m_currentState(-1),
+          m_started(false)
+    {
+        checkDefinition();
+    }
+
+    /*!
+     * Gets the context
+     *
+     * \return  Context that is passed to all actions
+     */
+    Context &context()
+    {
+        return m_context;
+    }
+
+    /*!
+     * Gets the context
+     *
+     * \return  Context that is passed to all actions
+     */
+    const Context &context() const
+    {
+        return m_context;
+    }
+
+    /*!
+     * Gets the index of the state
+     *
+     * \tparam  Tag     Type that identifies the state
+     *
+     * \return  Index of the state in the list of states or -1 if the state does not exist
+     */
+    template<typename Tag>
+    static constexpr int stateIndex()
+    {
+        const bool matches[] = { false, std::is_same<Tag, typename StateList::StateTag>::value... };
+
+        for (int i = 0; i < StateCount; i++)
+        {
+            if (matches[i + 1])
+            {
+                return i;
+            }
+        }
+
+        return -1;
+    }
+
+    /*!
+     * Checks if the state is a final state (a state without transitions)
+     *
+     * \param   index   Index of the state
+     *
+     * \retval  true    Final state
+     * \retval  false   Not a final state
+     */
+    static constexpr bool isFinalState(const int index)
+    {
+        const int fromStates[] = { -1, stateIndex<typename TransitionList::FromState>()... };
+
+        for (int i = 0; i < TransitionCount; i++)
+        {
+            if (fromStates[i + 1] == index)
+            {
+                return false;
+            }
+        }
+
+        return true;
+    }
+
+    /*!
+     * Checks if all of the states can be reached from the initial state
+     *
+     * \retval  true    All states can be reached
+     * \retval  false   At least one state cannot be reached
+     *
+     * \note    Default transitions (triggered by StaticAnyEvent) are not followed, the same as in
+     *          StateMachine::validate()
+     */
+    static constexpr bool allStatesReachable()
+    {
+        const int initialState = stateIndex<typename InitialTransition::ToState>();
+        const int fromStates[] = { -1, stateIndex<typename TransitionList::FromState>()... };
+        const int toStates[] = { -1, stateIndex<typename TransitionList::ToState>()... };
+        const bool defaults[] =
+        {
+            false, std::is_same<StaticAnyEvent, typename TransitionList::Event>::value...
+        };
+
+        if ((initialState < 0) || (!transitionStatesExist()))
+        {
+            return false;
+        }
+
+        bool reached[StateCount + 1] = {};
+        reached[initialState] = true;
+
+        // Propagate the reached states over the transitions until nothing changes
+        bool changed = true;
+
+        while (changed)
+        {
+            changed = false;
+
+            for (int i = 1; i <= TransitionCount; i++)
+            {
+                if ((!defaults[i]) && reached[fromStates[i]] && (!reached[toStates[i]]))
+                {
+                    reached[toStates[i]] = true;
+                    changed = true;
+                }
+            }
+        }
+
+        for (int i = 0; i < StateCount; i++)
+        {
+            if (!reached[i])
+            {
+                return false;
+            }
+        }
+
+        return true;
+    }
+
+    /*!
+     * Checks if the state machine is started
+     *
+     * \retval  true    Started
+     * \retval  false   Not started
+     */
+    bool isStarted() const
+    {
+        return m_started;
+    }
+
+    /*!
+     * Starts the state machine and executes the initial transition
+     *
+     * \param   event   Event passed to the initial transition's action and to the initial state's
+     *                  entry action
+     *
+     * \retval  true    Success
+     * \retval  false   Failure (state machine already started)
+     */
+    template<typename Event = StaticStartedEvent>
+    bool start(const Event &event = Event())
+    {
+        if (m_started)
+        {
+            return false;
+        }
+
+        constexpr int initialState = stateIndex<typename InitialTransition::ToState>();
+        using InitialState = StateAt<initialState>;
+
+        m_started = true;
+        typename InitialTransition::Action()(m_context, event);
+        typename InitialState::Entry()(m_context, event);
+        m_currentState = initialState;
+
+        if (isFinalState(initialState))
+        {
+            m_started = false;
+        }
+
+        return true;
+    }
+
+    /*!
+     * Stops the state machine
+     *
+     * \retval  true    Success
+     * \retval  false   Failure (state machine already stopped)
+     */
+    bool stop()
+    {
+        if (!m_started)
+        {
+            return false;
+        }
+
+        m_started = false;
+        return true;
+    }
+
+    /*!
+     * Gets the index of the current state
+     *
+     * \return  Index of the current state or -1 if the state machine was never started
+     */
+    int currentStateIndex() const
+    {
+        return m_currentState;
+    }
+
+    /*!
+     * Checks if the state machine is in the state
+     *
+     * \tparam  Tag     Type that identifies the state
+     *
+     * \retval  true    State machine is in the state
+     * \retval  false   State machine is not in the state
+     */
+    template<typename Tag>
+    bool isInState() const
+    {
+        static_assert(stateIndex<Tag>() >= 0, "State does not exist");
+
+        return (m_currentState == stateIndex<Tag>());
+    }
+
+    /*!
+     * Checks if the state machine reached a final state
+     *
+     * \retval  true    Final state reached
+     * \retval  false   Final state not reached
+     */
+    bool finalStateReached() const
+    {
+        static constexpr bool finalStates[] = { isFinalState(Indexes<StateList>::value)..., false };
+
+        return ((m_currentState >= 0) && finalStates[m_currentState]);
+    }
+
+    /*!
+     * Processes the event
+     *
+     * \param   event   Event
+     *
+     * \retval  true    Success
+     * \retval  false   Failure (state machine not started)
+     *
+     * \note    Events without a transition in the current state are ignored
+     */
+    template<typename Event>
+    bool processEvent(const Event &event)
+    {
+        if (!m_started)
+        {
+            return false;
+        }
+
+        using Handler = void (*)(StaticStateMachine &, const Event &);
+        static constexpr Handler handlers[] =
+        {
+            &StaticStateMachine::handleEvent<Event, Indexes<StateList>::value>...
+        };
+
+        handlers[m_currentState](*this, event);
+        return true;
+    }
+
+    /*!
+     * Executes the state action of the current state
+     *
+     * \retval  true    Success
+     * \retval  false   Failure (state machine not started)
+     */
+    bool executeStateAction()
+    {
+        if (!m_started)
+        {
+            return false;
+        }
+
+        using Handler = void (*)(StaticStateMachine &);
+        static constexpr Handler handlers[] =
+        {
+            &StaticStateMachine::handleStateAction<Indexes<StateList>::value>...
+        };
+
+        handlers[m_currentState](*this);
+        return true;
+    }
+
+private:
+    //! Marks that there is no transition for the event in the state
+    struct NoTransition
+    {
+        //! Flag that marks an internal transition
+        static constexpr bool IsInternal = false;
+    };
+
+    //! Gets the index of the state type in the list of states
+    template<typename State>
+    struct Indexes : std::integral_constant<int, stateIndex<typename State::StateTag>()>
+    {
+    };
+
+    //! Gets the state type at the index
+    template<int Index>
+    using StateAt = std::tuple_element_t<static_cast<std::size_t>(Index),
+                                         std::tuple<StateList...>>;
+
+    //! Gets the transition type at the index (or NoTransition for a negative index)
+    template<int Index>
+    using TransitionAt = std::tuple_element_t<
+            static_cast<std::size_t>((Index < 0) ? TransitionCount : Index),
+            std::tuple<TransitionList..., NoTransition>>;
+
+private:
+    /*!
+     * Finds the transition for the event in the state
+     *
+     * \tparam  Event   Type of the event
+     *
+     * \param   state   Index of the state
+     *
+     * \return  Index of the transition or -1 if there is no transition for the event in the state
+     */
+    template<typename Event>
+    static constexpr int findTransition(const int state)
+    {
+        const int fromStates[] = { -1, stateIndex<typename TransitionList::FromState>()... };
+        const bool internal[] = { false, TransitionList::IsInternal... };
+        const bool matches[] =
+        {
+            false, std::is_same<Event, typename TransitionList::Event>::value...
+        };
+        const bool defaults[] =
+        {
+            false, std::is_same<StaticAnyEvent, typename TransitionList::Event>::value...
+        };
+
+        // Explicit transitions are checked before the default transitions and internal transitions
+        // before the state transitions
+        for (int pass = 0; pass < 4; pass++)
+        {
+            const bool *candidates = (pass < 2) ? matches : defaults;
+            const bool internalTransition = ((pass % 2) == 0);
+
+            for (int i = 0; i < TransitionCount; i++)
+            {
+                if ((fromStates[i + 1] == state) &&
+                    candidates[i + 1] &&
+                    (internal[i + 1] == internalTransition))
+                {
+                    return i;
+                }
+            }
+        }
+
+        return -1;
+    }
+
+    //! Checks if all of the states are unique
+    static constexpr bool statesUnique()
+    {
+        const int indexes[] = { -1, Indexes<StateList>::value... };
+
+        for (int i = 0; i < StateCount; i++)
+        {
+            if (indexes[i + 1] != i)
+            {
+                return false;
+            }
+        }
+
+        return true;
+    }
+
+    //! Checks if the states used in the transitions exist
+    static constexpr bool transitionStatesExist()
+    {
+        const int fromStates[] = { 0, stateIndex<typename TransitionList::FromState>()... };
+        const int toStates[] = { 0, stateIndex<typename TransitionList::ToState>()... };
+
+        for (int i = 0; i <= TransitionCount; i++)
+        {
+            if ((fromStates[i] < 0) || (toStates[i] < 0))
+            {
+                return false;
+            }
+        }
+
+        return true;
+    }
+
+    //! Checks if a state has more than one transition for the same event
+    static constexpr bool transitionsUnique()
+    {
+        const int fromStates[] = { -1, stateIndex<typename TransitionList::FromState>()... };
+        const int events[] = { -1, findEvent<typename TransitionList::Event>()... };
+
+        for (int i = 1; i <= TransitionCount; i++)
+        {
+            for (int j = i + 1; j <= TransitionCount; j++)
+            {
+                if ((fromStates[i] == fromStates[j]) && (events[i] == events[j]))
+                {
+                    return false;
+                }
+            }
+        }
+
+        return true;
+    }
+
+    //! Checks if the final states have no state or exit actions
+    static constexpr bool finalStatesValid()
+    {
+        const bool hasActions[] =
+        {
+            false,
+            ((!std::is_same<typename StateList::Action, StaticNoAction>::value) ||
+             (!std::is_same<typename StateList::Exit, StaticNoAction>::value))...
+        };
+
+        for (int i = 0; i < StateCount; i++)
+        {
+            if (hasActions[i + 1] && isFinalState(i))
+            {
+                return false;
+            }
+        }
+
+        return true;
+    }
+
+    //! Gets the index of the first transition that is triggered by the event type
+    template<typename Event>
+    static constexpr int findEvent()
+    {
+        const bool matches[] =
+        {
+            false, std::is_same<Event, typename TransitionList::Event>::value...
+        };
+
+        for (int i = 0; i < TransitionCount; i++)
+        {
+            if (matches[i + 1])
+            {
+                return i;
+            }
+        }
+
+        return -1;
+    }
+
+    /*!
+     * Handles the event in the state
+     *
+     * \tparam  Event   Type of the event
+     * \tparam  State   Index of the state
+     *
+     * \param   stateMachine    State machine
+     * \param   event           Event
+     */
+    template<typename Event, int State>
+    static void handleEvent(StaticStateMachine &stateMachine, const Event &event)
+    {
+        using Transition = TransitionAt<findTransition<Event>(State)>;
+
+        stateMachine.template executeTransition<Event, State, Transition>(
+                    event, std::integral_constant<int, transitionKind<Transition>()>());
+    }
+
+    /*!
+     * Executes the state action of the state
+     *
+     * \tparam  State   Index of the state
+     *
+     * \param   stateMachine    State machine
+     */
+    template<int State>
+    static void handleStateAction(StaticStateMachine &stateMachine)
+    {
+        typename StateAt<State>::Action()(stateMachine.m_context);
+    }
+
+    //! Gets the kind of the transition (0: no transition, 1: state transition, 2: internal)
+    template<typename Transition>
+    static constexpr int transitionKind()
+    {
+        return std::is_same<Transition, NoTransition>::value ? 0 : (Transition::IsInternal ? 2 : 1);
+    }
+
+    //! Ignores the event (no transition)
+    template<typename Event, int State, typename Transition>
+    void executeTransition(const Event &, std::integral_constant<int, 0>)
+    {
+    }
+
+    //! Executes the state transition
+    template<typename Event, int State, typename Transition>
+    void executeTransition(const Event &event, std::integral_constant<int, 1>)
+    {
+        constexpr int nextState = stateIndex<typename Transition::ToState>();
+
+        // Check if the transition is blocked by the guard condition
+        if (!typename Transition::Guard()(static_cast<const Context &>(m_context), event))
+        {
+            return;
+        }
+
+        typename StateAt<State>::Exit()(m_context, event);
+        typename Transition::Action()(m_context, event);
+        typename StateAt<nextState>::Entry()(m_context, event);
+        m_currentState = nextState;
+
+        // Check if the state machine transitioned to a final state
+        if (isFinalState(nextState))
+        {
+            m_started = false;
+        }
+    }
+
+    //! Executes the internal transition
+    template<typename Event, int State, typename Transition>
+    void executeTransition(const Event &event, std::integral_constant<int, 2>)
+    {
+        // Check if the transition is blocked by the guard condition
+        if (!typename Transition::Guard()(static_cast<const Context &>(m_context), event))
+        {
+            return;
+        }
+
+        typename Transition::Action()(m_context, event);
+    }
+
+    //! Validates the state machine definition at compile time
+    static void checkDefinition()
+    {
+        static_assert(StateCount > 0, "State machine has no states");
+        static_assert(statesUnique(), "A state with the same type already exists");
+        static_assert(stateIndex<typename InitialTransition::ToState>() >= 0,
+                      "Initial state does not exist");
+        static_assert(transitionStatesExist(), "State used in a transition does not exist");
+        static_assert(transitionsUnique(), "A state has multiple transitions for the same event");
+        static_assert(finalStatesValid(),
+                      "A final state cannot have a state action or an exit action");
+        static_assert(allStatesReachable(), "Not all of the states can be reached");
+    }
+
+private:
+    //! Holds the context
+    Context m_context;
+
+    //! Holds the index of the current state (negative if not set)
+    int m_currentState;
+
+    //! Holds the started flag
+    bool m_started;
+};
+
+} // namespace CppStateMachineFramework
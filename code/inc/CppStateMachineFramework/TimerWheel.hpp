@@ -0,0 +1,461 @@
+/* This file is part of C++ State Machine Framework.
+ *
+ * C++ State Machine Framework is free software: you can redistribute it and/or modify it under the
+ * terms of the GNU Lesser General Public License as published by the Free Software Foundation,
+ * either version 3 of the License, or (at your option) any later version.
+ *
+ * C++ State Machine Framework is distributed in the hope that it will be useful, but WITHOUT ANY
+ * WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR
+ * PURPOSE. See the GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License along with C++ State
+ * Machine Framework. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+/*!
+ * \file
+ *
+ * Contains a hierarchical timing wheel that adds delayed events to state machine instances
+ */
+
+#pragma once
+
+// C++ State Machine Framework includes
+#include <CppStateMachineFramework/Event.hpp>
+
+// Qt includes
+#include <QtCore/QElapsedTimer>
+#include <QtCore/QMutex>
+#include <QtCore/QWaitCondition>
+
+// System includes
+#include <array>
+#include <atomic>
+#include <cstdint>
+#include <memory>
+#include <thread>
+#include <unordered_map>
+#include <vector>
+
+// Forward declarations
+namespace CppStateMachineFramework
+{
+class StateMachineInstance;
+}
+
+// Macros
+
+// -------------------------------------------------------------------------------------------------
+
+namespace CppStateMachineFramework
+{
+
+//! Type alias for the ID of a timer (delayed event)
+using TimerId = std::uint64_t;
+
+//! Invalid timer ID
+constexpr TimerId InvalidTimerId = 0U;
+
+/*!
+ * This class holds a hierarchical timing wheel that adds delayed events to state machine instances
+ *
+ * The timers are kept in four levels of 64 slots each. A timer is put in the slot of the lowest
+ * level that covers its delay and it is moved to the lower levels as the time advances, so arming
+ * and cancelling a timer takes constant time regardless of the number of timers. A single worker
+ * thread sleeps until the next slot with timers is due and then adds the events of all timers that
+ * expired in the meantime, so any number of timers expiring together costs only one wake-up. The
+ * same timing wheel can be shared by any number of state machine instances.
+ *
+ * Expired events are added to the back of the event queue of the instance (or to the lane of their
+ * priority). They are never blocked by the blocking backpressure policy (the event is rejected
+ * instead) so that a full event queue cannot stall the timers of the other instances.
+ *
+ * \note    The timers are usually armed through StateMachineInstance::addEventAfter() and
+ *          StateMachineInstance::addStateEventAfter() which also cancel the timers of an instance
+ *          when it is stopped or destroyed.
+ */
+class CPPSTATEMACHINEFRAMEWORK_EXPORT TimerWheel
+{
+public:
+    //! Default duration of a tick of the timing wheel in milliseconds
+    static constexpr int DefaultTickInterval = 1;
+
+public:
+    /*!
+     * Constructor
+     *
+     * \param   tickInterval    Duration of a tick in milliseconds (the resolution of the timers)
+     */
+    explicit TimerWheel(int tickInterval = DefaultTickInterval);
+
+    //! Copy constructor is disabled
+    TimerWheel(const TimerWheel &) = delete;
+
+    //! Move constructor is disabled
+    TimerWheel(TimerWheel &&) = delete;
+
+    //! Destructor (stops the worker thread)
+    ~TimerWheel();
+
+    //! Copy assignment operator is disabled
+    TimerWheel &operator=(const TimerWheel &) = delete;
+
+    //! Move assignment operator is disabled
+    TimerWheel &operator=(TimerWheel &&) = delete;
+
+    /*!
+     * Gets the timing wheel that is shared by all instances without an explicitly set timing wheel
+     *
+     * \return  Timing wheel (it is created and started on first use)
+     */
+    static std::shared_ptr<TimerWheel> defaultTimerWheel();
+
+    /*!
+     * Gets the duration of a tick
+     *
+     * \return  Duration of a tick in milliseconds
+     */
+    int tickInterval() const;
+
+    /*!
+     * Checks if the worker thread is running
+     *
+     * \retval  true    Running
+     * \retval  false   Not running
+     */
+    bool isRunning() const;
+
+    /*!
+     * Starts the worker thread
+     *
+     * \retval  true    Success
+     * \retval  false   Failure (timing wheel already running)
+     */
+    bool start();
+
+    /*!
+     * Stops the worker thread
+     *
+     * \retval  true    Success
+     * \retval  false   Failure (timing wheel already stopped)
+     *
+     * \note    The timers stay armed and expire after the timing wheel is started again (or when
+     *          processTimers() is called).
+     */
+    bool stop();
+
+    /*!
+     * Gets the number of armed timers (including the expired timers whose events were not yet
+     * added to their instances)
+     *
+     * \return  Number of timers
+     */
+    int timerCount() const;
+
+    /*!
+     * Checks if the timer is armed
+     *
+     * \param   timerId     Timer ID
+     *
+     * \retval  true    Timer is armed (its event was not yet added to the instance)
+     * \retval  false   Timer expired, was cancelled or the timer ID is invalid
+     */
+    bool isTimerActive(TimerId timerId) const;
+
+    /*!
+     * Arms a timer which adds the event to the instance after the delay
+     *
+     * \param   instance        State machine instance
+     * \param   delay           Delay in milliseconds (rounded up to the next tick)
+     * \param   event           Event
+     * \param   priority        Event priority
+     * \param   stateScoped     Timer is cancelled with cancelStateTimers()
+     *
+     * \return  Timer ID or InvalidTimerId on failure (null instance, negative delay, empty event
+     *          name)
+     *
+     * \note    The timers of an instance must be cancelled with cancelTimers() before the instance
+     *          is destroyed.
+     */
+    TimerId addTimer(StateMachineInstance *instance,
+                     int delay,
+                     Event &&event,
+                     int priority,
+                     bool stateScoped);
+
+    /*!
+     * Cancels the timer
+     *
+     * \param   timerId     Timer ID
+     *
+     * \retval  true    Success
+     * \retval  false   Failure (timer already expired or cancelled, invalid timer ID)
+     */
+    bool cancelTimer(TimerId timerId);
+
+    /*!
+     * Cancels all timers of the instance
+     *
+     * \param   instance    State machine instance
+     *
+     * \note    If an event of the instance is being added by the worker thread this method waits
+     *          until it is added, so after it returns no event is added to the instance anymore.
+     */
+    void cancelTimers(StateMachineInstance *instance);
+
+    /*!
+     * Cancels the state-scoped timers of the instance
+     *
+     * \param   instance    State machine instance
+     */
+    void cancelStateTimers(StateMachineInstance *instance);
+
+    /*!
+     * Advances the timing wheel to the current time and adds the events of the expired timers to
+     * their instances
+     *
+     * \return  Number of added events
+     *
+     * \note    This method makes it possible to drive the timing wheel from an existing event loop
+     *          instead of the worker thread.
+     */
+    int processTimers();
+
+private:
+    //! Enumerates the states of a timer
+    enum class TimerState
+    {
+        //! Timer is not used
+        Free,
+
+        //! Timer is in one of the slots of the timing wheel
+        Scheduled,
+
+        //! Timer expired and its event is waiting to be added to the instance
+        Expired
+    };
+
+    //! Holds a timer
+    struct Timer
+    {
+        //! Constructor
+        Timer();
+
+        //! Holds the event
+        Event event;
+
+        //! Holds the instance
+        StateMachineInstance *instance;
+
+        //! Holds the tick at which the timer expires
+        std::int64_t expiry;
+
+        //! Holds the generation of the timer (incremented each time the timer is released)
+        std::uint32_t generation;
+
+        //! Holds the event priority
+        int priority;
+
+        //! Holds the state of the timer
+        TimerState state;
+
+        //! Holds the flag which marks the timer as state-scoped
+        bool stateScoped;
+
+        //! Holds the index of the slot that holds the timer (negative if it is not in a slot)
+        int slot;
+
+        //! Holds the index of the previous timer in the slot or in the list of expired timers
+        int previous;
+
+        //! Holds the index of the next timer in the slot or in the list of expired timers (or in
+        //! the list of free timers)
+        int next;
+
+        //! Holds the index of the previous timer of the same instance
+        int previousOfInstance;
+
+        //! Holds the index of the next timer of the same instance
+        int nextOfInstance;
+    };
+
+    //! Holds a doubly-linked list of timers
+    struct TimerList
+    {
+        //! Holds the index of the first timer (negative if the list is empty)
+        int first = -1;
+
+        //! Holds the index of the last timer (negative if the list is empty)
+        int last = -1;
+    };
+
+    //! Number of levels of the timing wheel
+    static constexpr int LevelCount = 4;
+
+    //! Number of bits of the slot index in each level
+    static constexpr int SlotBits = 6;
+
+    //! Number of slots in each level
+    static constexpr int SlotCount = 1 << SlotBits;
+
+private:
+    /*!
+     * Gets the current tick
+     *
+     * \return  Number of ticks since the timing wheel was created
+     */
+    std::int64_t currentTick() const;
+
+    /*!
+     * Creates the timer ID
+     *
+     * \param   index   Index of the timer
+     *
+     * \return  Timer ID
+     */
+    TimerId timerId(int index) const;
+
+    /*!
+     * Gets the index of the armed timer
+     *
+     * \param   timerId     Timer ID
+     *
+     * \return  Index of the timer or a negative value if the timer is not armed
+     */
+    int timerIndex(TimerId timerId) const;
+
+    /*!
+     * Appends the timer to the list
+     *
+     * \param   list        List of timers
+     * \param   index       Index of the timer
+     * \param   previous    Member that holds the index of the previous timer in the list
+     * \param   next        Member that holds the index of the next timer in the list
+     */
+    void appendToList(TimerList *list, int index, int Timer::*previous, int Timer::*next);
+
+    /*!
+     * Removes the timer from the list
+     *
+     * \param   list        List of timers
+     * \param   index       Index of the timer
+     * \param   previous    Member that holds the index of the previous timer in the list
+     * \param   next        Member that holds the index of the next timer in the list
+     */
+    void removeFromList(TimerList *list, int index, int Timer::*previous, int Timer::*next);
+
+    /*!
+     * Puts the timer in the slot that covers its expiry
+     *
+     * \param   index   Index of the timer
+     */
+    void schedule(int index);
+
+    /*!
+     * Removes the timer from its slot or from the list of expired timers and releases it
+     *
+     * \param   index   Index of the timer
+     */
+    void cancel(int index);
+
+    /*!
+     * Removes the timer from the list of timers of its instance and releases it
+     *
+     * \param   index   Index of the timer
+     */
+    void release(int index);
+
+    /*!
+     * Gets the next tick at which a slot of the timing wheel must be processed
+     *
+     * \return  Tick or a negative value if there are no scheduled timers
+     */
+    std::int64_t nextTick() const;
+
+    /*!
+     * Processes all slots that are due up to the tick (the mutex must be locked)
+     *
+     * \param   tick    Tick
+     */
+    void advance(std::int64_t tick);
+
+    /*!
+     * Processes the slots that are due at the tick
+     *
+     * \param   tick    Tick
+     */
+    void processTick(std::int64_t tick);
+
+    /*!
+     * Adds the events of the expired timers to their instances (the mutex must be locked, it is
+     * unlocked while each event is added)
+     *
+     * \param   locker  Locker of the mutex
+     *
+     * \return  Number of added events
+     */
+    int deliverExpiredTimers(QMutexLocker *locker);
+
+    //! Runs the worker thread
+    void run();
+
+private:
+    //! Holds the duration of a tick in milliseconds
+    const int m_tickInterval;
+
+    //! Holds the timer used to measure the time since the timing wheel was created
+    QElapsedTimer m_clock;
+
+    //! Holds the current tick of the timing wheel
+    std::int64_t m_currentTick;
+
+    //! Holds the timers (the index of a timer is a part of its ID)
+    std::vector<Timer> m_timers;
+
+    //! Holds the index of the first free timer (the free timers are linked with their next index)
+    int m_freeTimer;
+
+    //! Holds the number of armed timers
+    int m_timerCount;
+
+    //! Holds the slots of all levels (slot N of level L is at index L * SlotCount + N)
+    std::array<TimerList, LevelCount * SlotCount> m_slots;
+
+    //! Holds the masks of the slots that are not empty (for each level)
+    std::array<std::uint64_t, LevelCount> m_slotMasks;
+
+    //! Holds the expired timers whose events were not yet added to their instances
+    TimerList m_expiredTimers;
+
+    //! Holds the timers of each instance
+    std::unordered_map<StateMachineInstance *, TimerList> m_instanceTimers;
+
+    //! Holds the instance to which an expired event is being added (if any)
+    StateMachineInstance *m_deliveringInstance;
+
+    //! Holds the ID of the thread that adds the expired event
+    std::thread::id m_deliveringThread;
+
+    //! Holds the tick until which the worker thread sleeps (negative if it sleeps without timeout)
+    std::int64_t m_wakeUpTick;
+
+    //! Holds the running flag
+    std::atomic<bool> m_running;
+
+    //! Holds the worker thread
+    std::thread m_thread;
+
+    //! Holds the mutex used to make the API thread safe
+    mutable QMutex m_apiMutex;
+
+    //! Holds the mutex used to make access to the timers thread safe
+    mutable QMutex m_mutex;
+
+    //! Holds the condition used to wake up the worker thread
+    QWaitCondition m_wakeUp;
+
+    //! Holds the condition used to signal that an expired event was added to its instance
+    QWaitCondition m_deliveryFinished;
+};
+
+} // namespace CppStateMachineFramework
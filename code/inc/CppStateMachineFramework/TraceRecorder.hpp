@@ -0,0 +1,210 @@
+/* This file is part of C++ State Machine Framework.
+ *
+ * C++ State Machine Framework is free software: you can redistribute it and/or modify it under the
+ * terms of the GNU Lesser General Public License as published by the Free Software Foundation,
+ * either version 3 of the License, or (at your option) any later version.
+ *
+ * C++ State Machine Framework is distributed in the hope that it will be useful, but WITHOUT ANY
+ * WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR
+ * PURPOSE. See the GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License along with C++ State
+ * Machine Framework. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+/*!
+ * \file
+ *
+ * Contains a process-wide flight recorder of the processed events
+ */
+
+#pragma once
+
+// C++ State Machine Framework includes
+#include <CppStateMachineFramework/EventNameRegistry.hpp>
+
+// Qt includes
+#include <QtCore/QByteArray>
+
+// System includes
+#include <chrono>
+#include <cstdint>
+#include <type_traits>
+#include <vector>
+
+// Forward declarations
+
+// Macros
+
+// -------------------------------------------------------------------------------------------------
+
+namespace CppStateMachineFramework
+{
+
+/*!
+ * This class holds a process-wide flight recorder of the processed events
+ *
+ * Each thread that writes a record gets its own ring buffer of fixed-size binary records, so
+ * writing a record does not need any locking or atomic read-modify-write instructions and it never
+ * allocates memory (except for the first record written by a thread). When a ring buffer is full
+ * the oldest records are overwritten, so the recorder always holds the last records of each thread.
+ * The ring buffers of the last MaxExitedThreadCount threads that exited are kept so that their
+ * records can still be dumped, older ones are freed as are all of them by clear().
+ *
+ * The records can be dumped at any time, serialized to a compact binary format and converted
+ * (also offline, in another process) to the Chrome trace event JSON format which can be viewed in
+ * chrome://tracing or in the Perfetto UI.
+ */
+class CPPSTATEMACHINEFRAMEWORK_EXPORT TraceRecorder
+{
+public:
+    //! Enumerates the types of the records
+    enum class RecordType : std::uint16_t
+    {
+        //! State transition was executed
+        StateTransition,
+
+        //! Internal transition was executed
+        InternalTransition,
+
+        //! Transition was blocked by its guard condition
+        GuardRejected,
+
+        //! Event was ignored (no transition for the event in the current state)
+        Ignored
+    };
+
+    //! Holds a record of a processed event (all timestamps are in nanoseconds of a steady clock)
+    struct Record
+    {
+        //! Holds the ID of the state machine instance
+        std::uint64_t machineId;
+
+        //! Holds the time at which the processing of the event was started
+        std::int64_t startTime;
+
+        //! Holds the time at which the guard condition was checked
+        std::int64_t guardTime;
+
+        //! Holds the time at which the exit action was executed
+        std::int64_t exitTime;
+
+        //! Holds the time at which the transition action was executed
+        std::int64_t actionTime;
+
+        //! Holds the time at which the entry action was executed (end of the processing)
+        std::int64_t entryTime;
+
+        //! Holds the index of the current state
+        std::int32_t fromState;
+
+        //! Holds the index of the next state (negative if the state was not changed)
+        std::int32_t toState;
+
+        //! Holds the ID of the event
+        EventId eventId;
+
+        //! Holds the record type
+        RecordType type;
+
+        //! Holds the index of the thread that processed the event (indexes of the exited threads
+        //! whose ring buffers were freed are reused)
+        std::uint16_t threadIndex;
+    };
+
+    static_assert(std::is_trivially_copyable<Record>::value, "Record must be trivially copyable");
+    static_assert(sizeof(Record) == 64U, "Record must fit in a cache line");
+
+    //! Default number of records held for each thread
+    static constexpr int DefaultCapacity = 4096;
+
+    //! Maximum number of exited threads whose ring buffers are kept
+    static constexpr int MaxExitedThreadCount = 64;
+
+public:
+    /*!
+     * Gets the number of records held for each thread
+     *
+     * \return  Capacity
+     */
+    static int capacity();
+
+    /*!
+     * Sets the number of records held for each thread
+     *
+     * \param   capacity    Capacity (rounded up to a power of two)
+     *
+     * \retval  true    Success
+     * \retval  false   Failure (capacity is not positive)
+     *
+     * \note    The capacity is applied only to the ring buffers of the threads that did not write
+     *          any records yet
+     */
+    static bool setCapacity(int capacity);
+
+    /*!
+     * Gets the current time
+     *
+     * \return  Nanoseconds of a steady clock
+     */
+    static inline std::int64_t now()
+    {
+        return std::chrono::duration_cast<std::chrono::nanoseconds>(
+                    std::chrono::steady_clock::now().time_since_epoch()).count();
+    }
+
+    /*!
+     * Writes the record to the ring buffer of the current thread
+     *
+     * \param   record  Record (its thread index is set by the recorder)
+     */
+    static void write(const Record &record);
+
+    /*!
+     * Takes a copy of the records of all threads
+     *
+     * \return  Records sorted by their start time
+     *
+     * \note    This method can be called from any thread while the records are written. Records
+     *          that are overwritten while they are copied are skipped.
+     */
+    static std::vector<Record> dump();
+
+    //! Discards the records of all threads
+    static void clear();
+
+    /*!
+     * Serializes the records to the binary dump format
+     *
+     * \param   records     Records
+     *
+     * \return  Binary dump (a versioned header followed by the raw records)
+     */
+    static QByteArray serialize(const std::vector<Record> &records);
+
+    /*!
+     * Deserializes the records from the binary dump format
+     *
+     * \param   data        Binary dump
+     * \param   records     Output for the records
+     *
+     * \retval  true    Success
+     * \retval  false   Failure (invalid header, unsupported version, truncated data)
+     */
+    static bool deserialize(const QByteArray &data, std::vector<Record> *records);
+
+    /*!
+     * Converts the records to the Chrome trace event JSON format
+     *
+     * \param   records     Records
+     *
+     * \return  JSON document
+     *
+     * Each record is shown as a slice named after its event (or "event #ID" if the event ID is not
+     * registered in the current process) on the track of its thread in the process of its machine.
+     * The guard, exit, action and entry phases of a state transition are shown as nested slices.
+     */
+    static QByteArray toChromeTrace(const std::vector<Record> &records);
+};
+
+} // namespace CppStateMachineFramework
@@ -36,25 +36,110 @@
 namespace CppStateMachineFramework
 {
 
+constexpr std::size_t Event::InlineParameterBufferSize;
+
+// -------------------------------------------------------------------------------------------------
+
 Event::Event(const QString &name)
-    : m_name(name),
-      m_parameter()
+    : Event(EventNameRegistry::id(name))
 {
+    // Only the names used by the state machine definitions are registered so that the events with
+    // arbitrary names do not grow the registry
+    if ((m_id == InvalidEventId) && (!name.isEmpty()))
+    {
+        m_id = UnregisteredEventId;
+        m_name = new QString(name);
+    }
 }
 
 // -------------------------------------------------------------------------------------------------
 
 Event::Event(const QString &name, std::unique_ptr<IEventParameter> &&parameter)
-    : m_name(name),
-      m_parameter(std::move(parameter))
+    : Event(name)
+{
+    m_parameter = parameter.release();
+}
+
+// -------------------------------------------------------------------------------------------------
+
+Event::Event(const EventId id)
+    : Event(id, {})
 {
 }
 
 // -------------------------------------------------------------------------------------------------
 
+Event::Event(const EventId id, std::unique_ptr<IEventParameter> &&parameter)
+    : m_id(EventNameRegistry::isRegistered(id) ? id : InvalidEventId),
+      m_parameterInline(false),
+      m_name(&EventNameRegistry::name(id)),
+      m_parameter(parameter.release())
+{
+}
+
+// -------------------------------------------------------------------------------------------------
+
+Event::Event(Event &&other) noexcept
+    : m_id(other.m_id),
+      m_parameterInline(false),
+      m_name(other.m_name),
+      m_parameter(nullptr)
+{
+    if (other.m_id == UnregisteredEventId)
+    {
+        // Name owned by the other event is taken over
+        other.m_id = InvalidEventId;
+        other.m_name = &EventNameRegistry::name(InvalidEventId);
+    }
+
+    takeParameter(other);
+}
+
+// -------------------------------------------------------------------------------------------------
+
+Event::~Event()
+{
+    destroyParameter();
+    releaseName();
+}
+
+// -------------------------------------------------------------------------------------------------
+
+Event &Event::operator=(Event &&other) noexcept
+{
+    if (this != &other)
+    {
+        destroyParameter();
+        releaseName();
+
+        m_id = other.m_id;
+        m_name = other.m_name;
+
+        if (other.m_id == UnregisteredEventId)
+        {
+            // Name owned by the other event is taken over
+            other.m_id = InvalidEventId;
+            other.m_name = &EventNameRegistry::name(InvalidEventId);
+        }
+
+        takeParameter(other);
+    }
+
+    return *this;
+}
+
+// -------------------------------------------------------------------------------------------------
+
+EventId Event::id() const
+{
+    return m_id;
+}
+
+// -------------------------------------------------------------------------------------------------
+
 const QString &Event::name() const
 {
-    return m_name;
+    return *m_name;
 }
 
 // -------------------------------------------------------------------------------------------------
@@ -66,16 +151,79 @@ bool Event::hasParameter() const
 
 // -------------------------------------------------------------------------------------------------
 
+bool Event::isParameterInline() const
+{
+    return m_parameterInline;
+}
+
+// -------------------------------------------------------------------------------------------------
+
 const IEventParameter *Event::parameter() const
 {
-    return m_parameter.get();
+    return m_parameter;
 }
 
 // -------------------------------------------------------------------------------------------------
 
 IEventParameter *Event::parameter()
 {
-    return m_parameter.get();
+    return m_parameter;
+}
+
+// -------------------------------------------------------------------------------------------------
+
+void Event::takeParameter(Event &other) noexcept
+{
+    if (other.m_parameter == nullptr)
+    {
+        return;
+    }
+
+    if (other.m_parameterInline)
+    {
+        // Move the parameter from the other event's buffer to this event's buffer
+        m_parameter = other.m_parameter->relocate(&m_parameterBuffer);
+        m_parameterInline = true;
+    }
+    else
+    {
+        m_parameter = other.m_parameter;
+    }
+
+    other.m_parameter = nullptr;
+    other.m_parameterInline = false;
+}
+
+// -------------------------------------------------------------------------------------------------
+
+void Event::destroyParameter() noexcept
+{
+    if (m_parameter == nullptr)
+    {
+        return;
+    }
+
+    if (m_parameterInline)
+    {
+        m_parameter->~IEventParameter();
+    }
+    else
+    {
+        delete m_parameter;
+    }
+
+    m_parameter = nullptr;
+    m_parameterInline = false;
+}
+
+// -------------------------------------------------------------------------------------------------
+
+void Event::releaseName() noexcept
+{
+    if (m_id == UnregisteredEventId)
+    {
+        delete m_name;
+    }
 }
 
 } // namespace CppStateMachineFramework
@@ -0,0 +1,1460 @@
+/* This file is part of C++ State Machine Framework.
+ *
+ * C++ State Machine Framework is free software: you can redistribute it and/or modify it under the
+ * terms of the GNU Lesser General Public License as published by the Free Software Foundation,
+ * either version 3 of the License, or (at your option) any later version.
+ *
+ * C++ State Machine Framework is distributed in the hope that it will be useful, but WITHOUT ANY
+ * WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR
+ * PURPOSE. See the GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License along with C++ State
+ * Machine Framework. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+/*!
+ * \file
+ *
+ * Contains an append-only journal of the events stored in memory-mapped segment files
+ */
+
+// Own header
+#include <CppStateMachineFramework/EventJournal.hpp>
+
+// C++ State Machine Framework includes
+#include <CppStateMachineFramework/EventNameRegistry.hpp>
+
+// Qt includes
+#include <QtCore/QDir>
+#include <QtCore/QFile>
+#include <QtCore/QLoggingCategory>
+
+// System includes
+#include <algorithm>
+#include <cstring>
+
+#if defined(Q_OS_WIN)
+#include <io.h>
+#include <windows.h>
+#elif defined(Q_OS_UNIX)
+#include <sys/mman.h>
+#include <unistd.h>
+#endif
+
+// Forward declarations
+
+// Macros
+
+// -------------------------------------------------------------------------------------------------
+
+//! Logging category for the event journal
+static const QLoggingCategory s_loggingCategory("CppStateMachineFramework.EventJournal",
+                                                QtWarningMsg);
+
+//! Magic number at the start of a segment file
+static const char s_segmentMagic[8] = { 'C', 'S', 'M', 'F', 'J', 'R', 'N', 'L' };
+
+//! Version of the segment file format
+static const std::uint32_t s_segmentVersion = 1U;
+
+//! Size of the segment header (magic number, version, header size, segment number and the sequence
+//! number of the first event)
+static const qint64 s_segmentHeaderSize = 32;
+
+//! Magic number at the start of the checkpoint file
+static const char s_checkpointMagic[8] = { 'C', 'S', 'M', 'F', 'C', 'K', 'P', 'T' };
+
+//! Size of the checkpoint file (magic number and the checkpoint)
+static const qint64 s_checkpointFileSize = 16;
+
+//! Name of the checkpoint file
+static const char s_checkpointFileName[] = "checkpoint";
+
+//! Size of the record header (payload size and checksum)
+static const qint64 s_recordHeaderSize = 8;
+
+//! Number of appended bytes after which a commit is requested without waiting for the interval
+static const qint64 s_commitSize = 1024 * 1024;
+
+//! Enumerates the types of the records
+enum class RecordType : std::uint8_t
+{
+    //! Name of an event ID used in the segment
+    EventName = 1,
+
+    //! Type name of an event parameter type used in the segment
+    ParameterType = 2,
+
+    //! Event
+    Event = 3
+};
+
+//! Offset of the parameter type index in the payload of an event record (after the record type,
+//! sequence number and event ID)
+static const int s_eventParameterTypeOffset = 1 + 8 + 4;
+
+// -------------------------------------------------------------------------------------------------
+
+/*!
+ * Calculates the checksum of a record's payload (32-bit FNV-1a)
+ *
+ * \param   data    Payload
+ * \param   size    Size of the payload
+ *
+ * \return  Checksum
+ */
+static std::uint32_t recordChecksum(const char *data, const std::size_t size)
+{
+    std::uint32_t checksum = 2166136261U;
+
+    for (std::size_t i = 0U; i < size; i++)
+    {
+        checksum ^= static_cast<std::uint8_t>(data[i]);
+        checksum *= 16777619U;
+    }
+
+    return checksum;
+}
+
+// -------------------------------------------------------------------------------------------------
+
+/*!
+ * Gets the size of a record in the segment (records are aligned to 8 bytes)
+ *
+ * \param   payloadSize     Size of the record's payload
+ *
+ * \return  Size of the record
+ */
+static qint64 alignedRecordSize(const qint64 payloadSize)
+{
+    return (s_recordHeaderSize + payloadSize + 7) & (~static_cast<qint64>(7));
+}
+
+// -------------------------------------------------------------------------------------------------
+
+/*!
+ * Gets the maximum size of a table record with a name
+ *
+ * \param   name    Name (an event name or a parameter type name)
+ *
+ * \return  Maximum size of the record
+ */
+static qint64 maximumTableRecordSize(const QString &name)
+{
+    // Record type, the larger of the event ID and the type index, the length of the name and its
+    // UTF-8 encoding (at most three bytes for each UTF-16 code unit)
+    return alignedRecordSize(1 + 4 + 4 + (3 * static_cast<qint64>(name.size())));
+}
+
+// -------------------------------------------------------------------------------------------------
+
+/*!
+ * Gets the path of a segment file
+ *
+ * \param   directory   Directory of the journal
+ * \param   number      Number of the segment
+ *
+ * \return  Path of the segment file
+ */
+static QString segmentFilePath(const QString &directory, const std::uint64_t number)
+{
+    // Numbers are padded so that the file names are ordered by the numbers
+    return QDir(directory).filePath(QString("%1.segment").arg(static_cast<qulonglong>(number),
+                                                              20,
+                                                              10,
+                                                              QChar('0')));
+}
+
+// -------------------------------------------------------------------------------------------------
+
+/*!
+ * Reads the segment header
+ *
+ * \param   data            Header
+ * \param   size            Size of the header data
+ * \param   number          Output for the number of the segment
+ * \param   firstSequence   Output for the sequence number of the first event in the segment
+ *
+ * \retval  true    Success
+ * \retval  false   Failure (header is not valid)
+ */
+static bool readSegmentHeader(const char *data,
+                              const qint64 size,
+                              std::uint64_t *number,
+                              std::uint64_t *firstSequence)
+{
+    if ((size < s_segmentHeaderSize) ||
+        (std::memcmp(data, s_segmentMagic, sizeof(s_segmentMagic)) != 0))
+    {
+        return false;
+    }
+
+    CppStateMachineFramework::BinaryReader reader(
+                data + sizeof(s_segmentMagic),
+                static_cast<std::size_t>(s_segmentHeaderSize) - sizeof(s_segmentMagic));
+    std::uint32_t version = 0U;
+    std::uint32_t headerSize = 0U;
+
+    return reader.readValue(&version) &&
+            reader.readValue(&headerSize) &&
+            reader.readValue(number) &&
+            reader.readValue(firstSequence) &&
+            (version == s_segmentVersion) &&
+            (headerSize == static_cast<std::uint32_t>(s_segmentHeaderSize));
+}
+
+// -------------------------------------------------------------------------------------------------
+
+/*!
+ * Flushes the memory-mapped data to the disk
+ *
+ * \param   file    Mapped file
+ * \param   data    Mapped data
+ * \param   offset  Offset of the flushed range
+ * \param   size    Size of the flushed range
+ *
+ * \retval  true    Success
+ * \retval  false   Failure
+ */
+static bool flushMappedData(QFile *file, uchar *data, const qint64 offset, const qint64 size)
+{
+    if (size <= 0)
+    {
+        return true;
+    }
+
+#if defined(Q_OS_WIN)
+    return (FlushViewOfFile(data + offset, static_cast<SIZE_T>(size)) != 0) &&
+            (FlushFileBuffers(reinterpret_cast<HANDLE>(_get_osfhandle(file->handle()))) != 0);
+#elif defined(Q_OS_UNIX)
+    Q_UNUSED(file)
+
+    // The flushed range must start at a page boundary (the mapping itself starts at one)
+    static const qint64 s_pageSize = static_cast<qint64>(sysconf(_SC_PAGESIZE));
+    const qint64 start = offset - (offset % s_pageSize);
+
+    return (msync(data + start, static_cast<std::size_t>(offset + size - start), MS_SYNC) == 0);
+#else
+    // Without a platform specific flush the data is written by the operating system eventually
+    Q_UNUSED(file)
+    Q_UNUSED(data)
+    Q_UNUSED(offset)
+    return true;
+#endif
+}
+
+// -------------------------------------------------------------------------------------------------
+
+namespace CppStateMachineFramework
+{
+
+/*!
+ * Reads the events from the records of a segment
+ *
+ * The tables of the event names and parameter types are read on the way. Reading stops at the first
+ * record that is incomplete or damaged (its checksum does not match).
+ */
+class SegmentEventReader
+{
+public:
+    /*!
+     * Constructor
+     *
+     * \param   data    Mapped segment file
+     * \param   size    Size of the segment file
+     */
+    SegmentEventReader(const uchar *data, const qint64 size)
+        : m_data(reinterpret_cast<const char *>(data)),
+          m_size(size),
+          m_offset(s_segmentHeaderSize),
+          m_failed(false)
+    {
+    }
+
+    //! Checks if an event could not be created (its name or parameter could not be read)
+    bool failed() const
+    {
+        return m_failed;
+    }
+
+    /*!
+     * Reads the next event
+     *
+     * \param[out]  sequence    Output for the sequence number of the event
+     * \param[out]  event       Output for the event (nullptr if the event is only checked)
+     *
+     * \retval  true    Success
+     * \retval  false   Failure (no more valid events or the event could not be created)
+     */
+    bool next(std::uint64_t *sequence, Event *event)
+    {
+        std::uint8_t type = 0U;
+        BinaryReader payload(nullptr, 0U);
+
+        while (nextRecord(&type, &payload))
+        {
+            switch (static_cast<RecordType>(type))
+            {
+                case RecordType::EventName:
+                {
+                    std::uint32_t eventId = 0U;
+                    QString name;
+
+                    if ((!payload.readValue(&eventId)) ||
+                        (!payload.readString(&name)) ||
+                        (eventId == InvalidEventId) ||
+                        (name.isEmpty()))
+                    {
+                        return false;
+                    }
+
+                    if (eventId >= m_eventNames.size())
+                    {
+                        m_eventNames.resize(eventId + 1U);
+                        m_eventIds.resize(eventId + 1U, InvalidEventId);
+                    }
+
+                    m_eventNames[eventId] = name;
+                    break;
+                }
+
+                case RecordType::ParameterType:
+                {
+                    std::uint16_t typeIndex = 0U;
+                    QString typeName;
+
+                    if ((!payload.readValue(&typeIndex)) ||
+                        (!payload.readString(&typeName)) ||
+                        (typeIndex != m_typeNames.size()))
+                    {
+                        return false;
+                    }
+
+                    m_typeNames.push_back(typeName);
+                    m_types.push_back(nullptr);
+                    break;
+                }
+
+                case RecordType::Event:
+                {
+                    return readEvent(&payload, sequence, event);
+                }
+
+                default:
+                {
+                    return false;
+                }
+            }
+        }
+
+        return false;
+    }
+
+private:
+    /*!
+     * Reads the next record
+     *
+     * \param[out]  type        Output for the record type
+     * \param[out]  payload     Output for the reader of the record's payload (after the type)
+     *
+     * \retval  true    Success
+     * \retval  false   Failure (no more valid records)
+     */
+    bool nextRecord(std::uint8_t *type, BinaryReader *payload)
+    {
+        if ((m_offset + s_recordHeaderSize) > m_size)
+        {
+            return false;
+        }
+
+        std::uint32_t size = 0U;
+        std::uint32_t checksum = 0U;
+
+        std::memcpy(&size, m_data + m_offset, sizeof(size));
+        std::memcpy(&checksum, m_data + m_offset + sizeof(size), sizeof(checksum));
+
+        if ((size == 0U) || ((m_offset + s_recordHeaderSize + size) > m_size))
+        {
+            return false;
+        }
+
+        const char *data = m_data + m_offset + s_recordHeaderSize;
+
+        if (recordChecksum(data, size) != checksum)
+        {
+            qCWarning(s_loggingCategory) << "Damaged record found in the journal";
+            return false;
+        }
+
+        *type = static_cast<std::uint8_t>(data[0]);
+        *payload = BinaryReader(data + 1, size - 1U);
+        m_offset += alignedRecordSize(size);
+        return true;
+    }
+
+    /*!
+     * Reads the event record
+     *
+     * \param       payload     Reader of the record's payload
+     * \param[out]  sequence    Output for the sequence number of the event
+     * \param[out]  event       Output for the event (nullptr if the event is only checked)
+     *
+     * \retval  true    Success
+     * \retval  false   Failure
+     */
+    bool readEvent(BinaryReader *payload, std::uint64_t *sequence, Event *event)
+    {
+        std::uint32_t eventId = 0U;
+        std::uint16_t typeIndex = 0U;
+
+        if ((!payload->readValue(sequence)) ||
+            (!payload->readValue(&eventId)) ||
+            (!payload->readValue(&typeIndex)) ||
+            (eventId >= m_eventNames.size()) ||
+            (m_eventNames[eventId].isEmpty()) ||
+            (typeIndex > m_typeNames.size()))
+        {
+            return false;
+        }
+
+        if (event == nullptr)
+        {
+            return true;
+        }
+
+        // Event IDs of the process that wrote the segment are mapped to the IDs of this process.
+        // Names are not registered so that a journal cannot grow the event name registry, the
+        // events with names that are not used by any definition hold their own copy of the name.
+        if (m_eventIds[eventId] == InvalidEventId)
+        {
+            const EventId id = EventNameRegistry::id(m_eventNames[eventId]);
+            m_eventIds[eventId] = (id != InvalidEventId) ? id : UnregisteredEventId;
+        }
+
+        if (m_eventIds[eventId] == UnregisteredEventId)
+        {
+            *event = Event(m_eventNames[eventId]);
+        }
+        else
+        {
+            *event = Event(m_eventIds[eventId]);
+        }
+
+        if (typeIndex == 0U)
+        {
+            return true;
+        }
+
+        // Parameter type index is written incremented by one as zero means no parameter
+        const std::size_t type = typeIndex - 1U;
+
+        if (m_types[type] == nullptr)
+        {
+            m_types[type] = EventParameterSerializer::handlerByTypeName(m_typeNames[type]);
+
+            if (m_types[type] == nullptr)
+            {
+                qCWarning(s_loggingCategory)
+                        << "No serializer is registered for the event parameter type:"
+                        << m_typeNames[type];
+                m_failed = true;
+                return false;
+            }
+        }
+
+        if ((!m_types[type]->deserialize(payload, event)) ||
+            (!payload->atEnd()))
+        {
+            qCWarning(s_loggingCategory)
+                    << "Failed to read the parameter of the event:" << m_eventNames[eventId];
+            m_failed = true;
+            return false;
+        }
+
+        return true;
+    }
+
+private:
+    //! Holds the mapped segment file
+    const char *m_data;
+
+    //! Holds the size of the segment file
+    qint64 m_size;
+
+    //! Holds the offset of the next record
+    qint64 m_offset;
+
+    //! Holds the flag which is set if an event could not be created
+    bool m_failed;
+
+    //! Holds the event names (indexed by the event ID of the process that wrote the segment)
+    std::vector<QString> m_eventNames;
+
+    //! Holds the event IDs of this process or UnregisteredEventId (indexed by the event ID of the
+    //! process that wrote the segment)
+    std::vector<EventId> m_eventIds;
+
+    //! Holds the parameter type names (indexed by the type index)
+    std::vector<QString> m_typeNames;
+
+    //! Holds the serializers of the parameter types (indexed by the type index)
+    std::vector<const EventParameterSerializer::Handler *> m_types;
+};
+
+// -------------------------------------------------------------------------------------------------
+
+constexpr qint64 EventJournal::DefaultSegmentSize;
+constexpr qint64 EventJournal::MinimumSegmentSize;
+constexpr int EventJournal::DefaultCommitInterval;
+
+// -------------------------------------------------------------------------------------------------
+
+EventJournal::EventJournal(const qint64 segmentSize, const int commitInterval)
+    : m_segmentSize(std::max(MinimumSegmentSize, segmentSize)),
+      m_commitInterval(std::max(1, commitInterval)),
+      m_open(false),
+      m_nextSegmentNumber(0U),
+      m_uncommittedSize(0),
+      m_lastSequence(0U),
+      m_checkpointData(nullptr),
+      m_checkpoint(0U),
+      m_committedSequence(0U),
+      m_commitPending(false),
+      m_committing(false),
+      m_commitCount(0U),
+      m_stopCommitThread(false)
+{
+}
+
+// -------------------------------------------------------------------------------------------------
+
+EventJournal::~EventJournal()
+{
+    if (isOpen())
+    {
+        close();
+    }
+}
+
+// -------------------------------------------------------------------------------------------------
+
+qint64 EventJournal::segmentSize() const
+{
+    return m_segmentSize;
+}
+
+// -------------------------------------------------------------------------------------------------
+
+int EventJournal::commitInterval() const
+{
+    return m_commitInterval;
+}
+
+// -------------------------------------------------------------------------------------------------
+
+bool EventJournal::isOpen() const
+{
+    return m_open.load(std::memory_order_acquire);
+}
+
+// -------------------------------------------------------------------------------------------------
+
+QString EventJournal::directory() const
+{
+    QMutexLocker apiLocker(&m_apiMutex);
+
+    return m_directory;
+}
+
+// -------------------------------------------------------------------------------------------------
+
+bool EventJournal::open(const QString &directory)
+{
+    QMutexLocker apiLocker(&m_apiMutex);
+
+    if (m_open.load(std::memory_order_acquire))
+    {
+        qCWarning(s_loggingCategory) << "Journal is already open";
+        return false;
+    }
+
+    if (directory.isEmpty() || (!QDir().mkpath(directory)))
+    {
+        qCWarning(s_loggingCategory) << "Failed to create the journal directory:" << directory;
+        return false;
+    }
+
+    m_directory = directory;
+
+    // Remove the segment files that were prepared but never used
+    QStringList unusedPaths;
+    const auto segments = listSegments(&unusedPaths);
+
+    for (const auto &path : unusedPaths)
+    {
+        QFile::remove(path);
+    }
+
+    // Find the last valid event (the segments must follow each other without any gaps)
+    std::uint64_t lastSequence = segments.empty() ? 0U : (segments.front().firstSequence - 1U);
+    std::uint64_t nextSegmentNumber = 0U;
+
+    for (const auto &segmentInfo : segments)
+    {
+        nextSegmentNumber = segmentInfo.number + 1U;
+
+        if (segmentInfo.firstSequence != (lastSequence + 1U))
+        {
+            // Its sequence numbers would clash with the events appended after the last valid one
+            qCWarning(s_loggingCategory)
+                    << "Journal segment does not follow the previous segment, it is renamed:"
+                    << segmentInfo.path;
+            QFile::rename(segmentInfo.path, segmentInfo.path + QStringLiteral(".damaged"));
+            continue;
+        }
+
+        QFile file(segmentInfo.path);
+        uchar *data = nullptr;
+
+        if (file.open(QIODevice::ReadOnly))
+        {
+            data = file.map(0, file.size());
+        }
+
+        if (data == nullptr)
+        {
+            qCWarning(s_loggingCategory)
+                    << "Failed to read the journal segment:" << file.fileName();
+            continue;
+        }
+
+        SegmentEventReader reader(data, file.size());
+        std::uint64_t sequence = 0U;
+
+        while (reader.next(&sequence, nullptr) && (sequence == (lastSequence + 1U)))
+        {
+            lastSequence = sequence;
+        }
+
+        file.unmap(data);
+    }
+
+    // Open the checkpoint file (the checkpoint cannot be after the last valid event as the events
+    // could have been lost in a crash of the operating system)
+    m_checkpointFile = std::make_unique<QFile>(QDir(directory).filePath(s_checkpointFileName));
+
+    if ((!m_checkpointFile->open(QIODevice::ReadWrite)) ||
+        ((m_checkpointFile->size() != s_checkpointFileSize) &&
+         (!m_checkpointFile->resize(s_checkpointFileSize))) ||
+        ((m_checkpointData = m_checkpointFile->map(0, s_checkpointFileSize)) == nullptr))
+    {
+        qCWarning(s_loggingCategory)
+                << "Failed to open the journal checkpoint file:" << m_checkpointFile->fileName();
+        m_checkpointFile.reset();
+        m_directory.clear();
+        return false;
+    }
+
+    std::uint64_t checkpoint = 0U;
+
+    if (std::memcmp(m_checkpointData, s_checkpointMagic, sizeof(s_checkpointMagic)) == 0)
+    {
+        std::memcpy(&checkpoint, m_checkpointData + sizeof(s_checkpointMagic), sizeof(checkpoint));
+    }
+
+    if (segments.empty())
+    {
+        // All segments were removed so the sequence numbers continue after the checkpoint
+        lastSequence = checkpoint;
+    }
+
+    checkpoint = std::min(checkpoint, lastSequence);
+
+    std::memcpy(m_checkpointData, s_checkpointMagic, sizeof(s_checkpointMagic));
+    std::memcpy(m_checkpointData + sizeof(s_checkpointMagic), &checkpoint, sizeof(checkpoint));
+
+    m_lastSequence.store(lastSequence, std::memory_order_release);
+    m_committedSequence.store(lastSequence, std::memory_order_release);
+    m_checkpoint.store(checkpoint, std::memory_order_release);
+
+    // Events are appended to a new segment as the tables of the existing segments belong to the
+    // process that wrote them
+    {
+        QMutexLocker appendLocker(&m_appendMutex);
+
+        m_nextSegmentNumber = nextSegmentNumber;
+
+        if (!startNextSegment())
+        {
+            appendLocker.unlock();
+
+            m_checkpointFile->unmap(m_checkpointData);
+            m_checkpointData = nullptr;
+            m_checkpointFile.reset();
+            m_directory.clear();
+            return false;
+        }
+    }
+
+    m_stopCommitThread = false;
+    m_commitThread = std::thread([this]() { runCommitThread(); });
+    m_open.store(true, std::memory_order_release);
+
+    qCDebug(s_loggingCategory) << "Journal opened:" << directory
+                               << "last sequence:" << lastSequence
+                               << "checkpoint:" << checkpoint;
+    return true;
+}
+
+// -------------------------------------------------------------------------------------------------
+
+bool EventJournal::close()
+{
+    QMutexLocker apiLocker(&m_apiMutex);
+
+    if (!m_open.load(std::memory_order_acquire))
+    {
+        qCWarning(s_loggingCategory) << "Journal is already closed";
+        return false;
+    }
+
+    m_open.store(false, std::memory_order_release);
+
+    {
+        QMutexLocker commitLocker(&m_commitMutex);
+        m_stopCommitThread = true;
+        m_commitRequested.wakeAll();
+    }
+
+    m_commitThread.join();
+
+    // Commit everything that was appended since the last commit
+    commit();
+
+    {
+        QMutexLocker commitLocker(&m_commitMutex);
+        m_commitPending = false;
+        m_commitCount++;
+        m_commitFinished.wakeAll();
+    }
+
+    QMutexLocker appendLocker(&m_appendMutex);
+
+    closeSegment(m_segment.get(), false);
+    m_segment.reset();
+
+    if (m_nextSegment)
+    {
+        closeSegment(m_nextSegment.get(), true);
+        m_nextSegment.reset();
+    }
+
+    m_segmentEventNames.clear();
+    m_segmentParameterTypes.clear();
+    m_uncommittedSize = 0;
+
+    m_checkpointFile->unmap(m_checkpointData);
+    m_checkpointData = nullptr;
+    m_checkpointFile.reset();
+
+    qCDebug(s_loggingCategory) << "Journal closed:" << m_directory;
+    m_directory.clear();
+    return true;
+}
+
+// -------------------------------------------------------------------------------------------------
+
+std::uint64_t EventJournal::lastSequence() const
+{
+    return m_lastSequence.load(std::memory_order_acquire);
+}
+
+// -------------------------------------------------------------------------------------------------
+
+std::uint64_t EventJournal::committedSequence() const
+{
+    return m_committedSequence.load(std::memory_order_acquire);
+}
+
+// -------------------------------------------------------------------------------------------------
+
+std::uint64_t EventJournal::checkpoint() const
+{
+    return m_checkpoint.load(std::memory_order_acquire);
+}
+
+// -------------------------------------------------------------------------------------------------
+
+std::uint64_t EventJournal::append(const Event &event)
+{
+    QMutexLocker appendLocker(&m_appendMutex);
+
+    if (!m_segment)
+    {
+        qCWarning(s_loggingCategory) << "Journal is not open";
+        return 0U;
+    }
+
+    // Events are journaled with the IDs of their names
+    if (event.id() == UnregisteredEventId)
+    {
+        qCWarning(s_loggingCategory) << "Event name is not registered:" << event.name();
+        return 0U;
+    }
+
+    const EventParameterSerializer::Handler *handler = nullptr;
+
+    if (event.hasParameter())
+    {
+        handler = parameterSerializer(*event.parameter());
+
+        if (handler == nullptr)
+        {
+            qCWarning(s_loggingCategory)
+                    << "No serializer is registered for the parameter of the event:"
+                    << event.name();
+            return 0U;
+        }
+    }
+
+    // Serialize the event (the parameter type index is written when the segment is known)
+    const std::uint64_t sequence = m_lastSequence.load(std::memory_order_relaxed) + 1U;
+
+    m_recordBuffer.resize(0);
+    BinaryWriter writer(&m_recordBuffer);
+
+    writer.writeValue(static_cast<std::uint8_t>(RecordType::Event));
+    writer.writeValue(sequence);
+    writer.writeValue(static_cast<std::uint32_t>(event.id()));
+    writer.writeValue(static_cast<std::uint16_t>(0U));
+
+    if (handler != nullptr)
+    {
+        handler->serialize(*event.parameter(), &writer);
+    }
+
+    // The event's name and parameter type must be written to the segment before the first event
+    // which uses them
+    const qint64 recordSize = alignedRecordSize(m_recordBuffer.size());
+    const bool hasEventName = (event.id() < m_segmentEventNames.size()) &&
+                              m_segmentEventNames[event.id()];
+    const bool hasParameterType =
+            (handler == nullptr) ||
+            (std::find(m_segmentParameterTypes.begin(), m_segmentParameterTypes.end(), handler) !=
+             m_segmentParameterTypes.end());
+
+    const qint64 tableSize =
+            maximumTableRecordSize(event.name()) +
+            ((handler != nullptr) ? maximumTableRecordSize(handler->typeName) : 0);
+
+    if ((s_segmentHeaderSize + recordSize + tableSize) > m_segmentSize)
+    {
+        qCWarning(s_loggingCategory) << "Event is too large for a journal segment:" << event.name();
+        return 0U;
+    }
+
+    const qint64 requiredSize = recordSize +
+                                (hasEventName ? 0 : maximumTableRecordSize(event.name())) +
+                                (hasParameterType ? 0 : maximumTableRecordSize(handler->typeName));
+
+    if (((m_segment->writeOffset + requiredSize) > m_segmentSize) && (!startNextSegment()))
+    {
+        return 0U;
+    }
+
+    // Write the table records and the event
+    if ((event.id() >= m_segmentEventNames.size()) || (!m_segmentEventNames[event.id()]))
+    {
+        if (event.id() >= m_segmentEventNames.size())
+        {
+            m_segmentEventNames.resize(event.id() + 1U, false);
+        }
+
+        m_tableBuffer.resize(0);
+        BinaryWriter tableWriter(&m_tableBuffer);
+
+        tableWriter.writeValue(static_cast<std::uint8_t>(RecordType::EventName));
+        tableWriter.writeValue(static_cast<std::uint32_t>(event.id()));
+        tableWriter.writeString(event.name());
+
+        writeRecord(m_tableBuffer);
+        m_segmentEventNames[event.id()] = true;
+    }
+
+    if (handler != nullptr)
+    {
+        // Parameter type index is written incremented by one as zero means no parameter
+        writer.overwriteValue(s_eventParameterTypeOffset,
+                              static_cast<std::uint16_t>(segmentParameterTypeIndex(handler) + 1U));
+    }
+
+    writeRecord(m_recordBuffer);
+    m_lastSequence.store(sequence, std::memory_order_release);
+
+    // Group commit is requested early if a lot of data is pending
+    m_uncommittedSize += recordSize;
+
+    if (m_uncommittedSize >= s_commitSize)
+    {
+        m_uncommittedSize = 0;
+        requestCommit();
+    }
+
+    return sequence;
+}
+
+// -------------------------------------------------------------------------------------------------
+
+void EventJournal::setCheckpoint(const std::uint64_t sequence)
+{
+    if ((sequence <= m_checkpoint.load(std::memory_order_relaxed)) || (m_checkpointData == nullptr))
+    {
+        return;
+    }
+
+    // The checkpoint file is mapped to memory so the checkpoint survives a crash of the process, it
+    // is flushed to the disk by the commit thread
+    m_checkpoint.store(sequence, std::memory_order_release);
+    std::memcpy(m_checkpointData + sizeof(s_checkpointMagic), &sequence, sizeof(sequence));
+}
+
+// -------------------------------------------------------------------------------------------------
+
+bool EventJournal::sync()
+{
+    QMutexLocker commitLocker(&m_commitMutex);
+
+    if (!m_open.load(std::memory_order_acquire))
+    {
+        qCWarning(s_loggingCategory) << "Journal is not open";
+        return false;
+    }
+
+    // A commit that is already running could have missed the latest events so the next one is
+    // waited for
+    const std::uint64_t commitCount = m_commitCount + (m_committing ? 2U : 1U);
+
+    while ((m_commitCount < commitCount) && m_open.load(std::memory_order_acquire))
+    {
+        m_commitPending = true;
+        m_commitRequested.wakeAll();
+        m_commitFinished.wait(&m_commitMutex);
+    }
+
+    return (m_commitCount >= commitCount);
+}
+
+// -------------------------------------------------------------------------------------------------
+
+bool EventJournal::replay(const std::uint64_t fromSequence,
+                          const Delegate<bool(std::uint64_t sequence, Event &&event)> &handler)
+    const
+{
+    QMutexLocker apiLocker(&m_apiMutex);
+
+    if (!m_open.load(std::memory_order_acquire))
+    {
+        qCWarning(s_loggingCategory) << "Journal is not open";
+        return false;
+    }
+
+    const std::uint64_t lastSequence = m_lastSequence.load(std::memory_order_acquire);
+
+    if (fromSequence > lastSequence)
+    {
+        return true;
+    }
+
+    // Find the segment with the first event
+    const auto segments = listSegments();
+    std::size_t index = segments.size();
+
+    for (std::size_t i = 0U; i < segments.size(); i++)
+    {
+        if (segments[i].firstSequence <= fromSequence)
+        {
+            index = i;
+        }
+    }
+
+    if (index == segments.size())
+    {
+        qCWarning(s_loggingCategory)
+                << "Event is no longer in the journal, sequence number:" << fromSequence;
+        return false;
+    }
+
+    // Read the events up to the last event (the events which are not needed are only checked)
+    std::uint64_t nextSequence = segments[index].firstSequence;
+
+    for (; (index < segments.size()) && (nextSequence <= lastSequence); index++)
+    {
+        if (segments[index].firstSequence != nextSequence)
+        {
+            break;
+        }
+
+        QFile file(segments[index].path);
+        uchar *data = nullptr;
+
+        if (file.open(QIODevice::ReadOnly))
+        {
+            data = file.map(0, file.size());
+        }
+
+        if (data == nullptr)
+        {
+            qCWarning(s_loggingCategory)
+                    << "Failed to read the journal segment:" << file.fileName();
+            return false;
+        }
+
+        SegmentEventReader reader(data, file.size());
+        std::uint64_t sequence = 0U;
+        Event event(InvalidEventId);
+
+        while ((nextSequence <= lastSequence) &&
+               reader.next(&sequence, (nextSequence >= fromSequence) ? (&event) : nullptr) &&
+               (sequence == nextSequence))
+        {
+            if ((sequence >= fromSequence) && (!handler(sequence, std::move(event))))
+            {
+                file.unmap(data);
+                return true;
+            }
+
+            nextSequence++;
+        }
+
+        file.unmap(data);
+
+        if (reader.failed())
+        {
+            return false;
+        }
+    }
+
+    if (nextSequence <= lastSequence)
+    {
+        qCWarning(s_loggingCategory)
+                << "Journal is incomplete, missing sequence number:" << nextSequence;
+        return false;
+    }
+
+    return true;
+}
+
+// -------------------------------------------------------------------------------------------------
+
+int EventJournal::removeProcessedSegments()
+{
+    QMutexLocker apiLocker(&m_apiMutex);
+
+    if (!m_open.load(std::memory_order_acquire))
+    {
+        qCWarning(s_loggingCategory) << "Journal is not open";
+        return -1;
+    }
+
+    // Segments which are still written or committed are kept
+    std::uint64_t firstUsedNumber = 0U;
+
+    {
+        QMutexLocker appendLocker(&m_appendMutex);
+
+        firstUsedNumber = m_segment->number;
+
+        for (const auto &segment : m_retiredSegments)
+        {
+            firstUsedNumber = std::min(firstUsedNumber, segment->number);
+        }
+    }
+
+    // Events must be both processed and committed (otherwise the checkpoint could be moved back
+    // after a crash of the operating system)
+    const std::uint64_t processedSequence =
+            std::min(m_checkpoint.load(std::memory_order_acquire),
+                     m_committedSequence.load(std::memory_order_acquire));
+
+    const auto segments = listSegments();
+    int removedCount = 0;
+
+    // All events of a segment are before the first event of the next segment
+    for (std::size_t i = 0U; (i + 1U) < segments.size(); i++)
+    {
+        if ((segments[i].number >= firstUsedNumber) ||
+            ((segments[i + 1U].firstSequence - 1U) > processedSequence))
+        {
+            break;
+        }
+
+        if (!QFile::remove(segments[i].path))
+        {
+            qCWarning(s_loggingCategory)
+                    << "Failed to remove the journal segment:" << segments[i].path;
+            break;
+        }
+
+        removedCount++;
+    }
+
+    qCDebug(s_loggingCategory) << "Removed processed journal segments:" << removedCount;
+    return removedCount;
+}
+
+// -------------------------------------------------------------------------------------------------
+
+std::vector<EventJournal::SegmentInfo> EventJournal::listSegments(QStringList *unusedPaths) const
+{
+    const QDir directory(m_directory);
+    const QStringList fileNames = directory.entryList(QStringList { QStringLiteral("*.segment") },
+                                                      QDir::Files,
+                                                      QDir::Name);
+    std::vector<SegmentInfo> segments;
+
+    for (const auto &fileName : fileNames)
+    {
+        QFile file(directory.filePath(fileName));
+
+        if (!file.open(QIODevice::ReadOnly))
+        {
+            qCWarning(s_loggingCategory) << "Failed to open the journal segment:" << fileName;
+            continue;
+        }
+
+        const QByteArray header = file.read(s_segmentHeaderSize);
+        SegmentInfo segmentInfo { file.fileName(), 0U, 0U };
+
+        if (!readSegmentHeader(header.constData(),
+                               header.size(),
+                               &segmentInfo.number,
+                               &segmentInfo.firstSequence))
+        {
+            if (unusedPaths != nullptr)
+            {
+                unusedPaths->append(file.fileName());
+            }
+
+            continue;
+        }
+
+        segments.push_back(segmentInfo);
+    }
+
+    std::sort(segments.begin(),
+              segments.end(),
+              [](const SegmentInfo &left, const SegmentInfo &right)
+    {
+        return (left.number < right.number);
+    });
+
+    return segments;
+}
+
+// -------------------------------------------------------------------------------------------------
+
+std::unique_ptr<EventJournal::Segment> EventJournal::createSegment(const std::uint64_t number) const
+{
+    auto segment = std::make_unique<Segment>();
+    segment->file = std::make_unique<QFile>(segmentFilePath(m_directory, number));
+    segment->number = number;
+
+    // The file is created with its full size so that it can be mapped only once
+    if ((!segment->file->open(QIODevice::ReadWrite | QIODevice::Truncate)) ||
+        (!segment->file->resize(m_segmentSize)))
+    {
+        qCWarning(s_loggingCategory)
+                << "Failed to create the journal segment:" << segment->file->fileName();
+        segment->file->remove();
+        return nullptr;
+    }
+
+    segment->data = segment->file->map(0, m_segmentSize);
+
+    if (segment->data == nullptr)
+    {
+        qCWarning(s_loggingCategory)
+                << "Failed to map the journal segment:" << segment->file->fileName();
+        segment->file->remove();
+        return nullptr;
+    }
+
+    return segment;
+}
+
+// -------------------------------------------------------------------------------------------------
+
+void EventJournal::closeSegment(Segment *segment, const bool remove) const
+{
+    if (segment->data != nullptr)
+    {
+        segment->file->unmap(segment->data);
+        segment->data = nullptr;
+    }
+
+    segment->file->close();
+
+    if (remove)
+    {
+        segment->file->remove();
+    }
+}
+
+// -------------------------------------------------------------------------------------------------
+
+bool EventJournal::startNextSegment()
+{
+    std::unique_ptr<Segment> segment = std::move(m_nextSegment);
+
+    if (!segment)
+    {
+        // The commit thread did not prepare the next segment in time
+        segment = createSegment(m_nextSegmentNumber++);
+
+        if (!segment)
+        {
+            return false;
+        }
+    }
+
+    // Write the header
+    const std::uint64_t firstSequence = m_lastSequence.load(std::memory_order_relaxed) + 1U;
+    QByteArray header;
+    BinaryWriter writer(&header);
+
+    writer.writeBytes(s_segmentMagic, static_cast<int>(sizeof(s_segmentMagic)));
+    writer.writeValue(s_segmentVersion);
+    writer.writeValue(static_cast<std::uint32_t>(s_segmentHeaderSize));
+    writer.writeValue(segment->number);
+    writer.writeValue(firstSequence);
+
+    std::memcpy(segment->data, header.constData(), static_cast<std::size_t>(header.size()));
+    segment->firstSequence = firstSequence;
+    segment->writeOffset = s_segmentHeaderSize;
+    segment->committedOffset = 0;
+
+    // The full segment is committed and closed by the commit thread
+    if (m_segment)
+    {
+        m_retiredSegments.push_back(std::move(m_segment));
+    }
+
+    m_segment = std::move(segment);
+    std::fill(m_segmentEventNames.begin(), m_segmentEventNames.end(), false);
+    m_segmentParameterTypes.clear();
+
+    requestCommit();
+
+    qCDebug(s_loggingCategory) << "Started journal segment:" << m_segment->file->fileName();
+    return true;
+}
+
+// -------------------------------------------------------------------------------------------------
+
+void EventJournal::writeRecord(const QByteArray &payload)
+{
+    uchar *record = m_segment->data + m_segment->writeOffset;
+    const auto size = static_cast<std::uint32_t>(payload.size());
+    const std::uint32_t checksum = recordChecksum(payload.constData(), size);
+
+    std::memcpy(record + sizeof(size), &checksum, sizeof(checksum));
+    std::memcpy(record + s_recordHeaderSize, payload.constData(), size);
+
+    // The size is written last so that an incomplete record is never seen as a valid one
+    std::atomic_signal_fence(std::memory_order_release);
+    std::memcpy(record, &size, sizeof(size));
+
+    m_segment->writeOffset += alignedRecordSize(size);
+}
+
+// -------------------------------------------------------------------------------------------------
+
+const EventParameterSerializer::Handler *EventJournal::parameterSerializer(
+        const IEventParameter &parameter)
+{
+    // The serializers are cached by the parameter's type ID as looking them up in the registry
+    // requires locking (parameters created in another module can have a different type ID)
+    const EventParameterTypeId typeId = parameter.typeId();
+
+    for (const auto &serializer : m_parameterSerializers)
+    {
+        if (serializer.first == typeId)
+        {
+            return serializer.second;
+        }
+    }
+
+    const auto *handler = EventParameterSerializer::handler(parameter);
+
+    if (handler != nullptr)
+    {
+        m_parameterSerializers.emplace_back(typeId, handler);
+    }
+
+    return handler;
+}
+
+// -------------------------------------------------------------------------------------------------
+
+std::uint16_t EventJournal::segmentParameterTypeIndex(
+        const EventParameterSerializer::Handler *handler)
+{
+    for (std::size_t i = 0U; i < m_segmentParameterTypes.size(); i++)
+    {
+        if (m_segmentParameterTypes[i] == handler)
+        {
+            return static_cast<std::uint16_t>(i);
+        }
+    }
+
+    const auto typeIndex = static_cast<std::uint16_t>(m_segmentParameterTypes.size());
+
+    m_tableBuffer.resize(0);
+    BinaryWriter tableWriter(&m_tableBuffer);
+
+    tableWriter.writeValue(static_cast<std::uint8_t>(RecordType::ParameterType));
+    tableWriter.writeValue(typeIndex);
+    tableWriter.writeString(handler->typeName);
+
+    writeRecord(m_tableBuffer);
+    m_segmentParameterTypes.push_back(handler);
+    return typeIndex;
+}
+
+// -------------------------------------------------------------------------------------------------
+
+void EventJournal::requestCommit()
+{
+    QMutexLocker commitLocker(&m_commitMutex);
+
+    m_commitPending = true;
+    m_commitRequested.wakeAll();
+}
+
+// -------------------------------------------------------------------------------------------------
+
+void EventJournal::runCommitThread()
+{
+    QMutexLocker commitLocker(&m_commitMutex);
+
+    while (!m_stopCommitThread)
+    {
+        if (!m_commitPending)
+        {
+            m_commitRequested.wait(&m_commitMutex, static_cast<unsigned long>(m_commitInterval));
+
+            if (m_stopCommitThread)
+            {
+                break;
+            }
+        }
+
+        m_commitPending = false;
+        m_committing = true;
+        commitLocker.unlock();
+
+        commit();
+        prepareNextSegment();
+
+        commitLocker.relock();
+        m_committing = false;
+        m_commitCount++;
+        m_commitFinished.wakeAll();
+    }
+}
+
+// -------------------------------------------------------------------------------------------------
+
+void EventJournal::commit()
+{
+    // Take the state of the appended records (the current segment is not destroyed while it is
+    // committed as only the commit thread destroys the retired segments)
+    std::vector<std::unique_ptr<Segment>> retiredSegments;
+    Segment *segment = nullptr;
+    qint64 writeOffset = 0;
+    std::uint64_t lastSequence = 0U;
+
+    {
+        QMutexLocker appendLocker(&m_appendMutex);
+
+        retiredSegments.swap(m_retiredSegments);
+        segment = m_segment.get();
+        writeOffset = (segment != nullptr) ? segment->writeOffset : 0;
+        lastSequence = m_lastSequence.load(std::memory_order_relaxed);
+        m_uncommittedSize = 0;
+    }
+
+    // Flush the events before the checkpoint so that the checkpoint is never ahead of them
+    bool success = true;
+
+    for (auto &retiredSegment : retiredSegments)
+    {
+        success = flushMappedData(retiredSegment->file.get(),
+                                  retiredSegment->data,
+                                  retiredSegment->committedOffset,
+                                  retiredSegment->writeOffset - retiredSegment->committedOffset) &&
+                  success;
+        closeSegment(retiredSegment.get(), false);
+    }
+
+    if (segment != nullptr)
+    {
+        success = flushMappedData(segment->file.get(),
+                                  segment->data,
+                                  segment->committedOffset,
+                                  writeOffset - segment->committedOffset) &&
+                  success;
+        segment->committedOffset = writeOffset;
+    }
+
+    success = flushMappedData(m_checkpointFile.get(), m_checkpointData, 0, s_checkpointFileSize) &&
+              success;
+
+    if (!success)
+    {
+        qCWarning(s_loggingCategory) << "Failed to commit the journal";
+        return;
+    }
+
+    m_committedSequence.store(lastSequence, std::memory_order_release);
+}
+
+// -------------------------------------------------------------------------------------------------
+
+void EventJournal::prepareNextSegment()
+{
+    std::uint64_t number = 0U;
+
+    {
+        QMutexLocker appendLocker(&m_appendMutex);
+
+        if (m_nextSegment || (!m_segment))
+        {
+            return;
+        }
+
+        number = m_nextSegmentNumber++;
+    }
+
+    // The file is created without blocking the producers (if it fails they create it themselves)
+    auto segment = createSegment(number);
+
+    if (!segment)
+    {
+        return;
+    }
+
+    QMutexLocker appendLocker(&m_appendMutex);
+
+    if ((!m_nextSegment) && m_segment && (m_segment->number < number))
+    {
+        m_nextSegment = std::move(segment);
+        return;
+    }
+
+    // The producers had to create the next segment in the meantime
+    appendLocker.unlock();
+    closeSegment(segment.get(), true);
+}
+
+} // namespace CppStateMachineFramework
@@ -0,0 +1,321 @@
+/* This file is part of C++ State Machine Framework.
+ *
+ * C++ State Machine Framework is free software: you can redistribute it and/or modify it under the
+ * terms of the GNU Lesser General Public License as published by the Free Software Foundation,
+ * either version 3 of the License, or (at your option) any later version.
+ *
+ * C++ State Machine Framework is distributed in the hope that it will be useful, but WITHOUT ANY
+ * WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR
+ * PURPOSE. See the GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License along with C++ State
+ * Machine Framework. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+/*!
+ * \file
+ *
+ * Contains a registry for interning event names
+ */
+
+// Own header
+#include <CppStateMachineFramework/EventNameRegistry.hpp>
+
+// C++ State Machine Framework includes
+#include <CppStateMachineFramework/HashFunctions.hpp>
+
+// Qt includes
+#include <QtCore/QLoggingCategory>
+#include <QtCore/QReadWriteLock>
+
+// System includes
+#include <atomic>
+#include <unordered_map>
+
+// Forward declarations
+
+// Macros
+
+// -------------------------------------------------------------------------------------------------
+
+//! Logging category for the event name registry
+static const QLoggingCategory s_loggingCategory("CppStateMachineFramework.EventNameRegistry",
+                                                QtWarningMsg);
+
+// -------------------------------------------------------------------------------------------------
+
+namespace CppStateMachineFramework
+{
+
+/*!
+ * Holds the registered event names
+ *
+ * Names are stored in chunks that never move once allocated. Chunk N holds (FirstChunkSize * 2^N)
+ * names so the number of chunks stays small even for a very large number of event names. This makes
+ * it possible to read a registered name without locking: a name is published by first storing it in
+ * its chunk and only then incrementing the (atomic) name count.
+ */
+class EventNameStorage
+{
+public:
+    //! Number of names in the first chunk
+    static constexpr std::uint32_t FirstChunkSize = 64U;
+
+    //! Maximum number of chunks
+    static constexpr int MaxChunkCount = 25;
+
+    //! Constructor
+    EventNameStorage()
+        : m_count(0U)
+    {
+        for (auto &chunk : m_chunks)
+        {
+            chunk.store(nullptr, std::memory_order_relaxed);
+        }
+    }
+
+    //! Destructor
+    ~EventNameStorage()
+    {
+        for (auto &chunk : m_chunks)
+        {
+            delete[] chunk.load(std::memory_order_relaxed);
+        }
+    }
+
+    //! Gets the storage instance
+    static EventNameStorage &instance()
+    {
+        static EventNameStorage storage;
+        return storage;
+    }
+
+    //! Gets the number of registered names
+    std::uint32_t count() const
+    {
+        return m_count.load(std::memory_order_acquire);
+    }
+
+    //! Gets the registered name for the specified (valid) ID
+    const QString &name(const EventId id) const
+    {
+        int chunk = 0;
+        std::uint32_t index = 0U;
+        locate(id, &chunk, &index);
+
+        return m_chunks[chunk].load(std::memory_order_acquire)[index];
+    }
+
+    //! Gets the ID of the registered name or InvalidEventId if the name is not registered
+    EventId find(const QString &name) const
+    {
+        QReadLocker locker(&m_lock);
+
+        auto it = m_ids.find(name);
+        return (it != m_ids.end()) ? it->second : InvalidEventId;
+    }
+
+    //! Registers the name (if needed) and returns its ID
+    EventId insert(const QString &name)
+    {
+        // Check if the name is already registered (common case)
+        const EventId existingId = find(name);
+
+        if (existingId != InvalidEventId)
+        {
+            return existingId;
+        }
+
+        // Register a new name
+        QWriteLocker locker(&m_lock);
+
+        auto it = m_ids.find(name);
+
+        if (it != m_ids.end())
+        {
+            // Name was registered in the meantime
+            return it->second;
+        }
+
+        const std::uint32_t currentCount = m_count.load(std::memory_order_relaxed);
+        const EventId id = currentCount + 1U;
+
+        int chunk = 0;
+        std::uint32_t index = 0U;
+        locate(id, &chunk, &index);
+
+        if (chunk >= MaxChunkCount)
+        {
+            qCWarning(s_loggingCategory) << "Maximum number of event names reached:" << name;
+            return InvalidEventId;
+        }
+
+        QString *chunkData = m_chunks[chunk].load(std::memory_order_relaxed);
+
+        if (chunkData == nullptr)
+        {
+            chunkData = new QString[FirstChunkSize << chunk];
+            m_chunks[chunk].store(chunkData, std::memory_order_release);
+        }
+
+        chunkData[index] = name;
+        m_ids[name] = id;
+        m_count.store(id, std::memory_order_release);
+
+        qCDebug(s_loggingCategory) << "Registered event name:" << name << "ID:" << id;
+        return id;
+    }
+
+private:
+    //! Calculates the chunk and the index inside of the chunk for the specified (valid) ID
+    static void locate(const EventId id, int *chunk, std::uint32_t *index)
+    {
+        const std::uint32_t position = id - 1U;
+        std::uint32_t chunkIndex = 0U;
+        std::uint32_t chunkStart = 0U;
+        std::uint32_t chunkSize = FirstChunkSize;
+
+        while ((position - chunkStart) >= chunkSize)
+        {
+            chunkStart += chunkSize;
+            chunkSize <<= 1U;
+            chunkIndex++;
+        }
+
+        *chunk = static_cast<int>(chunkIndex);
+        *index = position - chunkStart;
+    }
+
+private:
+    //! Holds the lock for the name lookup table
+    mutable QReadWriteLock m_lock;
+
+    //! Holds the name lookup table
+    std::unordered_map<QString, EventId> m_ids;
+
+    //! Holds the chunks with the registered names
+    std::atomic<QString *> m_chunks[MaxChunkCount];
+
+    //! Holds the number of registered names
+    std::atomic<std::uint32_t> m_count;
+};
+
+// -------------------------------------------------------------------------------------------------
+
+/*!
+ * Holds a per-thread cache of the looked up event names
+ *
+ * The cache is direct-mapped by the hash of the name so its size is bounded. A registered name
+ * keeps its ID forever so a cached ID stays valid. A name that was not registered is cached
+ * together with the number of registered names at the time of the lookup and it is only valid until
+ * another name gets registered.
+ */
+class EventNameCache
+{
+public:
+    //! Number of cached names (a power of two)
+    static constexpr std::size_t Size = 128U;
+
+    //! Gets the cache of the current thread
+    static EventNameCache &instance()
+    {
+        static thread_local EventNameCache cache;
+        return cache;
+    }
+
+    //! Gets the ID of the name (InvalidEventId if the name is not registered)
+    EventId find(const QString &name)
+    {
+        EventNameStorage &storage = EventNameStorage::instance();
+        Entry &entry = m_entries[std::hash<QString>()(name) & (Size - 1U)];
+
+        // Names are never empty so an empty entry does not match any name
+        if ((entry.name == name) &&
+            ((entry.id != InvalidEventId) || (entry.count == storage.count())))
+        {
+            return entry.id;
+        }
+
+        // The count is read before the lookup so that a name registered in the meantime is looked
+        // up again
+        const std::uint32_t count = storage.count();
+        const EventId id = storage.find(name);
+
+        entry.name = name;
+        entry.id = id;
+        entry.count = count;
+        return id;
+    }
+
+private:
+    //! Holds a cached name
+    struct Entry
+    {
+        //! Holds the name
+        QString name;
+
+        //! Holds the ID of the name (InvalidEventId if the name is not registered)
+        EventId id = InvalidEventId;
+
+        //! Holds the number of registered names at the time of the lookup
+        std::uint32_t count = 0U;
+    };
+
+private:
+    //! Holds the cached names
+    Entry m_entries[Size];
+};
+
+// -------------------------------------------------------------------------------------------------
+
+EventId EventNameRegistry::registerName(const QString &name)
+{
+    if (name.isEmpty())
+    {
+        return InvalidEventId;
+    }
+
+    return EventNameStorage::instance().insert(name);
+}
+
+// -------------------------------------------------------------------------------------------------
+
+EventId EventNameRegistry::id(const QString &name)
+{
+    if (name.isEmpty())
+    {
+        return InvalidEventId;
+    }
+
+    return EventNameCache::instance().find(name);
+}
+
+// -------------------------------------------------------------------------------------------------
+
+const QString &EventNameRegistry::name(const EventId id)
+{
+    static const QString s_emptyName;
+
+    if (!isRegistered(id))
+    {
+        return s_emptyName;
+    }
+
+    return EventNameStorage::instance().name(id);
+}
+
+// -------------------------------------------------------------------------------------------------
+
+bool EventNameRegistry::isRegistered(const EventId id)
+{
+    return ((id != InvalidEventId) && (id <= EventNameStorage::instance().count()));
+}
+
+// -------------------------------------------------------------------------------------------------
+
+std::uint32_t EventNameRegistry::count()
+{
+    return EventNameStorage::instance().count();
+}
+
+} // namespace CppStateMachineFramework
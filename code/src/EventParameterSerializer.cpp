@@ -0,0 +1,212 @@
+/* This file is part of C++ State Machine Framework.
+ *
+ * C++ State Machine Framework is free software: you can redistribute it and/or modify it under the
+ * terms of the GNU Lesser General Public License as published by the Free Software Foundation,
+ * either version 3 of the License, or (at your option) any later version.
+ *
+ * C++ State Machine Framework is distributed in the hope that it will be useful, but WITHOUT ANY
+ * WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR
+ * PURPOSE. See the GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License along with C++ State
+ * Machine Framework. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+/*!
+ * \file
+ *
+ * Contains the binary serialization of the events and their parameters
+ */
+
+// Own header
+#include <CppStateMachineFramework/EventParameterSerializer.hpp>
+
+// C++ State Machine Framework includes
+#include <CppStateMachineFramework/HashFunctions.hpp>
+
+// Qt includes
+#include <QtCore/QLoggingCategory>
+#include <QtCore/QReadWriteLock>
+
+// System includes
+#include <memory>
+#include <unordered_map>
+#include <vector>
+
+// Forward declarations
+
+// Macros
+
+// -------------------------------------------------------------------------------------------------
+
+//! Logging category for the event parameter serializer
+static const QLoggingCategory s_loggingCategory(
+        "CppStateMachineFramework.EventParameterSerializer", QtWarningMsg);
+
+// -------------------------------------------------------------------------------------------------
+
+namespace CppStateMachineFramework
+{
+
+/*!
+ * Holds the registered serializers
+ *
+ * The serializers are never removed so the pointers to them stay valid for the lifetime of the
+ * process.
+ */
+class EventParameterSerializerStorage
+{
+public:
+    //! Gets the storage instance
+    static EventParameterSerializerStorage &instance()
+    {
+        static EventParameterSerializerStorage storage;
+        return storage;
+    }
+
+    //! Gets the serializer of the type ID
+    const EventParameterSerializer::Handler *find(const EventParameterTypeId typeId) const
+    {
+        QReadLocker locker(&m_lock);
+
+        auto it = m_typeIds.find(typeId);
+        return (it != m_typeIds.end()) ? it->second : nullptr;
+    }
+
+    //! Gets the serializer of the event parameter's type
+    const EventParameterSerializer::Handler *find(const IEventParameter &parameter) const
+    {
+        QReadLocker locker(&m_lock);
+
+        auto it = m_typeIds.find(parameter.typeId());
+
+        if (it != m_typeIds.end())
+        {
+            return it->second;
+        }
+
+        for (const auto &handler : m_handlers)
+        {
+            if (handler->isType(parameter))
+            {
+                return handler.get();
+            }
+        }
+
+        return nullptr;
+    }
+
+    //! Gets the serializer of the type name
+    const EventParameterSerializer::Handler *find(const QString &typeName) const
+    {
+        QReadLocker locker(&m_lock);
+
+        auto it = m_typeNames.find(typeName);
+        return (it != m_typeNames.end()) ? it->second : nullptr;
+    }
+
+    //! Registers the serializer
+    bool insert(EventParameterSerializer::Handler &&handler)
+    {
+        QWriteLocker locker(&m_lock);
+
+        if ((m_typeIds.find(handler.typeId) != m_typeIds.end()) ||
+            (m_typeNames.find(handler.typeName) != m_typeNames.end()))
+        {
+            qCWarning(s_loggingCategory)
+                    << "Event parameter type is already registered:" << handler.typeName;
+            return false;
+        }
+
+        m_handlers.push_back(
+                    std::make_unique<EventParameterSerializer::Handler>(std::move(handler)));
+        const auto *registeredHandler = m_handlers.back().get();
+
+        m_typeIds[registeredHandler->typeId] = registeredHandler;
+        m_typeNames[registeredHandler->typeName] = registeredHandler;
+
+        qCDebug(s_loggingCategory)
+                << "Registered event parameter type:" << registeredHandler->typeName;
+        return true;
+    }
+
+private:
+    //! Holds the lock for the lookup tables
+    mutable QReadWriteLock m_lock;
+
+    //! Holds the registered serializers
+    std::vector<std::unique_ptr<EventParameterSerializer::Handler>> m_handlers;
+
+    //! Holds the serializers indexed by the type ID
+    std::unordered_map<EventParameterTypeId, const EventParameterSerializer::Handler *> m_typeIds;
+
+    //! Holds the serializers indexed by the type name
+    std::unordered_map<QString, const EventParameterSerializer::Handler *> m_typeNames;
+};
+
+// -------------------------------------------------------------------------------------------------
+
+void BinaryWriter::writeString(const QString &value)
+{
+    const QByteArray utf8 = value.toUtf8();
+
+    writeValue(static_cast<std::uint32_t>(utf8.size()));
+    writeBytes(utf8.constData(), utf8.size());
+}
+
+// -------------------------------------------------------------------------------------------------
+
+bool BinaryReader::readString(QString *value)
+{
+    const char *start = m_position;
+    std::uint32_t size = 0U;
+
+    if ((!readValue(&size)) || (size > remaining()))
+    {
+        m_position = start;
+        return false;
+    }
+
+    *value = QString::fromUtf8(m_position, static_cast<int>(size));
+    m_position += size;
+    return true;
+}
+
+// -------------------------------------------------------------------------------------------------
+
+const EventParameterSerializer::Handler *EventParameterSerializer::handler(
+        const EventParameterTypeId typeId)
+{
+    return EventParameterSerializerStorage::instance().find(typeId);
+}
+
+// -------------------------------------------------------------------------------------------------
+
+const EventParameterSerializer::Handler *EventParameterSerializer::handler(
+        const IEventParameter &parameter)
+{
+    return EventParameterSerializerStorage::instance().find(parameter);
+}
+
+// -------------------------------------------------------------------------------------------------
+
+const EventParameterSerializer::Handler *EventParameterSerializer::handlerByTypeName(
+        const QString &typeName)
+{
+    return EventParameterSerializerStorage::instance().find(typeName);
+}
+
+// -------------------------------------------------------------------------------------------------
+
+bool EventParameterSerializer::registerHandler(Handler &&handler)
+{
+    if (handler.typeName.isEmpty())
+    {
+        qCWarning(s_loggingCategory) << "Event parameter type name is empty";
+        return false;
+    }
+
+    return EventParameterSerializerStorage::instance().insert(std::move(handler));
+}
+
+} // namespace CppStateMachineFramework
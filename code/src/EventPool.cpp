@@ -0,0 +1,256 @@
+/* This file is part of C++ State Machine Framework.
+ *
+ * C++ State Machine Framework is free software: you can redistribute it and/or modify it under the
+ * terms of the GNU Lesser General Public License as published by the Free Software Foundation,
+ * either version 3 of the License, or (at your option) any later version.
+ *
+ * C++ State Machine Framework is distributed in the hope that it will be useful, but WITHOUT ANY
+ * WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR
+ * PURPOSE. See the GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License along with C++ State
+ * Machine Framework. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+/*!
+ * \file
+ *
+ * Contains a pool of memory blocks used for storing queued events
+ */
+
+// Own header
+#include <CppStateMachineFramework/EventPool.hpp>
+
+// C++ State Machine Framework includes
+
+// Qt includes
+
+// System includes
+
+// Forward declarations
+
+// Macros
+
+// -------------------------------------------------------------------------------------------------
+
+/*!
+ * Gets the number of cells needed for the capacity
+ *
+ * \param   capacity    Pool capacity
+ *
+ * \return  Smallest power of two that is not smaller than the capacity (or zero)
+ */
+static std::size_t cellCount(const int capacity)
+{
+    if (capacity <= 0)
+    {
+        return 0U;
+    }
+
+    std::size_t count = 1U;
+
+    while (count < static_cast<std::size_t>(capacity))
+    {
+        count *= 2U;
+    }
+
+    return count;
+}
+
+// -------------------------------------------------------------------------------------------------
+
+namespace CppStateMachineFramework
+{
+
+EventPool::EventPool(const std::size_t blockSize, const int capacity)
+    : m_blockSize(blockSize),
+      m_cellCount(cellCount(capacity)),
+      m_cells(std::make_unique<Cell[]>(m_cellCount)),
+      m_pushPosition(0U),
+      m_popPosition(0U),
+      m_hits(0U),
+      m_misses(0U),
+      m_allocatedCount(0),
+      m_highWaterMark(0)
+{
+    for (std::size_t i = 0U; i < m_cellCount; i++)
+    {
+        m_cells[i].sequence.store(i, std::memory_order_relaxed);
+        m_cells[i].block = nullptr;
+    }
+}
+
+// -------------------------------------------------------------------------------------------------
+
+EventPool::~EventPool()
+{
+    void *block = nullptr;
+
+    while (pop(&block))
+    {
+        ::operator delete(block);
+    }
+}
+
+// -------------------------------------------------------------------------------------------------
+
+std::size_t EventPool::blockSize() const
+{
+    return m_blockSize;
+}
+
+// -------------------------------------------------------------------------------------------------
+
+int EventPool::capacity() const
+{
+    return static_cast<int>(m_cellCount);
+}
+
+// -------------------------------------------------------------------------------------------------
+
+void *EventPool::allocate()
+{
+    // Update the statistics
+    const auto allocatedCount = m_allocatedCount.fetch_add(1, std::memory_order_relaxed) + 1;
+    auto highWaterMark = m_highWaterMark.load(std::memory_order_relaxed);
+
+    while ((allocatedCount > highWaterMark) &&
+           (!m_highWaterMark.compare_exchange_weak(highWaterMark,
+                                                   allocatedCount,
+                                                   std::memory_order_relaxed)))
+    {
+    }
+
+    // Take a free block from the pool if possible
+    void *block = nullptr;
+
+    if (pop(&block))
+    {
+        m_hits.fetch_add(1U, std::memory_order_relaxed);
+        return block;
+    }
+
+    m_misses.fetch_add(1U, std::memory_order_relaxed);
+    return ::operator new(m_blockSize);
+}
+
+// -------------------------------------------------------------------------------------------------
+
+void EventPool::release(void *block)
+{
+    if (block == nullptr)
+    {
+        return;
+    }
+
+    m_allocatedCount.fetch_sub(1, std::memory_order_relaxed);
+
+    if (!push(block))
+    {
+        ::operator delete(block);
+    }
+}
+
+// -------------------------------------------------------------------------------------------------
+
+EventPool::Statistics EventPool::statistics() const
+{
+    Statistics statistics;
+    statistics.hits = m_hits.load(std::memory_order_relaxed);
+    statistics.misses = m_misses.load(std::memory_order_relaxed);
+    statistics.highWaterMark = m_highWaterMark.load(std::memory_order_relaxed);
+
+    return statistics;
+}
+
+// -------------------------------------------------------------------------------------------------
+
+bool EventPool::push(void *block)
+{
+    if (m_cellCount == 0U)
+    {
+        return false;
+    }
+
+    // Reserve a cell (a cell is free if its sequence number matches the position)
+    Cell *cell = nullptr;
+    std::size_t position = m_pushPosition.load(std::memory_order_relaxed);
+
+    while (true)
+    {
+        cell = &m_cells[position & (m_cellCount - 1U)];
+        const std::size_t sequence = cell->sequence.load(std::memory_order_acquire);
+        const auto difference = static_cast<std::ptrdiff_t>(sequence - position);
+
+        if (difference == 0)
+        {
+            if (m_pushPosition.compare_exchange_weak(position,
+                                                     position + 1U,
+                                                     std::memory_order_relaxed))
+            {
+                break;
+            }
+        }
+        else if (difference < 0)
+        {
+            // Pool is full
+            return false;
+        }
+        else
+        {
+            position = m_pushPosition.load(std::memory_order_relaxed);
+        }
+    }
+
+    // Store the block and publish the cell to the consumers
+    cell->block = block;
+    cell->sequence.store(position + 1U, std::memory_order_release);
+    return true;
+}
+
+// -------------------------------------------------------------------------------------------------
+
+bool EventPool::pop(void **block)
+{
+    if (m_cellCount == 0U)
+    {
+        return false;
+    }
+
+    // Reserve a cell (a cell is filled if its sequence number is one ahead of the position)
+    Cell *cell = nullptr;
+    std::size_t position = m_popPosition.load(std::memory_order_relaxed);
+
+    while (true)
+    {
+        cell = &m_cells[position & (m_cellCount - 1U)];
+        const std::size_t sequence = cell->sequence.load(std::memory_order_acquire);
+        const auto difference = static_cast<std::ptrdiff_t>(sequence - (position + 1U));
+
+        if (difference == 0)
+        {
+            if (m_popPosition.compare_exchange_weak(position,
+                                                    position + 1U,
+                                                    std::memory_order_relaxed))
+            {
+                break;
+            }
+        }
+        else if (difference < 0)
+        {
+            // Pool is empty
+            return false;
+        }
+        else
+        {
+            position = m_popPosition.load(std::memory_order_relaxed);
+        }
+    }
+
+    // Take the block and make the cell available to the producers for the next round
+    *block = cell->block;
+    cell->sequence.store(position + m_cellCount, std::memory_order_release);
+    return true;
+}
+
+} // namespace CppStateMachineFramework
@@ -0,0 +1,267 @@
+/* This file is part of C++ State Machine Framework.
+ *
+ * C++ State Machine Framework is free software: you can redistribute it and/or modify it under the
+ * terms of the GNU Lesser General Public License as published by the Free Software Foundation,
+ * either version 3 of the License, or (at your option) any later version.
+ *
+ * C++ State Machine Framework is distributed in the hope that it will be useful, but WITHOUT ANY
+ * WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR
+ * PURPOSE. See the GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License along with C++ State
+ * Machine Framework. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+/*!
+ * \file
+ *
+ * Contains a double-ended event queue stored in a ring buffer
+ */
+
+// Own header
+#include <CppStateMachineFramework/EventRingBuffer.hpp>
+
+// C++ State Machine Framework includes
+
+// Qt includes
+
+// System includes
+
+// Forward declarations
+
+// Macros
+
+// -------------------------------------------------------------------------------------------------
+
+//! Minimum capacity of the buffer
+static const std::size_t s_minimumCapacity = 16U;
+
+// -------------------------------------------------------------------------------------------------
+
+namespace CppStateMachineFramework
+{
+
+EventRingBuffer::EventRingBuffer()
+    : m_head(0U),
+      m_size(0U)
+{
+}
+
+// -------------------------------------------------------------------------------------------------
+
+EventRingBuffer::EventRingBuffer(EventRingBuffer &&other) noexcept
+    : m_buffer(std::move(other.m_buffer)),
+      m_head(other.m_head),
+      m_size(other.m_size)
+{
+    other.m_buffer.clear();
+    other.m_head = 0U;
+    other.m_size = 0U;
+}
+
+// -------------------------------------------------------------------------------------------------
+
+EventRingBuffer &EventRingBuffer::operator=(EventRingBuffer &&other) noexcept
+{
+    if (this != (&other))
+    {
+        m_buffer = std::move(other.m_buffer);
+        m_head = other.m_head;
+        m_size = other.m_size;
+
+        other.m_buffer.clear();
+        other.m_head = 0U;
+        other.m_size = 0U;
+    }
+
+    return *this;
+}
+
+// -------------------------------------------------------------------------------------------------
+
+bool EventRingBuffer::isEmpty() const
+{
+    return (m_size == 0U);
+}
+
+// -------------------------------------------------------------------------------------------------
+
+std::size_t EventRingBuffer::size() const
+{
+    return m_size;
+}
+
+// -------------------------------------------------------------------------------------------------
+
+std::size_t EventRingBuffer::capacity() const
+{
+    return m_buffer.size();
+}
+
+// -------------------------------------------------------------------------------------------------
+
+void EventRingBuffer::reserve(const std::size_t capacity)
+{
+    if (capacity <= m_buffer.size())
+    {
+        return;
+    }
+
+    std::size_t newCapacity = s_minimumCapacity;
+
+    while (newCapacity < capacity)
+    {
+        newCapacity *= 2U;
+    }
+
+    // Move the events to the new buffer so that the front of the queue is at its beginning
+    std::vector<Event> buffer;
+    buffer.reserve(newCapacity);
+
+    for (std::size_t i = 0U; i < m_size; i++)
+    {
+        buffer.push_back(std::move(slot(i)));
+    }
+
+    while (buffer.size() < newCapacity)
+    {
+        buffer.emplace_back(InvalidEventId);
+    }
+
+    m_buffer = std::move(buffer);
+    m_head = 0U;
+}
+
+// -------------------------------------------------------------------------------------------------
+
+Event &EventRingBuffer::front()
+{
+    return m_buffer[m_head];
+}
+
+// -------------------------------------------------------------------------------------------------
+
+Event &EventRingBuffer::operator[](const std::size_t index)
+{
+    return slot(index);
+}
+
+// -------------------------------------------------------------------------------------------------
+
+void EventRingBuffer::pushFront(Event &&event)
+{
+    growIfFull();
+
+    m_head = (m_head - 1U) & (m_buffer.size() - 1U);
+    m_buffer[m_head] = std::move(event);
+    m_size++;
+}
+
+// -------------------------------------------------------------------------------------------------
+
+void EventRingBuffer::pushBack(Event &&event)
+{
+    growIfFull();
+
+    slot(m_size) = std::move(event);
+    m_size++;
+}
+
+// -------------------------------------------------------------------------------------------------
+
+void EventRingBuffer::popFront(const std::size_t count)
+{
+    // The removed events are replaced so that their parameters are destroyed immediately
+    for (std::size_t i = 0U; i < count; i++)
+    {
+        slot(i) = Event(InvalidEventId);
+    }
+
+    m_head = (m_head + count) & (m_buffer.size() - 1U);
+    m_size -= count;
+
+    if (m_size == 0U)
+    {
+        m_head = 0U;
+    }
+}
+
+// -------------------------------------------------------------------------------------------------
+
+void EventRingBuffer::popBack(const std::size_t count)
+{
+    for (std::size_t i = m_size - count; i < m_size; i++)
+    {
+        slot(i) = Event(InvalidEventId);
+    }
+
+    m_size -= count;
+}
+
+// -------------------------------------------------------------------------------------------------
+
+void EventRingBuffer::insert(const std::size_t index, EventRingBuffer &other)
+{
+    const std::size_t count = other.m_size;
+
+    if (count == 0U)
+    {
+        return;
+    }
+
+    reserve(m_size + count);
+
+    if (index < (m_size - index))
+    {
+        // Make room for the events by moving the head and the events before the position towards
+        // the front (nothing is moved when the events are inserted at the front)
+        m_head = (m_head - count) & (m_buffer.size() - 1U);
+
+        for (std::size_t i = 0U; i < index; i++)
+        {
+            slot(i) = std::move(slot(i + count));
+        }
+    }
+    else
+    {
+        // Make room for the events by moving the events after the position towards the back
+        for (std::size_t i = m_size; i > index; i--)
+        {
+            slot(i - 1U + count) = std::move(slot(i - 1U));
+        }
+    }
+
+    for (std::size_t i = 0U; i < count; i++)
+    {
+        slot(index + i) = std::move(other.slot(i));
+    }
+
+    m_size += count;
+    other.clear();
+}
+
+// -------------------------------------------------------------------------------------------------
+
+void EventRingBuffer::clear()
+{
+    popFront(m_size);
+}
+
+// -------------------------------------------------------------------------------------------------
+
+Event &EventRingBuffer::slot(const std::size_t index)
+{
+    return m_buffer[(m_head + index) & (m_buffer.size() - 1U)];
+}
+
+// -------------------------------------------------------------------------------------------------
+
+void EventRingBuffer::growIfFull()
+{
+    if (m_size == m_buffer.size())
+    {
+        reserve(m_size + 1U);
+    }
+}
+
+} // namespace CppStateMachineFramework
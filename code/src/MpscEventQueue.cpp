@@ -0,0 +1,130 @@
+/* This file is part of C++ State Machine Framework.
+ *
+ * C++ State Machine Framework is free software: you can redistribute it and/or modify it under the
+ * terms of the GNU Lesser General Public License as published by the Free Software Foundation,
+ * either version 3 of the License, or (at your option) any later version.
+ *
+ * C++ State Machine Framework is distributed in the hope that it will be useful, but WITHOUT ANY
+ * WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR
+ * PURPOSE. See the GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License along with C++ State
+ * Machine Framework. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+/*!
+ * \file
+ *
+ * Contains a lock-free multi-producer single-consumer event queue
+ */
+
+// Own header
+#include <CppStateMachineFramework/MpscEventQueue.hpp>
+
+// C++ State Machine Framework includes
+
+// Qt includes
+
+// System includes
+
+// Forward declarations
+
+// Macros
+
+// -------------------------------------------------------------------------------------------------
+
+namespace CppStateMachineFramework
+{
+
+constexpr int MpscEventQueue::DefaultPoolCapacity;
+
+// -------------------------------------------------------------------------------------------------
+
+MpscEventQueue::MpscEventQueue(const int poolCapacity)
+    : m_nodePool(sizeof(Node), poolCapacity),
+      m_head(nullptr),
+      m_tail(nullptr)
+{
+    // The queue always contains a node before the first event (its event is never used)
+    m_tail = createNode(Event(InvalidEventId));
+    m_head.store(m_tail, std::memory_order_relaxed);
+}
+
+// -------------------------------------------------------------------------------------------------
+
+MpscEventQueue::~MpscEventQueue()
+{
+    clear();
+    destroyNode(m_tail);
+}
+
+// -------------------------------------------------------------------------------------------------
+
+bool MpscEventQueue::isEmpty() const
+{
+    return (m_tail->next.load(std::memory_order_acquire) == nullptr);
+}
+
+// -------------------------------------------------------------------------------------------------
+
+void MpscEventQueue::push(Event &&event)
+{
+    Node *node = createNode(std::move(event));
+
+    // Append the node and link it to the previously added node
+    Node *previous = m_head.exchange(node, std::memory_order_acq_rel);
+    previous->next.store(node, std::memory_order_release);
+}
+
+// -------------------------------------------------------------------------------------------------
+
+bool MpscEventQueue::takeNext(Event *event)
+{
+    Node *next = m_tail->next.load(std::memory_order_acquire);
+
+    if (next == nullptr)
+    {
+        return false;
+    }
+
+    // The node with the taken event becomes the node before the next event
+    *event = std::move(next->event);
+    destroyNode(m_tail);
+    m_tail = next;
+    return true;
+}
+
+// -------------------------------------------------------------------------------------------------
+
+void MpscEventQueue::clear()
+{
+    Event event(InvalidEventId);
+
+    while (takeNext(&event))
+    {
+    }
+}
+
+// -------------------------------------------------------------------------------------------------
+
+EventPool::Statistics MpscEventQueue::poolStatistics() const
+{
+    return m_nodePool.statistics();
+}
+
+// -------------------------------------------------------------------------------------------------
+
+MpscEventQueue::Node *MpscEventQueue::createNode(Event &&event)
+{
+    return new (m_nodePool.allocate()) Node(std::move(event));
+}
+
+// -------------------------------------------------------------------------------------------------
+
+void MpscEventQueue::destroyNode(Node *node)
+{
+    node->~Node();
+    m_nodePool.release(node);
+}
+
+} // namespace CppStateMachineFramework
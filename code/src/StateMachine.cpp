@@ -44,21 +44,16 @@ namespace CppStateMachineFramework
 {
 
 StateMachine::StateMachine()
-    : m_validationStatus(ValidationStatus::Unvalidated),
-      m_started(false)
+    : m_definition(std::make_shared<StateMachineDefinition>()),
+      m_instance(m_definition)
 {
 }
 
 // -------------------------------------------------------------------------------------------------
 
 StateMachine::StateMachine(StateMachine &&other) noexcept
-    : m_states(std::move(other.m_states)),
-      m_initialTransition(std::move(other.m_initialTransition)),
-      m_validationStatus(other.m_validationStatus),
-      m_started(other.m_started),
-      m_currentState(std::move(other.m_currentState)),
-      m_eventQueue(std::move(other.m_eventQueue)),
-      m_finalEvent(std::move(other.m_finalEvent))
+    : m_definition(std::move(other.m_definition)),
+      m_instance(std::move(other.m_instance))
 {
 }
 
@@ -68,13 +63,8 @@ StateMachine &StateMachine::operator=(StateMachine &&other) noexcept
 {
     if (this != (&other))
     {
-        m_states = std::move(other.m_states);
-        m_initialTransition = std::move(other.m_initialTransition);
-        m_validationStatus = other.m_validationStatus;
-        m_started = other.m_started;
-        m_currentState = std::move(other.m_currentState);
-        m_eventQueue = std::move(other.m_eventQueue);
-        m_finalEvent = std::move(other.m_finalEvent);
+        m_definition = std::move(other.m_definition);
+        m_instance = std::move(other.m_instance);
     }
 
     return *this;
@@ -84,16 +74,21 @@ StateMachine &StateMachine::operator=(StateMachine &&other) noexcept
 
 StateMachine::ValidationStatus StateMachine::validationStatus() const
 {
-    QMutexLocker locker(&m_apiMutex);
+    QMutexLocker locker(apiMutex());
+
+    if (!m_definition)
+    {
+        return ValidationStatus::Unvalidated;
+    }
 
-    return m_validationStatus;
+    return m_definition->validationStatus();
 }
 
 // -------------------------------------------------------------------------------------------------
 
 bool StateMachine::validate()
 {
-    QMutexLocker locker(&m_apiMutex);
+    QMutexLocker locker(apiMutex());
 
     qCDebug(s_loggingCategory) << "Validating the state machine...";
 
@@ -104,699 +99,479 @@ bool StateMachine::validate()
         return false;
     }
 
-    // Check if the state machine has at least one state
-    if (m_states.empty())
-    {
-        qCWarning(s_loggingCategory) << "State machine has no states";
-        m_validationStatus = ValidationStatus::Invalid;
-        return false;
-    }
+    return definition().validate();
+}
 
-    // Check if initial transition is set
-    if (m_initialTransition.state.isEmpty())
-    {
-        qCWarning(s_loggingCategory) << "State machine has no initial transition";
-        m_validationStatus = ValidationStatus::Invalid;
-        return false;
-    }
+// -------------------------------------------------------------------------------------------------
 
-    // Validate final states
-    QSet<QString> availableStates;
+StateMachine::EventQueueMode StateMachine::eventQueueMode() const
+{
+    return m_instance.eventQueueMode();
+}
 
-    for (const auto &m_state : m_states)
-    {
-        const QString &stateName = m_state.first;
-        const StateData &stateData = m_state.second;
-        availableStates.insert(stateName);
-
-        if (isFinalState(stateData))
-        {
-            // This is a final state, check if it has a state or an exit action
-            if (stateData.stateAction)
-            {
-                qCWarning(s_loggingCategory)
-                        << "A final state cannot have a state action:" << stateName;
-                m_validationStatus = ValidationStatus::Invalid;
-                return false;
-            }
-
-            if (stateData.exitAction)
-            {
-                qCWarning(s_loggingCategory)
-                        << "A final state cannot have an exit action:" << stateName;
-                m_validationStatus = ValidationStatus::Invalid;
-                return false;
-            }
-        }
-    }
+// -------------------------------------------------------------------------------------------------
 
-    // Check if all of the states can be reached from the initial state
-    QSet<QString> statesReached;
-    traverseStates(m_initialTransition.state, &statesReached);
+bool StateMachine::setEventQueueMode(const EventQueueMode mode)
+{
+    return m_instance.setEventQueueMode(mode);
+}
 
-    if (statesReached != availableStates)
-    {
-        qCWarning(s_loggingCategory)
-                << "The following states cannot be reached:" << (availableStates - statesReached);
-        m_validationStatus = ValidationStatus::Invalid;
-        return false;
-    }
+// -------------------------------------------------------------------------------------------------
 
-    // Validation successful
-    m_validationStatus = ValidationStatus::Valid;
-    qCDebug(s_loggingCategory) << "State machine validated successfully";
-    return true;
+StateMachine::ExecutionMode StateMachine::executionMode() const
+{
+    return m_instance.executionMode();
 }
 
 // -------------------------------------------------------------------------------------------------
 
-bool StateMachine::isStarted()
+bool StateMachine::setExecutionMode(const ExecutionMode mode)
 {
-    QMutexLocker locker(&m_startedMutex);
+    QMutexLocker locker(&m_apiMutex);
 
-    return m_started;
+    return m_instance.setExecutionMode(mode);
 }
 
 // -------------------------------------------------------------------------------------------------
 
-bool StateMachine::start(Event &&event)
+StateMachineInstance &StateMachine::instance()
 {
-    QMutexLocker apiLocker(&m_apiMutex);
+    return m_instance;
+}
 
-    qCDebug(s_loggingCategory) << "Starting the state machine...";
+// -------------------------------------------------------------------------------------------------
 
-    // Check if the event is valid
-    if (event.name().isEmpty())
-    {
-        qCWarning(s_loggingCategory) << "Attempted to add an event with an empty name";
-        return false;
-    }
+int StateMachine::pollBatchSize() const
+{
+    return m_instance.pollBatchSize();
+}
 
-    // State machine can be started only if it is stopped and valid
-    QMutexLocker startedLocker(&m_startedMutex);
+// -------------------------------------------------------------------------------------------------
 
-    if (m_started)
-    {
-        qCWarning(s_loggingCategory) << "State machine is already started";
-        return false;
-    }
+bool StateMachine::setPollBatchSize(const int batchSize)
+{
+    return m_instance.setPollBatchSize(batchSize);
+}
 
-    if (m_validationStatus != ValidationStatus::Valid)
-    {
-        qCWarning(s_loggingCategory) << "State machine can be started only if it is valid";
-        return false;
-    }
+// -------------------------------------------------------------------------------------------------
 
-    // Execute initial transition
-    QMutexLocker eventQueueLocker(&m_eventQueueMutex);
+int StateMachine::eventPoolCapacity() const
+{
+    return m_instance.eventPoolCapacity();
+}
 
-    m_eventQueue.clear();
-    m_currentState.clear();
-    m_finalEvent.reset();
-    m_started = true;
+// -------------------------------------------------------------------------------------------------
 
-    qCDebug(s_loggingCategory) << "State machine started";
+bool StateMachine::setEventPoolCapacity(const int capacity)
+{
+    return m_instance.setEventPoolCapacity(capacity);
+}
 
-    eventQueueLocker.unlock();
-    startedLocker.unlock();
+// -------------------------------------------------------------------------------------------------
 
-    executeInitialTransition(std::move(event));
-    return true;
+EventPool::Statistics StateMachine::eventPoolStatistics() const
+{
+    return m_instance.eventPoolStatistics();
 }
 
 // -------------------------------------------------------------------------------------------------
 
-bool StateMachine::stop()
+int StateMachine::waitSpinCount() const
 {
-    QMutexLocker locker(&m_apiMutex);
-
-    return stopInternal();
+    return m_instance.waitSpinCount();
 }
 
 // -------------------------------------------------------------------------------------------------
 
-QString StateMachine::currentState() const
+bool StateMachine::setWaitSpinCount(const int spinCount)
 {
-    QMutexLocker locker(&m_apiMutex);
-
-    return m_currentState;
+    return m_instance.setWaitSpinCount(spinCount);
 }
 
 // -------------------------------------------------------------------------------------------------
 
-bool StateMachine::finalStateReached() const
+std::shared_ptr<TimerWheel> StateMachine::timerWheel() const
 {
-    QMutexLocker locker(&m_apiMutex);
-
-    // Check if the the state is set to a valid state
-    auto it = m_states.find(m_currentState);
+    return m_instance.timerWheel();
+}
 
-    if (it == m_states.end())
-    {
-        // This should not be possible as the current state cannot be changed externally and it
-        // should always store the name of an existing state
-        qCWarning(s_loggingCategory) << "Current state is invalid!";
-        return false;
-    }
+// -------------------------------------------------------------------------------------------------
 
-    // Check if the state is a final state (no transitions)
-    return isFinalState(it->second);
+bool StateMachine::setTimerWheel(std::shared_ptr<TimerWheel> timerWheel)
+{
+    return m_instance.setTimerWheel(std::move(timerWheel));
 }
 
 // -------------------------------------------------------------------------------------------------
 
-bool StateMachine::hasFinalEvent() const
+int StateMachine::eventQueueCapacity() const
 {
-    return (m_finalEvent != nullptr);
+    return m_instance.eventQueueCapacity();
 }
 
 // -------------------------------------------------------------------------------------------------
 
-std::unique_ptr<Event> StateMachine::takeFinalEvent()
+bool StateMachine::setEventQueueCapacity(const int capacity)
 {
-    QMutexLocker locker(&m_apiMutex);
-
-    return std::move(m_finalEvent);
+    return m_instance.setEventQueueCapacity(capacity);
 }
 
 // -------------------------------------------------------------------------------------------------
 
-bool StateMachine::hasPendingEvents() const
+StateMachine::BackpressurePolicy StateMachine::backpressurePolicy() const
 {
-    QMutexLocker locker(&m_eventQueueMutex);
-
-    return (!m_eventQueue.empty());
+    return m_instance.backpressurePolicy();
 }
 
 // -------------------------------------------------------------------------------------------------
 
-bool StateMachine::addEventToFront(Event &&event)
+int StateMachine::backpressureTimeout() const
 {
-    QMutexLocker eventQueueLocker(&m_eventQueueMutex);
-    QMutexLocker startedLocker(&m_startedMutex);
-
-    // Check if the event is valid
-    if (event.name().isEmpty())
-    {
-        qCWarning(s_loggingCategory) << "Attempted to add an event with an empty name";
-        return false;
-    }
+    return m_instance.backpressureTimeout();
+}
 
-    // Check if the state machine is started
-    if (!m_started)
-    {
-        qCWarning(s_loggingCategory)
-                << "Cannot add an event to a stopped state machine:" << event.name();
-        return false;
-    }
+// -------------------------------------------------------------------------------------------------
 
-    qCDebug(s_loggingCategory) << "Added event to the front of the event queue:" << event.name();
-    m_eventQueue.push_front(std::move(event));
-    return true;
+bool StateMachine::setBackpressurePolicy(const BackpressurePolicy policy, const int timeout)
+{
+    return m_instance.setBackpressurePolicy(policy, timeout);
 }
 
 // -------------------------------------------------------------------------------------------------
 
-bool StateMachine::addEventToBack(Event &&event)
+StateMachine::BackpressureStatistics StateMachine::backpressureStatistics() const
 {
-    QMutexLocker eventQueueLocker(&m_eventQueueMutex);
-    QMutexLocker startedLocker(&m_startedMutex);
+    return m_instance.backpressureStatistics();
+}
 
-    // Check if the event is valid
-    if (event.name().isEmpty())
-    {
-        qCWarning(s_loggingCategory) << "Attempted to add an event with an empty name";
-        return false;
-    }
+// -------------------------------------------------------------------------------------------------
 
-    // Check if the state machine is started
-    if (!m_started)
-    {
-        qCWarning(s_loggingCategory)
-                << "Cannot add an event to a stopped state machine:" << event.name();
-        return false;
-    }
+bool StateMachine::metricsEnabled() const
+{
+    return m_instance.metricsEnabled();
+}
 
-    qCDebug(s_loggingCategory) << "Added event to the back of the event queue:" << event.name();
-    m_eventQueue.push_back(std::move(event));
-    return true;
+// -------------------------------------------------------------------------------------------------
+
+bool StateMachine::setMetricsEnabled(const bool enabled)
+{
+    return m_instance.setMetricsEnabled(enabled);
 }
 
 // -------------------------------------------------------------------------------------------------
 
-bool StateMachine::processNextEvent()
+StateMachineMetrics::Snapshot StateMachine::metrics() const
 {
-    QMutexLocker apiLocker(&m_apiMutex);
+    return m_instance.metrics();
+}
 
-    qCDebug(s_loggingCategory) << "Processing next event...";
+// -------------------------------------------------------------------------------------------------
 
-    // Check if the state machine is started
-    if (!isStarted())
-    {
-        qCWarning(s_loggingCategory) << "State machine is not started";
-        return false;
-    }
+void StateMachine::resetMetrics()
+{
+    m_instance.resetMetrics();
+}
 
-    // Check if there are any pending events to process
-    QMutexLocker eventQueuelocker(&m_eventQueueMutex);
+// -------------------------------------------------------------------------------------------------
 
-    if (m_eventQueue.empty())
-    {
-        qCWarning(s_loggingCategory) << "No pending events to process!";
-        return false;
-    }
+std::shared_ptr<IStateMachineObserver> StateMachine::observer() const
+{
+    return m_instance.observer();
+}
 
-    // Take the next pending event
-    auto event = std::move(m_eventQueue.front());
-    m_eventQueue.pop_front();
-    qCDebug(s_loggingCategory) << "Processing event:" << event.name();
+// -------------------------------------------------------------------------------------------------
 
-    eventQueuelocker.unlock();
+bool StateMachine::setObserver(std::shared_ptr<IStateMachineObserver> observer)
+{
+    return m_instance.setObserver(std::move(observer));
+}
 
-    if (!processEvent(std::move(event)))
-    {
-        // This should not be possible as the current state should always be valid
-        qCWarning(s_loggingCategory) << "Failed to process event!";
-        return false;
-    }
+// -------------------------------------------------------------------------------------------------
 
-    return true;
+std::uint64_t StateMachine::traceMachineId() const
+{
+    return m_instance.traceMachineId();
 }
 
 // -------------------------------------------------------------------------------------------------
 
-bool StateMachine::poll()
+bool StateMachine::setTraceMachineId(const std::uint64_t machineId)
 {
-    QMutexLocker apiLocker(&m_apiMutex);
+    return m_instance.setTraceMachineId(machineId);
+}
 
-    qCDebug(s_loggingCategory) << "Polling...";
+// -------------------------------------------------------------------------------------------------
 
-    // Check if the state machine is started
-    if (!isStarted())
-    {
-        qCWarning(s_loggingCategory) << "State machine is not started";
-        return false;
-    }
+std::shared_ptr<EventJournal> StateMachine::journal() const
+{
+    return m_instance.journal();
+}
 
-    // Check if there are any pending events to process
-    QMutexLocker eventQueueLocker(&m_eventQueueMutex);
+// -------------------------------------------------------------------------------------------------
 
-    while (!m_eventQueue.empty())
-    {
-        // Take the next pending event
-        auto event = std::move(m_eventQueue.front());
-        m_eventQueue.pop_front();
-        qCDebug(s_loggingCategory) << "Processing event:" << event.name();
-
-        eventQueueLocker.unlock();
-
-        // Process the event
-        if (!processEvent(std::move(event)))
-        {
-            // This should not be possible as the current state should always be valid
-            qCWarning(s_loggingCategory) << "Failed to process event!";
-            return false;
-        }
-
-        // Re-lock the event queue so that it's state can be queried again
-        eventQueueLocker.relock();
-    }
+bool StateMachine::setJournal(std::shared_ptr<EventJournal> journal)
+{
+    return m_instance.setJournal(std::move(journal));
+}
 
-    eventQueueLocker.unlock();
+// -------------------------------------------------------------------------------------------------
 
-    // Get current state's data
-    auto itState = m_states.find(m_currentState);
+QByteArray StateMachine::snapshot()
+{
+    return m_instance.snapshot();
+}
 
-    if (itState == m_states.end())
-    {
-        // This should not be possible as the current state cannot be changed externally and it
-        // should always store the name of an existing state
-        qCWarning(s_loggingCategory) << "Current state is invalid!";
-        return false;
-    }
+// -------------------------------------------------------------------------------------------------
 
-    const auto &stateData = itState->second;
+bool StateMachine::restore(const QByteArray &snapshot)
+{
+    return m_instance.restore(snapshot);
+}
 
-    // Execute current state's state action
-    if (stateData.stateAction)
-    {
-        qCDebug(s_loggingCategory) << "Executing state's state action...";
-        stateData.stateAction(m_currentState);
-        qCDebug(s_loggingCategory) << "State's state action executed";
-    }
+// -------------------------------------------------------------------------------------------------
 
-    qCDebug(s_loggingCategory) << "Polling finished";
-    return true;
+StateMachine::CoalescingPolicy StateMachine::eventCoalescingPolicy(
+        const QString &eventName) const
+{
+    return m_instance.eventCoalescingPolicy(eventName);
 }
 
 // -------------------------------------------------------------------------------------------------
 
-bool StateMachine::addState(const QString &stateName)
+bool StateMachine::setEventCoalescingPolicy(const QString &eventName,
+                                            const CoalescingPolicy policy)
 {
-    QMutexLocker locker(&m_apiMutex);
+    return m_instance.setEventCoalescingPolicy(eventName, policy);
+}
 
-    // Check if a state is allowed to be added at this time
-    if (isStarted())
-    {
-        qCWarning(s_loggingCategory)
-                << "States can be added to the state machine only when it is stopped";
-        return false;
-    }
+// -------------------------------------------------------------------------------------------------
 
-    // Check if the state name is valid or duplicate
-    if (stateName.isEmpty())
-    {
-        qCWarning(s_loggingCategory) << "State name cannot be empty!";
-        return false;
-    }
+bool StateMachine::isStarted()
+{
+    return m_instance.isStarted();
+}
 
-    if (m_states.find(stateName) != m_states.end())
-    {
-        qCWarning(s_loggingCategory) << "A state with the same name already exists:" << stateName;
-        return false;
-    }
+// -------------------------------------------------------------------------------------------------
 
-    // Add state
-    m_states[stateName] = {};
-    m_validationStatus = ValidationStatus::Unvalidated;
+bool StateMachine::start(Event &&event)
+{
+    QMutexLocker locker(apiMutex());
 
-    qCDebug(s_loggingCategory) << "Added a new state:" << stateName;
-    return true;
+    return m_instance.start(std::move(event));
 }
 
 // -------------------------------------------------------------------------------------------------
 
-bool StateMachine::setStateEntryAction(const QString &stateName, StateEntryAction entryAction)
+bool StateMachine::stop()
 {
-    QMutexLocker locker(&m_apiMutex);
+    return m_instance.stop();
+}
 
-    // Check if a state's entry action is allowed to be set at this time
-    if (isStarted())
-    {
-        qCWarning(s_loggingCategory)
-                << "State's entry action can be set only when the state machine is stopped";
-        return false;
-    }
+// -------------------------------------------------------------------------------------------------
 
-    // Check if the action is empty
-    if (!entryAction)
-    {
-        qCWarning(s_loggingCategory) << "Invalid state's entry action:" << stateName;
-        return false;
-    }
+QString StateMachine::currentState() const
+{
+    return m_instance.currentState();
+}
 
-    // Check if the state name is valid
-    auto itState = m_states.find(stateName);
+// -------------------------------------------------------------------------------------------------
 
-    if (itState == m_states.end())
-    {
-        qCWarning(s_loggingCategory) << "State does not exist:" << stateName;
-        return false;
-    }
+bool StateMachine::finalStateReached() const
+{
+    return m_instance.finalStateReached();
+}
 
-    // Check if state's entry action already exists
-    auto &stateData = itState->second;
+// -------------------------------------------------------------------------------------------------
 
-    if (stateData.entryAction)
-    {
-        qCWarning(s_loggingCategory) << "The state's entry action is already set:" << stateName;
-        return false;
-    }
+bool StateMachine::hasFinalEvent() const
+{
+    return m_instance.hasFinalEvent();
+}
 
-    // Set state's entry action
-    stateData.entryAction = std::move(entryAction);
-    m_validationStatus = ValidationStatus::Unvalidated;
+// -------------------------------------------------------------------------------------------------
 
-    qCDebug(s_loggingCategory) << "Set the state's entry action:" << stateName;
-    return true;
+std::unique_ptr<Event> StateMachine::takeFinalEvent()
+{
+    return m_instance.takeFinalEvent();
 }
 
 // -------------------------------------------------------------------------------------------------
 
-bool StateMachine::setStateAction(const QString &stateName, StateAction stateAction)
+bool StateMachine::hasPendingEvents() const
 {
-    QMutexLocker locker(&m_apiMutex);
+    return m_instance.hasPendingEvents();
+}
 
-    // Check if a state's state action is allowed to be set at this time
-    if (isStarted())
-    {
-        qCWarning(s_loggingCategory)
-                << "State's state action can be set only when the state machine is stopped";
-        return false;
-    }
+// -------------------------------------------------------------------------------------------------
 
-    // Check if the action is empty
-    if (!stateAction)
-    {
-        qCWarning(s_loggingCategory) << "Invalid state's state action:" << stateName;
-        return false;
-    }
+bool StateMachine::addEventToFront(Event &&event)
+{
+    return m_instance.addEventToFront(std::move(event));
+}
 
-    // Check if the state name is valid
-    auto itState = m_states.find(stateName);
+// -------------------------------------------------------------------------------------------------
 
-    if (itState == m_states.end())
-    {
-        qCWarning(s_loggingCategory) << "State does not exist:" << stateName;
-        return false;
-    }
+bool StateMachine::addEventToBack(Event &&event)
+{
+    return m_instance.addEventToBack(std::move(event));
+}
 
-    // Check if state's state action already exists
-    auto &stateData = itState->second;
+// -------------------------------------------------------------------------------------------------
 
-    if (stateData.stateAction)
-    {
-        qCWarning(s_loggingCategory) << "The state's state action is already set:" << stateName;
-        return false;
-    }
+bool StateMachine::addEvent(Event &&event, const int priority)
+{
+    return m_instance.addEvent(std::move(event), priority);
+}
 
-    // Set state's state action
-    stateData.stateAction = std::move(stateAction);
-    m_validationStatus = ValidationStatus::Unvalidated;
+// -------------------------------------------------------------------------------------------------
 
-    qCDebug(s_loggingCategory) << "Set the state's state action:" << stateName;
-    return true;
+TimerId StateMachine::addEventAfter(const int delay, Event &&event, const int priority)
+{
+    return m_instance.addEventAfter(delay, std::move(event), priority);
 }
 
 // -------------------------------------------------------------------------------------------------
 
-bool StateMachine::setStateExitAction(const QString &stateName, StateExitAction exitAction)
+TimerId StateMachine::addStateEventAfter(const int delay, Event &&event, const int priority)
 {
-    QMutexLocker locker(&m_apiMutex);
+    return m_instance.addStateEventAfter(delay, std::move(event), priority);
+}
 
-    // Check if a state's exit action is allowed to be set at this time
-    if (isStarted())
-    {
-        qCWarning(s_loggingCategory)
-                << "State's exit action can be set only when the state machine is stopped";
-        return false;
-    }
+// -------------------------------------------------------------------------------------------------
 
-    // Check if the action is empty
-    if (!exitAction)
-    {
-        qCWarning(s_loggingCategory) << "Invalid state's exit action:" << stateName;
-        return false;
-    }
+bool StateMachine::cancelDelayedEvent(const TimerId timerId)
+{
+    return m_instance.cancelDelayedEvent(timerId);
+}
 
-    // Check if the state name is valid
-    auto itState = m_states.find(stateName);
+// -------------------------------------------------------------------------------------------------
 
-    if (itState == m_states.end())
-    {
-        qCWarning(s_loggingCategory) << "State does not exist:" << stateName;
-        return false;
-    }
+bool StateMachine::processNextEvent()
+{
+    return m_instance.processNextEvent();
+}
 
-    // Check if state's exit action already exists
-    auto &stateData = itState->second;
+// -------------------------------------------------------------------------------------------------
 
-    if (stateData.exitAction)
-    {
-        qCWarning(s_loggingCategory) << "The state's exit action is already set:" << stateName;
-        return false;
-    }
+bool StateMachine::poll()
+{
+    return m_instance.poll();
+}
 
-    // Set state's exit action
-    stateData.exitAction = std::move(exitAction);
-    m_validationStatus = ValidationStatus::Unvalidated;
+// -------------------------------------------------------------------------------------------------
 
-    qCDebug(s_loggingCategory) << "Set the state's exit action:" << stateName;
-    return true;
+bool StateMachine::waitForEvents(const int timeout)
+{
+    return m_instance.waitForEvents(timeout);
 }
 
 // -------------------------------------------------------------------------------------------------
 
-QString StateMachine::initialState() const
+bool StateMachine::runUntilStopped()
 {
-    QMutexLocker locker(&m_apiMutex);
-
-    return m_initialTransition.state;
+    return m_instance.runUntilStopped();
 }
 
 // -------------------------------------------------------------------------------------------------
 
-bool StateMachine::setInitialTransition(const QString &initialState, InitialTransitionAction action)
+bool StateMachine::addState(const QString &stateName)
 {
-    QMutexLocker locker(&m_apiMutex);
-
-    // Check if the initial state is already set
-    if (!m_initialTransition.state.isEmpty())
-    {
-        qCWarning(s_loggingCategory) << "Initial state is already set:"
-                                     << m_initialTransition.state;
-        return false;
-    }
+    QMutexLocker locker(apiMutex());
 
-    // Check if state exists
-    if (m_states.find(initialState) == m_states.end())
+    // Check if a state is allowed to be added at this time
+    if (isStarted())
     {
         qCWarning(s_loggingCategory)
-                << "Only existing states can be set as the initial state:" << initialState;
+                << "States can be added to the state machine only when it is stopped";
         return false;
     }
 
-    // Set initial state
-    m_initialTransition.state = initialState;
-    m_initialTransition.action = std::move(action);
-    m_validationStatus = ValidationStatus::Unvalidated;
-
-    qCDebug(s_loggingCategory) << "Set the initial state:" << initialState;
-    return true;
+    return definition().addState(stateName);
 }
 
 // -------------------------------------------------------------------------------------------------
 
-bool StateMachine::addStateTransition(const QString &fromState,
-                                      const QString &trigger,
-                                      const QString &toState,
-                                      StateTransitionAction action,
-                                      StateTransitionGuardCondition guard)
+bool StateMachine::setStateEntryAction(const QString &stateName, StateEntryAction entryAction)
 {
-    QMutexLocker locker(&m_apiMutex);
+    QMutexLocker locker(apiMutex());
 
-    // Check if a transition is allowed to be added at this time
+    // Check if a state's entry action is allowed to be set at this time
     if (isStarted())
     {
         qCWarning(s_loggingCategory)
-                << "Transitions can be added to the state machine only when it is stopped";
-        return false;
-    }
-
-    // Check if the state and event names are valid
-    auto itFromState = m_states.find(fromState);
-
-    if (itFromState == m_states.end())
-    {
-        qCWarning(s_loggingCategory) << "State to transition from does not exist:" << fromState;
+                << "State's entry action can be set only when the state machine is stopped";
         return false;
     }
 
-    if (trigger.isEmpty())
-    {
-        qCWarning(s_loggingCategory)
-                << "Name of the event that triggers the transition cannot be empty";
-        return false;
-    }
+    return definition().setStateEntryAction(stateName, std::move(entryAction));
+}
 
-    if (m_states.find(toState) == m_states.end())
-    {
-        qCWarning(s_loggingCategory) << "State to transition to does not exist:" << toState;
-        return false;
-    }
+// -------------------------------------------------------------------------------------------------
 
-    // Check if transition already exists
-    auto &stateData = itFromState->second;
+bool StateMachine::setStateAction(const QString &stateName, StateAction stateAction)
+{
+    QMutexLocker locker(apiMutex());
 
-    if ((stateData.stateTransitions.find(trigger) != stateData.stateTransitions.end()) ||
-        (stateData.internalTransitions.find(trigger) != stateData.internalTransitions.end()))
+    // Check if a state's state action is allowed to be set at this time
+    if (isStarted())
     {
         qCWarning(s_loggingCategory)
-                << QString("Transition from state [%1] with event [%2] already exists")
-                   .arg(fromState, trigger);
+                << "State's state action can be set only when the state machine is stopped";
         return false;
     }
 
-    // Add transition
-    stateData.stateTransitions[trigger] = { toState, std::move(guard), std::move(action) };
-    m_validationStatus = ValidationStatus::Unvalidated;
-
-    qCDebug(s_loggingCategory)
-            << QString("Added a state transition from state [%1] with event [%2] to state [%3]")
-               .arg(fromState, trigger, toState);
-    return true;
+    return definition().setStateAction(stateName, std::move(stateAction));
 }
 
 // -------------------------------------------------------------------------------------------------
 
-bool StateMachine::addInternalTransition(const QString &state,
-                                         const QString &trigger,
-                                         InternalTransitionAction action,
-                                         InternalTransitionGuardCondition guard)
+bool StateMachine::setStateExitAction(const QString &stateName, StateExitAction exitAction)
 {
-    QMutexLocker locker(&m_apiMutex);
+    QMutexLocker locker(apiMutex());
 
-    // Check if a transition is allowed to be added at this time
+    // Check if a state's exit action is allowed to be set at this time
     if (isStarted())
     {
         qCWarning(s_loggingCategory)
-                << "Transitions can be added to the state machine only when it is stopped";
+                << "State's exit action can be set only when the state machine is stopped";
         return false;
     }
 
-    // Check if the state and event names are valid
-    auto itState = m_states.find(state);
+    return definition().setStateExitAction(stateName, std::move(exitAction));
+}
 
-    if (itState == m_states.end())
-    {
-        qCWarning(s_loggingCategory) << "State of the internal transition does not exist:" << state;
-        return false;
-    }
+// -------------------------------------------------------------------------------------------------
 
-    if (trigger.isEmpty())
-    {
-        qCWarning(s_loggingCategory)
-                << "Name of the event that triggers the transition cannot be empty";
-        return false;
-    }
+QString StateMachine::initialState() const
+{
+    QMutexLocker locker(apiMutex());
 
-    // Check if transition has an action
-    if (!action)
+    if (!m_definition)
     {
-        qCWarning(s_loggingCategory) << "Internal transition does not have an action:" << state;
-        return false;
+        return {};
     }
 
-    // Check if transition already exists
-    auto &stateData = itState->second;
+    return m_definition->initialState();
+}
 
-    if ((stateData.stateTransitions.find(trigger) != stateData.stateTransitions.end()) ||
-        (stateData.internalTransitions.find(trigger) != stateData.internalTransitions.end()))
-    {
-        qCWarning(s_loggingCategory)
-                << QString("Transition from state [%1] with event [%2] already exists")
-                   .arg(state, trigger);
-        return false;
-    }
+// -------------------------------------------------------------------------------------------------
 
-    // Add transition
-    stateData.internalTransitions[trigger] = { std::move(guard), std::move(action) };
-    m_validationStatus = ValidationStatus::Unvalidated;
+bool StateMachine::setInitialTransition(const QString &initialState, InitialTransitionAction action)
+{
+    QMutexLocker locker(apiMutex());
 
-    qCDebug(s_loggingCategory)
-            << QString("Added an internal transition to state [%1] with event [%2]")
-               .arg(state, trigger);
-    return true;
+    return definition().setInitialTransition(initialState, std::move(action));
 }
 
 // -------------------------------------------------------------------------------------------------
 
-bool StateMachine::setDefaultTransition(const QString &fromState,
-                                        const QString &toState,
-                                        StateTransitionAction action,
-                                        StateTransitionGuardCondition guard)
+bool StateMachine::addStateTransition(const QString &fromState,
+                                      const QString &trigger,
+                                      const QString &toState,
+                                      StateTransitionAction action,
+                                      StateTransitionGuardCondition guard)
 {
-    QMutexLocker locker(&m_apiMutex);
+    QMutexLocker locker(apiMutex());
 
     // Check if a transition is allowed to be added at this time
     if (isStarted())
@@ -806,50 +581,18 @@ bool StateMachine::setDefaultTransition(const QString &fromState,
         return false;
     }
 
-    // Check if the state names are valid
-    auto itFromState = m_states.find(fromState);
-
-    if (itFromState == m_states.end())
-    {
-        qCWarning(s_loggingCategory) << "State to transition from does not exist:" << fromState;
-        return false;
-    }
-
-    if (m_states.find(toState) == m_states.end())
-    {
-        qCWarning(s_loggingCategory) << "State to transition to does not exist:" << toState;
-        return false;
-    }
-
-    // Check if a default transition already exists
-    auto &stateData = itFromState->second;
-
-    if (stateData.defaultStateTransition || stateData.defaultInternalTransition)
-    {
-        qCWarning(s_loggingCategory)
-                << QString("A default transition for state [%1] already exists").arg(fromState);
-        return false;
-    }
-
-    // Set default transition
-    stateData.defaultStateTransition =
-            std::make_unique<StateTransitionData>(
-                StateTransitionData { toState, std::move(guard), std::move(action) });
-    m_validationStatus = ValidationStatus::Unvalidated;
-
-    qCDebug(s_loggingCategory)
-            << QString("Set a default state transition from state [%1] to state [%2]")
-               .arg(fromState, toState);
-    return true;
+    return definition().addStateTransition(
+                fromState, trigger, toState, std::move(action), std::move(guard));
 }
 
 // -------------------------------------------------------------------------------------------------
 
-bool StateMachine::setDefaultTransition(const QString &state,
-                                        InternalTransitionAction action,
-                                        InternalTransitionGuardCondition guard)
+bool StateMachine::addInternalTransition(const QString &state,
+                                         const QString &trigger,
+                                         InternalTransitionAction action,
+                                         InternalTransitionGuardCondition guard)
 {
-    QMutexLocker locker(&m_apiMutex);
+    QMutexLocker locker(apiMutex());
 
     // Check if a transition is allowed to be added at this time
     if (isStarted())
@@ -859,335 +602,68 @@ bool StateMachine::setDefaultTransition(const QString &state,
         return false;
     }
 
-    // Check if the state name is valid
-    auto itState = m_states.find(state);
-
-    if (itState == m_states.end())
-    {
-        qCWarning(s_loggingCategory) << "State of the internal transition does not exist:" << state;
-        return false;
-    }
-
-    // Check if transition has an action
-    if (!action)
-    {
-        qCWarning(s_loggingCategory) << "Internal transition does not have an action:" << state;
-        return false;
-    }
-
-    // Check if a default transition already exists
-    auto &stateData = itState->second;
-
-    if (stateData.defaultStateTransition || stateData.defaultInternalTransition)
-    {
-        qCWarning(s_loggingCategory)
-                << QString("A default transition for state [%1] already exists").arg(state);
-        return false;
-    }
-
-    // Set default transition
-    stateData.defaultInternalTransition =
-            std::make_unique<InternalTransitionData>(
-                InternalTransitionData { std::move(guard), std::move(action) });
-    m_validationStatus = ValidationStatus::Unvalidated;
-
-    qCDebug(s_loggingCategory)
-            << QString("Set a default internal transition for state [%1]").arg(state);
-    return true;
+    return definition().addInternalTransition(
+                state, trigger, std::move(action), std::move(guard));
 }
 
 // -------------------------------------------------------------------------------------------------
 
-bool StateMachine::stopInternal()
+bool StateMachine::setDefaultTransition(const QString &fromState,
+                                        const QString &toState,
+                                        StateTransitionAction action,
+                                        StateTransitionGuardCondition guard)
 {
-    QMutexLocker locker(&m_startedMutex);
+    QMutexLocker locker(apiMutex());
 
-    qCDebug(s_loggingCategory) << "Stopping the state machine...";
-
-    // Check if the state machine can be started
-    if (!m_started)
+    // Check if a transition is allowed to be added at this time
+    if (isStarted())
     {
-        qCWarning(s_loggingCategory) << "State machine is already stopped";
+        qCWarning(s_loggingCategory)
+                << "Transitions can be added to the state machine only when it is stopped";
         return false;
     }
 
-    // Stop the state machine
-    qCDebug(s_loggingCategory) << "Current state:" << m_currentState;
-
-    m_started = false;
-    qCDebug(s_loggingCategory) << "State machine stopped";
-    return true;
+    return definition().setDefaultTransition(
+                fromState, toState, std::move(action), std::move(guard));
 }
 
 // -------------------------------------------------------------------------------------------------
 
-bool StateMachine::processEvent(Event &&event)
+bool StateMachine::setDefaultTransition(const QString &state,
+                                        InternalTransitionAction action,
+                                        InternalTransitionGuardCondition guard)
 {
-    // Get current state's data
-    auto itState = m_states.find(m_currentState);
+    QMutexLocker locker(apiMutex());
 
-    if (itState == m_states.end())
+    // Check if a transition is allowed to be added at this time
+    if (isStarted())
     {
-        // This should not be possible as the current state cannot be changed externally and it
-        // should always store the name of an existing state
-        qCWarning(s_loggingCategory) << "Current state is invalid!";
+        qCWarning(s_loggingCategory)
+                << "Transitions can be added to the state machine only when it is stopped";
         return false;
     }
 
-    const auto &stateData = itState->second;
-
-    // Check if a transition needs to be executed
-    if (!stateData.internalTransitions.empty())
-    {
-        // Check if an internal transition needs to be triggered
-        auto itTransition = stateData.internalTransitions.find(event.name());
-
-        if (itTransition != stateData.internalTransitions.end())
-        {
-            // Execute internal transition
-            executeInternalTransition(itTransition->second, event);
-
-            qCDebug(s_loggingCategory) << "Event processed";
-            return true;
-        }
-    }
-
-    if (!stateData.stateTransitions.empty())
-    {
-        // Check if a state transition needs to be triggered
-        auto itTransition = stateData.stateTransitions.find(event.name());
-
-        if (itTransition != stateData.stateTransitions.end())
-        {
-            // Execute state transition
-            executeStateTransition(itTransition->second, std::move(event));
-
-            qCDebug(s_loggingCategory) << "Event processed";
-            return true;
-        }
-    }
-
-    if (stateData.defaultInternalTransition)
-    {
-        // Execute default internal transition
-        executeInternalTransition(*stateData.defaultInternalTransition, event);
-
-        qCDebug(s_loggingCategory) << "Event processed";
-        return true;
-    }
-
-    if (stateData.defaultStateTransition)
-    {
-        // Execute default state transition
-        executeStateTransition(*stateData.defaultStateTransition, std::move(event));
-
-        qCDebug(s_loggingCategory) << "Event processed";
-        return true;
-    }
-
-    qCDebug(s_loggingCategory) << "No transitions for this event, ignore it:" << event.name();
-    qCDebug(s_loggingCategory) << "Event processed";
-    return true;
-}
-
-// -------------------------------------------------------------------------------------------------
-
-void StateMachine::traverseStates(const QString &stateName, QSet<QString> *statesReached) const
-{
-    // Record that the specified state was reached
-    statesReached->insert(stateName);
-
-    // Traverse all the states that can be transitioned to from the specified state
-    auto it = m_states.find(stateName);
-
-    if (it == m_states.end())
-    {
-        // This should not be possible as the method will always be passed an existing state's name
-        qCWarning(s_loggingCategory) << "State name is invalid!";
-        return;
-    }
-
-    const auto &stateData = it->second;
-
-    for (const auto &item : stateData.stateTransitions)
-    {
-        // Check if the transition needs to be processed
-        const auto &transitionData = item.second;
-
-        if (statesReached->contains(transitionData.state))
-        {
-            // State to transition to was already reached, skip the transition
-            continue;
-        }
-
-        // Traverse state from the transition
-        traverseStates(transitionData.state, statesReached);
-    }
-}
-
-// -------------------------------------------------------------------------------------------------
-
-bool StateMachine::isFinalState(const StateData &stateData) const
-{
-    return (stateData.stateTransitions.empty() &&
-            stateData.internalTransitions.empty() &&
-            (!stateData.defaultStateTransition) &&
-            (!stateData.defaultInternalTransition));
-}
-
-// -------------------------------------------------------------------------------------------------
-
-void StateMachine::executeInitialTransition(Event &&event)
-{
-    qCDebug(s_loggingCategory)
-            << QString("Transitioning to initial state [%1] with event [%2]...")
-               .arg(m_initialTransition.state, event.name());
-
-    // Execute transition's action
-    if (m_initialTransition.action)
-    {
-        qCDebug(s_loggingCategory) << "Executing initial transition's action...";
-        m_initialTransition.action(event, m_initialTransition.state);
-        qCDebug(s_loggingCategory) << "Initial transition's action executed";
-    }
-
-    // Execute the entry action of the initial state
-    auto it = m_states.find(m_initialTransition.state);
-
-    if (it == m_states.end())
-    {
-        // This should not be possible as the initial state cannot be changed after it is set and it
-        // should always store the name of an existing state
-        qCWarning(s_loggingCategory) << "Initial state is invalid!";
-        return;
-    }
-
-    auto &stateData = it->second;
-
-    if (stateData.entryAction)
-    {
-        qCDebug(s_loggingCategory) << "Executing entry action...";
-        stateData.entryAction(event, m_initialTransition.state, QString());
-        qCDebug(s_loggingCategory) << "entry action executed";
-    }
-
-    // Transition to the initial state
-    m_currentState = m_initialTransition.state;
-    qCDebug(s_loggingCategory) << "Transitioned to initial state:" << m_currentState;
-
-    // Check if the initial state is also a final state
-    if (isFinalState(stateData))
-    {
-        // Store final event
-        m_finalEvent = std::make_unique<Event>(std::move(event));
-
-        qCDebug(s_loggingCategory) << "Transitioned to a final state";
-        stopInternal();
-    }
+    return definition().setDefaultTransition(state, std::move(action), std::move(guard));
 }
 
 // -------------------------------------------------------------------------------------------------
 
-void StateMachine::executeStateTransition(const StateTransitionData &transitionData, Event &&event)
+StateMachineDefinition &StateMachine::definition()
 {
-    // Check if the transition is blocked by the guard condition
-    if (transitionData.guard)
-    {
-        if (!transitionData.guard(event, m_currentState, transitionData.state))
-        {
-            qCDebug(s_loggingCategory)
-                    << QString("Transition from state [%1] with event [%2] to state [%3] was "
-                               "blocked by the guard condition")
-                       .arg(m_currentState, event.name(), transitionData.state);
-            return;
-        }
-    }
-
-    qCDebug(s_loggingCategory)
-            << QString("Transitioning from state [%1] with event [%2] to state [%3]...")
-               .arg(m_currentState, event.name(), transitionData.state);
-
-    // Execute the exit action of the current state
-    auto it = m_states.find(m_currentState);
-
-    if (it == m_states.end())
-    {
-        // This should not be possible as the current state cannot be changed externally and it
-        // should always store the name of an existing state
-        qCWarning(s_loggingCategory) << "Current state is invalid!";
-        return;
-    }
-
-    auto &currentStateData = it->second;
-
-    if (currentStateData.exitAction)
+    if (!m_definition)
     {
-        qCDebug(s_loggingCategory) << "Executing state's exit action...";
-        currentStateData.exitAction(event, m_currentState, transitionData.state);
-        qCDebug(s_loggingCategory) << "State's exit action executed";
+        m_definition = std::make_shared<StateMachineDefinition>();
+        m_instance = StateMachineInstance(m_definition);
     }
 
-    // Execute transition's action
-    if (transitionData.action)
-    {
-        qCDebug(s_loggingCategory) << "Executing state transition's action...";
-        transitionData.action(event, m_currentState, transitionData.state);
-        qCDebug(s_loggingCategory) << "State transition's action executed";
-    }
-
-    // Execute the entry action of the next state
-    auto &nextStateData = m_states[transitionData.state];
-
-    if (nextStateData.entryAction)
-    {
-        qCDebug(s_loggingCategory) << "Executing entry action...";
-        nextStateData.entryAction(event, transitionData.state, m_currentState);
-        qCDebug(s_loggingCategory) << "entry action executed";
-    }
-
-    // Transition to the next state
-    m_currentState = transitionData.state;
-    qCDebug(s_loggingCategory) << "Transitioned to state:" << m_currentState;
-
-    // Check if the state machine transitioned to a final state
-    if (isFinalState(nextStateData))
-    {
-        // Store final event
-        m_finalEvent = std::make_unique<Event>(std::move(event));
-
-        qCDebug(s_loggingCategory) << "Transitioned to a final state";
-        stopInternal();
-    }
+    return *m_definition;
 }
 
 // -------------------------------------------------------------------------------------------------
 
-void StateMachine::executeInternalTransition(const InternalTransitionData &transitionData,
-                                             const Event &event)
+QMutex *StateMachine::apiMutex() const
 {
-    // Check if the transition is blocked by the guard condition
-    if (transitionData.guard)
-    {
-        if (!transitionData.guard(event, m_currentState))
-        {
-            qCDebug(s_loggingCategory)
-                    << QString("Internal transition of state [%1] with event [%2] was blocked by "
-                               "the guard condition")
-                       .arg(m_currentState, event.name());
-            return;
-        }
-    }
-
-    qCDebug(s_loggingCategory)
-            << QString("Executing internal transition of state [%1] with event [%2]...")
-               .arg(m_currentState, event.name());
-
-    // Execute transition's action
-    qCDebug(s_loggingCategory) << "Executing state transition's action...";
-    transitionData.action(event, m_currentState);
-    qCDebug(s_loggingCategory) << "State transition's action executed";
-
-    qCDebug(s_loggingCategory) << "Transition finished";
+    return (m_instance.executionMode() == ExecutionMode::Locked) ? (&m_apiMutex) : nullptr;
 }
 
 } // namespace CppStateMachineFramework
@@ -0,0 +1,842 @@
+/* This file is part of C++ State Machine Framework.
+ *
+ * C++ State Machine Framework is free software: you can redistribute it and/or modify it under the
+ * terms of the GNU Lesser General Public License as published by the Free Software Foundation,
+ * either version 3 of the License, or (at your option) any later version.
+ *
+ * C++ State Machine Framework is distributed in the hope that it will be useful, but WITHOUT ANY
+ * WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR
+ * PURPOSE. See the GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License along with C++ State
+ * Machine Framework. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+/*!
+ * \file
+ *
+ * Contains a class for a state machine definition
+ */
+
+// Own header
+#include <CppStateMachineFramework/StateMachineDefinition.hpp>
+
+// C++ State Machine Framework includes
+
+// Qt includes
+#include <QtCore/QLoggingCategory>
+#include <QtCore/QStringList>
+
+// System includes
+#include <algorithm>
+
+// Forward declarations
+
+// Macros
+
+// -------------------------------------------------------------------------------------------------
+
+//! Logging category for the state machine definition
+static const QLoggingCategory s_loggingCategory(
+        "CppStateMachineFramework.StateMachineDefinition", QtWarningMsg);
+
+// -------------------------------------------------------------------------------------------------
+
+namespace CppStateMachineFramework
+{
+
+StateMachineDefinition::StateMachineDefinition()
+    : m_initialTransition { -1, {} },
+      m_validationStatus(ValidationStatus::Unvalidated),
+      m_columnCount(0),
+      m_denseTransitionTable(true)
+{
+}
+
+// -------------------------------------------------------------------------------------------------
+
+StateMachineDefinition::ValidationStatus StateMachineDefinition::validationStatus() const
+{
+    return m_validationStatus;
+}
+
+// -------------------------------------------------------------------------------------------------
+
+bool StateMachineDefinition::validate()
+{
+    qCDebug(s_loggingCategory) << "Validating the state machine definition...";
+
+    clearTransitionTable();
+
+    // Check if the state machine has at least one state
+    if (m_states.empty())
+    {
+        qCWarning(s_loggingCategory) << "State machine has no states";
+        m_validationStatus = ValidationStatus::Invalid;
+        return false;
+    }
+
+    // Check if initial transition is set
+    if (m_initialTransition.state < 0)
+    {
+        qCWarning(s_loggingCategory) << "State machine has no initial transition";
+        m_validationStatus = ValidationStatus::Invalid;
+        return false;
+    }
+
+    // Validate final states
+    for (const auto &stateData : m_states)
+    {
+        if (isFinalState(stateData))
+        {
+            // This is a final state, check if it has a state or an exit action
+            if (stateData.stateAction)
+            {
+                qCWarning(s_loggingCategory)
+                        << "A final state cannot have a state action:" << stateData.name;
+                m_validationStatus = ValidationStatus::Invalid;
+                return false;
+            }
+
+            if (stateData.exitAction)
+            {
+                qCWarning(s_loggingCategory)
+                        << "A final state cannot have an exit action:" << stateData.name;
+                m_validationStatus = ValidationStatus::Invalid;
+                return false;
+            }
+        }
+    }
+
+    // Check if all of the states can be reached from the initial state
+    std::vector<bool> statesReached(m_states.size(), false);
+    traverseStates(m_initialTransition.state, &statesReached);
+
+    QStringList unreachableStates;
+
+    for (std::size_t i = 0; i < m_states.size(); i++)
+    {
+        if (!statesReached[i])
+        {
+            unreachableStates.append(m_states[i].name);
+        }
+    }
+
+    if (!unreachableStates.isEmpty())
+    {
+        qCWarning(s_loggingCategory)
+                << "The following states cannot be reached:" << unreachableStates;
+        m_validationStatus = ValidationStatus::Invalid;
+        return false;
+    }
+
+    // Validation successful
+    compileTransitionTable();
+    m_validationStatus = ValidationStatus::Valid;
+    qCDebug(s_loggingCategory) << "State machine definition validated successfully";
+    return true;
+}
+
+// -------------------------------------------------------------------------------------------------
+
+bool StateMachineDefinition::addState(const QString &stateName)
+{
+    // Check if the state name is valid or duplicate
+    if (stateName.isEmpty())
+    {
+        qCWarning(s_loggingCategory) << "State name cannot be empty!";
+        return false;
+    }
+
+    if (stateIndex(stateName) >= 0)
+    {
+        qCWarning(s_loggingCategory) << "A state with the same name already exists:" << stateName;
+        return false;
+    }
+
+    // Add state
+    m_stateIndexes[stateName] = static_cast<int>(m_states.size());
+    m_states.emplace_back();
+    m_states.back().name = stateName;
+    m_validationStatus = ValidationStatus::Unvalidated;
+
+    qCDebug(s_loggingCategory) << "Added a new state:" << stateName;
+    return true;
+}
+
+// -------------------------------------------------------------------------------------------------
+
+bool StateMachineDefinition::setStateEntryAction(const QString &stateName,
+                                                 StateEntryAction entryAction)
+{
+    // Check if the action is empty
+    if (!entryAction)
+    {
+        qCWarning(s_loggingCategory) << "Invalid state's entry action:" << stateName;
+        return false;
+    }
+
+    // Check if the state name is valid
+    const int index = stateIndex(stateName);
+
+    if (index < 0)
+    {
+        qCWarning(s_loggingCategory) << "State does not exist:" << stateName;
+        return false;
+    }
+
+    // Check if state's entry action already exists
+    auto &stateData = m_states[static_cast<std::size_t>(index)];
+
+    if (stateData.entryAction)
+    {
+        qCWarning(s_loggingCategory) << "The state's entry action is already set:" << stateName;
+        return false;
+    }
+
+    // Set state's entry action
+    stateData.entryAction = std::move(entryAction);
+    m_validationStatus = ValidationStatus::Unvalidated;
+
+    qCDebug(s_loggingCategory) << "Set the state's entry action:" << stateName;
+    return true;
+}
+
+// -------------------------------------------------------------------------------------------------
+
+bool StateMachineDefinition::setStateAction(const QString &stateName, StateAction stateAction)
+{
+    // Check if the action is empty
+    if (!stateAction)
+    {
+        qCWarning(s_loggingCategory) << "Invalid state's state action:" << stateName;
+        return false;
+    }
+
+    // Check if the state name is valid
+    const int index = stateIndex(stateName);
+
+    if (index < 0)
+    {
+        qCWarning(s_loggingCategory) << "State does not exist:" << stateName;
+        return false;
+    }
+
+    // Check if state's state action already exists
+    auto &stateData = m_states[static_cast<std::size_t>(index)];
+
+    if (stateData.stateAction)
+    {
+        qCWarning(s_loggingCategory) << "The state's state action is already set:" << stateName;
+        return false;
+    }
+
+    // Set state's state action
+    stateData.stateAction = std::move(stateAction);
+    m_validationStatus = ValidationStatus::Unvalidated;
+
+    qCDebug(s_loggingCategory) << "Set the state's state action:" << stateName;
+    return true;
+}
+
+// -------------------------------------------------------------------------------------------------
+
+bool StateMachineDefinition::setStateExitAction(const QString &stateName,
+                                                StateExitAction exitAction)
+{
+    // Check if the action is empty
+    if (!exitAction)
+    {
+        qCWarning(s_loggingCategory) << "Invalid state's exit action:" << stateName;
+        return false;
+    }
+
+    // Check if the state name is valid
+    const int index = stateIndex(stateName);
+
+    if (index < 0)
+    {
+        qCWarning(s_loggingCategory) << "State does not exist:" << stateName;
+        return false;
+    }
+
+    // Check if state's exit action already exists
+    auto &stateData = m_states[static_cast<std::size_t>(index)];
+
+    if (stateData.exitAction)
+    {
+        qCWarning(s_loggingCategory) << "The state's exit action is already set:" << stateName;
+        return false;
+    }
+
+    // Set state's exit action
+    stateData.exitAction = std::move(exitAction);
+    m_validationStatus = ValidationStatus::Unvalidated;
+
+    qCDebug(s_loggingCategory) << "Set the state's exit action:" << stateName;
+    return true;
+}
+
+// -------------------------------------------------------------------------------------------------
+
+QString StateMachineDefinition::initialState() const
+{
+    if (m_initialTransition.state < 0)
+    {
+        return {};
+    }
+
+    return m_states[static_cast<std::size_t>(m_initialTransition.state)].name;
+}
+
+// -------------------------------------------------------------------------------------------------
+
+bool StateMachineDefinition::setInitialTransition(const QString &initialState,
+                                                  InitialTransitionAction action)
+{
+    // Check if the initial state is already set
+    if (m_initialTransition.state >= 0)
+    {
+        qCWarning(s_loggingCategory)
+                << "Initial state is already set:"
+                << m_states[static_cast<std::size_t>(m_initialTransition.state)].name;
+        return false;
+    }
+
+    // Check if state exists
+    const int index = stateIndex(initialState);
+
+    if (index < 0)
+    {
+        qCWarning(s_loggingCategory)
+                << "Only existing states can be set as the initial state:" << initialState;
+        return false;
+    }
+
+    // Set initial state
+    m_initialTransition.state = index;
+    m_initialTransition.action = std::move(action);
+    m_validationStatus = ValidationStatus::Unvalidated;
+
+    qCDebug(s_loggingCategory) << "Set the initial state:" << initialState;
+    return true;
+}
+
+// -------------------------------------------------------------------------------------------------
+
+bool StateMachineDefinition::addStateTransition(const QString &fromState,
+                                                const QString &trigger,
+                                                const QString &toState,
+                                                StateTransitionAction action,
+                                                StateTransitionGuardCondition guard)
+{
+    // Check if the state and event names are valid
+    const int fromStateIndex = stateIndex(fromState);
+
+    if (fromStateIndex < 0)
+    {
+        qCWarning(s_loggingCategory) << "State to transition from does not exist:" << fromState;
+        return false;
+    }
+
+    if (trigger.isEmpty())
+    {
+        qCWarning(s_loggingCategory)
+                << "Name of the event that triggers the transition cannot be empty";
+        return false;
+    }
+
+    const int toStateIndex = stateIndex(toState);
+
+    if (toStateIndex < 0)
+    {
+        qCWarning(s_loggingCategory) << "State to transition to does not exist:" << toState;
+        return false;
+    }
+
+    const EventId triggerId = EventNameRegistry::registerName(trigger);
+
+    // Check if transition already exists
+    auto &stateData = m_states[static_cast<std::size_t>(fromStateIndex)];
+
+    if ((stateData.stateTransitions.find(triggerId) != stateData.stateTransitions.end()) ||
+        (stateData.internalTransitions.find(triggerId) != stateData.internalTransitions.end()))
+    {
+        qCWarning(s_loggingCategory)
+                << QString("Transition from state [%1] with event [%2] already exists")
+                   .arg(fromState, trigger);
+        return false;
+    }
+
+    // Add transition
+    stateData.stateTransitions[triggerId] = { toStateIndex, std::move(guard), std::move(action) };
+    m_validationStatus = ValidationStatus::Unvalidated;
+
+    qCDebug(s_loggingCategory)
+            << QString("Added a state transition from state [%1] with event [%2] to state [%3]")
+               .arg(fromState, trigger, toState);
+    return true;
+}
+
+// -------------------------------------------------------------------------------------------------
+
+bool StateMachineDefinition::addInternalTransition(const QString &state,
+                                                   const QString &trigger,
+                                                   InternalTransitionAction action,
+                                                   InternalTransitionGuardCondition guard)
+{
+    // Check if the state and event names are valid
+    const int index = stateIndex(state);
+
+    if (index < 0)
+    {
+        qCWarning(s_loggingCategory) << "State of the internal transition does not exist:" << state;
+        return false;
+    }
+
+    if (trigger.isEmpty())
+    {
+        qCWarning(s_loggingCategory)
+                << "Name of the event that triggers the transition cannot be empty";
+        return false;
+    }
+
+    // Check if transition has an action
+    if (!action)
+    {
+        qCWarning(s_loggingCategory) << "Internal transition does not have an action:" << state;
+        return false;
+    }
+
+    const EventId triggerId = EventNameRegistry::registerName(trigger);
+
+    // Check if transition already exists
+    auto &stateData = m_states[static_cast<std::size_t>(index)];
+
+    if ((stateData.stateTransitions.find(triggerId) != stateData.stateTransitions.end()) ||
+        (stateData.internalTransitions.find(triggerId) != stateData.internalTransitions.end()))
+    {
+        qCWarning(s_loggingCategory)
+                << QString("Transition from state [%1] with event [%2] already exists")
+                   .arg(state, trigger);
+        return false;
+    }
+
+    // Add transition
+    stateData.internalTransitions[triggerId] = { std::move(guard), std::move(action) };
+    m_validationStatus = ValidationStatus::Unvalidated;
+
+    qCDebug(s_loggingCategory)
+            << QString("Added an internal transition to state [%1] with event [%2]")
+               .arg(state, trigger);
+    return true;
+}
+
+// -------------------------------------------------------------------------------------------------
+
+bool StateMachineDefinition::setDefaultTransition(const QString &fromState,
+                                                  const QString &toState,
+                                                  StateTransitionAction action,
+                                                  StateTransitionGuardCondition guard)
+{
+    // Check if the state names are valid
+    const int fromStateIndex = stateIndex(fromState);
+
+    if (fromStateIndex < 0)
+    {
+        qCWarning(s_loggingCategory) << "State to transition from does not exist:" << fromState;
+        return false;
+    }
+
+    const int toStateIndex = stateIndex(toState);
+
+    if (toStateIndex < 0)
+    {
+        qCWarning(s_loggingCategory) << "State to transition to does not exist:" << toState;
+        return false;
+    }
+
+    // Check if a default transition already exists
+    auto &stateData = m_states[static_cast<std::size_t>(fromStateIndex)];
+
+    if (stateData.defaultStateTransition || stateData.defaultInternalTransition)
+    {
+        qCWarning(s_loggingCategory)
+                << QString("A default transition for state [%1] already exists").arg(fromState);
+        return false;
+    }
+
+    // Set default transition
+    stateData.defaultStateTransition =
+            std::make_unique<StateTransitionData>(
+                StateTransitionData { toStateIndex, std::move(guard), std::move(action) });
+    m_validationStatus = ValidationStatus::Unvalidated;
+
+    qCDebug(s_loggingCategory)
+            << QString("Set a default state transition from state [%1] to state [%2]")
+               .arg(fromState, toState);
+    return true;
+}
+
+// -------------------------------------------------------------------------------------------------
+
+bool StateMachineDefinition::setDefaultTransition(const QString &state,
+                                                  InternalTransitionAction action,
+                                                  InternalTransitionGuardCondition guard)
+{
+    // Check if the state name is valid
+    const int index = stateIndex(state);
+
+    if (index < 0)
+    {
+        qCWarning(s_loggingCategory) << "State of the internal transition does not exist:" << state;
+        return false;
+    }
+
+    // Check if transition has an action
+    if (!action)
+    {
+        qCWarning(s_loggingCategory) << "Internal transition does not have an action:" << state;
+        return false;
+    }
+
+    // Check if a default transition already exists
+    auto &stateData = m_states[static_cast<std::size_t>(index)];
+
+    if (stateData.defaultStateTransition || stateData.defaultInternalTransition)
+    {
+        qCWarning(s_loggingCategory)
+                << QString("A default transition for state [%1] already exists").arg(state);
+        return false;
+    }
+
+    // Set default transition
+    stateData.defaultInternalTransition =
+            std::make_unique<InternalTransitionData>(
+                InternalTransitionData { std::move(guard), std::move(action) });
+    m_validationStatus = ValidationStatus::Unvalidated;
+
+    qCDebug(s_loggingCategory)
+            << QString("Set a default internal transition for state [%1]").arg(state);
+    return true;
+}
+
+// -------------------------------------------------------------------------------------------------
+
+int StateMachineDefinition::stateCount() const
+{
+    return static_cast<int>(m_states.size());
+}
+
+// -------------------------------------------------------------------------------------------------
+
+int StateMachineDefinition::stateIndex(const QString &stateName) const
+{
+    auto it = m_stateIndexes.find(stateName);
+
+    if (it == m_stateIndexes.end())
+    {
+        return -1;
+    }
+
+    return it->second;
+}
+
+// -------------------------------------------------------------------------------------------------
+
+const StateMachineDefinition::StateData &StateMachineDefinition::state(const int stateIndex) const
+{
+    return m_states[static_cast<std::size_t>(stateIndex)];
+}
+
+// -------------------------------------------------------------------------------------------------
+
+const StateMachineDefinition::InitialTransitionData &
+StateMachineDefinition::initialTransition() const
+{
+    return m_initialTransition;
+}
+
+// -------------------------------------------------------------------------------------------------
+
+bool StateMachineDefinition::isFinalState(const int stateIndex) const
+{
+    return isFinalState(m_states[static_cast<std::size_t>(stateIndex)]);
+}
+
+// -------------------------------------------------------------------------------------------------
+
+const StateMachineDefinition::CompiledTransition &StateMachineDefinition::findTransition(
+        const int stateIndex, const EventId eventId) const
+{
+    const int column = (eventId < m_eventColumns.size()) ? m_eventColumns[eventId] : 0;
+    const std::size_t row = static_cast<std::size_t>(stateIndex);
+
+    if (m_denseTransitionTable)
+    {
+        return m_transitionTable[(row * static_cast<std::size_t>(m_columnCount)) +
+                                 static_cast<std::size_t>(column)];
+    }
+
+    if (column != 0)
+    {
+        const auto itBegin = m_sparseTransitions.begin() + m_sparseRowOffsets[row];
+        const auto itEnd = m_sparseTransitions.begin() + m_sparseRowOffsets[row + 1U];
+
+        const auto it = std::lower_bound(itBegin,
+                                         itEnd,
+                                         column,
+                                         [](const SparseTransition &item, const int value)
+        {
+            return (item.column < value);
+        });
+
+        if ((it != itEnd) && (it->column == column))
+        {
+            return it->transition;
+        }
+    }
+
+    return m_defaultTransitions[row];
+}
+
+// -------------------------------------------------------------------------------------------------
+
+int StateMachineDefinition::transitionCount() const
+{
+    return static_cast<int>(m_transitions.size());
+}
+
+// -------------------------------------------------------------------------------------------------
+
+const StateMachineDefinition::TransitionInfo &StateMachineDefinition::transitionInfo(
+        const int transitionIndex) const
+{
+    return m_transitions[static_cast<std::size_t>(transitionIndex)];
+}
+
+// -------------------------------------------------------------------------------------------------
+
+void StateMachineDefinition::traverseStates(const int stateIndex,
+                                            std::vector<bool> *statesReached) const
+{
+    // Traverse the states with an explicit stack of states that were reached but not yet visited
+    // so that long chains of states cannot overflow the call stack
+    std::vector<int> pendingStates;
+    pendingStates.push_back(stateIndex);
+    (*statesReached)[static_cast<std::size_t>(stateIndex)] = true;
+
+    const auto reachState = [&pendingStates, statesReached](const int nextState)
+    {
+        const std::size_t index = static_cast<std::size_t>(nextState);
+
+        if (!(*statesReached)[index])
+        {
+            (*statesReached)[index] = true;
+            pendingStates.push_back(nextState);
+        }
+    };
+
+    while (!pendingStates.empty())
+    {
+        const auto &stateData = m_states[static_cast<std::size_t>(pendingStates.back())];
+        pendingStates.pop_back();
+
+        // Reach all the states that can be transitioned to from the state
+        for (const auto &item : stateData.stateTransitions)
+        {
+            reachState(item.second.state);
+        }
+    }
+}
+
+// -------------------------------------------------------------------------------------------------
+
+bool StateMachineDefinition::isFinalState(const StateData &stateData)
+{
+    return (stateData.stateTransitions.empty() &&
+            stateData.internalTransitions.empty() &&
+            (!stateData.defaultStateTransition) &&
+            (!stateData.defaultInternalTransition));
+}
+
+// -------------------------------------------------------------------------------------------------
+
+void StateMachineDefinition::compileTransitionTable()
+{
+    clearTransitionTable();
+
+    // Assign an index to each transition
+    for (std::size_t row = 0; row < m_states.size(); row++)
+    {
+        auto &stateData = m_states[row];
+        const int fromState = static_cast<int>(row);
+
+        for (auto &item : stateData.stateTransitions)
+        {
+            item.second.index = static_cast<int>(m_transitions.size());
+            m_transitions.push_back({ fromState, item.first, item.second.state });
+        }
+
+        for (auto &item : stateData.internalTransitions)
+        {
+            item.second.index = static_cast<int>(m_transitions.size());
+            m_transitions.push_back({ fromState, item.first, -1 });
+        }
+
+        if (stateData.defaultStateTransition)
+        {
+            stateData.defaultStateTransition->index = static_cast<int>(m_transitions.size());
+            m_transitions.push_back(
+                        { fromState, InvalidEventId, stateData.defaultStateTransition->state });
+        }
+
+        if (stateData.defaultInternalTransition)
+        {
+            stateData.defaultInternalTransition->index = static_cast<int>(m_transitions.size());
+            m_transitions.push_back({ fromState, InvalidEventId, -1 });
+        }
+    }
+
+    // Assign a column to each event that triggers at least one transition (column 0 is reserved
+    // for all other events)
+    EventId maxEventId = InvalidEventId;
+
+    for (const auto &stateData : m_states)
+    {
+        for (const auto &item : stateData.stateTransitions)
+        {
+            maxEventId = std::max(maxEventId, item.first);
+        }
+
+        for (const auto &item : stateData.internalTransitions)
+        {
+            maxEventId = std::max(maxEventId, item.first);
+        }
+    }
+
+    m_eventColumns.assign(static_cast<std::size_t>(maxEventId) + 1U, 0);
+    m_columnCount = 1;
+
+    auto assignColumn = [this](const EventId eventId)
+    {
+        int &column = m_eventColumns[eventId];
+
+        if (column == 0)
+        {
+            column = m_columnCount;
+            m_columnCount++;
+        }
+
+        return column;
+    };
+
+    // Create the transition table
+    const std::size_t rowCount = m_states.size();
+
+    for (const auto &stateData : m_states)
+    {
+        for (const auto &item : stateData.stateTransitions)
+        {
+            assignColumn(item.first);
+        }
+
+        for (const auto &item : stateData.internalTransitions)
+        {
+            assignColumn(item.first);
+        }
+    }
+
+    const std::size_t columnCount = static_cast<std::size_t>(m_columnCount);
+    m_denseTransitionTable = ((rowCount * columnCount) <= MaxDenseTransitionTableSize);
+
+    if (m_denseTransitionTable)
+    {
+        m_transitionTable.resize(rowCount * columnCount);
+    }
+    else
+    {
+        m_sparseRowOffsets.reserve(rowCount + 1U);
+        m_defaultTransitions.reserve(rowCount);
+    }
+
+    std::vector<SparseTransition> rowTransitions;
+
+    for (std::size_t row = 0; row < rowCount; row++)
+    {
+        const auto &stateData = m_states[row];
+
+        // Collect the state's transitions
+        const CompiledTransition defaultTransition
+        {
+            stateData.defaultStateTransition.get(),
+            stateData.defaultInternalTransition.get()
+        };
+
+        rowTransitions.clear();
+
+        for (const auto &item : stateData.stateTransitions)
+        {
+            rowTransitions.push_back({ m_eventColumns[item.first], { &item.second, nullptr } });
+        }
+
+        for (const auto &item : stateData.internalTransitions)
+        {
+            rowTransitions.push_back({ m_eventColumns[item.first], { nullptr, &item.second } });
+        }
+
+        // Fill the state's row in the table
+        if (m_denseTransitionTable)
+        {
+            auto itRow = m_transitionTable.begin() + static_cast<std::ptrdiff_t>(row * columnCount);
+            std::fill(itRow, itRow + m_columnCount, defaultTransition);
+
+            for (const auto &item : rowTransitions)
+            {
+                *(itRow + item.column) = item.transition;
+            }
+        }
+        else
+        {
+            std::sort(rowTransitions.begin(),
+                      rowTransitions.end(),
+                      [](const SparseTransition &left, const SparseTransition &right)
+            {
+                return (left.column < right.column);
+            });
+
+            m_sparseRowOffsets.push_back(static_cast<int>(m_sparseTransitions.size()));
+            m_sparseTransitions.insert(m_sparseTransitions.end(),
+                                       rowTransitions.begin(),
+                                       rowTransitions.end());
+            m_defaultTransitions.push_back(defaultTransition);
+        }
+    }
+
+    if (!m_denseTransitionTable)
+    {
+        m_sparseRowOffsets.push_back(static_cast<int>(m_sparseTransitions.size()));
+    }
+
+    qCDebug(s_loggingCategory)
+            << QString("Compiled the %1 transition table with %2 rows and %3 columns")
+               .arg(m_denseTransitionTable ? QStringLiteral("dense") : QStringLiteral("sparse"))
+               .arg(rowCount)
+               .arg(m_columnCount);
+}
+
+// -------------------------------------------------------------------------------------------------
+
+void StateMachineDefinition::clearTransitionTable()
+{
+    m_eventColumns.clear();
+    m_columnCount = 0;
+    m_denseTransitionTable = true;
+    m_transitionTable.clear();
+    m_sparseRowOffsets.clear();
+    m_sparseTransitions.clear();
+    m_defaultTransitions.clear();
+    m_transitions.clear();
+}
+
+} // namespace CppStateMachineFramework
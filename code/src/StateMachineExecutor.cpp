@@ -0,0 +1,507 @@
+/* This file is part of C++ State Machine Framework.
+ *
+ * C++ State Machine Framework is free software: you can redistribute it and/or modify it under the
+ * terms of the GNU Lesser General Public License as published by the Free Software Foundation,
+ * either version 3 of the License, or (at your option) any later version.
+ *
+ * C++ State Machine Framework is distributed in the hope that it will be useful, but WITHOUT ANY
+ * WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR
+ * PURPOSE. See the GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License along with C++ State
+ * Machine Framework. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+/*!
+ * \file
+ *
+ * Contains a class for an executor that processes the events of state machine instances
+ */
+
+// Own header
+#include <CppStateMachineFramework/StateMachineExecutor.hpp>
+
+// C++ State Machine Framework includes
+
+// Qt includes
+#include <QtCore/QElapsedTimer>
+#include <QtCore/QLoggingCategory>
+
+// System includes
+#include <algorithm>
+
+// Forward declarations
+
+// Macros
+
+// -------------------------------------------------------------------------------------------------
+
+//! Logging category for the state machine executor
+static const QLoggingCategory s_loggingCategory(
+        "CppStateMachineFramework.StateMachineExecutor", QtWarningMsg);
+
+//! Holds the executor that owns the worker running in the current thread (if any)
+static thread_local const void *t_currentExecutor = nullptr;
+
+//! Holds the index of the worker running in the current thread
+static thread_local std::size_t t_currentWorkerIndex = 0U;
+
+// -------------------------------------------------------------------------------------------------
+
+namespace CppStateMachineFramework
+{
+
+constexpr int StateMachineExecutor::DefaultBatchSize;
+
+// -------------------------------------------------------------------------------------------------
+
+StateMachineExecutor::StateMachineExecutor(const int workerCount)
+    : m_batchSize(DefaultBatchSize),
+      m_running(false),
+      m_queuedCount(0),
+      m_activeCount(0),
+      m_sleepingCount(0),
+      m_nextWorkerQueue(0U)
+{
+    int count = workerCount;
+
+    if (count <= 0)
+    {
+        count = std::max(1, static_cast<int>(std::thread::hardware_concurrency()));
+    }
+
+    for (int i = 0; i < count; i++)
+    {
+        m_workers.push_back(std::make_unique<Worker>());
+    }
+}
+
+// -------------------------------------------------------------------------------------------------
+
+StateMachineExecutor::~StateMachineExecutor()
+{
+    if (isRunning())
+    {
+        stop();
+    }
+
+    // Detach the executor from the remaining instances
+    QMutexLocker locker(&m_apiMutex);
+
+    for (auto &item : m_entries)
+    {
+        item.second->instance->setEventNotifier({});
+    }
+}
+
+// -------------------------------------------------------------------------------------------------
+
+int StateMachineExecutor::workerCount() const
+{
+    return static_cast<int>(m_workers.size());
+}
+
+// -------------------------------------------------------------------------------------------------
+
+int StateMachineExecutor::batchSize() const
+{
+    return m_batchSize.load(std::memory_order_relaxed);
+}
+
+// -------------------------------------------------------------------------------------------------
+
+bool StateMachineExecutor::setBatchSize(const int batchSize)
+{
+    if (batchSize < 0)
+    {
+        qCWarning(s_loggingCategory) << "Invalid batch size:" << batchSize;
+        return false;
+    }
+
+    m_batchSize.store(batchSize, std::memory_order_relaxed);
+    return true;
+}
+
+// -------------------------------------------------------------------------------------------------
+
+bool StateMachineExecutor::isRunning() const
+{
+    return m_running.load(std::memory_order_acquire);
+}
+
+// -------------------------------------------------------------------------------------------------
+
+bool StateMachineExecutor::start()
+{
+    QMutexLocker locker(&m_apiMutex);
+
+    if (m_running.load(std::memory_order_acquire))
+    {
+        qCWarning(s_loggingCategory) << "Executor is already running";
+        return false;
+    }
+
+    m_running.store(true, std::memory_order_release);
+
+    for (std::size_t i = 0U; i < m_workers.size(); i++)
+    {
+        m_workers[i]->thread = std::thread([this, i]() { runWorker(i); });
+    }
+
+    qCDebug(s_loggingCategory) << "Executor started with" << m_workers.size() << "workers";
+    return true;
+}
+
+// -------------------------------------------------------------------------------------------------
+
+bool StateMachineExecutor::stop()
+{
+    QMutexLocker locker(&m_apiMutex);
+
+    if (!m_running.load(std::memory_order_acquire))
+    {
+        qCWarning(s_loggingCategory) << "Executor is already stopped";
+        return false;
+    }
+
+    // Wake up the sleeping workers and the waiters
+    m_running.store(false, std::memory_order_seq_cst);
+
+    {
+        QMutexLocker waitLocker(&m_waitMutex);
+        m_workAvailable.wakeAll();
+        m_idle.wakeAll();
+    }
+
+    for (auto &worker : m_workers)
+    {
+        worker->thread.join();
+    }
+
+    qCDebug(s_loggingCategory) << "Executor stopped";
+    return true;
+}
+
+// -------------------------------------------------------------------------------------------------
+
+bool StateMachineExecutor::addInstance(StateMachineInstance *instance)
+{
+    QMutexLocker locker(&m_apiMutex);
+
+    if (instance == nullptr)
+    {
+        qCWarning(s_loggingCategory) << "Null instance cannot be added";
+        return false;
+    }
+
+    if (m_entries.find(instance) != m_entries.end())
+    {
+        qCWarning(s_loggingCategory) << "Instance was already added";
+        return false;
+    }
+
+    auto entry = std::make_shared<Entry>(instance);
+    m_entries.emplace(instance, entry);
+
+    instance->setEventNotifier([this, entry]() { notify(entry); });
+
+    // Schedule the instance if it already has pending events
+    if (instance->isStarted() && instance->hasPendingEvents())
+    {
+        notify(entry);
+    }
+
+    return true;
+}
+
+// -------------------------------------------------------------------------------------------------
+
+bool StateMachineExecutor::removeInstance(StateMachineInstance *instance)
+{
+    QMutexLocker locker(&m_apiMutex);
+
+    auto it = m_entries.find(instance);
+
+    if (it == m_entries.end())
+    {
+        qCWarning(s_loggingCategory) << "Instance was not added";
+        return false;
+    }
+
+    const std::shared_ptr<Entry> entry = it->second;
+    m_entries.erase(it);
+
+    // Wait until the instance is no longer being processed (a scheduled instance is skipped by the
+    // worker that takes it from its queue)
+    EntryState state = entry->state.load(std::memory_order_acquire);
+
+    while (true)
+    {
+        if ((state == EntryState::Running) || (state == EntryState::RunningNotified))
+        {
+            std::this_thread::yield();
+            state = entry->state.load(std::memory_order_acquire);
+            continue;
+        }
+
+        if (entry->state.compare_exchange_weak(state,
+                                               EntryState::Removed,
+                                               std::memory_order_acq_rel))
+        {
+            break;
+        }
+    }
+
+    if (state == EntryState::Scheduled)
+    {
+        releaseActiveEntry();
+    }
+
+    // Notifier can be removed only after the instance is no longer being processed as its actions
+    // could be adding events
+    instance->setEventNotifier({});
+    return true;
+}
+
+// -------------------------------------------------------------------------------------------------
+
+bool StateMachineExecutor::waitForIdle(const int timeout)
+{
+    QElapsedTimer timer;
+    timer.start();
+
+    QMutexLocker locker(&m_waitMutex);
+
+    while (m_activeCount.load(std::memory_order_acquire) > 0)
+    {
+        if (!m_running.load(std::memory_order_acquire))
+        {
+            qCWarning(s_loggingCategory) << "Executor is not running";
+            return false;
+        }
+
+        if (timeout < 0)
+        {
+            m_idle.wait(&m_waitMutex);
+            continue;
+        }
+
+        const qint64 remaining = timeout - timer.elapsed();
+
+        if (remaining <= 0)
+        {
+            return false;
+        }
+
+        m_idle.wait(&m_waitMutex, static_cast<unsigned long>(remaining));
+    }
+
+    return true;
+}
+
+// -------------------------------------------------------------------------------------------------
+
+void StateMachineExecutor::notify(const std::shared_ptr<Entry> &entry)
+{
+    EntryState state = entry->state.load(std::memory_order_acquire);
+
+    while (true)
+    {
+        if (state == EntryState::Idle)
+        {
+            // Schedule the instance
+            if (entry->state.compare_exchange_weak(state,
+                                                   EntryState::Scheduled,
+                                                   std::memory_order_acq_rel))
+            {
+                m_activeCount.fetch_add(1, std::memory_order_acq_rel);
+                enqueue(entry);
+                return;
+            }
+        }
+        else if (state == EntryState::Running)
+        {
+            // Let the worker reschedule the instance after it finishes processing it
+            if (entry->state.compare_exchange_weak(state,
+                                                   EntryState::RunningNotified,
+                                                   std::memory_order_acq_rel))
+            {
+                return;
+            }
+        }
+        else
+        {
+            // Instance is already scheduled (or removed)
+            return;
+        }
+    }
+}
+
+// -------------------------------------------------------------------------------------------------
+
+void StateMachineExecutor::enqueue(std::shared_ptr<Entry> entry)
+{
+    // Workers keep their instances in their own queue, other threads distribute the instances
+    // over the worker queues
+    std::size_t workerIndex = 0U;
+
+    if (t_currentExecutor == this)
+    {
+        workerIndex = t_currentWorkerIndex;
+    }
+    else
+    {
+        workerIndex = m_nextWorkerQueue.fetch_add(1U, std::memory_order_relaxed) %
+                      m_workers.size();
+    }
+
+    Worker &worker = *m_workers[workerIndex];
+
+    {
+        QMutexLocker locker(&worker.mutex);
+        worker.queue.push_back(std::move(entry));
+    }
+
+    // Wake up a sleeping worker (the number of queued instances must be updated before checking
+    // for sleeping workers, the workers do it the other way around)
+    m_queuedCount.fetch_add(1, std::memory_order_seq_cst);
+
+    if (m_sleepingCount.load(std::memory_order_seq_cst) > 0)
+    {
+        QMutexLocker locker(&m_waitMutex);
+        m_workAvailable.wakeOne();
+    }
+}
+
+// -------------------------------------------------------------------------------------------------
+
+std::shared_ptr<StateMachineExecutor::Entry> StateMachineExecutor::takeNextEntry(
+        const std::size_t workerIndex)
+{
+    // Take the oldest instance from the own queue
+    {
+        Worker &worker = *m_workers[workerIndex];
+        QMutexLocker locker(&worker.mutex);
+
+        if (!worker.queue.empty())
+        {
+            auto entry = std::move(worker.queue.front());
+            worker.queue.pop_front();
+            m_queuedCount.fetch_sub(1, std::memory_order_relaxed);
+            return entry;
+        }
+    }
+
+    // Steal the newest instance from one of the other workers
+    for (std::size_t i = 1U; i < m_workers.size(); i++)
+    {
+        Worker &worker = *m_workers[(workerIndex + i) % m_workers.size()];
+        QMutexLocker locker(&worker.mutex);
+
+        if (!worker.queue.empty())
+        {
+            auto entry = std::move(worker.queue.back());
+            worker.queue.pop_back();
+            m_queuedCount.fetch_sub(1, std::memory_order_relaxed);
+            return entry;
+        }
+    }
+
+    return {};
+}
+
+// -------------------------------------------------------------------------------------------------
+
+void StateMachineExecutor::processEntry(std::shared_ptr<Entry> entry)
+{
+    // Skip removed instances
+    EntryState state = EntryState::Scheduled;
+
+    if (!entry->state.compare_exchange_strong(state,
+                                              EntryState::Running,
+                                              std::memory_order_acq_rel))
+    {
+        return;
+    }
+
+    // Process a batch of events
+    StateMachineInstance *instance = entry->instance;
+    const int batchSize = m_batchSize.load(std::memory_order_relaxed);
+    int processedCount = 0;
+
+    while (((batchSize == 0) || (processedCount < batchSize)) &&
+           instance->isStarted() &&
+           instance->hasPendingEvents())
+    {
+        instance->processNextEvent();
+        processedCount++;
+    }
+
+    // Reschedule the instance if it still has pending events or if an event was added while it was
+    // being processed, otherwise it becomes idle
+    if (instance->isStarted() && instance->hasPendingEvents())
+    {
+        entry->state.store(EntryState::Scheduled, std::memory_order_release);
+        enqueue(std::move(entry));
+        return;
+    }
+
+    state = EntryState::Running;
+
+    if (entry->state.compare_exchange_strong(state, EntryState::Idle, std::memory_order_acq_rel))
+    {
+        releaseActiveEntry();
+        return;
+    }
+
+    entry->state.store(EntryState::Scheduled, std::memory_order_release);
+    enqueue(std::move(entry));
+}
+
+// -------------------------------------------------------------------------------------------------
+
+void StateMachineExecutor::releaseActiveEntry()
+{
+    if (m_activeCount.fetch_sub(1, std::memory_order_acq_rel) == 1)
+    {
+        QMutexLocker locker(&m_waitMutex);
+        m_idle.wakeAll();
+    }
+}
+
+// -------------------------------------------------------------------------------------------------
+
+void StateMachineExecutor::runWorker(const std::size_t workerIndex)
+{
+    t_currentExecutor = this;
+    t_currentWorkerIndex = workerIndex;
+
+    while (m_running.load(std::memory_order_acquire))
+    {
+        auto entry = takeNextEntry(workerIndex);
+
+        if (entry)
+        {
+            processEntry(std::move(entry));
+            continue;
+        }
+
+        // Sleep until an instance is scheduled (the number of sleeping workers must be updated
+        // before checking the number of queued instances, the schedulers do it the other way
+        // around)
+        QMutexLocker locker(&m_waitMutex);
+        m_sleepingCount.fetch_add(1, std::memory_order_seq_cst);
+
+        if ((m_queuedCount.load(std::memory_order_seq_cst) == 0) &&
+            m_running.load(std::memory_order_seq_cst))
+        {
+            m_workAvailable.wait(&m_waitMutex);
+        }
+
+        m_sleepingCount.fetch_sub(1, std::memory_order_seq_cst);
+    }
+
+    t_currentExecutor = nullptr;
+}
+
+} // namespace CppStateMachineFramework
@@ -0,0 +1,3278 @@
+/* This file is part of C++ State Machine Framework.
+ *
+ * C++ State Machine Framework is free software: you can redistribute it and/or modify it under the
+ * terms of the GNU Lesser General Public License as published by the Free Software Foundation,
+ * either version 3 of the License, or (at your option) any later version.
+ *
+ * C++ State Machine Framework is distributed in the hope that it will be useful, but WITHOUT ANY
+ * WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR
+ * PURPOSE. See the GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License along with C++ State
+ * Machine Framework. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+/*!
+ * \file
+ *
+ * Contains a class for a state machine instance
+ */
+
+// Own header
+#include <CppStateMachineFramework/StateMachineInstance.hpp>
+
+// C++ State Machine Framework includes
+#include <CppStateMachineFramework/EventParameterSerializer.hpp>
+
+// Qt includes
+#include <QtCore/QElapsedTimer>
+#include <QtCore/QLoggingCategory>
+#include <QtCore/QThread>
+
+// System includes
+#include <algorithm>
+#include <utility>
+
+// Forward declarations
+
+// Macros
+#ifndef CPPSTATEMACHINEFRAMEWORK_HOT_PATH_LOGGING
+#define CPPSTATEMACHINEFRAMEWORK_HOT_PATH_LOGGING 1
+#endif
+
+#if CPPSTATEMACHINEFRAMEWORK_HOT_PATH_LOGGING
+//! Logs a debug message while adding or processing an event
+#define HOT_PATH_DEBUG() qCDebug(s_loggingCategory)
+#else
+//! Logging while adding or processing an event is compiled out (the message is never evaluated)
+#define HOT_PATH_DEBUG() while (false) qCDebug(s_loggingCategory)
+#endif
+
+// -------------------------------------------------------------------------------------------------
+
+//! Logging category for the state machine instance
+static const QLoggingCategory s_loggingCategory(
+        "CppStateMachineFramework.StateMachineInstance", QtWarningMsg);
+
+//! Number of events replaced by coalesced events that are kept in the event queue before it is
+//! compacted
+static const std::size_t s_maxReplacedEventCount = 64U;
+
+//! Index of the highest priority lane that is not empty for each mask of the priority lanes
+static const int s_highestPriorityLane[] = { -1, 0, 1, 1, 2, 2, 2, 2 };
+
+static_assert(sizeof(s_highestPriorityLane) / sizeof(s_highestPriorityLane[0]) ==
+              (1U << (CppStateMachineFramework::StateMachineInstance::EventPriorityCount - 1)),
+              "Lookup table does not match the number of priority lanes");
+
+//! Magic number at the start of a snapshot ("CSMS")
+static const std::uint32_t s_snapshotMagic = 0x534D5343U;
+
+//! Version of the snapshot format
+static const std::uint16_t s_snapshotVersion = 1U;
+
+//! Snapshot flag which is set if the state machine was started
+static const std::uint16_t s_snapshotStartedFlag = 0x0001U;
+
+//! Snapshot flag which is set if the snapshot holds the final event
+static const std::uint16_t s_snapshotFinalEventFlag = 0x0002U;
+
+// -------------------------------------------------------------------------------------------------
+
+namespace CppStateMachineFramework
+{
+
+constexpr int StateMachineInstance::DefaultPollBatchSize;
+constexpr int StateMachineInstance::DefaultEventPoolCapacity;
+constexpr int StateMachineInstance::DefaultWaitSpinCount;
+constexpr int StateMachineInstance::DefaultEventQueueCapacity;
+constexpr int StateMachineInstance::EventPriorityCount;
+constexpr int StateMachineInstance::NormalEventPriority;
+constexpr int StateMachineInstance::HighestEventPriority;
+
+// -------------------------------------------------------------------------------------------------
+
+StateMachineInstance::StateMachineInstance(
+        std::shared_ptr<const StateMachineDefinition> definition)
+    : m_definition(std::move(definition)),
+      m_started(false),
+      m_executionMode(ExecutionMode::Locked),
+      m_currentState(-1),
+      m_eventPoolCapacity(DefaultEventPoolCapacity),
+      m_eventQueueHead(0),
+      m_replacedEventCount(0),
+      m_priorityLaneMask(0U),
+      m_priorityEventCount(0),
+      m_pollBatchSize(DefaultPollBatchSize),
+      m_waitSpinCount(DefaultWaitSpinCount),
+      m_adaptiveSpinCount(DefaultWaitSpinCount),
+      m_waiterCount(0),
+      m_extensions(nullptr)
+{
+}
+
+// -------------------------------------------------------------------------------------------------
+
+StateMachineInstance::StateMachineInstance(StateMachineInstance &&other) noexcept
+    : m_definition(std::move(other.m_definition)),
+      m_started(other.m_started.load(std::memory_order_acquire)),
+      m_executionMode(other.m_executionMode),
+      m_currentState(other.m_currentState),
+      m_eventPoolCapacity(other.m_eventPoolCapacity),
+      m_eventQueue(std::move(other.m_eventQueue)),
+      m_eventQueueHead(other.m_eventQueueHead),
+      m_replacedEventCount(other.m_replacedEventCount),
+      m_priorityLanes(std::move(other.m_priorityLanes)),
+      m_priorityLaneMask(other.m_priorityLaneMask.load(std::memory_order_acquire)),
+      m_priorityEventCount(other.m_priorityEventCount.load(std::memory_order_acquire)),
+      m_eventBatch(std::move(other.m_eventBatch)),
+      m_pollBatchSize(other.m_pollBatchSize),
+      m_lockFreeEventQueue(std::move(other.m_lockFreeEventQueue)),
+      m_finalEvent(std::move(other.m_finalEvent)),
+      m_eventNotifier(std::move(other.m_eventNotifier)),
+      m_waitSpinCount(other.m_waitSpinCount),
+      m_adaptiveSpinCount(other.m_adaptiveSpinCount),
+      m_waiterCount(0),
+      m_extensions(nullptr)
+{
+    // The timers of the delayed events refer to the other instance so they cannot be moved
+    other.cancelDelayedEvents();
+    m_extensions.store(other.m_extensions.exchange(nullptr, std::memory_order_acq_rel),
+                       std::memory_order_release);
+}
+
+// -------------------------------------------------------------------------------------------------
+
+StateMachineInstance::~StateMachineInstance()
+{
+    cancelDelayedEvents();
+    delete m_extensions.load(std::memory_order_acquire);
+}
+
+// -------------------------------------------------------------------------------------------------
+
+StateMachineInstance &StateMachineInstance::operator=(StateMachineInstance &&other) noexcept
+{
+    if (this != (&other))
+    {
+        m_definition = std::move(other.m_definition);
+        m_started.store(other.m_started.load(std::memory_order_acquire),
+                        std::memory_order_release);
+        m_executionMode = other.m_executionMode;
+        m_currentState = other.m_currentState;
+        m_eventPoolCapacity = other.m_eventPoolCapacity;
+        m_eventQueue = std::move(other.m_eventQueue);
+        m_eventQueueHead = other.m_eventQueueHead;
+        m_replacedEventCount = other.m_replacedEventCount;
+        m_priorityLanes = std::move(other.m_priorityLanes);
+        m_priorityLaneMask.store(other.m_priorityLaneMask.load(std::memory_order_acquire),
+                                 std::memory_order_release);
+        m_priorityEventCount.store(other.m_priorityEventCount.load(std::memory_order_acquire),
+                                   std::memory_order_release);
+        m_eventBatch = std::move(other.m_eventBatch);
+        m_pollBatchSize = other.m_pollBatchSize;
+        m_lockFreeEventQueue = std::move(other.m_lockFreeEventQueue);
+        m_finalEvent = std::move(other.m_finalEvent);
+        m_eventNotifier = std::move(other.m_eventNotifier);
+        m_waitSpinCount = other.m_waitSpinCount;
+        m_adaptiveSpinCount = other.m_adaptiveSpinCount;
+
+        // The timers of the delayed events refer to the instances so they cannot be moved
+        cancelDelayedEvents();
+        other.cancelDelayedEvents();
+        delete m_extensions.exchange(other.m_extensions.exchange(nullptr,
+                                                                 std::memory_order_acq_rel),
+                                     std::memory_order_acq_rel);
+    }
+
+    return *this;
+}
+
+// -------------------------------------------------------------------------------------------------
+
+const std::shared_ptr<const StateMachineDefinition> &StateMachineInstance::definition() const
+{
+    return m_definition;
+}
+
+// -------------------------------------------------------------------------------------------------
+
+StateMachineInstance::EventQueueMode StateMachineInstance::eventQueueMode() const
+{
+    QMutexLocker locker(apiMutex());
+
+    return m_lockFreeEventQueue ? EventQueueMode::LockFree : EventQueueMode::Locked;
+}
+
+// -------------------------------------------------------------------------------------------------
+
+bool StateMachineInstance::setEventQueueMode(const EventQueueMode mode)
+{
+    QMutexLocker apiLocker(&m_apiMutex);
+    QMutexLocker eventQueueLocker(&m_eventQueueMutex);
+    QMutexLocker startedLocker(&m_startedMutex);
+
+    // Event queue mode can be changed only if the state machine is stopped
+    if (m_started.load(std::memory_order_acquire))
+    {
+        qCWarning(s_loggingCategory)
+                << "Event queue mode can be changed only when the state machine is stopped";
+        return false;
+    }
+
+    const Extensions *extensions = m_extensions.load(std::memory_order_acquire);
+
+    if ((mode == EventQueueMode::LockFree) && (extensions != nullptr))
+    {
+        // Journal relies on the order of the events in the locked event queue
+        if (extensions->journal)
+        {
+            qCWarning(s_loggingCategory)
+                    << "Lock-free event queue mode cannot be used with a journal";
+            return false;
+        }
+
+        // Capacity and backpressure are applied only by the locked event queue
+        if ((extensions->eventQueueCapacity != 0U) ||
+            (extensions->backpressurePolicy != BackpressurePolicy::Reject))
+        {
+            qCWarning(s_loggingCategory)
+                    << "Lock-free event queue mode cannot be used with a bounded event queue";
+            return false;
+        }
+
+        // Events are coalesced only in the locked event queue
+        if (hasCoalescingPolicies())
+        {
+            qCWarning(s_loggingCategory)
+                    << "Lock-free event queue mode cannot be used with coalesced events";
+            return false;
+        }
+    }
+
+    // Change the event queue mode (pending events are discarded)
+    clearEventQueue();
+
+    if (mode == EventQueueMode::LockFree)
+    {
+        if (!m_lockFreeEventQueue)
+        {
+            m_lockFreeEventQueue = std::make_unique<MpscEventQueue>(m_eventPoolCapacity);
+        }
+    }
+    else
+    {
+        m_lockFreeEventQueue.reset();
+    }
+
+    qCDebug(s_loggingCategory) << "Event queue mode changed";
+    return true;
+}
+
+// -------------------------------------------------------------------------------------------------
+
+StateMachineInstance::ExecutionMode StateMachineInstance::executionMode() const
+{
+    return m_executionMode;
+}
+
+// -------------------------------------------------------------------------------------------------
+
+bool StateMachineInstance::setExecutionMode(const ExecutionMode mode)
+{
+    QMutexLocker apiLocker(&m_apiMutex);
+    QMutexLocker eventQueueLocker(&m_eventQueueMutex);
+    QMutexLocker startedLocker(&m_startedMutex);
+
+    // Execution mode can be changed only if the state machine is stopped
+    if (m_started.load(std::memory_order_acquire))
+    {
+        qCWarning(s_loggingCategory)
+                << "Execution mode can be changed only when the state machine is stopped";
+        return false;
+    }
+
+    m_executionMode = mode;
+
+    qCDebug(s_loggingCategory) << "Execution mode changed";
+    return true;
+}
+
+// -------------------------------------------------------------------------------------------------
+
+int StateMachineInstance::pollBatchSize() const
+{
+    QMutexLocker locker(apiMutex());
+
+    return m_pollBatchSize;
+}
+
+// -------------------------------------------------------------------------------------------------
+
+bool StateMachineInstance::setPollBatchSize(const int batchSize)
+{
+    QMutexLocker locker(apiMutex());
+
+    if (batchSize < 0)
+    {
+        qCWarning(s_loggingCategory) << "Invalid poll batch size:" << batchSize;
+        return false;
+    }
+
+    m_pollBatchSize = batchSize;
+    return true;
+}
+
+// -------------------------------------------------------------------------------------------------
+
+int StateMachineInstance::eventPoolCapacity() const
+{
+    QMutexLocker locker(apiMutex());
+
+    return m_eventPoolCapacity;
+}
+
+// -------------------------------------------------------------------------------------------------
+
+bool StateMachineInstance::setEventPoolCapacity(const int capacity)
+{
+    QMutexLocker apiLocker(&m_apiMutex);
+    QMutexLocker eventQueueLocker(&m_eventQueueMutex);
+    QMutexLocker startedLocker(&m_startedMutex);
+
+    if (capacity < 0)
+    {
+        qCWarning(s_loggingCategory) << "Invalid event pool capacity:" << capacity;
+        return false;
+    }
+
+    // Event pool capacity can be changed only if the state machine is stopped
+    if (m_started.load(std::memory_order_acquire))
+    {
+        qCWarning(s_loggingCategory)
+                << "Event pool capacity can be changed only when the state machine is stopped";
+        return false;
+    }
+
+    // Only the lock-free event queue uses the event pools so the locked event queue is kept
+    m_eventPoolCapacity = capacity;
+
+    if (m_lockFreeEventQueue)
+    {
+        // Recreate the event pools (pending events are discarded)
+        clearEventQueue();
+        m_eventBatch.clear();
+        m_priorityEventCount.store(0, std::memory_order_release);
+        m_lockFreeEventQueue = std::make_unique<MpscEventQueue>(m_eventPoolCapacity);
+    }
+
+    qCDebug(s_loggingCategory) << "Event pool capacity changed:" << capacity;
+    return true;
+}
+
+// -------------------------------------------------------------------------------------------------
+
+EventPool::Statistics StateMachineInstance::eventPoolStatistics() const
+{
+    QMutexLocker locker(apiMutex());
+
+    if (!m_lockFreeEventQueue)
+    {
+        // Memory of the locked event queue is held in a ring buffer instead of an event pool
+        return {};
+    }
+
+    return m_lockFreeEventQueue->poolStatistics();
+}
+
+// -------------------------------------------------------------------------------------------------
+
+int StateMachineInstance::eventQueueCapacity() const
+{
+    QMutexLocker locker(apiMutex());
+
+    const Extensions *extensions = m_extensions.load(std::memory_order_acquire);
+
+    if (extensions == nullptr)
+    {
+        return DefaultEventQueueCapacity;
+    }
+
+    return static_cast<int>(extensions->eventQueueCapacity);
+}
+
+// -------------------------------------------------------------------------------------------------
+
+bool StateMachineInstance::setEventQueueCapacity(const int capacity)
+{
+    QMutexLocker apiLocker(&m_apiMutex);
+    QMutexLocker eventQueueLocker(&m_eventQueueMutex);
+    QMutexLocker startedLocker(&m_startedMutex);
+
+    if (capacity < 0)
+    {
+        qCWarning(s_loggingCategory) << "Invalid event queue capacity:" << capacity;
+        return false;
+    }
+
+    // Event queue capacity can be changed only if the state machine is stopped
+    if (m_started.load(std::memory_order_acquire))
+    {
+        qCWarning(s_loggingCategory)
+                << "Event queue capacity can be changed only when the state machine is stopped";
+        return false;
+    }
+
+    // Lock-free event queue is unbounded
+    if ((capacity != 0) && m_lockFreeEventQueue)
+    {
+        qCWarning(s_loggingCategory)
+                << "Event queue capacity cannot be set in the lock-free event queue mode";
+        return false;
+    }
+
+    // Allocate the memory for the events up front (pending events are discarded). The whole event
+    // queue can be moved to the batch so the batch needs the same capacity.
+    const auto eventQueueCapacity = static_cast<std::size_t>(capacity);
+
+    if ((eventQueueCapacity != 0U) || (m_extensions.load(std::memory_order_acquire) != nullptr))
+    {
+        createExtensions()->eventQueueCapacity = eventQueueCapacity;
+    }
+
+    clearEventQueue();
+    m_eventBatch.clear();
+    m_eventQueue.reserve(eventQueueCapacity);
+    m_eventBatch.reserve(eventQueueCapacity);
+
+    qCDebug(s_loggingCategory) << "Event queue capacity changed:" << capacity;
+    return true;
+}
+
+// -------------------------------------------------------------------------------------------------
+
+StateMachineInstance::BackpressurePolicy StateMachineInstance::backpressurePolicy() const
+{
+    QMutexLocker locker(apiMutex());
+
+    const Extensions *extensions = m_extensions.load(std::memory_order_acquire);
+
+    if (extensions == nullptr)
+    {
+        return BackpressurePolicy::Reject;
+    }
+
+    return extensions->backpressurePolicy;
+}
+
+// -------------------------------------------------------------------------------------------------
+
+int StateMachineInstance::backpressureTimeout() const
+{
+    QMutexLocker locker(apiMutex());
+
+    const Extensions *extensions = m_extensions.load(std::memory_order_acquire);
+
+    if (extensions == nullptr)
+    {
+        return -1;
+    }
+
+    return extensions->backpressureTimeout;
+}
+
+// -------------------------------------------------------------------------------------------------
+
+bool StateMachineInstance::setBackpressurePolicy(const BackpressurePolicy policy,
+                                                 const int timeout)
+{
+    QMutexLocker apiLocker(&m_apiMutex);
+    QMutexLocker eventQueueLocker(&m_eventQueueMutex);
+    QMutexLocker startedLocker(&m_startedMutex);
+
+    // Backpressure policy can be changed only if the state machine is stopped
+    if (m_started.load(std::memory_order_acquire))
+    {
+        qCWarning(s_loggingCategory)
+                << "Backpressure policy can be changed only when the state machine is stopped";
+        return false;
+    }
+
+    // Lock-free event queue is unbounded
+    if ((policy != BackpressurePolicy::Reject) && m_lockFreeEventQueue)
+    {
+        qCWarning(s_loggingCategory)
+                << "Backpressure policy cannot be set in the lock-free event queue mode";
+        return false;
+    }
+
+    Extensions *extensions = createExtensions();
+    extensions->backpressurePolicy = policy;
+    extensions->backpressureTimeout = timeout;
+
+    if ((policy == BackpressurePolicy::Block) && (!extensions->eventQueueSpaceAvailable))
+    {
+        extensions->eventQueueSpaceAvailable = std::make_unique<QWaitCondition>();
+    }
+
+    qCDebug(s_loggingCategory) << "Backpressure policy changed";
+    return true;
+}
+
+// -------------------------------------------------------------------------------------------------
+
+StateMachineInstance::BackpressureStatistics StateMachineInstance::backpressureStatistics() const
+{
+    QMutexLocker locker(&m_eventQueueMutex);
+
+    const Extensions *extensions = m_extensions.load(std::memory_order_acquire);
+
+    if (extensions == nullptr)
+    {
+        return {};
+    }
+
+    return extensions->backpressureStatistics;
+}
+
+// -------------------------------------------------------------------------------------------------
+
+StateMachineInstance::CoalescingPolicy StateMachineInstance::eventCoalescingPolicy(
+        const QString &eventName) const
+{
+    QMutexLocker locker(apiMutex());
+
+    const Extensions *extensions = m_extensions.load(std::memory_order_acquire);
+    const EventId eventId = EventNameRegistry::id(eventName);
+
+    if ((extensions == nullptr) || (eventId >= extensions->coalescingPolicies.size()))
+    {
+        return CoalescingPolicy::None;
+    }
+
+    return extensions->coalescingPolicies[eventId];
+}
+
+// -------------------------------------------------------------------------------------------------
+
+bool StateMachineInstance::setEventCoalescingPolicy(const QString &eventName,
+                                                    const CoalescingPolicy policy)
+{
+    QMutexLocker apiLocker(&m_apiMutex);
+    QMutexLocker eventQueueLocker(&m_eventQueueMutex);
+    QMutexLocker startedLocker(&m_startedMutex);
+
+    if (eventName.isEmpty())
+    {
+        qCWarning(s_loggingCategory) << "Event name is empty";
+        return false;
+    }
+
+    // Coalescing policy can be changed only if the state machine is stopped
+    if (m_started.load(std::memory_order_acquire))
+    {
+        qCWarning(s_loggingCategory)
+                << "Coalescing policy can be changed only when the state machine is stopped";
+        return false;
+    }
+
+    // Journal relies on the order of the events in the event queue
+    Extensions *extensions = m_extensions.load(std::memory_order_acquire);
+
+    if ((policy != CoalescingPolicy::None) && (extensions != nullptr) && extensions->journal)
+    {
+        qCWarning(s_loggingCategory) << "Events cannot be coalesced with a journal";
+        return false;
+    }
+
+    // Events are coalesced only in the locked event queue
+    if ((policy != CoalescingPolicy::None) && m_lockFreeEventQueue)
+    {
+        qCWarning(s_loggingCategory)
+                << "Events cannot be coalesced in the lock-free event queue mode";
+        return false;
+    }
+
+    // The policies are indexed by the event ID so that they can be found in constant time
+    const EventId eventId = EventNameRegistry::registerName(eventName);
+
+    if ((extensions == nullptr) || (eventId >= extensions->coalescingPolicies.size()))
+    {
+        if (policy == CoalescingPolicy::None)
+        {
+            return true;
+        }
+
+        extensions = createExtensions();
+        extensions->coalescingPolicies.resize(eventId + 1U, CoalescingPolicy::None);
+        extensions->coalescedEventSequences.resize(eventId + 1U, -1);
+    }
+
+    extensions->coalescingPolicies[eventId] = policy;
+
+    qCDebug(s_loggingCategory) << "Coalescing policy changed:" << eventName;
+    return true;
+}
+
+// -------------------------------------------------------------------------------------------------
+
+void StateMachineInstance::setEventNotifier(EventNotifier notifier)
+{
+    std::shared_ptr<const EventNotifier> eventNotifier;
+
+    if (notifier)
+    {
+        eventNotifier = std::make_shared<const EventNotifier>(std::move(notifier));
+    }
+
+    std::atomic_store(&m_eventNotifier, std::move(eventNotifier));
+}
+
+// -------------------------------------------------------------------------------------------------
+
+int StateMachineInstance::waitSpinCount() const
+{
+    QMutexLocker locker(apiMutex());
+
+    return m_waitSpinCount;
+}
+
+// -------------------------------------------------------------------------------------------------
+
+bool StateMachineInstance::setWaitSpinCount(const int spinCount)
+{
+    QMutexLocker locker(apiMutex());
+
+    if (spinCount < 0)
+    {
+        qCWarning(s_loggingCategory) << "Invalid wait spin count:" << spinCount;
+        return false;
+    }
+
+    m_waitSpinCount = spinCount;
+    m_adaptiveSpinCount = spinCount;
+    return true;
+}
+
+// -------------------------------------------------------------------------------------------------
+
+std::shared_ptr<TimerWheel> StateMachineInstance::timerWheel() const
+{
+    QMutexLocker locker(&m_eventQueueMutex);
+
+    const Extensions *extensions = m_extensions.load(std::memory_order_acquire);
+
+    if (extensions == nullptr)
+    {
+        return {};
+    }
+
+    return extensions->timerWheel;
+}
+
+// -------------------------------------------------------------------------------------------------
+
+bool StateMachineInstance::setTimerWheel(std::shared_ptr<TimerWheel> timerWheel)
+{
+    QMutexLocker apiLocker(&m_apiMutex);
+
+    // Timing wheel can be changed only if the state machine is stopped
+    if (m_started.load(std::memory_order_acquire))
+    {
+        qCWarning(s_loggingCategory)
+                << "Timing wheel can be changed only when the state machine is stopped";
+        return false;
+    }
+
+    // The event queue mutex must not be locked while cancelling the delayed events as the timing
+    // wheel could be adding an event to this instance
+    cancelDelayedEvents();
+
+    QMutexLocker eventQueueLocker(&m_eventQueueMutex);
+
+    if (timerWheel || (m_extensions.load(std::memory_order_acquire) != nullptr))
+    {
+        Extensions *extensions = createExtensions();
+        extensions->timerWheel = std::move(timerWheel);
+        extensions->activeTimerWheel.store(extensions->timerWheel.get(),
+                                           std::memory_order_release);
+    }
+
+    qCDebug(s_loggingCategory) << "Timing wheel changed";
+    return true;
+}
+
+// -------------------------------------------------------------------------------------------------
+
+bool StateMachineInstance::metricsEnabled() const
+{
+    QMutexLocker locker(apiMutex());
+
+    const Extensions *extensions = m_extensions.load(std::memory_order_acquire);
+
+    return ((extensions != nullptr) && extensions->metricsEnabled);
+}
+
+// -------------------------------------------------------------------------------------------------
+
+bool StateMachineInstance::setMetricsEnabled(const bool enabled)
+{
+    QMutexLocker apiLocker(&m_apiMutex);
+
+    // Metrics can be enabled or disabled only if the state machine is stopped
+    if (m_started.load(std::memory_order_acquire))
+    {
+        qCWarning(s_loggingCategory)
+                << "Metrics can be enabled or disabled only when the state machine is stopped";
+        return false;
+    }
+
+    if (enabled || (m_extensions.load(std::memory_order_acquire) != nullptr))
+    {
+        QMutexLocker eventQueueLocker(&m_eventQueueMutex);
+        Extensions *extensions = createExtensions();
+        extensions->metricsEnabled = enabled;
+
+        if (!enabled)
+        {
+            std::atomic_store(&extensions->metrics, std::shared_ptr<StateMachineMetrics>());
+        }
+    }
+
+    qCDebug(s_loggingCategory) << "Metrics" << (enabled ? "enabled" : "disabled");
+    return true;
+}
+
+// -------------------------------------------------------------------------------------------------
+
+StateMachineMetrics::Snapshot StateMachineInstance::metrics() const
+{
+    const Extensions *extensions = m_extensions.load(std::memory_order_acquire);
+
+    if (extensions == nullptr)
+    {
+        return {};
+    }
+
+    // A local copy keeps the metrics alive even if they are replaced while the snapshot is taken
+    const auto metrics = std::atomic_load(&extensions->metrics);
+
+    if (!metrics)
+    {
+        return {};
+    }
+
+    return metrics->snapshot();
+}
+
+// -------------------------------------------------------------------------------------------------
+
+void StateMachineInstance::resetMetrics()
+{
+    const Extensions *extensions = m_extensions.load(std::memory_order_acquire);
+
+    if (extensions == nullptr)
+    {
+        return;
+    }
+
+    const auto metrics = std::atomic_load(&extensions->metrics);
+
+    if (metrics)
+    {
+        metrics->reset();
+    }
+}
+
+// -------------------------------------------------------------------------------------------------
+
+std::shared_ptr<IStateMachineObserver> StateMachineInstance::observer() const
+{
+    QMutexLocker locker(apiMutex());
+
+    const Extensions *extensions = m_extensions.load(std::memory_order_acquire);
+
+    if (extensions == nullptr)
+    {
+        return {};
+    }
+
+    return extensions->observer;
+}
+
+// -------------------------------------------------------------------------------------------------
+
+bool StateMachineInstance::setObserver(std::shared_ptr<IStateMachineObserver> observer)
+{
+    QMutexLocker apiLocker(&m_apiMutex);
+
+    // Observer can be changed only if the state machine is stopped
+    if (m_started.load(std::memory_order_acquire))
+    {
+        qCWarning(s_loggingCategory)
+                << "Observer can be changed only when the state machine is stopped";
+        return false;
+    }
+
+    if (observer || (m_extensions.load(std::memory_order_acquire) != nullptr))
+    {
+        QMutexLocker eventQueueLocker(&m_eventQueueMutex);
+        createExtensions()->observer = std::move(observer);
+    }
+
+    qCDebug(s_loggingCategory) << "Observer changed";
+    return true;
+}
+
+// -------------------------------------------------------------------------------------------------
+
+std::uint64_t StateMachineInstance::traceMachineId() const
+{
+    QMutexLocker locker(apiMutex());
+
+    const Extensions *extensions = m_extensions.load(std::memory_order_acquire);
+
+    if (extensions == nullptr)
+    {
+        return 0U;
+    }
+
+    return extensions->traceMachineId;
+}
+
+// -------------------------------------------------------------------------------------------------
+
+bool StateMachineInstance::setTraceMachineId(const std::uint64_t machineId)
+{
+    QMutexLocker apiLocker(&m_apiMutex);
+
+    // Trace machine ID can be changed only if the state machine is stopped
+    if (m_started.load(std::memory_order_acquire))
+    {
+        qCWarning(s_loggingCategory)
+                << "Trace machine ID can be changed only when the state machine is stopped";
+        return false;
+    }
+
+    if ((machineId != 0U) || (m_extensions.load(std::memory_order_acquire) != nullptr))
+    {
+        QMutexLocker eventQueueLocker(&m_eventQueueMutex);
+        createExtensions()->traceMachineId = machineId;
+    }
+
+    qCDebug(s_loggingCategory) << "Trace machine ID changed:" << machineId;
+    return true;
+}
+
+// -------------------------------------------------------------------------------------------------
+
+std::shared_ptr<EventJournal> StateMachineInstance::journal() const
+{
+    QMutexLocker locker(apiMutex());
+
+    const Extensions *extensions = m_extensions.load(std::memory_order_acquire);
+
+    if (extensions == nullptr)
+    {
+        return {};
+    }
+
+    return extensions->journal;
+}
+
+// -------------------------------------------------------------------------------------------------
+
+bool StateMachineInstance::setJournal(std::shared_ptr<EventJournal> journal)
+{
+    QMutexLocker apiLocker(&m_apiMutex);
+    QMutexLocker eventQueueLocker(&m_eventQueueMutex);
+    QMutexLocker startedLocker(&m_startedMutex);
+
+    // Journal can be changed only if the state machine is stopped
+    if (m_started.load(std::memory_order_acquire))
+    {
+        qCWarning(s_loggingCategory)
+                << "Journal can be changed only when the state machine is stopped";
+        return false;
+    }
+
+    // The checkpoint is the position of the processed event in the order in which the events were
+    // journaled so the events must be processed in the same order
+    if (journal && m_lockFreeEventQueue)
+    {
+        qCWarning(s_loggingCategory) << "Journal cannot be used in the lock-free event queue mode";
+        return false;
+    }
+
+    if (journal && hasCoalescingPolicies())
+    {
+        qCWarning(s_loggingCategory) << "Journal cannot be used with coalesced events";
+        return false;
+    }
+
+    if (journal || (m_extensions.load(std::memory_order_acquire) != nullptr))
+    {
+        createExtensions()->journal = std::move(journal);
+    }
+
+    qCDebug(s_loggingCategory) << "Journal changed";
+    return true;
+}
+
+// -------------------------------------------------------------------------------------------------
+
+/*!
+ * Holds the tables of the event names and parameter types of a snapshot
+ *
+ * Events in the snapshot refer to the tables by index so that each name is written only once and
+ * the snapshot does not depend on the event IDs of the process that wrote it.
+ */
+class SnapshotTables
+{
+public:
+    /*!
+     * Adds the event's name and parameter type to the tables
+     *
+     * \param   event   Event
+     *
+     * \retval  true    Success
+     * \retval  false   Failure (no serializer is registered for the event parameter's type)
+     */
+    bool add(const Event &event)
+    {
+        if (event.id() == UnregisteredEventId)
+        {
+            m_unregisteredNames.push_back(event.name());
+        }
+        else if (m_eventIds.empty() || (m_eventIds.back() != event.id()))
+        {
+            m_eventIds.push_back(event.id());
+        }
+
+        if (!event.hasParameter())
+        {
+            return true;
+        }
+
+        const EventParameterTypeId typeId = event.parameter()->typeId();
+
+        for (const auto &typeIndex : m_parameterTypeIndexes)
+        {
+            if (typeIndex.first == typeId)
+            {
+                return true;
+            }
+        }
+
+        // Parameters created in another module can have a different type ID for the same type
+        const auto *handler = EventParameterSerializer::handler(*event.parameter());
+
+        if (handler == nullptr)
+        {
+            qCWarning(s_loggingCategory)
+                    << "No serializer is registered for the parameter of the event:"
+                    << event.name();
+            return false;
+        }
+
+        const auto it = std::find(m_parameterTypes.begin(), m_parameterTypes.end(), handler);
+        const auto typeIndex = static_cast<std::size_t>(it - m_parameterTypes.begin());
+        m_parameterTypeIndexes.emplace_back(typeId, typeIndex);
+
+        if (it == m_parameterTypes.end())
+        {
+            m_parameterTypes.push_back(handler);
+        }
+
+        return true;
+    }
+
+    //! Writes the tables (after all events were added)
+    void write(BinaryWriter *writer)
+    {
+        std::sort(m_eventIds.begin(), m_eventIds.end());
+        m_eventIds.erase(std::unique(m_eventIds.begin(), m_eventIds.end()), m_eventIds.end());
+        std::sort(m_unregisteredNames.begin(), m_unregisteredNames.end());
+        m_unregisteredNames.erase(std::unique(m_unregisteredNames.begin(),
+                                              m_unregisteredNames.end()),
+                                  m_unregisteredNames.end());
+
+        // Unregistered names follow the registered ones
+        writer->writeValue(static_cast<std::uint32_t>(m_eventIds.size() +
+                                                      m_unregisteredNames.size()));
+
+        for (const EventId eventId : m_eventIds)
+        {
+            writer->writeString(EventNameRegistry::name(eventId));
+        }
+
+        for (const QString &name : m_unregisteredNames)
+        {
+            writer->writeString(name);
+        }
+
+        writer->writeValue(static_cast<std::uint16_t>(m_parameterTypes.size()));
+
+        for (const auto *handler : m_parameterTypes)
+        {
+            writer->writeString(handler->typeName);
+        }
+    }
+
+    /*!
+     * Writes the event
+     *
+     * \param   event       Event (it must have been added to the tables)
+     * \param   priority    Event priority
+     * \param   writer      Writer
+     */
+    void writeEvent(const Event &event, const int priority, BinaryWriter *writer) const
+    {
+        std::size_t eventIndex = 0U;
+
+        if (event.id() == UnregisteredEventId)
+        {
+            const auto it = std::lower_bound(m_unregisteredNames.begin(),
+                                             m_unregisteredNames.end(),
+                                             event.name());
+            eventIndex = m_eventIds.size() +
+                         static_cast<std::size_t>(it - m_unregisteredNames.begin());
+        }
+        else
+        {
+            const auto it = std::lower_bound(m_eventIds.begin(), m_eventIds.end(), event.id());
+            eventIndex = static_cast<std::size_t>(it - m_eventIds.begin());
+        }
+
+        writer->writeValue(static_cast<std::uint32_t>(eventIndex));
+        writer->writeValue(static_cast<std::uint8_t>(priority));
+
+        if (!event.hasParameter())
+        {
+            writer->writeValue(static_cast<std::uint16_t>(0U));
+            return;
+        }
+
+        // Parameter type index is written incremented by one as zero means no parameter
+        const EventParameterTypeId typeId = event.parameter()->typeId();
+        std::size_t typeIndex = 0U;
+
+        for (const auto &parameterTypeIndex : m_parameterTypeIndexes)
+        {
+            if (parameterTypeIndex.first == typeId)
+            {
+                typeIndex = parameterTypeIndex.second;
+                break;
+            }
+        }
+
+        writer->writeValue(static_cast<std::uint16_t>(typeIndex + 1U));
+
+        // Parameter is prefixed with its size so that its serializer cannot read past it
+        const int sizePosition = writer->size();
+        writer->writeValue(static_cast<std::uint32_t>(0U));
+        m_parameterTypes[typeIndex]->serialize(*event.parameter(), writer);
+        writer->overwriteValue(sizePosition,
+                               static_cast<std::uint32_t>(writer->size() - sizePosition -
+                                                          static_cast<int>(sizeof(std::uint32_t))));
+    }
+
+private:
+    //! Holds the IDs of the event names
+    std::vector<EventId> m_eventIds;
+
+    //! Holds the event names that are not registered
+    std::vector<QString> m_unregisteredNames;
+
+    //! Holds the serializers of the parameter types
+    std::vector<const EventParameterSerializer::Handler *> m_parameterTypes;
+
+    //! Holds the indexes of the serializers for the type IDs of the added event parameters
+    std::vector<std::pair<EventParameterTypeId, std::size_t>> m_parameterTypeIndexes;
+};
+
+// -------------------------------------------------------------------------------------------------
+
+/*!
+ * Reads an event from the snapshot
+ *
+ * \param   reader          Reader
+ * \param   eventNames      Event names in the snapshot's table
+ * \param   parameterTypes  Serializers of the parameter types in the snapshot's table
+ * \param   event           Output for the event
+ * \param   priority        Output for the event priority
+ *
+ * \retval  true    Success
+ * \retval  false   Failure
+ */
+static bool readSnapshotEvent(BinaryReader *reader,
+                              const std::vector<QString> &eventNames,
+                              const std::vector<const EventParameterSerializer::Handler *>
+                              &parameterTypes,
+                              Event *event,
+                              int *priority)
+{
+    std::uint32_t eventIndex = 0U;
+    std::uint8_t eventPriority = 0U;
+    std::uint16_t typeIndex = 0U;
+
+    if ((!reader->readValue(&eventIndex)) ||
+        (!reader->readValue(&eventPriority)) ||
+        (!reader->readValue(&typeIndex)) ||
+        (eventIndex >= eventNames.size()) ||
+        (eventPriority > StateMachineInstance::HighestEventPriority) ||
+        (typeIndex > parameterTypes.size()))
+    {
+        return false;
+    }
+
+    *priority = eventPriority;
+    *event = Event(eventNames[eventIndex]);
+
+    if (typeIndex == 0U)
+    {
+        return true;
+    }
+
+    std::uint32_t size = 0U;
+
+    if ((!reader->readValue(&size)) || (size > reader->remaining()))
+    {
+        return false;
+    }
+
+    BinaryReader parameterReader(reader->position(), size);
+
+    if ((!parameterTypes[typeIndex - 1U]->deserialize(&parameterReader, event)) ||
+        (!parameterReader.atEnd()))
+    {
+        return false;
+    }
+
+    return reader->skip(size);
+}
+
+// -------------------------------------------------------------------------------------------------
+
+QByteArray StateMachineInstance::snapshot()
+{
+    QMutexLocker apiLocker(apiMutex());
+    QMutexLocker eventQueueLocker(&m_eventQueueMutex);
+
+    // Collect the event names and the parameter types
+    SnapshotTables tables;
+    bool success = true;
+    std::uint32_t pendingEventCount = 0U;
+
+    if (m_finalEvent)
+    {
+        success = tables.add(*m_finalEvent);
+    }
+
+    forEachPendingEvent([&](const Event &event, int)
+    {
+        success = tables.add(event) && success;
+        pendingEventCount++;
+    });
+
+    if (!success)
+    {
+        qCWarning(s_loggingCategory) << "Failed to take a snapshot";
+        return {};
+    }
+
+    // Write the snapshot
+    QByteArray data;
+    BinaryWriter writer(&data);
+
+    std::uint16_t flags = 0U;
+
+    if (m_started.load(std::memory_order_acquire))
+    {
+        flags |= s_snapshotStartedFlag;
+    }
+
+    if (m_finalEvent)
+    {
+        flags |= s_snapshotFinalEventFlag;
+    }
+
+    writer.writeValue(s_snapshotMagic);
+    writer.writeValue(s_snapshotVersion);
+    writer.writeValue(flags);
+    writer.writeString((m_currentState < 0) ? QString()
+                                            : m_definition->state(m_currentState).name);
+    tables.write(&writer);
+
+    if (m_finalEvent)
+    {
+        tables.writeEvent(*m_finalEvent, NormalEventPriority, &writer);
+    }
+
+    writer.writeValue(pendingEventCount);
+
+    forEachPendingEvent([&](const Event &event, const int priority)
+    {
+        tables.writeEvent(event, priority, &writer);
+    });
+
+    qCDebug(s_loggingCategory) << "Snapshot taken:" << data.size() << "bytes";
+    return data;
+}
+
+// -------------------------------------------------------------------------------------------------
+
+bool StateMachineInstance::restore(const QByteArray &snapshot)
+{
+    QMutexLocker apiLocker(apiMutex());
+
+    // State machine can be restored only if it is stopped and valid
+    if (m_started.load(std::memory_order_acquire))
+    {
+        qCWarning(s_loggingCategory)
+                << "State machine can be restored only when the state machine is stopped";
+        return false;
+    }
+
+    if ((!m_definition) ||
+        (m_definition->validationStatus() != StateMachineDefinition::ValidationStatus::Valid))
+    {
+        qCWarning(s_loggingCategory) << "State machine can be restored only if it is valid";
+        return false;
+    }
+
+    // Pending events of the journal are restored when the state machine is started
+    Extensions *extensions = m_extensions.load(std::memory_order_acquire);
+
+    if ((extensions != nullptr) && extensions->journal)
+    {
+        qCWarning(s_loggingCategory) << "State machine with a journal cannot be restored";
+        return false;
+    }
+
+    // Read the header
+    BinaryReader reader(snapshot.constData(), static_cast<std::size_t>(snapshot.size()));
+    std::uint32_t magic = 0U;
+    std::uint16_t version = 0U;
+    std::uint16_t flags = 0U;
+    QString stateName;
+
+    if ((!reader.readValue(&magic)) ||
+        (!reader.readValue(&version)) ||
+        (!reader.readValue(&flags)) ||
+        (magic != s_snapshotMagic) ||
+        (version != s_snapshotVersion) ||
+        (!reader.readString(&stateName)))
+    {
+        qCWarning(s_loggingCategory) << "Invalid snapshot header";
+        return false;
+    }
+
+    int stateIndex = -1;
+
+    if (!stateName.isEmpty())
+    {
+        stateIndex = m_definition->stateIndex(stateName);
+
+        if (stateIndex < 0)
+        {
+            qCWarning(s_loggingCategory) << "Snapshot state does not exist:" << stateName;
+            return false;
+        }
+    }
+
+    // Read the tables
+    std::uint32_t eventNameCount = 0U;
+
+    if ((!reader.readValue(&eventNameCount)) ||
+        (eventNameCount > (reader.remaining() / sizeof(std::uint32_t))))
+    {
+        qCWarning(s_loggingCategory) << "Invalid snapshot event name table";
+        return false;
+    }
+
+    // Names are not registered so that a snapshot cannot grow the event name registry, the events
+    // with names that are not used by any definition hold their own copy of the name
+    std::vector<QString> eventNames;
+    eventNames.reserve(eventNameCount);
+
+    for (std::uint32_t i = 0U; i < eventNameCount; i++)
+    {
+        QString eventName;
+
+        if ((!reader.readString(&eventName)) || eventName.isEmpty())
+        {
+            qCWarning(s_loggingCategory) << "Invalid snapshot event name table";
+            return false;
+        }
+
+        eventNames.push_back(eventName);
+    }
+
+    std::uint16_t parameterTypeCount = 0U;
+
+    if (!reader.readValue(&parameterTypeCount))
+    {
+        qCWarning(s_loggingCategory) << "Invalid snapshot parameter type table";
+        return false;
+    }
+
+    std::vector<const EventParameterSerializer::Handler *> parameterTypes;
+    parameterTypes.reserve(parameterTypeCount);
+
+    for (std::uint16_t i = 0U; i < parameterTypeCount; i++)
+    {
+        QString typeName;
+
+        if (!reader.readString(&typeName))
+        {
+            qCWarning(s_loggingCategory) << "Invalid snapshot parameter type table";
+            return false;
+        }
+
+        const auto *handler = EventParameterSerializer::handlerByTypeName(typeName);
+
+        if (handler == nullptr)
+        {
+            qCWarning(s_loggingCategory)
+                    << "No serializer is registered for the snapshot parameter type:" << typeName;
+            return false;
+        }
+
+        parameterTypes.push_back(handler);
+    }
+
+    // Read the events
+    std::unique_ptr<Event> finalEvent;
+    int priority = NormalEventPriority;
+
+    if ((flags & s_snapshotFinalEventFlag) != 0U)
+    {
+        finalEvent = std::make_unique<Event>(InvalidEventId);
+
+        if (!readSnapshotEvent(&reader, eventNames, parameterTypes, finalEvent.get(), &priority))
+        {
+            qCWarning(s_loggingCategory) << "Invalid snapshot final event";
+            return false;
+        }
+    }
+
+    // Each event takes at least 7 bytes which bounds the number of events in a corrupted snapshot
+    std::uint32_t pendingEventCount = 0U;
+
+    if ((!reader.readValue(&pendingEventCount)) || (pendingEventCount > (reader.remaining() / 7U)))
+    {
+        qCWarning(s_loggingCategory) << "Invalid snapshot pending events";
+        return false;
+    }
+
+    EventQueue pendingEvents;
+    std::vector<std::uint8_t> pendingEventPriorities;
+    pendingEvents.reserve(pendingEventCount);
+    pendingEventPriorities.reserve(pendingEventCount);
+
+    for (std::uint32_t i = 0U; i < pendingEventCount; i++)
+    {
+        Event event(InvalidEventId);
+
+        if (!readSnapshotEvent(&reader, eventNames, parameterTypes, &event, &priority))
+        {
+            qCWarning(s_loggingCategory) << "Invalid snapshot pending event";
+            return false;
+        }
+
+        pendingEvents.pushBack(std::move(event));
+        pendingEventPriorities.push_back(static_cast<std::uint8_t>(priority));
+    }
+
+    if (!reader.atEnd())
+    {
+        qCWarning(s_loggingCategory) << "Invalid snapshot size";
+        return false;
+    }
+
+    // Apply the snapshot (the event queue mutex must be locked before the started mutex, the same
+    // as when adding events)
+    QMutexLocker eventQueueLocker(&m_eventQueueMutex);
+    QMutexLocker startedLocker(startedMutex());
+
+    clearEventQueue();
+    m_eventBatch.clear();
+
+    if (m_lockFreeEventQueue)
+    {
+        m_lockFreeEventQueue->clear();
+    }
+
+    m_currentState = stateIndex;
+    m_finalEvent = std::move(finalEvent);
+
+    if ((extensions != nullptr) && extensions->metricsEnabled)
+    {
+        std::atomic_store(&extensions->metrics,
+                          std::make_shared<StateMachineMetrics>(m_definition));
+    }
+
+    for (std::uint32_t i = 0U; i < pendingEventCount; i++)
+    {
+        Event &event = pendingEvents[i];
+        const int eventPriority = pendingEventPriorities[i];
+
+        if (eventPriority > NormalEventPriority)
+        {
+            const int lane = eventPriority - 1;
+            m_priorityLanes[lane].pushBack(std::move(event));
+            m_priorityLaneMask.fetch_or(1U << lane, std::memory_order_relaxed);
+        }
+        else if (m_lockFreeEventQueue)
+        {
+            m_lockFreeEventQueue->push(std::move(event));
+        }
+        else if (!addCoalescedEvent(event))
+        {
+            m_eventQueue.pushBack(std::move(event));
+        }
+    }
+
+    m_priorityEventCount.store(0, std::memory_order_relaxed);
+    m_started.store((flags & s_snapshotStartedFlag) != 0U, std::memory_order_release);
+
+    qCDebug(s_loggingCategory) << "State machine restored, current state:" << stateName
+                               << "pending events:" << pendingEventCount;
+
+    eventQueueLocker.unlock();
+    startedLocker.unlock();
+
+    if ((pendingEventCount > 0U) && m_started.load(std::memory_order_acquire))
+    {
+        notifyEventAdded();
+    }
+
+    return true;
+}
+
+// -------------------------------------------------------------------------------------------------
+
+bool StateMachineInstance::isStarted()
+{
+    return m_started.load(std::memory_order_acquire);
+}
+
+// -------------------------------------------------------------------------------------------------
+
+bool StateMachineInstance::start(Event &&event)
+{
+    QMutexLocker apiLocker(apiMutex());
+
+    qCDebug(s_loggingCategory) << "Starting the state machine...";
+
+    // Check if the event is valid
+    if (event.id() == InvalidEventId)
+    {
+        qCWarning(s_loggingCategory) << "Attempted to add an event with an empty name";
+        return false;
+    }
+
+    // State machine can be started only if it is stopped and valid (the event queue mutex must be
+    // locked before the started mutex, the same as when adding events)
+    QMutexLocker eventQueueLocker(&m_eventQueueMutex);
+    QMutexLocker startedLocker(startedMutex());
+
+    if (m_started.load(std::memory_order_acquire))
+    {
+        qCWarning(s_loggingCategory) << "State machine is already started";
+        return false;
+    }
+
+    if ((!m_definition) ||
+        (m_definition->validationStatus() != StateMachineDefinition::ValidationStatus::Valid))
+    {
+        qCWarning(s_loggingCategory) << "State machine can be started only if it is valid";
+        return false;
+    }
+
+    // Execute initial transition
+    clearEventQueue();
+
+    if (m_lockFreeEventQueue)
+    {
+        m_lockFreeEventQueue->clear();
+    }
+
+    Extensions *extensions = m_extensions.load(std::memory_order_acquire);
+
+    if ((extensions != nullptr) && extensions->journal && (!replayJournal()))
+    {
+        return false;
+    }
+
+    m_currentState = -1;
+    m_finalEvent.reset();
+
+    if ((extensions != nullptr) && extensions->metricsEnabled)
+    {
+        // The definition could have been changed since the metrics were created
+        std::atomic_store(&extensions->metrics,
+                          std::make_shared<StateMachineMetrics>(m_definition));
+    }
+
+    m_started.store(true, std::memory_order_release);
+
+    qCDebug(s_loggingCategory) << "State machine started";
+
+    eventQueueLocker.unlock();
+    startedLocker.unlock();
+
+    executeInitialTransition(std::move(event));
+    return true;
+}
+
+// -------------------------------------------------------------------------------------------------
+
+bool StateMachineInstance::stop()
+{
+    QMutexLocker locker(apiMutex());
+
+    return stopInternal();
+}
+
+// -------------------------------------------------------------------------------------------------
+
+QString StateMachineInstance::currentState() const
+{
+    QMutexLocker locker(apiMutex());
+
+    if (m_currentState < 0)
+    {
+        return {};
+    }
+
+    return m_definition->state(m_currentState).name;
+}
+
+// -------------------------------------------------------------------------------------------------
+
+int StateMachineInstance::currentStateIndex() const
+{
+    QMutexLocker locker(apiMutex());
+
+    return m_currentState;
+}
+
+// -------------------------------------------------------------------------------------------------
+
+bool StateMachineInstance::finalStateReached() const
+{
+    QMutexLocker locker(apiMutex());
+
+    // Check if the the state is set to a valid state
+    if (m_currentState < 0)
+    {
+        // This is only possible if the state machine was never started
+        qCWarning(s_loggingCategory) << "Current state is invalid!";
+        return false;
+    }
+
+    // Check if the state is a final state (no transitions)
+    return m_definition->isFinalState(m_currentState);
+}
+
+// -------------------------------------------------------------------------------------------------
+
+bool StateMachineInstance::hasFinalEvent() const
+{
+    return (m_finalEvent != nullptr);
+}
+
+// -------------------------------------------------------------------------------------------------
+
+std::unique_ptr<Event> StateMachineInstance::takeFinalEvent()
+{
+    QMutexLocker locker(apiMutex());
+
+    return std::move(m_finalEvent);
+}
+
+// -------------------------------------------------------------------------------------------------
+
+bool StateMachineInstance::hasPendingEvents() const
+{
+    if (m_lockFreeEventQueue)
+    {
+        return ((!m_eventQueue.isEmpty()) ||
+                (m_priorityLaneMask.load(std::memory_order_acquire) != 0U) ||
+                (!m_lockFreeEventQueue->isEmpty()));
+    }
+
+    QMutexLocker locker(&m_eventQueueMutex);
+
+    // Events replaced by coalesced events stay in the event queue until they are removed
+    return ((m_priorityLaneMask.load(std::memory_order_relaxed) != 0U) ||
+            (m_eventQueue.size() > m_replacedEventCount));
+}
+
+// -------------------------------------------------------------------------------------------------
+
+bool StateMachineInstance::addEventToFront(Event &&event)
+{
+    if (m_lockFreeEventQueue)
+    {
+        // Only the consumer thread is allowed to add events to the front of the event queue so the
+        // event can be added to the front of the consumer's event queue without locking
+        if (!checkNewEvent(event))
+        {
+            return false;
+        }
+
+        HOT_PATH_DEBUG()
+                << "Added event to the front of the event queue:" << event.name();
+        m_eventQueue.pushFront(std::move(event));
+        notifyEventAdded();
+        return true;
+    }
+
+    // The event is added to the front of the highest priority lane so that it is processed before
+    // all other pending events
+    return addPriorityEvent(std::move(event), HighestEventPriority, true);
+}
+
+// -------------------------------------------------------------------------------------------------
+
+bool StateMachineInstance::addEventToBack(Event &&event)
+{
+    return addEventToBackInternal(std::move(event), true);
+}
+
+// -------------------------------------------------------------------------------------------------
+
+bool StateMachineInstance::addEvent(Event &&event, const int priority)
+{
+    if ((priority < NormalEventPriority) || (priority > HighestEventPriority))
+    {
+        qCWarning(s_loggingCategory) << "Invalid event priority:" << priority;
+        return false;
+    }
+
+    if (priority == NormalEventPriority)
+    {
+        return addEventToBack(std::move(event));
+    }
+
+    return addPriorityEvent(std::move(event), priority, false);
+}
+
+// -------------------------------------------------------------------------------------------------
+
+TimerId StateMachineInstance::addEventAfter(const int delay, Event &&event, const int priority)
+{
+    return addDelayedEventTimer(delay, std::move(event), priority, false);
+}
+
+// -------------------------------------------------------------------------------------------------
+
+TimerId StateMachineInstance::addStateEventAfter(const int delay,
+                                                 Event &&event,
+                                                 const int priority)
+{
+    return addDelayedEventTimer(delay, std::move(event), priority, true);
+}
+
+// -------------------------------------------------------------------------------------------------
+
+bool StateMachineInstance::cancelDelayedEvent(const TimerId timerId)
+{
+    const Extensions *extensions = m_extensions.load(std::memory_order_acquire);
+
+    if (extensions == nullptr)
+    {
+        return false;
+    }
+
+    TimerWheel *timerWheel = extensions->activeTimerWheel.load(std::memory_order_acquire);
+
+    if (timerWheel == nullptr)
+    {
+        return false;
+    }
+
+    return timerWheel->cancelTimer(timerId);
+}
+
+// -------------------------------------------------------------------------------------------------
+
+bool StateMachineInstance::processNextEvent()
+{
+    QMutexLocker apiLocker(apiMutex());
+
+    HOT_PATH_DEBUG() << "Processing next event...";
+
+    // Check if the state machine is started
+    if (!isStarted())
+    {
+        qCWarning(s_loggingCategory) << "State machine is not started";
+        return false;
+    }
+
+    // Take the next pending event
+    Event event(InvalidEventId);
+
+    if (!takeNextEvent(&event))
+    {
+        qCWarning(s_loggingCategory) << "No pending events to process!";
+        return false;
+    }
+
+    HOT_PATH_DEBUG() << "Processing event:" << event.name();
+
+    if (!processEvent(std::move(event)))
+    {
+        // This should not be possible as the current state should always be valid
+        qCWarning(s_loggingCategory) << "Failed to process event!";
+        return false;
+    }
+
+    const Extensions *extensions = m_extensions.load(std::memory_order_acquire);
+
+    if ((extensions != nullptr) && extensions->journal)
+    {
+        extensions->journal->setCheckpoint(extensions->journalSequence);
+    }
+
+    return true;
+}
+
+// -------------------------------------------------------------------------------------------------
+
+bool StateMachineInstance::poll()
+{
+    QMutexLocker apiLocker(apiMutex());
+
+    HOT_PATH_DEBUG() << "Polling...";
+
+    // Check if the state machine is started
+    if (!isStarted())
+    {
+        qCWarning(s_loggingCategory) << "State machine is not started";
+        return false;
+    }
+
+    // Process all pending events (journal can be changed only while the state machine is stopped)
+    const Extensions *extensions = m_extensions.load(std::memory_order_acquire);
+    EventJournal *journal = (extensions != nullptr) ? extensions->journal.get() : nullptr;
+    Event event(InvalidEventId);
+
+    while (takeNextBatchedEvent(&event))
+    {
+        HOT_PATH_DEBUG() << "Processing event:" << event.name();
+
+        // Process the event
+        if (!processEvent(std::move(event)))
+        {
+            // This should not be possible as the current state should always be valid
+            qCWarning(s_loggingCategory) << "Failed to process event!";
+            returnEventBatch();
+            return false;
+        }
+
+        if (journal != nullptr)
+        {
+            journal->setCheckpoint(extensions->journalSequence);
+        }
+    }
+
+    // Get current state's data
+    if (m_currentState < 0)
+    {
+        // This should not be possible as the current state is always set after startup
+        qCWarning(s_loggingCategory) << "Current state is invalid!";
+        return false;
+    }
+
+    const auto &stateData = m_definition->state(m_currentState);
+
+    // Execute current state's state action
+    if (stateData.stateAction)
+    {
+        HOT_PATH_DEBUG() << "Executing state's state action...";
+        stateData.stateAction(stateData.name);
+        HOT_PATH_DEBUG() << "State's state action executed";
+    }
+
+    HOT_PATH_DEBUG() << "Polling finished";
+    return true;
+}
+
+// -------------------------------------------------------------------------------------------------
+
+bool StateMachineInstance::waitForEvents(const int timeout)
+{
+    // Check if the state machine is started
+    if (!isStarted())
+    {
+        qCWarning(s_loggingCategory) << "State machine is not started";
+        return false;
+    }
+
+    if (hasPendingEvents())
+    {
+        return true;
+    }
+
+    // Spin for a while before blocking (the number of checks adapts to how often the events arrive
+    // during spinning)
+    int spinCount = 0;
+
+    {
+        QMutexLocker locker(apiMutex());
+        spinCount = m_waitSpinCount;
+    }
+
+    if (spinCount > 0)
+    {
+        m_adaptiveSpinCount = std::min(std::max(m_adaptiveSpinCount, 1), spinCount);
+
+        for (int i = 0; i < m_adaptiveSpinCount; i++)
+        {
+            QThread::yieldCurrentThread();
+
+            if (hasPendingEvents())
+            {
+                m_adaptiveSpinCount = std::min(m_adaptiveSpinCount * 2, spinCount);
+                return true;
+            }
+
+            if (!isStarted())
+            {
+                return false;
+            }
+        }
+
+        m_adaptiveSpinCount = std::max(m_adaptiveSpinCount / 2, 1);
+    }
+
+    // Block until an event is added or the state machine is stopped (the waiter count must be
+    // incremented before the event queue is checked, the producers check it after adding an event)
+    QElapsedTimer timer;
+    timer.start();
+
+    m_waiterCount.fetch_add(1, std::memory_order_seq_cst);
+    std::atomic_thread_fence(std::memory_order_seq_cst);
+
+    QMutexLocker locker(&m_waitMutex);
+    bool success = true;
+
+    if (!m_eventsAvailable)
+    {
+        m_eventsAvailable = std::make_unique<QWaitCondition>();
+    }
+
+    while (!hasPendingEvents())
+    {
+        if (!isStarted())
+        {
+            success = false;
+            break;
+        }
+
+        if (timeout < 0)
+        {
+            m_eventsAvailable->wait(&m_waitMutex);
+            continue;
+        }
+
+        const qint64 remaining = timeout - timer.elapsed();
+
+        if (remaining <= 0)
+        {
+            success = false;
+            break;
+        }
+
+        m_eventsAvailable->wait(&m_waitMutex, static_cast<unsigned long>(remaining));
+    }
+
+    locker.unlock();
+    m_waiterCount.fetch_sub(1, std::memory_order_release);
+    return success;
+}
+
+// -------------------------------------------------------------------------------------------------
+
+bool StateMachineInstance::runUntilStopped()
+{
+    // Check if the state machine is started
+    if (!isStarted())
+    {
+        qCWarning(s_loggingCategory) << "State machine is not started";
+        return false;
+    }
+
+    qCDebug(s_loggingCategory) << "Running the state machine until it is stopped...";
+
+    while (isStarted())
+    {
+        if (!waitForEvents())
+        {
+            continue;
+        }
+
+        if (!poll())
+        {
+            // The state machine could have been stopped from another thread in the meantime
+            if (!isStarted())
+            {
+                break;
+            }
+
+            return false;
+        }
+    }
+
+    qCDebug(s_loggingCategory) << "Run finished";
+    return true;
+}
+
+// -------------------------------------------------------------------------------------------------
+
+QMutex *StateMachineInstance::apiMutex() const
+{
+    return (m_executionMode == ExecutionMode::Locked) ? (&m_apiMutex) : nullptr;
+}
+
+// -------------------------------------------------------------------------------------------------
+
+QMutex *StateMachineInstance::startedMutex() const
+{
+    return (m_executionMode == ExecutionMode::Locked) ? (&m_startedMutex) : nullptr;
+}
+
+// -------------------------------------------------------------------------------------------------
+
+bool StateMachineInstance::stopInternal()
+{
+    QMutexLocker locker(startedMutex());
+
+    qCDebug(s_loggingCategory) << "Stopping the state machine...";
+
+    // Check if the state machine can be started
+    if (!m_started.load(std::memory_order_acquire))
+    {
+        qCWarning(s_loggingCategory) << "State machine is already stopped";
+        return false;
+    }
+
+    // Stop the state machine
+    qCDebug(s_loggingCategory) << "Current state:"
+                               << ((m_currentState < 0)
+                                   ? QString()
+                                   : m_definition->state(m_currentState).name);
+
+    m_started.store(false, std::memory_order_release);
+    qCDebug(s_loggingCategory) << "State machine stopped";
+
+    locker.unlock();
+    wakeUpWaiter();
+
+    // The fence pairs with the one in applyBackpressure() so that either the blocked producer sees
+    // that the state machine is stopped or its registration is seen here
+    std::atomic_thread_fence(std::memory_order_seq_cst);
+
+    // Producers block only with the BackpressurePolicy::Block policy which creates the condition
+    Extensions *extensions = m_extensions.load(std::memory_order_acquire);
+
+    if ((extensions != nullptr) &&
+        (extensions->blockedProducerCount.load(std::memory_order_relaxed) > 0))
+    {
+        QMutexLocker eventQueueLocker(&m_eventQueueMutex);
+        extensions->eventQueueSpaceAvailable->wakeAll();
+    }
+
+    // The started mutex must not be locked while cancelling the delayed events as the timing wheel
+    // could be adding an event to this instance
+    cancelDelayedEvents();
+    return true;
+}
+
+// -------------------------------------------------------------------------------------------------
+
+StateMachineInstance::Extensions *StateMachineInstance::createExtensions()
+{
+    Extensions *extensions = m_extensions.load(std::memory_order_acquire);
+
+    if (extensions == nullptr)
+    {
+        // It is published atomically so that it can be read without locking the event queue mutex
+        extensions = new Extensions();
+        m_extensions.store(extensions, std::memory_order_release);
+    }
+
+    return extensions;
+}
+
+// -------------------------------------------------------------------------------------------------
+
+bool StateMachineInstance::checkNewEvent(const Event &event) const
+{
+    // Check if the event is valid
+    if (event.id() == InvalidEventId)
+    {
+        qCWarning(s_loggingCategory) << "Attempted to add an event with an empty name";
+        return false;
+    }
+
+    // Check if the state machine is started
+    if (!m_started.load(std::memory_order_acquire))
+    {
+        qCWarning(s_loggingCategory)
+                << "Cannot add an event to a stopped state machine:" << event.name();
+        return false;
+    }
+
+    return true;
+}
+
+// -------------------------------------------------------------------------------------------------
+
+bool StateMachineInstance::addEventToBackInternal(Event &&event, const bool canBlock)
+{
+    if (m_lockFreeEventQueue)
+    {
+        if (!checkNewEvent(event))
+        {
+            return false;
+        }
+
+        HOT_PATH_DEBUG()
+                << "Added event to the back of the event queue:" << event.name();
+        m_lockFreeEventQueue->push(std::move(event));
+        notifyEventAdded();
+        return true;
+    }
+
+    QMutexLocker eventQueueLocker(&m_eventQueueMutex);
+    QMutexLocker startedLocker(startedMutex());
+
+    if (!checkNewEvent(event))
+    {
+        return false;
+    }
+
+    // Replacing of a pending coalesced event does not need any room in the event queue
+    if (!hasPendingCoalescedEvent(event.id()))
+    {
+        bool result = false;
+
+        if (!applyBackpressure(&startedLocker, canBlock, &result))
+        {
+            return result;
+        }
+    }
+
+    if (!addCoalescedEvent(event))
+    {
+        // Journal is appended under the event queue mutex so that it has the order of the queue
+        const Extensions *extensions = m_extensions.load(std::memory_order_acquire);
+
+        if ((extensions != nullptr) && extensions->journal &&
+            (extensions->journal->append(event) == 0U))
+        {
+            qCWarning(s_loggingCategory)
+                    << "Failed to append the event to the journal:" << event.name();
+            return false;
+        }
+
+        HOT_PATH_DEBUG() << "Added event to the back of the event queue:" << event.name();
+        m_eventQueue.pushBack(std::move(event));
+    }
+
+    eventQueueLocker.unlock();
+    startedLocker.unlock();
+
+    notifyEventAdded();
+    return true;
+}
+
+// -------------------------------------------------------------------------------------------------
+
+TimerWheel *StateMachineInstance::activeTimerWheel()
+{
+    Extensions *extensions = m_extensions.load(std::memory_order_acquire);
+
+    if (extensions != nullptr)
+    {
+        TimerWheel *timerWheel = extensions->activeTimerWheel.load(std::memory_order_acquire);
+
+        if (timerWheel != nullptr)
+        {
+            return timerWheel;
+        }
+    }
+
+    // The default timing wheel is held by the instance so that it outlives the instance
+    QMutexLocker eventQueueLocker(&m_eventQueueMutex);
+
+    extensions = createExtensions();
+
+    if (!extensions->timerWheel)
+    {
+        extensions->timerWheel = TimerWheel::defaultTimerWheel();
+    }
+
+    extensions->activeTimerWheel.store(extensions->timerWheel.get(), std::memory_order_release);
+    return extensions->timerWheel.get();
+}
+
+// -------------------------------------------------------------------------------------------------
+
+TimerId StateMachineInstance::addDelayedEventTimer(const int delay,
+                                                   Event &&event,
+                                                   const int priority,
+                                                   const bool stateScoped)
+{
+    if ((priority < NormalEventPriority) || (priority > HighestEventPriority))
+    {
+        qCWarning(s_loggingCategory) << "Invalid event priority:" << priority;
+        return InvalidTimerId;
+    }
+
+    if (!m_started.load(std::memory_order_acquire))
+    {
+        qCWarning(s_loggingCategory)
+                << "Cannot add a delayed event to a stopped state machine:" << event.name();
+        return InvalidTimerId;
+    }
+
+    const TimerId timerId =
+            activeTimerWheel()->addTimer(this, delay, std::move(event), priority, stateScoped);
+
+    if (stateScoped && (timerId != InvalidTimerId))
+    {
+        // The timing wheel is held by the state of the optional features so it already exists
+        Extensions *extensions = m_extensions.load(std::memory_order_acquire);
+        extensions->stateTimersArmed.store(true, std::memory_order_relaxed);
+    }
+
+    return timerId;
+}
+
+// -------------------------------------------------------------------------------------------------
+
+bool StateMachineInstance::addDelayedEvent(Event &&event, const int priority)
+{
+    // Events of the timers that expired while the state machine was being stopped are dropped
+    if (!m_started.load(std::memory_order_acquire))
+    {
+        HOT_PATH_DEBUG() << "Delayed event was dropped as the state machine is stopped";
+        return false;
+    }
+
+    if (priority == NormalEventPriority)
+    {
+        return addEventToBackInternal(std::move(event), false);
+    }
+
+    return addPriorityEvent(std::move(event), priority, false);
+}
+
+// -------------------------------------------------------------------------------------------------
+
+void StateMachineInstance::cancelDelayedEvents()
+{
+    Extensions *extensions = m_extensions.load(std::memory_order_acquire);
+
+    if (extensions == nullptr)
+    {
+        return;
+    }
+
+    TimerWheel *timerWheel = extensions->activeTimerWheel.load(std::memory_order_acquire);
+
+    if (timerWheel != nullptr)
+    {
+        timerWheel->cancelTimers(this);
+    }
+
+    extensions->stateTimersArmed.store(false, std::memory_order_relaxed);
+}
+
+// -------------------------------------------------------------------------------------------------
+
+bool StateMachineInstance::applyBackpressure(QMutexLocker *startedLocker,
+                                             const bool canBlock,
+                                             bool *result)
+{
+    // Events replaced by coalesced events do not count as pending events
+    Extensions *extensions = m_extensions.load(std::memory_order_acquire);
+
+    if ((extensions == nullptr) ||
+        (extensions->eventQueueCapacity == 0U) ||
+        ((m_eventQueue.size() - m_replacedEventCount) < extensions->eventQueueCapacity))
+    {
+        return true;
+    }
+
+    auto &statistics = extensions->backpressureStatistics;
+
+    // Producers that must not be blocked are rejected instead
+    if ((extensions->backpressurePolicy == BackpressurePolicy::Reject) ||
+        ((extensions->backpressurePolicy == BackpressurePolicy::Block) && (!canBlock)))
+    {
+        HOT_PATH_DEBUG() << "Event queue is full, the event was rejected";
+        statistics.rejected++;
+        *result = false;
+        return false;
+    }
+
+    if (extensions->backpressurePolicy == BackpressurePolicy::DropNewest)
+    {
+        HOT_PATH_DEBUG() << "Event queue is full, the event was dropped";
+        statistics.dropped++;
+        *result = true;
+        return false;
+    }
+
+    if (extensions->backpressurePolicy == BackpressurePolicy::DropOldest)
+    {
+        // Drop the event at the front of the event queue (the replaced events are skipped)
+        while (!m_eventQueue.isEmpty())
+        {
+            const bool replaced = (m_eventQueue.front().id() == InvalidEventId);
+
+            markEventsTaken(1U);
+            m_eventQueue.popFront();
+
+            if (!replaced)
+            {
+                break;
+            }
+
+            m_replacedEventCount--;
+        }
+
+        HOT_PATH_DEBUG() << "Event queue is full, the oldest event was dropped";
+        statistics.dropped++;
+        return true;
+    }
+
+    // Block until the events are taken from the event queue or the state machine is stopped (the
+    // started mutex must not be held while waiting as it is needed to stop the state machine)
+    statistics.blocked++;
+    extensions->blockedProducerCount.fetch_add(1, std::memory_order_relaxed);
+    std::atomic_thread_fence(std::memory_order_seq_cst);
+    startedLocker->unlock();
+
+    QElapsedTimer timer;
+    timer.start();
+
+    bool canAdd = true;
+
+    while ((m_eventQueue.size() - m_replacedEventCount) >= extensions->eventQueueCapacity)
+    {
+        if (!m_started.load(std::memory_order_acquire))
+        {
+            canAdd = false;
+            break;
+        }
+
+        if (extensions->backpressureTimeout < 0)
+        {
+            extensions->eventQueueSpaceAvailable->wait(&m_eventQueueMutex);
+            continue;
+        }
+
+        const qint64 remaining = extensions->backpressureTimeout - timer.elapsed();
+
+        if (remaining <= 0)
+        {
+            HOT_PATH_DEBUG() << "Event queue is full, the event was rejected after a timeout";
+            statistics.rejected++;
+            canAdd = false;
+            break;
+        }
+
+        extensions->eventQueueSpaceAvailable->wait(&m_eventQueueMutex,
+                                                   static_cast<unsigned long>(remaining));
+    }
+
+    extensions->blockedProducerCount.fetch_sub(1, std::memory_order_relaxed);
+    startedLocker->relock();
+
+    // State machine could have been stopped while the producer was blocked
+    if (canAdd && (!m_started.load(std::memory_order_acquire)))
+    {
+        qCWarning(s_loggingCategory) << "Cannot add an event to a stopped state machine";
+        canAdd = false;
+    }
+
+    *result = false;
+    return canAdd;
+}
+
+// -------------------------------------------------------------------------------------------------
+
+bool StateMachineInstance::hasCoalescingPolicies() const
+{
+    const Extensions *extensions = m_extensions.load(std::memory_order_acquire);
+
+    if (extensions == nullptr)
+    {
+        return false;
+    }
+
+    return std::any_of(extensions->coalescingPolicies.begin(),
+                       extensions->coalescingPolicies.end(),
+                       [](const CoalescingPolicy policy)
+    {
+        return policy != CoalescingPolicy::None;
+    });
+}
+
+// -------------------------------------------------------------------------------------------------
+
+bool StateMachineInstance::hasPendingCoalescedEvent(const EventId eventId) const
+{
+    const Extensions *extensions = m_extensions.load(std::memory_order_acquire);
+
+    return ((extensions != nullptr) &&
+            (eventId < extensions->coalescedEventSequences.size()) &&
+            (extensions->coalescedEventSequences[eventId] >= 0));
+}
+
+// -------------------------------------------------------------------------------------------------
+
+bool StateMachineInstance::addCoalescedEvent(Event &event)
+{
+    Extensions *extensions = m_extensions.load(std::memory_order_acquire);
+    const EventId eventId = event.id();
+
+    if ((extensions == nullptr) ||
+        (eventId >= extensions->coalescingPolicies.size()) ||
+        (extensions->coalescingPolicies[eventId] == CoalescingPolicy::None))
+    {
+        return false;
+    }
+
+    // Replace the pending event (its sequence number is cleared when it is taken from the queue)
+    auto &sequence = extensions->coalescedEventSequences[eventId];
+
+    if (sequence >= 0)
+    {
+        auto &pendingEvent = m_eventQueue[static_cast<std::size_t>(sequence - m_eventQueueHead)];
+
+        if (extensions->coalescingPolicies[eventId] == CoalescingPolicy::ReplaceInPlace)
+        {
+            HOT_PATH_DEBUG() << "Replaced the pending event in the event queue:" << event.name();
+            pendingEvent = std::move(event);
+            return true;
+        }
+
+        // The pending event is only marked as replaced as it cannot be removed in constant time
+        pendingEvent = Event(InvalidEventId);
+        m_replacedEventCount++;
+    }
+
+    HOT_PATH_DEBUG() << "Added event to the back of the event queue:" << event.name();
+    sequence = m_eventQueueHead + static_cast<std::int64_t>(m_eventQueue.size());
+    m_eventQueue.pushBack(std::move(event));
+
+    // Keep the number of replaced events bounded by the number of pending events
+    if ((m_replacedEventCount > s_maxReplacedEventCount) &&
+        ((m_replacedEventCount * 2U) > m_eventQueue.size()))
+    {
+        compactEventQueue();
+    }
+
+    return true;
+}
+
+// -------------------------------------------------------------------------------------------------
+
+void StateMachineInstance::compactEventQueue()
+{
+    // Events are replaced only if they have a coalescing policy so the policies are already set
+    Extensions *extensions = m_extensions.load(std::memory_order_acquire);
+    auto &coalescedEventSequences = extensions->coalescedEventSequences;
+    std::size_t position = 0U;
+
+    for (std::size_t i = 0U; i < m_eventQueue.size(); i++)
+    {
+        const EventId eventId = m_eventQueue[i].id();
+
+        if (eventId == InvalidEventId)
+        {
+            continue;
+        }
+
+        // Update the sequence number of the moved pending coalesced event
+        if ((eventId < coalescedEventSequences.size()) &&
+            (coalescedEventSequences[eventId] ==
+             (m_eventQueueHead + static_cast<std::int64_t>(i))))
+        {
+            coalescedEventSequences[eventId] =
+                    m_eventQueueHead + static_cast<std::int64_t>(position);
+        }
+
+        if (position != i)
+        {
+            m_eventQueue[position] = std::move(m_eventQueue[i]);
+        }
+
+        position++;
+    }
+
+    m_eventQueue.popBack(m_eventQueue.size() - position);
+    m_replacedEventCount = 0U;
+}
+
+// -------------------------------------------------------------------------------------------------
+
+void StateMachineInstance::markEventsTaken(const std::size_t count)
+{
+    Extensions *extensions = m_extensions.load(std::memory_order_acquire);
+
+    if ((extensions != nullptr) && (!extensions->coalescingPolicies.empty()))
+    {
+        auto &coalescedEventSequences = extensions->coalescedEventSequences;
+
+        for (std::size_t i = 0U; i < count; i++)
+        {
+            const EventId eventId = m_eventQueue[i].id();
+
+            if ((eventId < coalescedEventSequences.size()) &&
+                (coalescedEventSequences[eventId] ==
+                 (m_eventQueueHead + static_cast<std::int64_t>(i))))
+            {
+                coalescedEventSequences[eventId] = -1;
+            }
+        }
+    }
+
+    m_eventQueueHead += static_cast<std::int64_t>(count);
+}
+
+// -------------------------------------------------------------------------------------------------
+
+void StateMachineInstance::clearEventQueue()
+{
+    m_eventQueue.clear();
+
+    for (auto &laneEvents : m_priorityLanes)
+    {
+        laneEvents.clear();
+    }
+
+    m_priorityLaneMask.store(0U, std::memory_order_release);
+    m_eventQueueHead = 0;
+    m_replacedEventCount = 0U;
+
+    Extensions *extensions = m_extensions.load(std::memory_order_acquire);
+
+    if (extensions != nullptr)
+    {
+        std::fill(extensions->coalescedEventSequences.begin(),
+                  extensions->coalescedEventSequences.end(),
+                  -1);
+    }
+}
+
+// -------------------------------------------------------------------------------------------------
+
+bool StateMachineInstance::replayJournal()
+{
+    Extensions *extensions = m_extensions.load(std::memory_order_acquire);
+    EventJournal *journal = extensions->journal.get();
+
+    if (!journal->isOpen())
+    {
+        qCWarning(s_loggingCategory) << "Journal is not open";
+        return false;
+    }
+
+    // Events that were left in the batch are replayed from the journal together with the rest
+    m_eventBatch.clear();
+
+    const std::uint64_t checkpoint = journal->checkpoint();
+    const std::uint64_t lastSequence = journal->lastSequence();
+
+    extensions->journalBase = checkpoint;
+    extensions->journalBatchEnd = checkpoint;
+    extensions->journalSequence = checkpoint;
+
+    // The replayed events are not appended to the journal again (they are not subject to the event
+    // queue capacity either)
+    const bool result = journal->replay(checkpoint + 1U,
+                                        [this](std::uint64_t, Event &&event)
+    {
+        m_eventQueue.pushBack(std::move(event));
+        return true;
+    });
+
+    // Sequence numbers of the events in the event queue are derived from their positions
+    if ((!result) || (m_eventQueue.size() != (lastSequence - checkpoint)))
+    {
+        qCWarning(s_loggingCategory) << "Failed to replay the journal";
+        clearEventQueue();
+        return false;
+    }
+
+    qCDebug(s_loggingCategory) << "Journaled events replayed:" << m_eventQueue.size();
+    return true;
+}
+
+// -------------------------------------------------------------------------------------------------
+
+void StateMachineInstance::wakeUpBlockedProducers()
+{
+    // Producers block only with the BackpressurePolicy::Block policy which creates the condition
+    Extensions *extensions = m_extensions.load(std::memory_order_acquire);
+
+    if ((extensions != nullptr) &&
+        (extensions->blockedProducerCount.load(std::memory_order_relaxed) > 0))
+    {
+        extensions->eventQueueSpaceAvailable->wakeAll();
+    }
+}
+
+// -------------------------------------------------------------------------------------------------
+
+void StateMachineInstance::notifyEventAdded()
+{
+    // A local copy keeps the notifier alive even if it is replaced while it is called
+    const auto eventNotifier = std::atomic_load(&m_eventNotifier);
+
+    if (eventNotifier)
+    {
+        (*eventNotifier)();
+    }
+
+    wakeUpWaiter();
+}
+
+// -------------------------------------------------------------------------------------------------
+
+void StateMachineInstance::wakeUpWaiter()
+{
+    // The fence pairs with the one in waitForEvents() so that either the waiter sees the change or
+    // the waiter count is seen here
+    std::atomic_thread_fence(std::memory_order_seq_cst);
+
+    if (m_waiterCount.load(std::memory_order_relaxed) == 0)
+    {
+        return;
+    }
+
+    QMutexLocker locker(&m_waitMutex);
+
+    if (m_eventsAvailable)
+    {
+        m_eventsAvailable->wakeAll();
+    }
+}
+
+// -------------------------------------------------------------------------------------------------
+
+bool StateMachineInstance::addPriorityEvent(Event &&event, const int priority, const bool toFront)
+{
+    QMutexLocker eventQueueLocker(&m_eventQueueMutex);
+    QMutexLocker startedLocker(startedMutex());
+
+    if (!checkNewEvent(event))
+    {
+        return false;
+    }
+
+    const int lane = priority - 1;
+
+    if (toFront)
+    {
+        HOT_PATH_DEBUG() << "Added event to the front of the event queue:" << event.name();
+        m_priorityLanes[lane].pushFront(std::move(event));
+    }
+    else
+    {
+        HOT_PATH_DEBUG() << "Added event with priority" << priority << "to the event queue:"
+                         << event.name();
+        m_priorityLanes[lane].pushBack(std::move(event));
+    }
+
+    m_priorityLaneMask.fetch_or(1U << lane, std::memory_order_release);
+    m_priorityEventCount.fetch_add(1, std::memory_order_release);
+
+    eventQueueLocker.unlock();
+    startedLocker.unlock();
+
+    notifyEventAdded();
+    return true;
+}
+
+// -------------------------------------------------------------------------------------------------
+
+bool StateMachineInstance::takeNextPriorityEvent(Event *event)
+{
+    const std::uint32_t mask = m_priorityLaneMask.load(std::memory_order_relaxed);
+
+    if (mask == 0U)
+    {
+        return false;
+    }
+
+    const int lane = s_highestPriorityLane[mask];
+    auto &laneEvents = m_priorityLanes[lane];
+
+    *event = std::move(laneEvents.front());
+    laneEvents.popFront();
+
+    if (laneEvents.isEmpty())
+    {
+        m_priorityLaneMask.fetch_and(~(1U << lane), std::memory_order_release);
+    }
+
+    return true;
+}
+
+// -------------------------------------------------------------------------------------------------
+
+bool StateMachineInstance::takeNextEvent(Event *event)
+{
+    if (m_lockFreeEventQueue)
+    {
+        // Events added to the front of the event queue are always processed first
+        if (!m_eventQueue.isEmpty())
+        {
+            *event = std::move(m_eventQueue.front());
+            m_eventQueue.popFront();
+            return true;
+        }
+
+        // The priority lanes are locked only if they contain any events
+        if (m_priorityLaneMask.load(std::memory_order_acquire) != 0U)
+        {
+            QMutexLocker locker(&m_eventQueueMutex);
+
+            if (takeNextPriorityEvent(event))
+            {
+                return true;
+            }
+        }
+
+        return m_lockFreeEventQueue->takeNext(event);
+    }
+
+    QMutexLocker locker(&m_eventQueueMutex);
+
+    if (takeNextPriorityEvent(event))
+    {
+        return true;
+    }
+
+    Extensions *extensions = m_extensions.load(std::memory_order_acquire);
+
+    while (!m_eventQueue.isEmpty())
+    {
+        markEventsTaken(1U);
+        *event = std::move(m_eventQueue.front());
+        m_eventQueue.popFront();
+
+        if ((extensions != nullptr) && extensions->journal)
+        {
+            extensions->journalSequence =
+                    extensions->journalBase + static_cast<std::uint64_t>(m_eventQueueHead);
+        }
+
+        // Skip the events that were replaced by coalesced events
+        if (event->id() != InvalidEventId)
+        {
+            wakeUpBlockedProducers();
+            return true;
+        }
+
+        m_replacedEventCount--;
+    }
+
+    return false;
+}
+
+// -------------------------------------------------------------------------------------------------
+
+bool StateMachineInstance::takeNextBatchedEvent(Event *event)
+{
+    if (m_lockFreeEventQueue)
+    {
+        // Events are already taken from the lock-free event queue without locking
+        return takeNextEvent(event);
+    }
+
+    Extensions *extensions = m_extensions.load(std::memory_order_acquire);
+    const bool journaled = ((extensions != nullptr) && extensions->journal);
+
+    // Events that were added to the front of the event queue or to the priority lanes while the
+    // batch was being processed must be processed before the rest of the batch
+    if ((!m_eventBatch.isEmpty()) && (m_priorityEventCount.load(std::memory_order_acquire) > 0))
+    {
+        returnEventBatch();
+    }
+
+    if (m_eventBatch.isEmpty())
+    {
+        // Take the next batch of events from the event queue (the events from the priority lanes
+        // are taken one at a time)
+        QMutexLocker locker(&m_eventQueueMutex);
+
+        m_priorityEventCount.store(0, std::memory_order_relaxed);
+
+        if (takeNextPriorityEvent(event))
+        {
+            return true;
+        }
+
+        while (m_eventBatch.isEmpty())
+        {
+            if (m_eventQueue.isEmpty())
+            {
+                return false;
+            }
+
+            if ((m_pollBatchSize == 0) ||
+                (m_eventQueue.size() <= static_cast<std::size_t>(m_pollBatchSize)))
+            {
+                // Take all of the pending events (the containers are swapped so that the memory of
+                // the empty batch is reused by the event queue)
+                markEventsTaken(m_eventQueue.size());
+                std::swap(m_eventBatch, m_eventQueue);
+            }
+            else
+            {
+                const auto batchSize = static_cast<std::size_t>(m_pollBatchSize);
+
+                markEventsTaken(batchSize);
+
+                for (std::size_t i = 0U; i < batchSize; i++)
+                {
+                    m_eventBatch.pushBack(std::move(m_eventQueue[i]));
+                }
+
+                m_eventQueue.popFront(batchSize);
+            }
+
+            // Remove the events that were replaced by coalesced events
+            if (m_replacedEventCount > 0U)
+            {
+                std::size_t position = 0U;
+
+                for (std::size_t i = 0U; i < m_eventBatch.size(); i++)
+                {
+                    if (m_eventBatch[i].id() == InvalidEventId)
+                    {
+                        m_replacedEventCount--;
+                        continue;
+                    }
+
+                    if (position != i)
+                    {
+                        m_eventBatch[position] = std::move(m_eventBatch[i]);
+                    }
+
+                    position++;
+                }
+
+                m_eventBatch.popBack(m_eventBatch.size() - position);
+            }
+        }
+
+        if (journaled)
+        {
+            extensions->journalBatchEnd =
+                    extensions->journalBase + static_cast<std::uint64_t>(m_eventQueueHead);
+        }
+
+        wakeUpBlockedProducers();
+    }
+
+    // Events in the batch are the last taken events
+    if (journaled)
+    {
+        extensions->journalSequence = extensions->journalBatchEnd - m_eventBatch.size() + 1U;
+    }
+
+    *event = std::move(m_eventBatch.front());
+    m_eventBatch.popFront();
+    return true;
+}
+
+// -------------------------------------------------------------------------------------------------
+
+void StateMachineInstance::returnEventBatch()
+{
+    if (m_eventBatch.isEmpty())
+    {
+        return;
+    }
+
+    // Put the events back to the front of the event queue (the events after the inserted events
+    // keep their sequence numbers)
+    QMutexLocker locker(&m_eventQueueMutex);
+
+    m_eventQueueHead -= static_cast<std::int64_t>(m_eventBatch.size());
+    m_eventQueue.insert(0U, m_eventBatch);
+    m_priorityEventCount.store(0, std::memory_order_relaxed);
+}
+
+// -------------------------------------------------------------------------------------------------
+
+void StateMachineInstance::forEachPendingEvent(
+        const Delegate<void(const Event &event, int priority)> &visitor)
+{
+    if (m_lockFreeEventQueue)
+    {
+        // Events added to the front of the event queue are processed before all other events, the
+        // same as the events added to the front of the highest priority lane
+        for (std::size_t i = 0U; i < m_eventQueue.size(); i++)
+        {
+            visitor(m_eventQueue[i], HighestEventPriority);
+        }
+    }
+
+    for (int lane = static_cast<int>(m_priorityLanes.size()) - 1; lane >= 0; lane--)
+    {
+        auto &laneEvents = m_priorityLanes[static_cast<std::size_t>(lane)];
+
+        for (std::size_t i = 0U; i < laneEvents.size(); i++)
+        {
+            visitor(laneEvents[i], lane + 1);
+        }
+    }
+
+    if (m_lockFreeEventQueue)
+    {
+        m_lockFreeEventQueue->forEach([&](const Event &event)
+        {
+            visitor(event, NormalEventPriority);
+        });
+        return;
+    }
+
+    for (std::size_t i = 0U; i < m_eventBatch.size(); i++)
+    {
+        visitor(m_eventBatch[i], NormalEventPriority);
+    }
+
+    // Skip the events that were replaced by coalesced events
+    for (std::size_t i = 0U; i < m_eventQueue.size(); i++)
+    {
+        if (m_eventQueue[i].id() != InvalidEventId)
+        {
+            visitor(m_eventQueue[i], NormalEventPriority);
+        }
+    }
+}
+
+// -------------------------------------------------------------------------------------------------
+
+bool StateMachineInstance::processEvent(Event &&event)
+{
+    // Check if the current state is valid
+    if (m_currentState < 0)
+    {
+        // This should not be possible as the current state is always set after startup
+        qCWarning(s_loggingCategory) << "Current state is invalid!";
+        return false;
+    }
+
+    // Optional features are checked only once if none of them is used
+    const Extensions *extensions = m_extensions.load(std::memory_order_acquire);
+    StateMachineMetrics *metrics = nullptr;
+    IStateMachineObserver *observer = nullptr;
+    std::uint64_t traceMachineId = 0U;
+
+    if (extensions != nullptr)
+    {
+        metrics = extensions->metrics.get();
+        observer = extensions->observer.get();
+        traceMachineId = extensions->traceMachineId;
+    }
+
+    if (observer != nullptr)
+    {
+        observer->onEventDequeued(*this, m_currentState, event.id());
+    }
+
+    // Start the flight recorder record
+    TraceRecorder::Record traceRecord;
+    TraceRecorder::Record *trace = nullptr;
+
+    if (traceMachineId != 0U)
+    {
+        trace = &traceRecord;
+        trace->machineId = traceMachineId;
+        trace->startTime = TraceRecorder::now();
+        trace->fromState = m_currentState;
+        trace->toState = -1;
+        trace->eventId = event.id();
+        trace->threadIndex = 0U;
+    }
+
+    // Check if a transition needs to be executed
+    const auto &transition = m_definition->findTransition(m_currentState, event.id());
+
+    if (transition.internalTransition != nullptr)
+    {
+        // Execute internal transition
+        executeInternalTransition(*transition.internalTransition, event, trace);
+    }
+    else if (transition.stateTransition != nullptr)
+    {
+        // Execute state transition
+        executeStateTransition(*transition.stateTransition, std::move(event), trace);
+    }
+    else
+    {
+        if (metrics != nullptr)
+        {
+            metrics->recordIgnoredEvent(m_currentState);
+        }
+
+        if (observer != nullptr)
+        {
+            observer->onIgnored(*this, m_currentState, event.id());
+        }
+
+        if (trace != nullptr)
+        {
+            trace->type = TraceRecorder::RecordType::Ignored;
+            trace->guardTime = trace->startTime;
+            trace->exitTime = trace->startTime;
+            trace->actionTime = trace->startTime;
+            trace->entryTime = trace->startTime;
+        }
+
+        HOT_PATH_DEBUG() << "No transitions for this event, ignore it:" << event.name();
+    }
+
+    if (trace != nullptr)
+    {
+        TraceRecorder::write(*trace);
+    }
+
+    HOT_PATH_DEBUG() << "Event processed";
+    return true;
+}
+
+// -------------------------------------------------------------------------------------------------
+
+void StateMachineInstance::executeInitialTransition(Event &&event)
+{
+    const auto &initialTransition = m_definition->initialTransition();
+    const auto &stateData = m_definition->state(initialTransition.state);
+
+    qCDebug(s_loggingCategory)
+            << QString("Transitioning to initial state [%1] with event [%2]...")
+               .arg(stateData.name, event.name());
+
+    // Execute transition's action
+    if (initialTransition.action)
+    {
+        qCDebug(s_loggingCategory) << "Executing initial transition's action...";
+        initialTransition.action(event, stateData.name);
+        qCDebug(s_loggingCategory) << "Initial transition's action executed";
+    }
+
+    // Execute the entry action of the initial state
+    const Extensions *extensions = m_extensions.load(std::memory_order_acquire);
+    StateMachineMetrics *metrics = (extensions != nullptr) ? extensions->metrics.get() : nullptr;
+    const auto entryStart = (metrics != nullptr) ? StateMachineMetrics::now()
+                                                 : StateMachineMetrics::TimePoint();
+
+    if (stateData.entryAction)
+    {
+        qCDebug(s_loggingCategory) << "Executing entry action...";
+        stateData.entryAction(event, stateData.name, QString());
+        qCDebug(s_loggingCategory) << "entry action executed";
+    }
+
+    if (metrics != nullptr)
+    {
+        metrics->recordEntry(initialTransition.state, entryStart);
+    }
+
+    IStateMachineObserver *observer = (extensions != nullptr) ? extensions->observer.get()
+                                                              : nullptr;
+
+    if (observer != nullptr)
+    {
+        observer->onEntry(*this, initialTransition.state, event.id());
+    }
+
+    // Transition to the initial state
+    m_currentState = initialTransition.state;
+    qCDebug(s_loggingCategory) << "Transitioned to initial state:" << stateData.name;
+
+    // Check if the initial state is also a final state
+    if (m_definition->isFinalState(initialTransition.state))
+    {
+        if (observer != nullptr)
+        {
+            observer->onFinal(*this, initialTransition.state, event.id());
+        }
+
+        // Store final event
+        m_finalEvent = std::make_unique<Event>(std::move(event));
+
+        qCDebug(s_loggingCategory) << "Transitioned to a final state";
+        stopInternal();
+    }
+}
+
+// -------------------------------------------------------------------------------------------------
+
+void StateMachineInstance::executeStateTransition(const StateTransitionData &transitionData,
+                                                  Event &&event,
+                                                  TraceRecorder::Record *trace)
+{
+    const auto &currentStateData = m_definition->state(m_currentState);
+    const auto &nextStateData = m_definition->state(transitionData.state);
+    Extensions *extensions = m_extensions.load(std::memory_order_acquire);
+    StateMachineMetrics *metrics = (extensions != nullptr) ? extensions->metrics.get() : nullptr;
+    IStateMachineObserver *observer = (extensions != nullptr) ? extensions->observer.get()
+                                                              : nullptr;
+
+    // Check if the transition is blocked by the guard condition
+    if (transitionData.guard)
+    {
+        if (!transitionData.guard(event, currentStateData.name, nextStateData.name))
+        {
+            if (metrics != nullptr)
+            {
+                metrics->recordGuardRejection(transitionData.index);
+            }
+
+            if (observer != nullptr)
+            {
+                observer->onGuardRejected(*this, transitionData.index, event.id());
+            }
+
+            if (trace != nullptr)
+            {
+                trace->type = TraceRecorder::RecordType::GuardRejected;
+                trace->toState = transitionData.state;
+                trace->guardTime = TraceRecorder::now();
+                trace->exitTime = trace->guardTime;
+                trace->actionTime = trace->guardTime;
+                trace->entryTime = trace->guardTime;
+            }
+
+            HOT_PATH_DEBUG()
+                    << QString("Transition from state [%1] with event [%2] to state [%3] was "
+                               "blocked by the guard condition")
+                       .arg(currentStateData.name, event.name(), nextStateData.name);
+            return;
+        }
+    }
+
+    HOT_PATH_DEBUG()
+            << QString("Transitioning from state [%1] with event [%2] to state [%3]...")
+               .arg(currentStateData.name, event.name(), nextStateData.name);
+
+    if (trace != nullptr)
+    {
+        trace->type = TraceRecorder::RecordType::StateTransition;
+        trace->toState = transitionData.state;
+        trace->guardTime = TraceRecorder::now();
+    }
+
+    // Execute the exit action of the current state
+    auto start = (metrics != nullptr) ? StateMachineMetrics::now()
+                                      : StateMachineMetrics::TimePoint();
+
+    if (currentStateData.exitAction)
+    {
+        HOT_PATH_DEBUG() << "Executing state's exit action...";
+        currentStateData.exitAction(event, currentStateData.name, nextStateData.name);
+        HOT_PATH_DEBUG() << "State's exit action executed";
+    }
+
+    if (metrics != nullptr)
+    {
+        metrics->recordExit(m_currentState, start);
+    }
+
+    if (observer != nullptr)
+    {
+        observer->onExit(*this, m_currentState, event.id());
+    }
+
+    if (trace != nullptr)
+    {
+        trace->exitTime = TraceRecorder::now();
+    }
+
+    // Cancel the state-scoped delayed events of the exited state (the state of the optional
+    // features is loaded again as the first delayed event could have created it meanwhile)
+    extensions = m_extensions.load(std::memory_order_acquire);
+
+    if ((extensions != nullptr) &&
+        extensions->stateTimersArmed.load(std::memory_order_relaxed) &&
+        extensions->stateTimersArmed.exchange(false, std::memory_order_relaxed))
+    {
+        extensions->activeTimerWheel.load(std::memory_order_acquire)->cancelStateTimers(this);
+    }
+
+    // Execute transition's action
+    if (metrics != nullptr)
+    {
+        start = StateMachineMetrics::now();
+    }
+
+    if (transitionData.action)
+    {
+        HOT_PATH_DEBUG() << "Executing state transition's action...";
+        transitionData.action(event, currentStateData.name, nextStateData.name);
+        HOT_PATH_DEBUG() << "State transition's action executed";
+    }
+
+    if (metrics != nullptr)
+    {
+        metrics->recordTransition(transitionData.index, start);
+    }
+
+    if (observer != nullptr)
+    {
+        observer->onTransition(*this, transitionData.index, event.id());
+    }
+
+    if (trace != nullptr)
+    {
+        trace->actionTime = TraceRecorder::now();
+    }
+
+    // Execute the entry action of the next state
+    if (metrics != nullptr)
+    {
+        start = StateMachineMetrics::now();
+    }
+
+    if (nextStateData.entryAction)
+    {
+        HOT_PATH_DEBUG() << "Executing entry action...";
+        nextStateData.entryAction(event, nextStateData.name, currentStateData.name);
+        HOT_PATH_DEBUG() << "entry action executed";
+    }
+
+    if (metrics != nullptr)
+    {
+        metrics->recordEntry(transitionData.state, start);
+    }
+
+    if (observer != nullptr)
+    {
+        observer->onEntry(*this, transitionData.state, event.id());
+    }
+
+    if (trace != nullptr)
+    {
+        trace->entryTime = TraceRecorder::now();
+    }
+
+    // Transition to the next state
+    m_currentState = transitionData.state;
+    HOT_PATH_DEBUG() << "Transitioned to state:" << nextStateData.name;
+
+    // Check if the state machine transitioned to a final state
+    if (m_definition->isFinalState(transitionData.state))
+    {
+        if (observer != nullptr)
+        {
+            observer->onFinal(*this, transitionData.state, event.id());
+        }
+
+        // Store final event
+        m_finalEvent = std::make_unique<Event>(std::move(event));
+
+        HOT_PATH_DEBUG() << "Transitioned to a final state";
+        stopInternal();
+    }
+}
+
+// -------------------------------------------------------------------------------------------------
+
+void StateMachineInstance::executeInternalTransition(
+        const InternalTransitionData &transitionData,
+        const Event &event,
+        TraceRecorder::Record *trace)
+{
+    const auto &currentStateName = m_definition->state(m_currentState).name;
+    const Extensions *extensions = m_extensions.load(std::memory_order_acquire);
+    StateMachineMetrics *metrics = (extensions != nullptr) ? extensions->metrics.get() : nullptr;
+    IStateMachineObserver *observer = (extensions != nullptr) ? extensions->observer.get()
+                                                              : nullptr;
+
+    // Check if the transition is blocked by the guard condition
+    if (transitionData.guard)
+    {
+        if (!transitionData.guard(event, currentStateName))
+        {
+            if (metrics != nullptr)
+            {
+                metrics->recordGuardRejection(transitionData.index);
+            }
+
+            if (observer != nullptr)
+            {
+                observer->onGuardRejected(*this, transitionData.index, event.id());
+            }
+
+            if (trace != nullptr)
+            {
+                trace->type = TraceRecorder::RecordType::GuardRejected;
+                trace->guardTime = TraceRecorder::now();
+                trace->exitTime = trace->guardTime;
+                trace->actionTime = trace->guardTime;
+                trace->entryTime = trace->guardTime;
+            }
+
+            HOT_PATH_DEBUG()
+                    << QString("Internal transition of state [%1] with event [%2] was blocked by "
+                               "the guard condition")
+                       .arg(currentStateName, event.name());
+            return;
+        }
+    }
+
+    HOT_PATH_DEBUG()
+            << QString("Executing internal transition of state [%1] with event [%2]...")
+               .arg(currentStateName, event.name());
+
+    if (trace != nullptr)
+    {
+        trace->type = TraceRecorder::RecordType::InternalTransition;
+        trace->guardTime = TraceRecorder::now();
+        trace->exitTime = trace->guardTime;
+    }
+
+    // Execute transition's action
+    const auto start = (metrics != nullptr) ? StateMachineMetrics::now()
+                                            : StateMachineMetrics::TimePoint();
+
+    HOT_PATH_DEBUG() << "Executing state transition's action...";
+    transitionData.action(event, currentStateName);
+    HOT_PATH_DEBUG() << "State transition's action executed";
+
+    if (metrics != nullptr)
+    {
+        metrics->recordTransition(transitionData.index, start);
+    }
+
+    if (observer != nullptr)
+    {
+        observer->onTransition(*this, transitionData.index, event.id());
+    }
+
+    if (trace != nullptr)
+    {
+        trace->actionTime = TraceRecorder::now();
+        trace->entryTime = trace->actionTime;
+    }
+
+    HOT_PATH_DEBUG() << "Transition finished";
+}
+
+} // namespace CppStateMachineFramework
@@ -0,0 +1,412 @@
+/* This file is part of C++ State Machine Framework.
+ *
+ * C++ State Machine Framework is free software: you can redistribute it and/or modify it under the
+ * terms of the GNU Lesser General Public License as published by the Free Software Foundation,
+ * either version 3 of the License, or (at your option) any later version.
+ *
+ * C++ State Machine Framework is distributed in the hope that it will be useful, but WITHOUT ANY
+ * WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR
+ * PURPOSE. See the GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License along with C++ State
+ * Machine Framework. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+/*!
+ * \file
+ *
+ * Contains the runtime metrics of a state machine instance
+ */
+
+// Own header
+#include <CppStateMachineFramework/StateMachineMetrics.hpp>
+
+// C++ State Machine Framework includes
+#include <CppStateMachineFramework/EventNameRegistry.hpp>
+
+// Qt includes
+#include <QtCore/QJsonArray>
+
+// System includes
+#include <algorithm>
+#include <cmath>
+#include <limits>
+
+// Forward declarations
+
+// Macros
+
+// -------------------------------------------------------------------------------------------------
+
+namespace CppStateMachineFramework
+{
+
+constexpr int LatencyHistogram::BucketCount;
+constexpr int LatencyHistogram::SubBucketBits;
+constexpr std::uint64_t LatencyHistogram::SubBucketCount;
+constexpr int LatencyHistogram::MinExponent;
+constexpr int LatencyHistogram::MaxExponent;
+constexpr std::uint64_t LatencyHistogram::LinearBucketCount;
+
+// -------------------------------------------------------------------------------------------------
+
+double LatencyHistogram::Snapshot::mean() const
+{
+    if (count == 0U)
+    {
+        return 0.0;
+    }
+
+    return static_cast<double>(sum) / static_cast<double>(count);
+}
+
+// -------------------------------------------------------------------------------------------------
+
+std::uint64_t LatencyHistogram::Snapshot::percentile(const double percentile) const
+{
+    if ((count == 0U) || buckets.empty())
+    {
+        return 0U;
+    }
+
+    // Rank of the latency at the percentile (at least the first recorded latency)
+    const double clamped = std::min(std::max(percentile, 0.0), 100.0);
+    const auto rank = std::max<std::uint64_t>(
+                          static_cast<std::uint64_t>(
+                              std::ceil((clamped / 100.0) * static_cast<double>(count))),
+                          1U);
+
+    std::uint64_t total = 0U;
+
+    for (std::size_t index = 0; index < buckets.size(); index++)
+    {
+        total += buckets[index];
+
+        if (total >= rank)
+        {
+            return std::min(bucketUpperBound(static_cast<int>(index)), max);
+        }
+    }
+
+    return max;
+}
+
+// -------------------------------------------------------------------------------------------------
+
+QJsonObject LatencyHistogram::Snapshot::toJson() const
+{
+    return QJsonObject
+    {
+        { "count", static_cast<double>(count) },
+        { "sum", static_cast<double>(sum) },
+        { "mean", mean() },
+        { "max", static_cast<double>(max) },
+        { "p50", static_cast<double>(percentile(50.0)) },
+        { "p90", static_cast<double>(percentile(90.0)) },
+        { "p99", static_cast<double>(percentile(99.0)) },
+        { "p999", static_cast<double>(percentile(99.9)) }
+    };
+}
+
+// -------------------------------------------------------------------------------------------------
+
+LatencyHistogram::LatencyHistogram()
+{
+    reset();
+}
+
+// -------------------------------------------------------------------------------------------------
+
+LatencyHistogram::Snapshot LatencyHistogram::snapshot() const
+{
+    Snapshot result;
+    result.count = m_count.load(std::memory_order_relaxed);
+
+    if (result.count == 0U)
+    {
+        return result;
+    }
+
+    // The count and the sum are taken from the buckets so that they are consistent with each other
+    // even if a latency is being recorded concurrently
+    result.buckets.resize(static_cast<std::size_t>(BucketCount));
+    result.count = 0U;
+
+    for (std::size_t index = 0; index < result.buckets.size(); index++)
+    {
+        result.buckets[index] = m_buckets[index].load(std::memory_order_relaxed);
+        result.count += result.buckets[index];
+    }
+
+    result.sum = m_sum.load(std::memory_order_relaxed);
+    result.max = m_max.load(std::memory_order_relaxed);
+    return result;
+}
+
+// -------------------------------------------------------------------------------------------------
+
+void LatencyHistogram::reset()
+{
+    for (auto &bucket : m_buckets)
+    {
+        bucket.store(0U, std::memory_order_relaxed);
+    }
+
+    m_count.store(0U, std::memory_order_relaxed);
+    m_sum.store(0U, std::memory_order_relaxed);
+    m_max.store(0U, std::memory_order_relaxed);
+}
+
+// -------------------------------------------------------------------------------------------------
+
+std::uint64_t LatencyHistogram::bucketUpperBound(const int index)
+{
+    if (index < static_cast<int>(LinearBucketCount))
+    {
+        return static_cast<std::uint64_t>(std::max(index, 0));
+    }
+
+    if (index >= (BucketCount - 1))
+    {
+        return std::numeric_limits<std::uint64_t>::max();
+    }
+
+    const int offset = index - static_cast<int>(LinearBucketCount);
+    const int exponent = MinExponent + (offset / static_cast<int>(SubBucketCount));
+    const auto subBucket = static_cast<std::uint64_t>(offset % static_cast<int>(SubBucketCount));
+    const int subBucketShift = exponent - SubBucketBits;
+
+    return (static_cast<std::uint64_t>(1U) << static_cast<unsigned>(exponent)) +
+            ((subBucket + 1U) << static_cast<unsigned>(subBucketShift)) - 1U;
+}
+
+// -------------------------------------------------------------------------------------------------
+
+QJsonObject StateMachineMetrics::Snapshot::toJson() const
+{
+    QJsonArray statesJson;
+
+    for (const auto &state : states)
+    {
+        QJsonObject stateJson
+        {
+            { "name", state.name },
+            { "entered", static_cast<double>(state.entered) },
+            { "exited", static_cast<double>(state.exited) },
+            { "ignoredEvents", static_cast<double>(state.ignoredEvents) }
+        };
+
+        if (state.entryActionLatency.count > 0U)
+        {
+            stateJson.insert("entryActionLatency", state.entryActionLatency.toJson());
+        }
+
+        if (state.exitActionLatency.count > 0U)
+        {
+            stateJson.insert("exitActionLatency", state.exitActionLatency.toJson());
+        }
+
+        statesJson.append(stateJson);
+    }
+
+    QJsonArray transitionsJson;
+
+    for (const auto &transition : transitions)
+    {
+        QJsonObject transitionJson
+        {
+            { "fromState", transition.fromState },
+            { "trigger", transition.trigger },
+            { "toState", transition.toState },
+            { "fired", static_cast<double>(transition.fired) },
+            { "guardRejected", static_cast<double>(transition.guardRejected) }
+        };
+
+        if (transition.actionLatency.count > 0U)
+        {
+            transitionJson.insert("actionLatency", transition.actionLatency.toJson());
+        }
+
+        transitionsJson.append(transitionJson);
+    }
+
+    return QJsonObject
+    {
+        { "states", statesJson },
+        { "transitions", transitionsJson }
+    };
+}
+
+// -------------------------------------------------------------------------------------------------
+
+StateMachineMetrics::StateMachineMetrics(std::shared_ptr<const StateMachineDefinition> definition)
+    : m_definition(std::move(definition)),
+      m_histogramCount(0)
+{
+    const int stateCount = m_definition->stateCount();
+    const int transitionCount = m_definition->transitionCount();
+
+    // Count the actions so that the histograms can be allocated at once
+    for (int stateIndex = 0; stateIndex < stateCount; stateIndex++)
+    {
+        const auto &stateData = m_definition->state(stateIndex);
+        m_histogramCount += (stateData.entryAction ? 1 : 0) + (stateData.exitAction ? 1 : 0);
+    }
+
+    for (int transitionIndex = 0; transitionIndex < transitionCount; transitionIndex++)
+    {
+        const auto &info = m_definition->transitionInfo(transitionIndex);
+
+        // Internal transitions always have an action, state transitions only optionally
+        if (info.toState < 0)
+        {
+            m_histogramCount++;
+            continue;
+        }
+
+        const auto &stateData = m_definition->state(info.fromState);
+        const auto *transitionData = (info.trigger == InvalidEventId)
+                                     ? stateData.defaultStateTransition.get()
+                                     : &stateData.stateTransitions.at(info.trigger);
+
+        m_histogramCount += (transitionData->action ? 1 : 0);
+    }
+
+    m_states = std::make_unique<StateCounters[]>(static_cast<std::size_t>(stateCount));
+    m_transitions =
+            std::make_unique<TransitionCounters[]>(static_cast<std::size_t>(transitionCount));
+    m_histograms = std::make_unique<LatencyHistogram[]>(static_cast<std::size_t>(m_histogramCount));
+
+    // Assign the histograms
+    int histogramIndex = 0;
+
+    auto takeHistogram = [this, &histogramIndex](const bool hasAction) -> LatencyHistogram *
+    {
+        if (!hasAction)
+        {
+            return nullptr;
+        }
+
+        LatencyHistogram *histogram = &m_histograms[static_cast<std::size_t>(histogramIndex)];
+        histogramIndex++;
+        return histogram;
+    };
+
+    for (int stateIndex = 0; stateIndex < stateCount; stateIndex++)
+    {
+        const auto &stateData = m_definition->state(stateIndex);
+        auto &state = m_states[static_cast<std::size_t>(stateIndex)];
+
+        state.entryActionLatency = takeHistogram(static_cast<bool>(stateData.entryAction));
+        state.exitActionLatency = takeHistogram(static_cast<bool>(stateData.exitAction));
+    }
+
+    for (int transitionIndex = 0; transitionIndex < transitionCount; transitionIndex++)
+    {
+        const auto &info = m_definition->transitionInfo(transitionIndex);
+        bool hasAction = true;
+
+        if (info.toState >= 0)
+        {
+            const auto &stateData = m_definition->state(info.fromState);
+            hasAction = static_cast<bool>((info.trigger == InvalidEventId)
+                                          ? stateData.defaultStateTransition->action
+                                          : stateData.stateTransitions.at(info.trigger).action);
+        }
+
+        m_transitions[static_cast<std::size_t>(transitionIndex)].actionLatency =
+                takeHistogram(hasAction);
+    }
+
+    reset();
+}
+
+// -------------------------------------------------------------------------------------------------
+
+StateMachineMetrics::Snapshot StateMachineMetrics::snapshot() const
+{
+    Snapshot result;
+    const int stateCount = m_definition->stateCount();
+    const int transitionCount = m_definition->transitionCount();
+
+    result.states.resize(static_cast<std::size_t>(stateCount));
+    result.transitions.resize(static_cast<std::size_t>(transitionCount));
+
+    for (int stateIndex = 0; stateIndex < stateCount; stateIndex++)
+    {
+        const auto &state = m_states[static_cast<std::size_t>(stateIndex)];
+        auto &stateMetrics = result.states[static_cast<std::size_t>(stateIndex)];
+
+        stateMetrics.name = m_definition->state(stateIndex).name;
+        stateMetrics.entered = state.entered.load(std::memory_order_relaxed);
+        stateMetrics.exited = state.exited.load(std::memory_order_relaxed);
+        stateMetrics.ignoredEvents = state.ignoredEvents.load(std::memory_order_relaxed);
+
+        if (state.entryActionLatency != nullptr)
+        {
+            stateMetrics.entryActionLatency = state.entryActionLatency->snapshot();
+        }
+
+        if (state.exitActionLatency != nullptr)
+        {
+            stateMetrics.exitActionLatency = state.exitActionLatency->snapshot();
+        }
+    }
+
+    for (int transitionIndex = 0; transitionIndex < transitionCount; transitionIndex++)
+    {
+        const auto &info = m_definition->transitionInfo(transitionIndex);
+        const auto &transition = m_transitions[static_cast<std::size_t>(transitionIndex)];
+        auto &transitionMetrics = result.transitions[static_cast<std::size_t>(transitionIndex)];
+
+        transitionMetrics.fromState = m_definition->state(info.fromState).name;
+
+        if (info.trigger != InvalidEventId)
+        {
+            transitionMetrics.trigger = EventNameRegistry::name(info.trigger);
+        }
+
+        if (info.toState >= 0)
+        {
+            transitionMetrics.toState = m_definition->state(info.toState).name;
+        }
+
+        transitionMetrics.fired = transition.fired.load(std::memory_order_relaxed);
+        transitionMetrics.guardRejected = transition.guardRejected.load(std::memory_order_relaxed);
+
+        if (transition.actionLatency != nullptr)
+        {
+            transitionMetrics.actionLatency = transition.actionLatency->snapshot();
+        }
+    }
+
+    return result;
+}
+
+// -------------------------------------------------------------------------------------------------
+
+void StateMachineMetrics::reset()
+{
+    const auto stateCount = static_cast<std::size_t>(m_definition->stateCount());
+    const auto transitionCount = static_cast<std::size_t>(m_definition->transitionCount());
+
+    for (std::size_t index = 0; index < stateCount; index++)
+    {
+        m_states[index].entered.store(0U, std::memory_order_relaxed);
+        m_states[index].exited.store(0U, std::memory_order_relaxed);
+        m_states[index].ignoredEvents.store(0U, std::memory_order_relaxed);
+    }
+
+    for (std::size_t index = 0; index < transitionCount; index++)
+    {
+        m_transitions[index].fired.store(0U, std::memory_order_relaxed);
+        m_transitions[index].guardRejected.store(0U, std::memory_order_relaxed);
+    }
+
+    for (std::size_t index = 0; index < static_cast<std::size_t>(m_histogramCount); index++)
+    {
+        m_histograms[index].reset();
+    }
+}
+
+} // namespace CppStateMachineFramework
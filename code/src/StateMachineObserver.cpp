@@ -0,0 +1,79 @@
+/* This file is part of C++ State Machine Framework.
+ *
+ * C++ State Machine Framework is free software: you can redistribute it and/or modify it under the
+ * terms of the GNU Lesser General Public License as published by the Free Software Foundation,
+ * either version 3 of the License, or (at your option) any later version.
+ *
+ * C++ State Machine Framework is distributed in the hope that it will be useful, but WITHOUT ANY
+ * WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR
+ * PURPOSE. See the GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License along with C++ State
+ * Machine Framework. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+/*!
+ * \file
+ *
+ * Contains an interface for observing the event processing of a state machine instance
+ */
+
+// Own header
+#include <CppStateMachineFramework/StateMachineObserver.hpp>
+
+// C++ State Machine Framework includes
+
+// Qt includes
+
+// System includes
+
+// Forward declarations
+
+// Macros
+
+// -------------------------------------------------------------------------------------------------
+
+namespace CppStateMachineFramework
+{
+
+void IStateMachineObserver::onEventDequeued(const StateMachineInstance &, int, EventId)
+{
+}
+
+// -------------------------------------------------------------------------------------------------
+
+void IStateMachineObserver::onGuardRejected(const StateMachineInstance &, int, EventId)
+{
+}
+
+// -------------------------------------------------------------------------------------------------
+
+void IStateMachineObserver::onExit(const StateMachineInstance &, int, EventId)
+{
+}
+
+// -------------------------------------------------------------------------------------------------
+
+void IStateMachineObserver::onTransition(const StateMachineInstance &, int, EventId)
+{
+}
+
+// -------------------------------------------------------------------------------------------------
+
+void IStateMachineObserver::onEntry(const StateMachineInstance &, int, EventId)
+{
+}
+
+// -------------------------------------------------------------------------------------------------
+
+void IStateMachineObserver::onFinal(const StateMachineInstance &, int, EventId)
+{
+}
+
+// -------------------------------------------------------------------------------------------------
+
+void IStateMachineObserver::onIgnored(const StateMachineInstance &, int, EventId)
+{
+}
+
+} // namespace CppStateMachineFramework
@@ -0,0 +1,727 @@
+/* This file is part of C++ State Machine Framework.
+ *
+ * C++ State Machine Framework is free software: you can redistribute it and/or modify it under the
+ * terms of the GNU Lesser General Public License as published by the Free Software Foundation,
+ * either version 3 of the License, or (at your option) any later version.
+ *
+ * C++ State Machine Framework is distributed in the hope that it will be useful, but WITHOUT ANY
+ * WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR
+ * PURPOSE. See the GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License along with C++ State
+ * Machine Framework. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+/*!
+ * \file
+ *
+ * Contains a hierarchical timing wheel that adds delayed events to state machine instances
+ */
+
+// Own header
+#include <CppStateMachineFramework/TimerWheel.hpp>
+
+// C++ State Machine Framework includes
+#include <CppStateMachineFramework/StateMachineInstance.hpp>
+
+// Qt includes
+#include <QtCore/QLoggingCategory>
+
+// System includes
+#include <algorithm>
+
+// Forward declarations
+
+// Macros
+
+// -------------------------------------------------------------------------------------------------
+
+//! Logging category for the timing wheel
+static const QLoggingCategory s_loggingCategory("CppStateMachineFramework.TimerWheel",
+                                                QtWarningMsg);
+
+// -------------------------------------------------------------------------------------------------
+
+/*!
+ * Gets the number of trailing zero bits
+ *
+ * \param   value   Value (must not be zero)
+ *
+ * \return  Number of trailing zero bits
+ */
+static int countTrailingZeros(std::uint64_t value)
+{
+    int count = 0;
+
+    while ((value & 0xFFU) == 0U)
+    {
+        value >>= 8U;
+        count += 8;
+    }
+
+    while ((value & 1U) == 0U)
+    {
+        value >>= 1U;
+        count++;
+    }
+
+    return count;
+}
+
+// -------------------------------------------------------------------------------------------------
+
+namespace CppStateMachineFramework
+{
+
+constexpr int TimerWheel::DefaultTickInterval;
+constexpr int TimerWheel::LevelCount;
+constexpr int TimerWheel::SlotBits;
+constexpr int TimerWheel::SlotCount;
+
+// -------------------------------------------------------------------------------------------------
+
+TimerWheel::Timer::Timer()
+    : event(InvalidEventId),
+      instance(nullptr),
+      expiry(0),
+      generation(0U),
+      priority(0),
+      state(TimerState::Free),
+      stateScoped(false),
+      slot(-1),
+      previous(-1),
+      next(-1),
+      previousOfInstance(-1),
+      nextOfInstance(-1)
+{
+}
+
+// -------------------------------------------------------------------------------------------------
+
+TimerWheel::TimerWheel(const int tickInterval)
+    : m_tickInterval(std::max(1, tickInterval)),
+      m_currentTick(0),
+      m_freeTimer(-1),
+      m_timerCount(0),
+      m_slotMasks(),
+      m_deliveringInstance(nullptr),
+      m_wakeUpTick(-1),
+      m_running(false)
+{
+    m_clock.start();
+}
+
+// -------------------------------------------------------------------------------------------------
+
+TimerWheel::~TimerWheel()
+{
+    if (m_running.load(std::memory_order_acquire))
+    {
+        stop();
+    }
+}
+
+// -------------------------------------------------------------------------------------------------
+
+std::shared_ptr<TimerWheel> TimerWheel::defaultTimerWheel()
+{
+    static const std::shared_ptr<TimerWheel> timerWheel = []()
+    {
+        auto defaultTimerWheel = std::make_shared<TimerWheel>();
+        defaultTimerWheel->start();
+        return defaultTimerWheel;
+    }();
+
+    return timerWheel;
+}
+
+// -------------------------------------------------------------------------------------------------
+
+int TimerWheel::tickInterval() const
+{
+    return m_tickInterval;
+}
+
+// -------------------------------------------------------------------------------------------------
+
+bool TimerWheel::isRunning() const
+{
+    return m_running.load(std::memory_order_acquire);
+}
+
+// -------------------------------------------------------------------------------------------------
+
+bool TimerWheel::start()
+{
+    QMutexLocker locker(&m_apiMutex);
+
+    if (m_running.load(std::memory_order_acquire))
+    {
+        qCWarning(s_loggingCategory) << "Timing wheel is already running";
+        return false;
+    }
+
+    m_running.store(true, std::memory_order_release);
+    m_thread = std::thread([this]() { run(); });
+
+    qCDebug(s_loggingCategory) << "Timing wheel started";
+    return true;
+}
+
+// -------------------------------------------------------------------------------------------------
+
+bool TimerWheel::stop()
+{
+    QMutexLocker locker(&m_apiMutex);
+
+    if (!m_running.load(std::memory_order_acquire))
+    {
+        qCWarning(s_loggingCategory) << "Timing wheel is already stopped";
+        return false;
+    }
+
+    {
+        QMutexLocker timersLocker(&m_mutex);
+        m_running.store(false, std::memory_order_release);
+        m_wakeUp.wakeAll();
+    }
+
+    m_thread.join();
+
+    qCDebug(s_loggingCategory) << "Timing wheel stopped";
+    return true;
+}
+
+// -------------------------------------------------------------------------------------------------
+
+int TimerWheel::timerCount() const
+{
+    QMutexLocker locker(&m_mutex);
+
+    return m_timerCount;
+}
+
+// -------------------------------------------------------------------------------------------------
+
+bool TimerWheel::isTimerActive(const TimerId timerId) const
+{
+    QMutexLocker locker(&m_mutex);
+
+    return (timerIndex(timerId) >= 0);
+}
+
+// -------------------------------------------------------------------------------------------------
+
+TimerId TimerWheel::addTimer(StateMachineInstance *instance,
+                             const int delay,
+                             Event &&event,
+                             const int priority,
+                             const bool stateScoped)
+{
+    if (instance == nullptr)
+    {
+        qCWarning(s_loggingCategory) << "Attempted to add a timer without an instance";
+        return InvalidTimerId;
+    }
+
+    if (delay < 0)
+    {
+        qCWarning(s_loggingCategory) << "Attempted to add a timer with a negative delay:" << delay;
+        return InvalidTimerId;
+    }
+
+    if (event.id() == InvalidEventId)
+    {
+        qCWarning(s_loggingCategory) << "Attempted to add a timer with an empty event name";
+        return InvalidTimerId;
+    }
+
+    QMutexLocker locker(&m_mutex);
+
+    // Take a free timer
+    int index = m_freeTimer;
+
+    if (index < 0)
+    {
+        m_timers.emplace_back();
+        index = static_cast<int>(m_timers.size()) - 1;
+    }
+    else
+    {
+        m_freeTimer = m_timers[static_cast<std::size_t>(index)].next;
+    }
+
+    // The current tick of the timing wheel can lag behind the time while the worker thread sleeps,
+    // that only puts the timer in a higher level. An extra tick makes sure that the timer never
+    // expires before the delay has elapsed.
+    auto &timer = m_timers[static_cast<std::size_t>(index)];
+    timer.event = std::move(event);
+    timer.instance = instance;
+    timer.expiry = currentTick() + ((delay + m_tickInterval - 1) / m_tickInterval) + 1;
+    timer.priority = priority;
+    timer.state = TimerState::Scheduled;
+    timer.stateScoped = stateScoped;
+
+    schedule(index);
+    appendToList(&m_instanceTimers[instance],
+                 index,
+                 &Timer::previousOfInstance,
+                 &Timer::nextOfInstance);
+    m_timerCount++;
+
+    // Wake up the worker thread if the timer expires before the worker thread wakes up
+    if (m_running.load(std::memory_order_acquire) &&
+        ((m_wakeUpTick < 0) || (timer.expiry < m_wakeUpTick)))
+    {
+        m_wakeUp.wakeAll();
+    }
+
+    return timerId(index);
+}
+
+// -------------------------------------------------------------------------------------------------
+
+bool TimerWheel::cancelTimer(const TimerId timerId)
+{
+    QMutexLocker locker(&m_mutex);
+
+    const int index = timerIndex(timerId);
+
+    if (index < 0)
+    {
+        return false;
+    }
+
+    cancel(index);
+    return true;
+}
+
+// -------------------------------------------------------------------------------------------------
+
+void TimerWheel::cancelTimers(StateMachineInstance *instance)
+{
+    QMutexLocker locker(&m_mutex);
+
+    auto it = m_instanceTimers.find(instance);
+
+    if (it != m_instanceTimers.end())
+    {
+        while (it->second.first >= 0)
+        {
+            cancel(it->second.first);
+        }
+
+        m_instanceTimers.erase(it);
+    }
+
+    // Wait until the event that is being added to the instance is added (unless it is added by the
+    // current thread, for example from an event notifier)
+    while ((m_deliveringInstance == instance) &&
+           (m_deliveringThread != std::this_thread::get_id()))
+    {
+        m_deliveryFinished.wait(&m_mutex);
+    }
+}
+
+// -------------------------------------------------------------------------------------------------
+
+void TimerWheel::cancelStateTimers(StateMachineInstance *instance)
+{
+    QMutexLocker locker(&m_mutex);
+
+    auto it = m_instanceTimers.find(instance);
+
+    if (it == m_instanceTimers.end())
+    {
+        return;
+    }
+
+    int index = it->second.first;
+
+    while (index >= 0)
+    {
+        const int next = m_timers[static_cast<std::size_t>(index)].nextOfInstance;
+
+        if (m_timers[static_cast<std::size_t>(index)].stateScoped)
+        {
+            cancel(index);
+        }
+
+        index = next;
+    }
+
+    while ((m_deliveringInstance == instance) &&
+           (m_deliveringThread != std::this_thread::get_id()))
+    {
+        m_deliveryFinished.wait(&m_mutex);
+    }
+}
+
+// -------------------------------------------------------------------------------------------------
+
+int TimerWheel::processTimers()
+{
+    QMutexLocker apiLocker(&m_apiMutex);
+
+    if (m_running.load(std::memory_order_acquire))
+    {
+        qCWarning(s_loggingCategory)
+                << "Timers cannot be processed manually while the timing wheel is running";
+        return 0;
+    }
+
+    QMutexLocker locker(&m_mutex);
+
+    advance(currentTick());
+    return deliverExpiredTimers(&locker);
+}
+
+// -------------------------------------------------------------------------------------------------
+
+std::int64_t TimerWheel::currentTick() const
+{
+    return m_clock.elapsed() / m_tickInterval;
+}
+
+// -------------------------------------------------------------------------------------------------
+
+TimerId TimerWheel::timerId(const int index) const
+{
+    return ((static_cast<TimerId>(m_timers[static_cast<std::size_t>(index)].generation) << 32U) |
+            (static_cast<TimerId>(index) + 1U));
+}
+
+// -------------------------------------------------------------------------------------------------
+
+int TimerWheel::timerIndex(const TimerId timerId) const
+{
+    const TimerId indexPart = (timerId & 0xFFFFFFFFU);
+
+    if ((indexPart == 0U) || (indexPart > m_timers.size()))
+    {
+        return -1;
+    }
+
+    const auto index = static_cast<std::size_t>(indexPart - 1U);
+    const auto &timer = m_timers[index];
+
+    if ((timer.state == TimerState::Free) ||
+        (timer.generation != static_cast<std::uint32_t>(timerId >> 32U)))
+    {
+        return -1;
+    }
+
+    return static_cast<int>(index);
+}
+
+// -------------------------------------------------------------------------------------------------
+
+void TimerWheel::appendToList(TimerList *list,
+                              const int index,
+                              int Timer::*previous,
+                              int Timer::*next)
+{
+    auto &timer = m_timers[static_cast<std::size_t>(index)];
+    timer.*previous = list->last;
+    timer.*next = -1;
+
+    if (list->last < 0)
+    {
+        list->first = index;
+    }
+    else
+    {
+        m_timers[static_cast<std::size_t>(list->last)].*next = index;
+    }
+
+    list->last = index;
+}
+
+// -------------------------------------------------------------------------------------------------
+
+void TimerWheel::removeFromList(TimerList *list,
+                                const int index,
+                                int Timer::*previous,
+                                int Timer::*next)
+{
+    auto &timer = m_timers[static_cast<std::size_t>(index)];
+
+    if (timer.*previous < 0)
+    {
+        list->first = timer.*next;
+    }
+    else
+    {
+        m_timers[static_cast<std::size_t>(timer.*previous)].*next = timer.*next;
+    }
+
+    if (timer.*next < 0)
+    {
+        list->last = timer.*previous;
+    }
+    else
+    {
+        m_timers[static_cast<std::size_t>(timer.*next)].*previous = timer.*previous;
+    }
+
+    timer.*previous = -1;
+    timer.*next = -1;
+}
+
+// -------------------------------------------------------------------------------------------------
+
+void TimerWheel::schedule(const int index)
+{
+    auto &timer = m_timers[static_cast<std::size_t>(index)];
+
+    // Timers beyond the range of the highest level are put in its farthest slot and rescheduled
+    // when that slot is processed
+    const std::int64_t range = (static_cast<std::int64_t>(1) << (SlotBits * LevelCount));
+    const std::int64_t expiry = std::min(timer.expiry, m_currentTick + range - 1);
+    const std::int64_t delta = expiry - m_currentTick;
+
+    int level = 0;
+
+    while ((level < (LevelCount - 1)) &&
+           (delta >= (static_cast<std::int64_t>(1) << (SlotBits * (level + 1)))))
+    {
+        level++;
+    }
+
+    const int slotIndex = static_cast<int>((expiry >> (SlotBits * level)) & (SlotCount - 1));
+
+    timer.slot = (level * SlotCount) + slotIndex;
+    appendToList(&m_slots[static_cast<std::size_t>(timer.slot)],
+                 index,
+                 &Timer::previous,
+                 &Timer::next);
+    m_slotMasks[static_cast<std::size_t>(level)] |= (static_cast<std::uint64_t>(1U) << slotIndex);
+}
+
+// -------------------------------------------------------------------------------------------------
+
+void TimerWheel::cancel(const int index)
+{
+    auto &timer = m_timers[static_cast<std::size_t>(index)];
+
+    if (timer.state == TimerState::Scheduled)
+    {
+        auto &slot = m_slots[static_cast<std::size_t>(timer.slot)];
+        removeFromList(&slot, index, &Timer::previous, &Timer::next);
+
+        if (slot.first < 0)
+        {
+            m_slotMasks[static_cast<std::size_t>(timer.slot / SlotCount)] &=
+                    ~(static_cast<std::uint64_t>(1U) << (timer.slot % SlotCount));
+        }
+    }
+    else
+    {
+        removeFromList(&m_expiredTimers, index, &Timer::previous, &Timer::next);
+    }
+
+    release(index);
+}
+
+// -------------------------------------------------------------------------------------------------
+
+void TimerWheel::release(const int index)
+{
+    auto &timer = m_timers[static_cast<std::size_t>(index)];
+
+    removeFromList(&m_instanceTimers[timer.instance],
+                   index,
+                   &Timer::previousOfInstance,
+                   &Timer::nextOfInstance);
+
+    // The event is replaced so that its parameter is destroyed immediately and the new generation
+    // invalidates the ID of the timer
+    timer.event = Event(InvalidEventId);
+    timer.instance = nullptr;
+    timer.generation++;
+    timer.state = TimerState::Free;
+    timer.slot = -1;
+    timer.next = m_freeTimer;
+    m_freeTimer = index;
+    m_timerCount--;
+}
+
+// -------------------------------------------------------------------------------------------------
+
+std::int64_t TimerWheel::nextTick() const
+{
+    std::int64_t result = -1;
+
+    for (int level = 0; level < LevelCount; level++)
+    {
+        const std::uint64_t mask = m_slotMasks[static_cast<std::size_t>(level)];
+
+        if (mask == 0U)
+        {
+            continue;
+        }
+
+        // First tick after the current tick at which the slots of the level are processed and the
+        // distance from its slot to the next slot that is not empty
+        const int shift = SlotBits * level;
+        const std::int64_t base = ((m_currentTick >> shift) + 1) << shift;
+        const int baseSlot = static_cast<int>((base >> shift) & (SlotCount - 1));
+        const std::uint64_t rotatedMask =
+                (mask >> baseSlot) | (mask << ((SlotCount - baseSlot) & (SlotCount - 1)));
+        const std::int64_t tick =
+                base + (static_cast<std::int64_t>(countTrailingZeros(rotatedMask)) << shift);
+
+        if ((result < 0) || (tick < result))
+        {
+            result = tick;
+        }
+    }
+
+    return result;
+}
+
+// -------------------------------------------------------------------------------------------------
+
+void TimerWheel::advance(const std::int64_t tick)
+{
+    // Only the ticks at which a slot that is not empty is due are processed
+    std::int64_t next = nextTick();
+
+    while ((next >= 0) && (next <= tick))
+    {
+        processTick(next);
+        next = nextTick();
+    }
+
+    m_currentTick = std::max(m_currentTick, tick);
+}
+
+// -------------------------------------------------------------------------------------------------
+
+void TimerWheel::processTick(const std::int64_t tick)
+{
+    m_currentTick = tick;
+
+    // Move the timers from the due slots of the higher levels to the lower levels (a level is due
+    // when the slot index of the level below it wraps around)
+    if ((tick & (SlotCount - 1)) == 0)
+    {
+        for (int level = 1; level < LevelCount; level++)
+        {
+            const int slotIndex = static_cast<int>((tick >> (SlotBits * level)) & (SlotCount - 1));
+            const auto slotPosition = static_cast<std::size_t>((level * SlotCount) + slotIndex);
+            int index = m_slots[slotPosition].first;
+
+            m_slots[slotPosition] = TimerList();
+            m_slotMasks[static_cast<std::size_t>(level)] &=
+                    ~(static_cast<std::uint64_t>(1U) << slotIndex);
+
+            while (index >= 0)
+            {
+                const int next = m_timers[static_cast<std::size_t>(index)].next;
+                schedule(index);
+                index = next;
+            }
+
+            if (slotIndex != 0)
+            {
+                break;
+            }
+        }
+    }
+
+    // Expire the timers in the due slot of the lowest level
+    const int slotIndex = static_cast<int>(tick & (SlotCount - 1));
+    int index = m_slots[static_cast<std::size_t>(slotIndex)].first;
+
+    m_slots[static_cast<std::size_t>(slotIndex)] = TimerList();
+    m_slotMasks[0] &= ~(static_cast<std::uint64_t>(1U) << slotIndex);
+
+    while (index >= 0)
+    {
+        auto &timer = m_timers[static_cast<std::size_t>(index)];
+        const int next = timer.next;
+
+        timer.state = TimerState::Expired;
+        timer.slot = -1;
+        appendToList(&m_expiredTimers, index, &Timer::previous, &Timer::next);
+        index = next;
+    }
+}
+
+// -------------------------------------------------------------------------------------------------
+
+int TimerWheel::deliverExpiredTimers(QMutexLocker *locker)
+{
+    int count = 0;
+
+    while (m_expiredTimers.first >= 0)
+    {
+        const int index = m_expiredTimers.first;
+        auto &timer = m_timers[static_cast<std::size_t>(index)];
+
+        StateMachineInstance *instance = timer.instance;
+        const int priority = timer.priority;
+        Event event(std::move(timer.event));
+
+        removeFromList(&m_expiredTimers, index, &Timer::previous, &Timer::next);
+        release(index);
+
+        // The event is added without holding the mutex so that the instance can arm and cancel
+        // timers, the instance is marked so that it is not destroyed in the meantime
+        m_deliveringInstance = instance;
+        m_deliveringThread = std::this_thread::get_id();
+        locker->unlock();
+
+        if (instance->addDelayedEvent(std::move(event), priority))
+        {
+            count++;
+        }
+
+        locker->relock();
+        m_deliveringInstance = nullptr;
+        m_deliveringThread = std::thread::id();
+        m_deliveryFinished.wakeAll();
+    }
+
+    return count;
+}
+
+// -------------------------------------------------------------------------------------------------
+
+void TimerWheel::run()
+{
+    QMutexLocker locker(&m_mutex);
+
+    while (m_running.load(std::memory_order_acquire))
+    {
+        advance(currentTick());
+
+        if (m_expiredTimers.first >= 0)
+        {
+            deliverExpiredTimers(&locker);
+            continue;
+        }
+
+        // Sleep until the next slot is due or until a timer that expires earlier is added
+        m_wakeUpTick = nextTick();
+
+        if (m_wakeUpTick < 0)
+        {
+            m_wakeUp.wait(&m_mutex);
+        }
+        else
+        {
+            const qint64 remaining = (m_wakeUpTick * m_tickInterval) - m_clock.elapsed();
+
+            if (remaining > 0)
+            {
+                m_wakeUp.wait(&m_mutex, static_cast<unsigned long>(remaining));
+            }
+        }
+
+        m_wakeUpTick = -1;
+    }
+}
+
+} // namespace CppStateMachineFramework
@@ -0,0 +1,597 @@
+/* This file is part of C++ State Machine Framework.
+ *
+ * C++ State Machine Framework is free software: you can redistribute it and/or modify it under the
+ * terms of the GNU Lesser General Public License as published by the Free Software Foundation,
+ * either version 3 of the License, or (at your option) any later version.
+ *
+ * C++ State Machine Framework is distributed in the hope that it will be useful, but WITHOUT ANY
+ * WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR
+ * PURPOSE. See the GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License along with C++ State
+ * Machine Framework. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+/*!
+ * \file
+ *
+ * Contains a process-wide flight recorder of the processed events
+ */
+
+// Own header
+#include <CppStateMachineFramework/TraceRecorder.hpp>
+
+// C++ State Machine Framework includes
+
+// Qt includes
+#include <QtCore/QJsonArray>
+#include <QtCore/QJsonDocument>
+#include <QtCore/QJsonObject>
+#include <QtCore/QLoggingCategory>
+#include <QtCore/QMutex>
+
+// System includes
+#include <algorithm>
+#include <atomic>
+#include <cstring>
+#include <limits>
+#include <memory>
+
+// Forward declarations
+
+// Macros
+
+// -------------------------------------------------------------------------------------------------
+
+//! Logging category for the trace recorder
+static const QLoggingCategory s_loggingCategory("CppStateMachineFramework.TraceRecorder",
+                                                QtWarningMsg);
+
+//! Magic bytes at the start of a binary dump
+static const char s_dumpMagic[8] = { 'C', 'S', 'M', 'F', 'T', 'R', 'C', 'E' };
+
+//! Version of the binary dump format
+static const std::uint32_t s_dumpVersion = 1U;
+
+// -------------------------------------------------------------------------------------------------
+
+namespace CppStateMachineFramework
+{
+
+constexpr int TraceRecorder::DefaultCapacity;
+constexpr int TraceRecorder::MaxExitedThreadCount;
+
+// -------------------------------------------------------------------------------------------------
+
+/*!
+ * Holds the ring buffer of records of a single thread
+ *
+ * The ring buffer has a single writer (its thread). Each slot is guarded by a sequence number
+ * (odd while the slot is written) so that a reader can detect and skip the records that were
+ * overwritten while they were copied.
+ */
+class TraceRingBuffer
+{
+public:
+    //! Constructor
+    TraceRingBuffer(const int capacity, const std::uint16_t threadIndex)
+        : m_slots(std::make_unique<Slot[]>(static_cast<std::size_t>(capacity))),
+          m_mask(static_cast<std::uint64_t>(capacity) - 1U),
+          m_threadIndex(threadIndex),
+          m_head(0U),
+          m_tail(0U)
+    {
+        for (std::uint64_t index = 0U; index <= m_mask; index++)
+        {
+            m_slots[index].sequence.store(0U, std::memory_order_relaxed);
+        }
+    }
+
+    //! Writes the record
+    void write(const TraceRecorder::Record &record)
+    {
+        const std::uint64_t position = m_head.load(std::memory_order_relaxed);
+        Slot &slot = m_slots[position & m_mask];
+
+        slot.sequence.store((position * 2U) + 1U, std::memory_order_relaxed);
+        std::atomic_thread_fence(std::memory_order_release);
+
+        slot.record = record;
+        slot.record.threadIndex = m_threadIndex;
+
+        slot.sequence.store((position * 2U) + 2U, std::memory_order_release);
+        m_head.store(position + 1U, std::memory_order_release);
+    }
+
+    //! Copies the records to the container
+    void dump(std::vector<TraceRecorder::Record> *records) const
+    {
+        const std::uint64_t head = m_head.load(std::memory_order_acquire);
+        const std::uint64_t capacity = m_mask + 1U;
+        std::uint64_t position = m_tail.load(std::memory_order_acquire);
+
+        if ((head - position) > capacity)
+        {
+            position = head - capacity;
+        }
+
+        for (; position < head; position++)
+        {
+            const Slot &slot = m_slots[position & m_mask];
+            const std::uint64_t sequence = slot.sequence.load(std::memory_order_acquire);
+
+            if (sequence != ((position * 2U) + 2U))
+            {
+                continue;
+            }
+
+            TraceRecorder::Record record = slot.record;
+            std::atomic_thread_fence(std::memory_order_acquire);
+
+            if (slot.sequence.load(std::memory_order_relaxed) == sequence)
+            {
+                records->push_back(record);
+            }
+        }
+    }
+
+    //! Discards the records
+    void clear()
+    {
+        m_tail.store(m_head.load(std::memory_order_acquire), std::memory_order_release);
+    }
+
+    //! Gets the thread index
+    std::uint16_t threadIndex() const
+    {
+        return m_threadIndex;
+    }
+
+private:
+    //! Holds a slot of the ring buffer
+    struct Slot
+    {
+        //! Holds the sequence number of the slot
+        std::atomic<std::uint64_t> sequence;
+
+        //! Holds the record
+        TraceRecorder::Record record;
+    };
+
+private:
+    //! Holds the slots
+    std::unique_ptr<Slot[]> m_slots;
+
+    //! Holds the mask used to get the slot of a position
+    const std::uint64_t m_mask;
+
+    //! Holds the thread index
+    const std::uint16_t m_threadIndex;
+
+    //! Holds the position of the next record
+    std::atomic<std::uint64_t> m_head;
+
+    //! Holds the position of the first record that was not discarded
+    std::atomic<std::uint64_t> m_tail;
+};
+
+// -------------------------------------------------------------------------------------------------
+
+//! Holds the ring buffer of the current thread
+static thread_local TraceRingBuffer *s_threadBuffer = nullptr;
+
+//! Flag indicating that the ring buffer of the current thread was retired (the thread is exiting)
+static thread_local bool s_threadBufferRetired = false;
+
+// -------------------------------------------------------------------------------------------------
+
+/*!
+ * Retires the ring buffer of the current thread when the thread exits
+ */
+class TraceThreadBufferOwner
+{
+public:
+    //! Destructor
+    ~TraceThreadBufferOwner();
+};
+
+// -------------------------------------------------------------------------------------------------
+
+/*!
+ * Holds the ring buffers of all threads
+ */
+class TraceStorage
+{
+public:
+    //! Constructor
+    TraceStorage()
+        : m_capacity(TraceRecorder::DefaultCapacity),
+          m_nextThreadIndex(0U)
+    {
+    }
+
+    //! Gets the storage instance
+    static TraceStorage &instance()
+    {
+        static TraceStorage storage;
+        return storage;
+    }
+
+    //! Gets the ring buffer of the current thread (it is created on first use, nullptr if the
+    //! thread is exiting)
+    TraceRingBuffer *threadBuffer()
+    {
+        if (s_threadBuffer != nullptr)
+        {
+            return s_threadBuffer;
+        }
+
+        if (s_threadBufferRetired)
+        {
+            return nullptr;
+        }
+
+        // The owner is constructed on first use so that it is destroyed when the thread exits
+        static thread_local TraceThreadBufferOwner s_owner;
+        static_cast<void>(s_owner);
+
+        QMutexLocker locker(&m_mutex);
+        std::uint16_t threadIndex = 0U;
+
+        if (m_freeThreadIndexes.empty())
+        {
+            // Thread indexes wrap around only if 65536 ring buffers are held at the same time
+            threadIndex = m_nextThreadIndex++;
+        }
+        else
+        {
+            threadIndex = m_freeThreadIndexes.back();
+            m_freeThreadIndexes.pop_back();
+        }
+
+        m_buffers.push_back(std::make_unique<TraceRingBuffer>(
+                                m_capacity.load(std::memory_order_relaxed), threadIndex));
+        s_threadBuffer = m_buffers.back().get();
+        return s_threadBuffer;
+    }
+
+    //! Retires the ring buffer of an exited thread (the oldest ones are freed above the limit)
+    void retire(TraceRingBuffer *buffer)
+    {
+        QMutexLocker locker(&m_mutex);
+
+        m_exitedBuffers.push_back(buffer);
+
+        if (m_exitedBuffers.size() > static_cast<std::size_t>(TraceRecorder::MaxExitedThreadCount))
+        {
+            freeBuffer(m_exitedBuffers.front());
+            m_exitedBuffers.erase(m_exitedBuffers.begin());
+        }
+    }
+
+    //! Gets the capacity of the new ring buffers
+    int capacity() const
+    {
+        return m_capacity.load(std::memory_order_relaxed);
+    }
+
+    //! Sets the capacity of the new ring buffers
+    void setCapacity(const int capacity)
+    {
+        m_capacity.store(capacity, std::memory_order_relaxed);
+    }
+
+    //! Copies the records of all ring buffers
+    std::vector<TraceRecorder::Record> dump()
+    {
+        std::vector<TraceRecorder::Record> records;
+        QMutexLocker locker(&m_mutex);
+
+        for (const auto &buffer : m_buffers)
+        {
+            buffer->dump(&records);
+        }
+
+        return records;
+    }
+
+    //! Discards the records of all ring buffers and frees the ring buffers of the exited threads
+    void clear()
+    {
+        QMutexLocker locker(&m_mutex);
+
+        for (const auto &buffer : m_buffers)
+        {
+            buffer->clear();
+        }
+
+        for (auto *buffer : m_exitedBuffers)
+        {
+            freeBuffer(buffer);
+        }
+
+        m_exitedBuffers.clear();
+    }
+
+private:
+    //! Frees the ring buffer and releases its thread index (the mutex must be locked)
+    void freeBuffer(TraceRingBuffer *buffer)
+    {
+        auto it = std::find_if(m_buffers.begin(),
+                               m_buffers.end(),
+                               [buffer](const std::unique_ptr<TraceRingBuffer> &item)
+        {
+            return (item.get() == buffer);
+        });
+
+        m_freeThreadIndexes.push_back(buffer->threadIndex());
+        m_buffers.erase(it);
+    }
+
+private:
+    //! Holds the mutex used to make access to the ring buffers thread safe
+    QMutex m_mutex;
+
+    //! Holds the ring buffers of all threads
+    std::vector<std::unique_ptr<TraceRingBuffer>> m_buffers;
+
+    //! Holds the ring buffers of the exited threads (the oldest first)
+    std::vector<TraceRingBuffer *> m_exitedBuffers;
+
+    //! Holds the thread indexes of the freed ring buffers
+    std::vector<std::uint16_t> m_freeThreadIndexes;
+
+    //! Holds the capacity of the new ring buffers
+    std::atomic<int> m_capacity;
+
+    //! Holds the thread index of the next ring buffer if there are no free thread indexes
+    std::uint16_t m_nextThreadIndex;
+};
+
+// -------------------------------------------------------------------------------------------------
+
+TraceThreadBufferOwner::~TraceThreadBufferOwner()
+{
+    if (s_threadBuffer != nullptr)
+    {
+        TraceStorage::instance().retire(s_threadBuffer);
+        s_threadBuffer = nullptr;
+    }
+
+    s_threadBufferRetired = true;
+}
+
+// -------------------------------------------------------------------------------------------------
+
+int TraceRecorder::capacity()
+{
+    return TraceStorage::instance().capacity();
+}
+
+// -------------------------------------------------------------------------------------------------
+
+bool TraceRecorder::setCapacity(const int capacity)
+{
+    if (capacity <= 0)
+    {
+        qCWarning(s_loggingCategory) << "Invalid trace recorder capacity:" << capacity;
+        return false;
+    }
+
+    int roundedCapacity = 1;
+
+    while ((roundedCapacity < capacity) &&
+           (roundedCapacity <= (std::numeric_limits<int>::max() / 2)))
+    {
+        roundedCapacity *= 2;
+    }
+
+    TraceStorage::instance().setCapacity(roundedCapacity);
+    return true;
+}
+
+// -------------------------------------------------------------------------------------------------
+
+void TraceRecorder::write(const Record &record)
+{
+    auto *buffer = TraceStorage::instance().threadBuffer();
+
+    // Records written while the thread is exiting are dropped as its ring buffer was retired
+    if (buffer != nullptr)
+    {
+        buffer->write(record);
+    }
+}
+
+// -------------------------------------------------------------------------------------------------
+
+std::vector<TraceRecorder::Record> TraceRecorder::dump()
+{
+    auto records = TraceStorage::instance().dump();
+
+    std::stable_sort(records.begin(),
+                     records.end(),
+                     [](const Record &left, const Record &right)
+    {
+        return (left.startTime < right.startTime);
+    });
+
+    return records;
+}
+
+// -------------------------------------------------------------------------------------------------
+
+void TraceRecorder::clear()
+{
+    TraceStorage::instance().clear();
+}
+
+// -------------------------------------------------------------------------------------------------
+
+QByteArray TraceRecorder::serialize(const std::vector<Record> &records)
+{
+    const std::uint32_t recordSize = sizeof(Record);
+    const auto recordCount = static_cast<std::uint64_t>(records.size());
+
+    QByteArray data;
+    data.reserve(static_cast<int>(sizeof(s_dumpMagic) + (2U * sizeof(std::uint32_t)) +
+                                  sizeof(std::uint64_t) + (records.size() * sizeof(Record))));
+
+    data.append(s_dumpMagic, static_cast<int>(sizeof(s_dumpMagic)));
+    data.append(reinterpret_cast<const char *>(&s_dumpVersion),
+                static_cast<int>(sizeof(s_dumpVersion)));
+    data.append(reinterpret_cast<const char *>(&recordSize), static_cast<int>(sizeof(recordSize)));
+    data.append(reinterpret_cast<const char *>(&recordCount),
+                static_cast<int>(sizeof(recordCount)));
+
+    if (!records.empty())
+    {
+        data.append(reinterpret_cast<const char *>(records.data()),
+                    static_cast<int>(records.size() * sizeof(Record)));
+    }
+
+    return data;
+}
+
+// -------------------------------------------------------------------------------------------------
+
+bool TraceRecorder::deserialize(const QByteArray &data, std::vector<Record> *records)
+{
+    const std::size_t headerSize =
+            sizeof(s_dumpMagic) + (2U * sizeof(std::uint32_t)) + sizeof(std::uint64_t);
+    const auto dataSize = static_cast<std::size_t>(data.size());
+
+    if ((records == nullptr) || (dataSize < headerSize) ||
+        (std::memcmp(data.constData(), s_dumpMagic, sizeof(s_dumpMagic)) != 0))
+    {
+        qCWarning(s_loggingCategory) << "Invalid trace dump header";
+        return false;
+    }
+
+    const char *position = data.constData() + sizeof(s_dumpMagic);
+    std::uint32_t version = 0U;
+    std::uint32_t recordSize = 0U;
+    std::uint64_t recordCount = 0U;
+
+    std::memcpy(&version, position, sizeof(version));
+    position += sizeof(version);
+    std::memcpy(&recordSize, position, sizeof(recordSize));
+    position += sizeof(recordSize);
+    std::memcpy(&recordCount, position, sizeof(recordCount));
+    position += sizeof(recordCount);
+
+    if ((version != s_dumpVersion) || (recordSize != sizeof(Record)))
+    {
+        qCWarning(s_loggingCategory) << "Unsupported trace dump version:" << version;
+        return false;
+    }
+
+    if (recordCount > ((dataSize - headerSize) / sizeof(Record)))
+    {
+        qCWarning(s_loggingCategory) << "Truncated trace dump";
+        return false;
+    }
+
+    records->resize(static_cast<std::size_t>(recordCount));
+
+    if (recordCount > 0U)
+    {
+        std::memcpy(records->data(), position, records->size() * sizeof(Record));
+    }
+
+    return true;
+}
+
+// -------------------------------------------------------------------------------------------------
+
+QByteArray TraceRecorder::toChromeTrace(const std::vector<Record> &records)
+{
+    QJsonArray traceEvents;
+
+    if (records.empty())
+    {
+        return QJsonDocument(QJsonObject { { "traceEvents", traceEvents } })
+                .toJson(QJsonDocument::Compact);
+    }
+
+    // Timestamps are exported in microseconds relative to the first record
+    std::int64_t origin = records.front().startTime;
+
+    for (const auto &record : records)
+    {
+        origin = std::min(origin, record.startTime);
+    }
+
+    auto addSlice = [&](const Record &record,
+                        const QString &name,
+                        const std::int64_t begin,
+                        const std::int64_t end,
+                        const QJsonObject &args)
+    {
+        QJsonObject slice
+        {
+            { "name", name },
+            { "ph", "X" },
+            { "ts", static_cast<double>(begin - origin) / 1000.0 },
+            { "dur", static_cast<double>(std::max<std::int64_t>(end - begin, 0)) / 1000.0 },
+            { "pid", static_cast<double>(record.machineId) },
+            { "tid", static_cast<int>(record.threadIndex) }
+        };
+
+        if (!args.isEmpty())
+        {
+            slice.insert("args", args);
+        }
+
+        traceEvents.append(slice);
+    };
+
+    for (const auto &record : records)
+    {
+        QString eventName = EventNameRegistry::name(record.eventId);
+
+        if (eventName.isEmpty())
+        {
+            eventName = QString("event #%1").arg(record.eventId);
+        }
+
+        static const char *const s_typeNames[] =
+        {
+            "StateTransition", "InternalTransition", "GuardRejected", "Ignored"
+        };
+
+        const auto typeIndex = static_cast<std::size_t>(record.type);
+
+        QJsonObject args
+        {
+            { "type", (typeIndex < 4U) ? s_typeNames[typeIndex] : "Unknown" },
+            { "eventId", static_cast<double>(record.eventId) },
+            { "fromState", record.fromState },
+            { "toState", record.toState }
+        };
+
+        addSlice(record, eventName, record.startTime, record.entryTime, args);
+
+        if (record.type == RecordType::StateTransition)
+        {
+            addSlice(record, "guard", record.startTime, record.guardTime, {});
+            addSlice(record, "exit", record.guardTime, record.exitTime, {});
+            addSlice(record, "action", record.exitTime, record.actionTime, {});
+            addSlice(record, "entry", record.actionTime, record.entryTime, {});
+        }
+        else if (record.type == RecordType::InternalTransition)
+        {
+            addSlice(record, "guard", record.startTime, record.guardTime, {});
+            addSlice(record, "action", record.guardTime, record.actionTime, {});
+        }
+        else if (record.type == RecordType::GuardRejected)
+        {
+            addSlice(record, "guard", record.startTime, record.guardTime, {});
+        }
+    }
+
+    return QJsonDocument(QJsonObject { { "traceEvents", traceEvents } })
+            .toJson(QJsonDocument::Compact);
+}
+
+} // namespace CppStateMachineFramework
@@ -0,0 +1,189 @@
+/* This file is part of C++ State Machine Framework.
+ *
+ * C++ State Machine Framework is free software: you can redistribute it and/or modify it under the
+ * terms of the GNU Lesser General Public License as published by the Free Software Foundation,
+ * either version 3 of the License, or (at your option) any later version.
+ *
+ * C++ State Machine Framework is distributed in the hope that it will be useful, but WITHOUT ANY
+ * WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR
+ * PURPOSE. See the GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License along with C++ State
+ * Machine Framework. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+/*!
+ * \file
+ *
+ * Contains benchmarks for the Event class
+ */
+
+// C++ State Machine Framework includes
+#include <CppStateMachineFramework/Event.hpp>
+
+// Qt includes
+#include <QtCore/QDebug>
+#include <QtCore/QElapsedTimer>
+#include <QtTest/QTest>
+
+// System includes
+
+// Forward declarations
+
+// Macros
+
+// Benchmark class declaration ---------------------------------------------------------------------
+
+using namespace CppStateMachineFramework;
+
+//! Number of events created in each benchmark iteration
+static const int s_eventCount = 100000;
+
+static const QString s_eventName("benchmark_event");
+
+class BenchmarkEvent : public QObject
+{
+    Q_OBJECT
+
+private slots:
+    // Functions executed by QtTest before and after test suite
+    void initTestCase();
+    void cleanupTestCase();
+
+    // Functions executed by QtTest before and after each test
+    void init();
+    void cleanup();
+
+    // Benchmark functions
+    void benchmarkEventFromName();
+    void benchmarkEventFromNameWithParameter();
+    void benchmarkEventFromId();
+    void benchmarkEventFromIdWithParameter();
+    void benchmarkEventFromIdWithInlineParameter();
+
+private:
+    template<typename Function>
+    void runBenchmark(Function function);
+};
+
+// Test Case init/cleanup methods ------------------------------------------------------------------
+
+void BenchmarkEvent::initTestCase()
+{
+    EventNameRegistry::registerName(s_eventName);
+}
+
+void BenchmarkEvent::cleanupTestCase()
+{
+}
+
+// Test init/cleanup methods -----------------------------------------------------------------------
+
+void BenchmarkEvent::init()
+{
+}
+
+void BenchmarkEvent::cleanup()
+{
+}
+
+// Benchmark: Event created from a name ------------------------------------------------------------
+
+void BenchmarkEvent::benchmarkEventFromName()
+{
+    runBenchmark([]()
+    {
+        Event event(s_eventName);
+        return event.id();
+    });
+}
+
+// Benchmark: Event created from a name with a parameter -------------------------------------------
+
+void BenchmarkEvent::benchmarkEventFromNameWithParameter()
+{
+    runBenchmark([]()
+    {
+        Event event(s_eventName, EventParameter<int>::create(42));
+        return event.id();
+    });
+}
+
+// Benchmark: Event created from an ID -------------------------------------------------------------
+
+void BenchmarkEvent::benchmarkEventFromId()
+{
+    const EventId eventId = EventNameRegistry::id(s_eventName);
+
+    runBenchmark([eventId]()
+    {
+        Event event(eventId);
+        return event.id();
+    });
+}
+
+// Benchmark: Event created from an ID with a parameter --------------------------------------------
+
+void BenchmarkEvent::benchmarkEventFromIdWithParameter()
+{
+    const EventId eventId = EventNameRegistry::id(s_eventName);
+
+    runBenchmark([eventId]()
+    {
+        Event event(eventId, EventParameter<int>::create(42));
+        return event.id();
+    });
+}
+
+// Benchmark: Event created from an ID with an inline parameter ------------------------------------
+
+void BenchmarkEvent::benchmarkEventFromIdWithInlineParameter()
+{
+    const EventId eventId = EventNameRegistry::id(s_eventName);
+
+    runBenchmark([eventId]()
+    {
+        Event event(eventId, EventParameter<int>(42));
+        return event.id();
+    });
+}
+
+// Helper methods ----------------------------------------------------------------------------------
+
+/*!
+ * Runs the benchmark and reports the time per event and the throughput
+ *
+ * \param   function    Function that creates a single event and returns its ID
+ */
+template<typename Function>
+void BenchmarkEvent::runBenchmark(Function function)
+{
+    QElapsedTimer timer;
+    qint64 elapsed = 0;
+    qint64 iterations = 0;
+    EventId checksum = 0U;
+
+    QBENCHMARK
+    {
+        timer.start();
+
+        for (int i = 0; i < s_eventCount; i++)
+        {
+            checksum += function();
+        }
+
+        elapsed += timer.nsecsElapsed();
+        iterations++;
+    }
+
+    QVERIFY(checksum != 0U);
+
+    const double nsPerEvent =
+            static_cast<double>(elapsed) / static_cast<double>(iterations * s_eventCount);
+    qInfo() << "ns/event:" << nsPerEvent << "events/s:" << (1.0e9 / nsPerEvent);
+}
+
+// Main function -----------------------------------------------------------------------------------
+
+QTEST_MAIN(BenchmarkEvent)
+#include "benchmarkEvent.moc"
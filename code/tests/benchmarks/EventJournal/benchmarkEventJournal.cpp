@@ -0,0 +1,266 @@
+/* This file is part of C++ State Machine Framework.
+ *
+ * C++ State Machine Framework is free software: you can redistribute it and/or modify it under the
+ * terms of the GNU Lesser General Public License as published by the Free Software Foundation,
+ * either version 3 of the License, or (at your option) any later version.
+ *
+ * C++ State Machine Framework is distributed in the hope that it will be useful, but WITHOUT ANY
+ * WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR
+ * PURPOSE. See the GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License along with C++ State
+ * Machine Framework. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+/*!
+ * \file
+ *
+ * Contains benchmarks for the EventJournal class
+ */
+
+// C++ State Machine Framework includes
+#include <CppStateMachineFramework/EventJournal.hpp>
+#include <CppStateMachineFramework/StateMachineInstance.hpp>
+
+// Qt includes
+#include <QtCore/QDebug>
+#include <QtCore/QElapsedTimer>
+#include <QtCore/QTemporaryDir>
+#include <QtTest/QTest>
+
+// System includes
+
+// Forward declarations
+
+// Macros
+
+// Benchmark class declaration ---------------------------------------------------------------------
+
+using namespace CppStateMachineFramework;
+
+//! Number of events appended in each benchmark iteration
+static const int s_eventCount = 1000000;
+
+//! Size of the segment files (small enough that the events are spread over several segments)
+static const qint64 s_segmentSize = 8 * 1024 * 1024;
+
+class BenchmarkEventJournal : public QObject
+{
+    Q_OBJECT
+
+private slots:
+    // Functions executed by QtTest before and after test suite
+    void initTestCase();
+    void cleanupTestCase();
+
+    // Functions executed by QtTest before and after each test
+    void init();
+    void cleanup();
+
+    // Benchmark functions
+    void benchmarkAppend();
+    void benchmarkAppendAndSync();
+    void benchmarkReplay();
+    void benchmarkEnqueueAndPoll();
+
+private:
+    bool openJournal();
+
+    template<typename Setup, typename Function>
+    void runBenchmark(const char *unit, int count, Setup setup, Function function);
+
+private:
+    EventId m_eventId;
+    std::unique_ptr<QTemporaryDir> m_directory;
+    std::shared_ptr<EventJournal> m_journal;
+};
+
+// Test Case init/cleanup methods ------------------------------------------------------------------
+
+void BenchmarkEventJournal::initTestCase()
+{
+    m_eventId = EventNameRegistry::registerName("benchmark_journal");
+
+    QVERIFY(EventParameterSerializer::registerType<int>("benchmark_int"));
+}
+
+void BenchmarkEventJournal::cleanupTestCase()
+{
+}
+
+// Test init/cleanup methods -----------------------------------------------------------------------
+
+void BenchmarkEventJournal::init()
+{
+}
+
+void BenchmarkEventJournal::cleanup()
+{
+    m_journal.reset();
+    m_directory.reset();
+}
+
+// Benchmark: Append events ------------------------------------------------------------------------
+
+void BenchmarkEventJournal::benchmarkAppend()
+{
+    runBenchmark("event",
+                 s_eventCount,
+                 [&]() { QVERIFY(openJournal()); },
+                 [&]()
+    {
+        for (int i = 0; i < s_eventCount; i++)
+        {
+            m_journal->append(Event(m_eventId, EventParameter<int>(i)));
+        }
+    });
+
+    QCOMPARE(m_journal->lastSequence(), static_cast<std::uint64_t>(s_eventCount));
+}
+
+// Benchmark: Append events and wait until they are flushed to the disk ----------------------------
+
+void BenchmarkEventJournal::benchmarkAppendAndSync()
+{
+    runBenchmark("event",
+                 s_eventCount,
+                 [&]() { QVERIFY(openJournal()); },
+                 [&]()
+    {
+        for (int i = 0; i < s_eventCount; i++)
+        {
+            m_journal->append(Event(m_eventId, EventParameter<int>(i)));
+        }
+
+        m_journal->sync();
+    });
+
+    QCOMPARE(m_journal->committedSequence(), static_cast<std::uint64_t>(s_eventCount));
+}
+
+// Benchmark: Replay events ------------------------------------------------------------------------
+
+void BenchmarkEventJournal::benchmarkReplay()
+{
+    QVERIFY(openJournal());
+
+    for (int i = 0; i < s_eventCount; i++)
+    {
+        m_journal->append(Event(m_eventId, EventParameter<int>(i)));
+    }
+
+    std::int64_t checksum = 0;
+
+    runBenchmark("event",
+                 s_eventCount,
+                 []() {},
+                 [&]()
+    {
+        m_journal->replay(1U, [&](std::uint64_t, Event &&event)
+        {
+            checksum += event.parameter<EventParameter<int>>()->value();
+            return true;
+        });
+    });
+
+    QVERIFY(checksum != 0);
+}
+
+// Benchmark: Enqueue and poll events with a journal -----------------------------------------------
+
+void BenchmarkEventJournal::benchmarkEnqueueAndPoll()
+{
+    auto definition = std::make_shared<StateMachineDefinition>();
+    QVERIFY(definition->addState("a"));
+    QVERIFY(definition->setInitialTransition("a"));
+    QVERIFY(definition->addInternalTransition("a", "benchmark_journal", [](auto &, auto &) {}));
+    QVERIFY(definition->validate());
+
+    StateMachineInstance instance(definition);
+
+    runBenchmark("event",
+                 s_eventCount,
+                 [&]()
+    {
+        if (instance.isStarted())
+        {
+            QVERIFY(instance.stop());
+        }
+
+        QVERIFY(openJournal());
+        QVERIFY(instance.setJournal(m_journal));
+        QVERIFY(instance.start());
+    },
+                 [&]()
+    {
+        for (int i = 0; i < s_eventCount; i++)
+        {
+            instance.addEventToBack(Event(m_eventId, EventParameter<int>(i)));
+        }
+
+        instance.poll();
+    });
+
+    QCOMPARE(m_journal->checkpoint(), static_cast<std::uint64_t>(s_eventCount));
+    QVERIFY(instance.stop());
+}
+
+// Helper methods ----------------------------------------------------------------------------------
+
+/*!
+ * Opens a new journal in a new temporary directory
+ *
+ * \retval  true    Success
+ * \retval  false   Failure
+ */
+bool BenchmarkEventJournal::openJournal()
+{
+    m_journal.reset();
+    m_directory = std::make_unique<QTemporaryDir>();
+    m_journal = std::make_shared<EventJournal>(s_segmentSize);
+
+    return m_directory->isValid() && m_journal->open(m_directory->path());
+}
+
+// -------------------------------------------------------------------------------------------------
+
+/*!
+ * Runs the benchmark and reports the time per item and the throughput
+ *
+ * \param   unit        Name of the measured item (for example "event")
+ * \param   count       Number of items processed by the function
+ * \param   setup       Function that prepares each iteration (not measured)
+ * \param   function    Function that is measured
+ *
+ * \note    The QBENCHMARK result includes the setup, the reported time per item does not
+ */
+template<typename Setup, typename Function>
+void BenchmarkEventJournal::runBenchmark(const char *unit,
+                                         const int count,
+                                         Setup setup,
+                                         Function function)
+{
+    QElapsedTimer timer;
+    qint64 elapsed = 0;
+    qint64 iterations = 0;
+
+    QBENCHMARK
+    {
+        setup();
+
+        timer.start();
+        function();
+        elapsed += timer.nsecsElapsed();
+        iterations++;
+    }
+
+    const double nsPerItem =
+            static_cast<double>(elapsed) / static_cast<double>(iterations * count);
+    qInfo().noquote() << (QString("ns/") + unit + ":") << nsPerItem
+                      << (QString(unit) + "s/s:") << (1.0e9 / nsPerItem);
+}
+
+// Main function -----------------------------------------------------------------------------------
+
+QTEST_MAIN(BenchmarkEventJournal)
+#include "benchmarkEventJournal.moc"
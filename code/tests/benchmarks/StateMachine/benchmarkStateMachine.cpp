@@ -0,0 +1,906 @@
+/* This file is part of C++ State Machine Framework.
+ *
+ * C++ State Machine Framework is free software: you can redistribute it and/or modify it under the
+ * terms of the GNU Lesser General Public License as published by the Free Software Foundation,
+ * either version 3 of the License, or (at your option) any later version.
+ *
+ * C++ State Machine Framework is distributed in the hope that it will be useful, but WITHOUT ANY
+ * WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR
+ * PURPOSE. See the GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License along with C++ State
+ * Machine Framework. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+/*!
+ * \file
+ *
+ * Contains benchmarks for the hot paths of the StateMachine class
+ */
+
+// C++ State Machine Framework includes
+#include <CppStateMachineFramework/EventParameterSerializer.hpp>
+#include <CppStateMachineFramework/StateMachine.hpp>
+#include <CppStateMachineFramework/StateMachineExecutor.hpp>
+#include <CppStateMachineFramework/StaticStateMachine.hpp>
+
+// Qt includes
+#include <QtCore/QDebug>
+#include <QtCore/QElapsedTimer>
+#include <QtTest/QTest>
+
+// System includes
+#include <random>
+#include <thread>
+#include <vector>
+
+// Forward declarations
+
+// Macros
+#ifndef CPPSTATEMACHINEFRAMEWORK_HOT_PATH_LOGGING
+#define CPPSTATEMACHINEFRAMEWORK_HOT_PATH_LOGGING 1
+#endif
+
+// Benchmark class declaration ---------------------------------------------------------------------
+
+using namespace CppStateMachineFramework;
+
+//! Number of events processed in each benchmark iteration
+static const int s_eventCount = 100000;
+
+//! Number of producer threads in the multi-producer benchmarks
+static const int s_producerCount = 4;
+
+//! Number of state machines in the snapshot benchmarks
+static const int s_snapshotMachineCount = 100000;
+
+//! Number of pending events of each state machine in the snapshot benchmarks
+static const int s_snapshotEventCount = 4;
+
+namespace
+{
+
+//! Context of the compile-time state machine used by the dispatch benchmarks
+struct StaticContext
+{
+    int transitionCount = 0;
+};
+
+// States and events of the compile-time state machine
+struct StaticA {};
+struct StaticB {};
+struct StaticToA {};
+struct StaticToB {};
+
+//! Counts the transitions
+struct CountTransition
+{
+    template<typename Event>
+    void operator()(StaticContext &context, const Event &) const
+    {
+        context.transitionCount++;
+    }
+};
+
+//! Compile-time equivalent of the two states used by the dispatch benchmarks
+using BenchmarkStaticStateMachine = StaticStateMachine<
+        StaticContext,
+        StaticStates<StaticState<StaticA>, StaticState<StaticB>>,
+        StaticInitialTransition<StaticA>,
+        StaticTransitions<StaticStateTransition<StaticA, StaticToB, StaticB, CountTransition>,
+                          StaticStateTransition<StaticB, StaticToA, StaticA, CountTransition>>>;
+
+} // namespace
+
+class BenchmarkStateMachine : public QObject
+{
+    Q_OBJECT
+
+private slots:
+    // Functions executed by QtTest before and after test suite
+    void initTestCase();
+    void cleanupTestCase();
+
+    // Functions executed by QtTest before and after each test
+    void init();
+    void cleanup();
+
+    // Benchmark functions
+    void benchmarkEnqueueSingleProducer();
+    void benchmarkEnqueueMultipleProducers();
+    void benchmarkEnqueueMultipleProducersLockFree();
+    void benchmarkPoll();
+    void benchmarkPollPriorities();
+    void benchmarkStateTransitions();
+    void benchmarkStateTransitionsSingleOwner();
+    void benchmarkStaticStateTransitions();
+    void benchmarkInternalTransitions();
+    void benchmarkDefaultTransitions();
+    void benchmarkGuardRejectedTransitions();
+    void benchmarkHotPathLogging();
+    void benchmarkExecutor();
+    void benchmarkSnapshot();
+    void benchmarkRestore();
+    void benchmarkValidate10States();
+    void benchmarkValidate1kStates();
+    void benchmarkValidate100kStates();
+    void benchmarkValidateChain1k();
+    void benchmarkValidateChain1M();
+    void benchmarkValidateTree1k();
+    void benchmarkValidateTree1M();
+    void benchmarkValidateRandom1k();
+    void benchmarkValidateRandom1M();
+
+private:
+    //! Enumerates the shapes of the state graphs used by the validation benchmarks
+    enum class GraphShape
+    {
+        //! Each state transitions to the next state
+        Chain,
+
+        //! Each state transitions to two child states (binary tree)
+        Tree,
+
+        //! Each state is reached from a random earlier state and has a random extra transition
+        Random
+    };
+
+private:
+    std::unique_ptr<StateMachine> createStateMachine();
+    bool createSnapshotInstances(std::vector<StateMachineInstance> *instances);
+    void benchmarkEnqueueMultipleProducers(StateMachine::EventQueueMode mode);
+    void benchmarkStateTransitions(StateMachine::ExecutionMode executionMode,
+                                   StateMachine::EventQueueMode eventQueueMode);
+    void benchmarkValidate(int stateCount);
+    void benchmarkValidateGraph(GraphShape shape, int stateCount);
+
+    template<typename Setup, typename Function>
+    void runBenchmark(const char *unit, int count, Setup setup, Function function);
+
+private:
+    EventId m_toB;
+    EventId m_toA;
+    EventId m_internal;
+    EventId m_unknown;
+    EventId m_guarded;
+};
+
+// Test Case init/cleanup methods ------------------------------------------------------------------
+
+void BenchmarkStateMachine::initTestCase()
+{
+    m_toB = EventNameRegistry::registerName("benchmark_to_b");
+    m_toA = EventNameRegistry::registerName("benchmark_to_a");
+    m_internal = EventNameRegistry::registerName("benchmark_internal");
+    m_unknown = EventNameRegistry::registerName("benchmark_unknown");
+    m_guarded = EventNameRegistry::registerName("benchmark_guarded");
+
+    QVERIFY(EventParameterSerializer::registerType<int>("benchmark_int"));
+}
+
+void BenchmarkStateMachine::cleanupTestCase()
+{
+}
+
+// Test init/cleanup methods -----------------------------------------------------------------------
+
+void BenchmarkStateMachine::init()
+{
+}
+
+void BenchmarkStateMachine::cleanup()
+{
+}
+
+// Benchmark: Enqueue events from a single producer ------------------------------------------------
+
+void BenchmarkStateMachine::benchmarkEnqueueSingleProducer()
+{
+    auto stateMachine = createStateMachine();
+    QVERIFY(stateMachine);
+
+    runBenchmark("event",
+                 s_eventCount,
+                 [&]() { stateMachine->start(); },
+                 [&]()
+    {
+        for (int i = 0; i < s_eventCount; i++)
+        {
+            stateMachine->addEventToBack(m_internal);
+        }
+
+        stateMachine->stop();
+    });
+}
+
+// Benchmark: Enqueue events from multiple producers -----------------------------------------------
+
+void BenchmarkStateMachine::benchmarkEnqueueMultipleProducers()
+{
+    benchmarkEnqueueMultipleProducers(StateMachine::EventQueueMode::Locked);
+}
+
+// Benchmark: Enqueue events from multiple producers in the lock-free event queue mode -------------
+
+void BenchmarkStateMachine::benchmarkEnqueueMultipleProducersLockFree()
+{
+    benchmarkEnqueueMultipleProducers(StateMachine::EventQueueMode::LockFree);
+}
+
+// Benchmark: Poll events --------------------------------------------------------------------------
+
+void BenchmarkStateMachine::benchmarkPoll()
+{
+    auto stateMachine = createStateMachine();
+    QVERIFY(stateMachine);
+    QVERIFY(stateMachine->start());
+
+    runBenchmark("event",
+                 s_eventCount,
+                 [&]()
+    {
+        for (int i = 0; i < s_eventCount; i++)
+        {
+            stateMachine->addEventToBack((i % 2 == 0) ? m_toB : m_internal);
+        }
+    },
+                 [&]() { stateMachine->poll(); });
+}
+
+// Benchmark: Poll events with mixed priorities ---------------------------------------------------
+
+void BenchmarkStateMachine::benchmarkPollPriorities()
+{
+    auto stateMachine = createStateMachine();
+    QVERIFY(stateMachine);
+    QVERIFY(stateMachine->start());
+
+    runBenchmark("event",
+                 s_eventCount,
+                 [&]()
+    {
+        for (int i = 0; i < s_eventCount; i++)
+        {
+            stateMachine->addEvent(Event(m_internal), i % StateMachineInstance::EventPriorityCount);
+        }
+    },
+                 [&]() { stateMachine->poll(); });
+}
+
+// Benchmark: State transitions --------------------------------------------------------------------
+
+void BenchmarkStateMachine::benchmarkStateTransitions()
+{
+    benchmarkStateTransitions(StateMachine::ExecutionMode::Locked,
+                              StateMachine::EventQueueMode::Locked);
+}
+
+// Benchmark: State transitions without locking ----------------------------------------------------
+
+void BenchmarkStateMachine::benchmarkStateTransitionsSingleOwner()
+{
+    benchmarkStateTransitions(StateMachine::ExecutionMode::SingleOwner,
+                              StateMachine::EventQueueMode::LockFree);
+}
+
+// Benchmark: State transitions of a compile-time state machine ------------------------------------
+
+void BenchmarkStateMachine::benchmarkStaticStateTransitions()
+{
+    BenchmarkStaticStateMachine stateMachine;
+    QVERIFY(stateMachine.start());
+
+    runBenchmark("event",
+                 s_eventCount,
+                 []()
+    {
+    },
+                 [&]()
+    {
+        for (int i = 0; i < s_eventCount; i += 2)
+        {
+            stateMachine.processEvent(StaticToB());
+            stateMachine.processEvent(StaticToA());
+        }
+    });
+
+    QVERIFY(stateMachine.context().transitionCount > 0);
+}
+
+// Benchmark: Internal transitions -----------------------------------------------------------------
+
+void BenchmarkStateMachine::benchmarkInternalTransitions()
+{
+    auto stateMachine = createStateMachine();
+    QVERIFY(stateMachine);
+    QVERIFY(stateMachine->start());
+
+    runBenchmark("event",
+                 s_eventCount,
+                 [&]()
+    {
+        for (int i = 0; i < s_eventCount; i++)
+        {
+            stateMachine->addEventToBack(m_internal);
+        }
+    },
+                 [&]()
+    {
+        while (stateMachine->hasPendingEvents())
+        {
+            stateMachine->processNextEvent();
+        }
+    });
+}
+
+// Benchmark: Default transitions ------------------------------------------------------------------
+
+void BenchmarkStateMachine::benchmarkDefaultTransitions()
+{
+    auto stateMachine = createStateMachine();
+    QVERIFY(stateMachine);
+    QVERIFY(stateMachine->start());
+
+    runBenchmark("event",
+                 s_eventCount,
+                 [&]()
+    {
+        for (int i = 0; i < s_eventCount; i++)
+        {
+            stateMachine->addEventToBack(m_unknown);
+        }
+    },
+                 [&]()
+    {
+        while (stateMachine->hasPendingEvents())
+        {
+            stateMachine->processNextEvent();
+        }
+    });
+}
+
+// Benchmark: Transitions rejected by a guard condition --------------------------------------------
+
+void BenchmarkStateMachine::benchmarkGuardRejectedTransitions()
+{
+    auto stateMachine = createStateMachine();
+    QVERIFY(stateMachine);
+    QVERIFY(stateMachine->start());
+
+    runBenchmark("event",
+                 s_eventCount,
+                 [&]()
+    {
+        for (int i = 0; i < s_eventCount; i++)
+        {
+            stateMachine->addEventToBack(m_guarded);
+        }
+    },
+                 [&]()
+    {
+        while (stateMachine->hasPendingEvents())
+        {
+            stateMachine->processNextEvent();
+        }
+    });
+}
+
+// Benchmark: Hot path logging --------------------------------------------------------------------
+
+void BenchmarkStateMachine::benchmarkHotPathLogging()
+{
+    // Compare the results of the builds with the CppStateMachineFramework_HotPathLogging CMake
+    // option enabled and disabled (the debug messages are not enabled in either case)
+    qInfo() << "Hot path logging compiled in:" << (CPPSTATEMACHINEFRAMEWORK_HOT_PATH_LOGGING != 0);
+
+    auto stateMachine = createStateMachine();
+    QVERIFY(stateMachine);
+    QVERIFY(stateMachine->setExecutionMode(StateMachine::ExecutionMode::SingleOwner));
+    QVERIFY(stateMachine->setEventQueueMode(StateMachine::EventQueueMode::LockFree));
+    QVERIFY(stateMachine->start());
+
+    // State transition, internal transition, state transition and a rejected state transition
+    const EventId events[] = {m_toB, m_internal, m_toA, m_guarded};
+
+    runBenchmark("event",
+                 s_eventCount,
+                 [&]()
+    {
+        for (int i = 0; i < s_eventCount; i++)
+        {
+            stateMachine->addEventToBack(events[i % 4]);
+        }
+    },
+                 [&]() { stateMachine->poll(); });
+}
+
+// Benchmark: Executor processing the events of many state machines -------------------------------
+
+void BenchmarkStateMachine::benchmarkExecutor()
+{
+    const int stateMachineCount = 1000;
+
+    std::vector<std::unique_ptr<StateMachine>> stateMachines;
+    StateMachineExecutor executor;
+
+    for (int i = 0; i < stateMachineCount; i++)
+    {
+        stateMachines.push_back(createStateMachine());
+        QVERIFY(stateMachines.back());
+        QVERIFY(stateMachines.back()->start());
+        QVERIFY(executor.addInstance(&stateMachines.back()->instance()));
+    }
+
+    QVERIFY(executor.start());
+    qInfo() << "Workers:" << executor.workerCount();
+
+    runBenchmark("event",
+                 s_eventCount,
+                 []() {},
+                 [&]()
+    {
+        for (int i = 0; i < s_eventCount; i++)
+        {
+            stateMachines[i % stateMachineCount]->addEventToBack(
+                        ((i / stateMachineCount) % 2 == 0) ? m_toB : m_toA);
+        }
+
+        executor.waitForIdle();
+    });
+
+    QVERIFY(executor.stop());
+
+    for (auto &stateMachine : stateMachines)
+    {
+        QVERIFY(executor.removeInstance(&stateMachine->instance()));
+    }
+}
+
+// Benchmark: Snapshots of many state machines ----------------------------------------------------
+
+void BenchmarkStateMachine::benchmarkSnapshot()
+{
+    std::vector<StateMachineInstance> instances;
+    QVERIFY(createSnapshotInstances(&instances));
+
+    std::vector<QByteArray> snapshots(instances.size());
+
+    runBenchmark("machine",
+                 s_snapshotMachineCount,
+                 []() {},
+                 [&]()
+    {
+        for (std::size_t i = 0U; i < instances.size(); i++)
+        {
+            snapshots[i] = instances[i].snapshot();
+        }
+    });
+
+    QVERIFY(!snapshots.front().isEmpty());
+    qInfo() << "Snapshot size:" << snapshots.front().size();
+}
+
+// Benchmark: Restoring many state machines from their snapshots -----------------------------------
+
+void BenchmarkStateMachine::benchmarkRestore()
+{
+    std::vector<StateMachineInstance> instances;
+    QVERIFY(createSnapshotInstances(&instances));
+
+    std::vector<QByteArray> snapshots;
+    snapshots.reserve(instances.size());
+
+    for (auto &instance : instances)
+    {
+        snapshots.push_back(instance.snapshot());
+        QVERIFY(!snapshots.back().isEmpty());
+    }
+
+    runBenchmark("machine",
+                 s_snapshotMachineCount,
+                 [&]()
+    {
+        for (auto &instance : instances)
+        {
+            instance.stop();
+        }
+    },
+                 [&]()
+    {
+        for (std::size_t i = 0U; i < instances.size(); i++)
+        {
+            instances[i].restore(snapshots[i]);
+        }
+    });
+
+    for (auto &instance : instances)
+    {
+        QVERIFY(instance.isStarted());
+    }
+}
+
+// Benchmark: Construction and validation of a state machine with 10 states ------------------------
+
+void BenchmarkStateMachine::benchmarkValidate10States()
+{
+    benchmarkValidate(10);
+}
+
+// Benchmark: Construction and validation of a state machine with 1k states ------------------------
+
+void BenchmarkStateMachine::benchmarkValidate1kStates()
+{
+    benchmarkValidate(1000);
+}
+
+// Benchmark: Construction and validation of a state machine with 100k states ----------------------
+
+void BenchmarkStateMachine::benchmarkValidate100kStates()
+{
+    benchmarkValidate(100000);
+}
+
+// Benchmark: Validation of a chain of 1k states ---------------------------------------------------
+
+void BenchmarkStateMachine::benchmarkValidateChain1k()
+{
+    benchmarkValidateGraph(GraphShape::Chain, 1000);
+}
+
+// Benchmark: Validation of a chain of 1M states ---------------------------------------------------
+
+void BenchmarkStateMachine::benchmarkValidateChain1M()
+{
+    benchmarkValidateGraph(GraphShape::Chain, 1000000);
+}
+
+// Benchmark: Validation of a tree of 1k states ----------------------------------------------------
+
+void BenchmarkStateMachine::benchmarkValidateTree1k()
+{
+    benchmarkValidateGraph(GraphShape::Tree, 1000);
+}
+
+// Benchmark: Validation of a tree of 1M states ----------------------------------------------------
+
+void BenchmarkStateMachine::benchmarkValidateTree1M()
+{
+    benchmarkValidateGraph(GraphShape::Tree, 1000000);
+}
+
+// Benchmark: Validation of a random graph of 1k states --------------------------------------------
+
+void BenchmarkStateMachine::benchmarkValidateRandom1k()
+{
+    benchmarkValidateGraph(GraphShape::Random, 1000);
+}
+
+// Benchmark: Validation of a random graph of 1M states --------------------------------------------
+
+void BenchmarkStateMachine::benchmarkValidateRandom1M()
+{
+    benchmarkValidateGraph(GraphShape::Random, 1000000);
+}
+
+// Helper methods ----------------------------------------------------------------------------------
+
+/*!
+ * Creates a state machine with two states that are used by the dispatch benchmarks
+ *
+ * \return  Validated state machine or nullptr in case of a failure
+ */
+std::unique_ptr<StateMachine> BenchmarkStateMachine::createStateMachine()
+{
+    auto stateMachine = std::make_unique<StateMachine>();
+    int counter = 0;
+
+    const bool success =
+            stateMachine->addState("a") &&
+            stateMachine->addState("b") &&
+            stateMachine->setInitialTransition("a") &&
+            stateMachine->addStateTransition("a", "benchmark_to_b", "b") &&
+            stateMachine->addStateTransition("b", "benchmark_to_a", "a") &&
+            stateMachine->addStateTransition("a",
+                                             "benchmark_guarded",
+                                             "b",
+                                             {},
+                                             [](auto &, auto &, auto &) { return false; }) &&
+            stateMachine->addInternalTransition("a",
+                                                "benchmark_internal",
+                                                [counter](auto &, auto &) mutable { counter++; }) &&
+            stateMachine->addInternalTransition("b",
+                                                "benchmark_internal",
+                                                [counter](auto &, auto &) mutable { counter++; }) &&
+            stateMachine->setDefaultTransition("a",
+                                               [counter](auto &, auto &) mutable { counter++; }) &&
+            stateMachine->validate();
+
+    return success ? std::move(stateMachine) : nullptr;
+}
+
+// -------------------------------------------------------------------------------------------------
+
+/*!
+ * Creates the started state machine instances used by the snapshot benchmarks
+ *
+ * \param[out]  instances   Output for the instances (they share a single definition)
+ *
+ * \retval  true    Success
+ * \retval  false   Failure
+ *
+ * Each instance has pending events with an integer parameter.
+ */
+bool BenchmarkStateMachine::createSnapshotInstances(std::vector<StateMachineInstance> *instances)
+{
+    auto stateMachine = createStateMachine();
+
+    if (!stateMachine)
+    {
+        return false;
+    }
+
+    const auto definition = stateMachine->instance().definition();
+    instances->reserve(s_snapshotMachineCount);
+
+    for (int i = 0; i < s_snapshotMachineCount; i++)
+    {
+        instances->emplace_back(definition);
+        auto &instance = instances->back();
+
+        if (!instance.start())
+        {
+            return false;
+        }
+
+        for (int j = 0; j < s_snapshotEventCount; j++)
+        {
+            const EventId eventId = (j % 2 == 0) ? m_toB : m_internal;
+
+            if (!instance.addEventToBack(Event(eventId, EventParameter<int>(i + j))))
+            {
+                return false;
+            }
+        }
+    }
+
+    return true;
+}
+
+// -------------------------------------------------------------------------------------------------
+
+/*!
+ * Runs the state transition benchmark
+ *
+ * \param   executionMode   Execution mode
+ * \param   eventQueueMode  Event queue mode
+ */
+void BenchmarkStateMachine::benchmarkStateTransitions(
+        const StateMachine::ExecutionMode executionMode,
+        const StateMachine::EventQueueMode eventQueueMode)
+{
+    auto stateMachine = createStateMachine();
+    QVERIFY(stateMachine);
+    QVERIFY(stateMachine->setExecutionMode(executionMode));
+    QVERIFY(stateMachine->setEventQueueMode(eventQueueMode));
+    QVERIFY(stateMachine->start());
+
+    runBenchmark("event",
+                 s_eventCount,
+                 [&]()
+    {
+        for (int i = 0; i < s_eventCount; i++)
+        {
+            stateMachine->addEventToBack((i % 2 == 0) ? m_toB : m_toA);
+        }
+    },
+                 [&]()
+    {
+        while (stateMachine->hasPendingEvents())
+        {
+            stateMachine->processNextEvent();
+        }
+    });
+}
+
+// -------------------------------------------------------------------------------------------------
+
+/*!
+ * Runs the multi-producer enqueue benchmark
+ *
+ * \param   mode    Event queue mode
+ */
+void BenchmarkStateMachine::benchmarkEnqueueMultipleProducers(
+        const StateMachine::EventQueueMode mode)
+{
+    auto stateMachine = createStateMachine();
+    QVERIFY(stateMachine);
+    QVERIFY(stateMachine->setEventQueueMode(mode));
+
+    runBenchmark("event",
+                 s_eventCount,
+                 [&]() { stateMachine->start(); },
+                 [&]()
+    {
+        std::vector<std::thread> producers;
+
+        for (int producer = 0; producer < s_producerCount; producer++)
+        {
+            producers.emplace_back([&]()
+            {
+                for (int i = 0; i < (s_eventCount / s_producerCount); i++)
+                {
+                    stateMachine->addEventToBack(m_internal);
+                }
+            });
+        }
+
+        for (auto &producer : producers)
+        {
+            producer.join();
+        }
+
+        stateMachine->stop();
+    });
+}
+
+// -------------------------------------------------------------------------------------------------
+
+/*!
+ * Runs the construction and validation benchmark
+ *
+ * \param   stateCount  Number of states in the state machine
+ */
+void BenchmarkStateMachine::benchmarkValidate(const int stateCount)
+{
+    QStringList stateNames;
+
+    for (int i = 0; i < stateCount; i++)
+    {
+        stateNames.append(QString("s%1").arg(i));
+    }
+
+    EventNameRegistry::registerName("benchmark_next");
+
+    runBenchmark("state",
+                 stateCount,
+                 []() {},
+                 [&]()
+    {
+        StateMachine stateMachine;
+
+        for (const auto &stateName : stateNames)
+        {
+            stateMachine.addState(stateName);
+        }
+
+        stateMachine.setInitialTransition(stateNames.at(0));
+
+        for (int i = 0; i < (stateCount - 1); i++)
+        {
+            stateMachine.addStateTransition(stateNames.at(i),
+                                            "benchmark_next",
+                                            stateNames.at(i + 1));
+        }
+
+        QVERIFY(stateMachine.validate());
+    });
+}
+
+// -------------------------------------------------------------------------------------------------
+
+/*!
+ * Runs the validation benchmark (only the validation is measured)
+ *
+ * \param   shape       Shape of the state graph
+ * \param   stateCount  Number of states in the state machine
+ */
+void BenchmarkStateMachine::benchmarkValidateGraph(const GraphShape shape, const int stateCount)
+{
+    StateMachineDefinition definition;
+    std::vector<QString> stateNames;
+    std::vector<int> transitionCounts(static_cast<std::size_t>(stateCount), 0);
+    std::vector<QString> triggers;
+    std::mt19937 random(42U);
+
+    for (int i = 0; i < stateCount; i++)
+    {
+        stateNames.push_back(QString("s%1").arg(i));
+        QVERIFY(definition.addState(stateNames.back()));
+    }
+
+    QVERIFY(definition.setInitialTransition(stateNames.front()));
+
+    // Each state uses a different trigger for each of its transitions
+    const auto addTransition = [&](const int fromState, const int toState)
+    {
+        int &transitionCount = transitionCounts[static_cast<std::size_t>(fromState)];
+
+        while (static_cast<int>(triggers.size()) <= transitionCount)
+        {
+            triggers.push_back(QString("benchmark_edge_%1").arg(triggers.size()));
+        }
+
+        const QString &trigger = triggers[static_cast<std::size_t>(transitionCount)];
+        transitionCount++;
+
+        return definition.addStateTransition(stateNames[static_cast<std::size_t>(fromState)],
+                                             trigger,
+                                             stateNames[static_cast<std::size_t>(toState)]);
+    };
+
+    for (int i = 1; i < stateCount; i++)
+    {
+        if (shape == GraphShape::Chain)
+        {
+            QVERIFY(addTransition(i - 1, i));
+        }
+        else if (shape == GraphShape::Tree)
+        {
+            QVERIFY(addTransition((i - 1) / 2, i));
+        }
+        else
+        {
+            QVERIFY(addTransition(static_cast<int>(random() % static_cast<unsigned>(i)), i));
+        }
+    }
+
+    if (shape == GraphShape::Random)
+    {
+        for (int i = 0; i < stateCount; i++)
+        {
+            const int toState = static_cast<int>(random() % static_cast<unsigned>(stateCount));
+            QVERIFY(addTransition(i, toState));
+        }
+    }
+
+    runBenchmark("state",
+                 stateCount,
+                 []() {},
+                 [&]()
+    {
+        QVERIFY(definition.validate());
+    });
+}
+
+// -------------------------------------------------------------------------------------------------
+
+/*!
+ * Runs the benchmark and reports the time per item and the throughput
+ *
+ * \param   unit        Name of the measured item (for example "event")
+ * \param   count       Number of items processed by the function
+ * \param   setup       Function that prepares each iteration (not measured)
+ * \param   function    Function that is measured
+ *
+ * \note    The QBENCHMARK result includes the setup, the reported time per item does not
+ */
+template<typename Setup, typename Function>
+void BenchmarkStateMachine::runBenchmark(const char *unit,
+                                         const int count,
+                                         Setup setup,
+                                         Function function)
+{
+    QElapsedTimer timer;
+    qint64 elapsed = 0;
+    qint64 iterations = 0;
+
+    QBENCHMARK
+    {
+        setup();
+
+        timer.start();
+        function();
+        elapsed += timer.nsecsElapsed();
+        iterations++;
+    }
+
+    const double nsPerItem =
+            static_cast<double>(elapsed) / static_cast<double>(iterations * count);
+    qInfo().noquote() << (QString("ns/") + unit + ":") << nsPerItem
+                      << (QString(unit) + "s/s:") << (1.0e9 / nsPerItem);
+}
+
+// Main function -----------------------------------------------------------------------------------
+
+QTEST_MAIN(BenchmarkStateMachine)
+#include "benchmarkStateMachine.moc"
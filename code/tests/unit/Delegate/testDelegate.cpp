@@ -0,0 +1,246 @@
+/* This file is part of C++ State Machine Framework.
+ *
+ * C++ State Machine Framework is free software: you can redistribute it and/or modify it under the
+ * terms of the GNU Lesser General Public License as published by the Free Software Foundation,
+ * either version 3 of the License, or (at your option) any later version.
+ *
+ * C++ State Machine Framework is distributed in the hope that it will be useful, but WITHOUT ANY
+ * WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR
+ * PURPOSE. See the GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License along with C++ State
+ * Machine Framework. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+/*!
+ * \file
+ *
+ * Contains unit tests for the Delegate class
+ */
+
+// C++ State Machine Framework includes
+#include <CppStateMachineFramework/StateMachineMethods.hpp>
+
+// Qt includes
+#include <QtCore/QDebug>
+#include <QtTest/QTest>
+
+// System includes
+#include <array>
+#include <functional>
+#include <memory>
+
+// Forward declarations
+
+// Macros
+
+// Test class declaration --------------------------------------------------------------------------
+
+using namespace CppStateMachineFramework;
+
+class TestDelegate : public QObject
+{
+    Q_OBJECT
+
+private slots:
+    // Functions executed by QtTest before and after test suite
+    void initTestCase();
+    void cleanupTestCase();
+
+    // Functions executed by QtTest before and after each test
+    void init();
+    void cleanup();
+
+    // Test functions
+    void testEmpty();
+    void testCallables();
+    void testMethods();
+    void testCopyAndMove();
+
+public:
+    // Helper methods
+    void onAction(const Event &trigger, const QString &currentState);
+    void onActionWithoutArguments();
+    bool guard(const Event &trigger, const QString &currentState);
+
+private:
+    QStringList m_log;
+};
+
+// Test Case init/cleanup methods ------------------------------------------------------------------
+
+void TestDelegate::initTestCase()
+{
+}
+
+void TestDelegate::cleanupTestCase()
+{
+}
+
+// Test init/cleanup methods -----------------------------------------------------------------------
+
+void TestDelegate::init()
+{
+    m_log.clear();
+}
+
+void TestDelegate::cleanup()
+{
+}
+
+// Test: Empty delegates ---------------------------------------------------------------------------
+
+void TestDelegate::testEmpty()
+{
+    InternalTransitionAction action1;
+    QVERIFY(!action1);
+
+    InternalTransitionAction action2 = nullptr;
+    QVERIFY(!action2);
+
+    // Empty function pointers and std::function objects must result in an empty delegate
+    void (*function)(const Event &, const QString &) = nullptr;
+    InternalTransitionAction action3 = function;
+    QVERIFY(!action3);
+
+    std::function<void(const Event &, const QString &)> stdFunction;
+    InternalTransitionAction action4 = stdFunction;
+    QVERIFY(!action4);
+
+    // Clear a delegate
+    InternalTransitionAction action5 = [](auto &, auto &) {};
+    QVERIFY(action5);
+
+    action5 = nullptr;
+    QVERIFY(!action5);
+}
+
+// Test: Callable objects --------------------------------------------------------------------------
+
+void TestDelegate::testCallables()
+{
+    const Event event("event");
+
+    // Small lambda (stored inline)
+    InternalTransitionAction action1 = [this](const Event &trigger, const QString &state)
+    {
+        m_log.append(trigger.name() + ":" + state);
+    };
+    QVERIFY(action1);
+
+    action1(event, "state1");
+    QCOMPARE(m_log, QStringList({"event:state1"}));
+
+    // Large lambda (stored on the heap)
+    std::array<int, 32> values = {};
+    values[31] = 42;
+
+    InternalTransitionGuardCondition guard1 = [values](auto &, auto &) { return values[31] == 42; };
+    QVERIFY(guard1);
+    QVERIFY(guard1(event, "state1"));
+
+    // Function pointer and std::function
+    StateAction action2 = [](const QString &) {};
+    StateAction action3 = std::function<void(const QString &)>([this](const QString &state)
+    {
+        m_log.append(state);
+    });
+
+    action2("state2");
+    action3("state3");
+    QCOMPARE(m_log, QStringList({"event:state1", "state3"}));
+}
+
+// Test: Methods -----------------------------------------------------------------------------------
+
+void TestDelegate::testMethods()
+{
+    const Event event("event");
+
+    auto action1 = createInternalTransitionAction(this, &TestDelegate::onAction);
+    auto action2 = createInternalTransitionAction(this, &TestDelegate::onActionWithoutArguments);
+    auto guard1 = createInternalTransitionGuardCondition(this, &TestDelegate::guard);
+
+    QVERIFY(action1);
+    QVERIFY(action2);
+    QVERIFY(guard1);
+
+    action1(event, "state");
+    action2(event, "state");
+    QVERIFY(guard1(event, "state"));
+    QVERIFY(!guard1(event, "other"));
+
+    QCOMPARE(m_log, QStringList({"onAction:event:state", "onActionWithoutArguments"}));
+}
+
+// Test: Copy and move -----------------------------------------------------------------------------
+
+void TestDelegate::testCopyAndMove()
+{
+    auto counter = std::make_shared<int>(0);
+    std::array<std::shared_ptr<int>, 8> counters;
+    counters.fill(counter);
+
+    StateAction smallAction = [counter](const QString &) { (*counter)++; };
+    StateAction largeAction = [counters](const QString &) { (*counters[0])++; };
+    QCOMPARE(counter.use_count(), 18L);
+
+    // Copy
+    StateAction smallCopy = smallAction;
+    StateAction largeCopy(largeAction);
+    QCOMPARE(counter.use_count(), 27L);
+
+    smallCopy("state");
+    largeCopy("state");
+    smallAction("state");
+    largeAction("state");
+    QCOMPARE(*counter, 4);
+
+    // Move
+    StateAction smallMoved = std::move(smallCopy);
+    StateAction largeMoved(std::move(largeCopy));
+    QVERIFY(!smallCopy);
+    QVERIFY(!largeCopy);
+    QCOMPARE(counter.use_count(), 27L);
+
+    smallMoved("state");
+    largeMoved("state");
+    QCOMPARE(*counter, 6);
+
+    // Assignment
+    smallMoved = largeMoved;
+    QCOMPARE(counter.use_count(), 34L);
+
+    largeMoved = std::move(smallAction);
+    QVERIFY(!smallAction);
+    QCOMPARE(counter.use_count(), 26L);
+
+    smallMoved = nullptr;
+    largeMoved = nullptr;
+    QCOMPARE(counter.use_count(), 17L);
+
+    largeAction = nullptr;
+    QCOMPARE(counter.use_count(), 9L);
+}
+
+// Helper methods ----------------------------------------------------------------------------------
+
+void TestDelegate::onAction(const Event &trigger, const QString &currentState)
+{
+    m_log.append(QString("onAction:") + trigger.name() + ":" + currentState);
+}
+
+void TestDelegate::onActionWithoutArguments()
+{
+    m_log.append("onActionWithoutArguments");
+}
+
+bool TestDelegate::guard(const Event &, const QString &currentState)
+{
+    return (currentState == "state");
+}
+
+// Main function -----------------------------------------------------------------------------------
+
+QTEST_MAIN(TestDelegate)
+#include "testDelegate.moc"
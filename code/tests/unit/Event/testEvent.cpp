@@ -26,6 +26,7 @@
 #include <QtTest/QTest>
 
 // System includes
+#include <array>
 
 // Forward declarations
 
@@ -47,6 +48,33 @@ static const QString s_stringValue("value");
 
 using PtrEventParameter = EventParameter<std::unique_ptr<int>>;
 
+using SharedPtrEventParameter = EventParameter<std::shared_ptr<int>>;
+
+using LargeEventParameter =
+        EventParameter<std::array<char, CPPSTATEMACHINEFRAMEWORK_EVENT_PARAMETER_INLINE_SIZE + 1>>;
+
+class DerivedIntEventParameter : public IntEventParameter
+{
+public:
+    DerivedIntEventParameter(int value)
+        : IntEventParameter(value)
+    {
+    }
+};
+
+class OwnTypeIdIntEventParameter : public IntEventParameter
+{
+public:
+    OwnTypeIdIntEventParameter(int value)
+        : IntEventParameter(eventParameterTypeId<OwnTypeIdIntEventParameter>(), std::move(value))
+    {
+    }
+};
+
+class CustomEventParameter : public IEventParameter
+{
+};
+
 class TestEvent : public QObject
 {
     Q_OBJECT
@@ -64,6 +92,9 @@ private slots:
     void testConstructor();
     void testMove();
     void testEventParameter();
+    void testEventId();
+    void testInlineEventParameter();
+    void testEventParameterTypeId();
 };
 
 // Test Case init/cleanup methods ------------------------------------------------------------------
@@ -170,6 +201,172 @@ void TestEvent::testEventParameter()
     QCOMPARE(*(ptrEvent.parameter<PtrEventParameter>()->value()), s_intValue1);
 }
 
+// Test: Events created from event IDs -----------------------------------------------------------
+
+void TestEvent::testEventId()
+{
+    // Events created from a registered name must have the name's ID
+    QVERIFY(EventNameRegistry::registerName(s_name1) != InvalidEventId);
+    Event event1(s_name1);
+    QVERIFY(event1.id() != InvalidEventId);
+    QCOMPARE(event1.id(), EventNameRegistry::id(s_name1));
+
+    // Events created from an ID must have the registered name
+    Event event2(event1.id(), IntEventParameter::create(s_intValue1));
+    QCOMPARE(event2.id(), event1.id());
+    QCOMPARE(event2.name(), s_name1);
+    QVERIFY(event2.parameter<IntEventParameter>() != nullptr);
+    QCOMPARE(event2.parameter<IntEventParameter>()->value(), s_intValue1);
+
+    // Events with an empty name or an unregistered ID must be invalid
+    Event event3((QString()));
+    QCOMPARE(event3.id(), InvalidEventId);
+    QVERIFY(event3.name().isEmpty());
+
+    Event event4(EventNameRegistry::count() + 1U);
+    QCOMPARE(event4.id(), InvalidEventId);
+    QVERIFY(event4.name().isEmpty());
+
+    // Names that are not registered must not be added to the registry
+    const std::uint32_t count = EventNameRegistry::count();
+    Event event5("event_unregistered", IntEventParameter(s_intValue1));
+    QCOMPARE(event5.id(), UnregisteredEventId);
+    QCOMPARE(event5.name(), QString("event_unregistered"));
+    QCOMPARE(EventNameRegistry::id("event_unregistered"), InvalidEventId);
+    QCOMPARE(EventNameRegistry::count(), count);
+
+    // Moved event must take over the name
+    Event event6(std::move(event5));
+    QCOMPARE(event6.id(), UnregisteredEventId);
+    QCOMPARE(event6.name(), QString("event_unregistered"));
+    QCOMPARE(event6.parameter<IntEventParameter>()->value(), s_intValue1);
+
+    event6 = Event("event_unregistered2");
+    QCOMPARE(event6.name(), QString("event_unregistered2"));
+
+    // Name registered later must be found
+    const EventId id = EventNameRegistry::registerName("event_unregistered");
+    QCOMPARE(Event("event_unregistered").id(), id);
+}
+
+// Test: Events with inline parameters ------------------------------------------------------------
+
+void TestEvent::testInlineEventParameter()
+{
+    // Small parameters must be stored inline
+    Event intEvent(s_name1, IntEventParameter(s_intValue1));
+    QVERIFY(intEvent.hasParameter());
+    QVERIFY(intEvent.isParameterInline());
+    QVERIFY(intEvent.parameter<StringEventParameter>() == nullptr);
+    QVERIFY(intEvent.parameter<IntEventParameter>() != nullptr);
+    QCOMPARE(intEvent.parameter<IntEventParameter>()->value(), s_intValue1);
+
+    Event ptrEvent(s_name1, PtrEventParameter(std::make_unique<int>(s_intValue2)));
+    QVERIFY(ptrEvent.isParameterInline());
+    QCOMPARE(*(ptrEvent.parameter<PtrEventParameter>()->value()), s_intValue2);
+
+    // Heap allocated parameters must not be stored inline
+    Event heapEvent(s_name1, IntEventParameter::create(s_intValue1));
+    QVERIFY(heapEvent.hasParameter());
+    QVERIFY(!heapEvent.isParameterInline());
+
+    // Large parameters must be stored on the heap
+    LargeEventParameter largeParameter({});
+    largeParameter.value().front() = 'a';
+
+    Event largeEvent(s_name1, std::move(largeParameter));
+    QVERIFY(largeEvent.hasParameter());
+    QVERIFY(!largeEvent.isParameterInline());
+    QCOMPARE(largeEvent.parameter<LargeEventParameter>()->value().front(), 'a');
+
+    // Derived parameters cannot be passed by value as they would be sliced
+    static_assert(std::is_constructible<Event, QString, IntEventParameter>::value,
+                  "EventParameter<T> must be accepted by value");
+    static_assert(!std::is_constructible<Event, QString, DerivedIntEventParameter>::value,
+                  "Derived event parameters must not be accepted by value");
+    static_assert(!std::is_constructible<Event, EventId, DerivedIntEventParameter>::value,
+                  "Derived event parameters must not be accepted by value");
+
+    // Inline parameters must be moved together with the event and destroyed exactly once
+    auto value = std::make_shared<int>(s_intValue2);
+
+    {
+        Event event1(s_name2, SharedPtrEventParameter(value));
+        QVERIFY(event1.isParameterInline());
+        QCOMPARE(value.use_count(), 2L);
+
+        Event event2(std::move(event1));
+        QVERIFY(!event1.hasParameter());
+        QVERIFY(event2.isParameterInline());
+        QCOMPARE(*event2.parameter<SharedPtrEventParameter>()->value(), s_intValue2);
+        QCOMPARE(value.use_count(), 2L);
+
+        event1 = std::move(event2);
+        QVERIFY(!event2.hasParameter());
+        QVERIFY(event1.isParameterInline());
+        QCOMPARE(*event1.parameter<SharedPtrEventParameter>()->value(), s_intValue2);
+        QCOMPARE(value.use_count(), 2L);
+
+        event1 = Event(s_name1, IntEventParameter(s_intValue1));
+        QCOMPARE(value.use_count(), 1L);
+        QCOMPARE(event1.parameter<IntEventParameter>()->value(), s_intValue1);
+
+        event2 = Event(s_name2, SharedPtrEventParameter(value));
+        QCOMPARE(value.use_count(), 2L);
+    }
+
+    QCOMPARE(value.use_count(), 1L);
+}
+
+// Test: Event parameter type IDs -----------------------------------------------------------------
+
+void TestEvent::testEventParameterTypeId()
+{
+    QVERIFY(eventParameterTypeId<IntEventParameter>() != nullptr);
+    QVERIFY(eventParameterTypeId<IntEventParameter>() == eventParameterTypeId<IntEventParameter>());
+    QVERIFY(eventParameterTypeId<IntEventParameter>() !=
+            eventParameterTypeId<StringEventParameter>());
+
+    // Event parameters
+    Event intEvent(s_name1, IntEventParameter(s_intValue1));
+    QVERIFY(intEvent.parameter()->typeId() == eventParameterTypeId<IntEventParameter>());
+    QVERIFY(intEvent.parameter<IntEventParameter>() != nullptr);
+    QVERIFY(intEvent.parameter<StringEventParameter>() == nullptr);
+    QVERIFY(intEvent.parameter<DerivedIntEventParameter>() == nullptr);
+    QVERIFY(intEvent.parameter<CustomEventParameter>() == nullptr);
+    QCOMPARE(intEvent.parameterUnsafe<IntEventParameter>()->value(), s_intValue1);
+
+    intEvent.parameterUnsafe<IntEventParameter>()->value() = s_intValue2;
+    QCOMPARE(qAsConst(intEvent).parameterUnsafe<IntEventParameter>()->value(), s_intValue2);
+
+    // Derived event parameters
+    Event derivedEvent(s_name1, std::make_unique<DerivedIntEventParameter>(s_intValue1));
+    QVERIFY(derivedEvent.parameter<IntEventParameter>() != nullptr);
+    QVERIFY(derivedEvent.parameter<DerivedIntEventParameter>() != nullptr);
+    QVERIFY(derivedEvent.parameter<StringEventParameter>() == nullptr);
+    QCOMPARE(derivedEvent.parameter<DerivedIntEventParameter>()->value(), s_intValue1);
+
+    // Event parameters with a type ID that differs from the type ID of EventParameter<T> (for
+    // example parameters created in another module) are found with a dynamic cast
+    Event ownTypeIdEvent(s_name1, std::make_unique<OwnTypeIdIntEventParameter>(s_intValue1));
+    QVERIFY(ownTypeIdEvent.parameter()->typeId() != eventParameterTypeId<IntEventParameter>());
+    QVERIFY(ownTypeIdEvent.parameter<OwnTypeIdIntEventParameter>() != nullptr);
+    QVERIFY(ownTypeIdEvent.parameter<IntEventParameter>() != nullptr);
+    QVERIFY(ownTypeIdEvent.parameter<StringEventParameter>() == nullptr);
+    QCOMPARE(ownTypeIdEvent.parameter<IntEventParameter>()->value(), s_intValue1);
+
+    // Custom event parameters
+    Event customEvent(s_name1, std::make_unique<CustomEventParameter>());
+    QVERIFY(customEvent.parameter()->typeId() == nullptr);
+    QVERIFY(customEvent.parameter<CustomEventParameter>() != nullptr);
+    QVERIFY(customEvent.parameter<IntEventParameter>() == nullptr);
+
+    // Events without a parameter
+    Event emptyEvent(s_name1);
+    QVERIFY(emptyEvent.parameter<IntEventParameter>() == nullptr);
+    QVERIFY(emptyEvent.parameterUnsafe<IntEventParameter>() == nullptr);
+}
+
 // Main function -----------------------------------------------------------------------------------
 
 QTEST_MAIN(TestEvent)
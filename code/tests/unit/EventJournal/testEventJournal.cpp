@@ -0,0 +1,464 @@
+/* This file is part of C++ State Machine Framework.
+ *
+ * C++ State Machine Framework is free software: you can redistribute it and/or modify it under the
+ * terms of the GNU Lesser General Public License as published by the Free Software Foundation,
+ * either version 3 of the License, or (at your option) any later version.
+ *
+ * C++ State Machine Framework is distributed in the hope that it will be useful, but WITHOUT ANY
+ * WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR
+ * PURPOSE. See the GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License along with C++ State
+ * Machine Framework. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+/*!
+ * \file
+ *
+ * Contains unit tests for the EventJournal class
+ */
+
+// C++ State Machine Framework includes
+#include <CppStateMachineFramework/EventJournal.hpp>
+#include <CppStateMachineFramework/StateMachineInstance.hpp>
+
+// Qt includes
+#include <QtCore/QDebug>
+#include <QtCore/QDir>
+#include <QtCore/QTemporaryDir>
+#include <QtTest/QTest>
+
+// System includes
+
+// Forward declarations
+
+// Macros
+
+// Test class declaration --------------------------------------------------------------------------
+
+using namespace CppStateMachineFramework;
+
+class OwnTypeIdIntEventParameter : public EventParameter<int>
+{
+public:
+    OwnTypeIdIntEventParameter(int value)
+        : EventParameter<int>(eventParameterTypeId<OwnTypeIdIntEventParameter>(), std::move(value))
+    {
+    }
+};
+
+class TestEventJournal : public QObject
+{
+    Q_OBJECT
+
+private slots:
+    // Functions executed by QtTest before and after test suite
+    void initTestCase();
+    void cleanupTestCase();
+
+    // Functions executed by QtTest before and after each test
+    void init();
+    void cleanup();
+
+    // Test functions
+    void testOpenAndClose();
+    void testAppendAndReplay();
+    void testSegments();
+    void testUnregisteredParameter();
+    void testStateMachineRecovery();
+    void testStateMachineRestrictions();
+
+private:
+    // Helper methods
+    QList<int> replayValues(const EventJournal &journal, std::uint64_t fromSequence);
+    std::shared_ptr<StateMachineDefinition> createDefinition(QList<int> *processedValues);
+};
+
+// Test Case init/cleanup methods ------------------------------------------------------------------
+
+void TestEventJournal::initTestCase()
+{
+    QVERIFY(EventParameterSerializer::registerType<int>("journal_int"));
+
+    // Only the events with registered names can be journaled
+    QVERIFY(EventNameRegistry::registerName("journal_value") != InvalidEventId);
+    QVERIFY(EventNameRegistry::registerName("journal_empty") != InvalidEventId);
+}
+
+void TestEventJournal::cleanupTestCase()
+{
+}
+
+// Test init/cleanup methods -----------------------------------------------------------------------
+
+void TestEventJournal::init()
+{
+}
+
+void TestEventJournal::cleanup()
+{
+}
+
+// Test: Opening and closing of the journal --------------------------------------------------------
+
+void TestEventJournal::testOpenAndClose()
+{
+    QTemporaryDir temporaryDir;
+    QVERIFY(temporaryDir.isValid());
+    const QString directory = QDir(temporaryDir.path()).filePath("journal");
+
+    EventJournal journal(100, 0);
+    QCOMPARE(journal.segmentSize(), EventJournal::MinimumSegmentSize);
+    QCOMPARE(journal.commitInterval(), 1);
+    QVERIFY(!journal.isOpen());
+    QVERIFY(journal.directory().isEmpty());
+
+    // Closed journal
+    QCOMPARE(journal.append(Event("journal_event")), static_cast<std::uint64_t>(0U));
+    QVERIFY(!journal.sync());
+    QVERIFY(!journal.close());
+    QVERIFY(!journal.open(QString()));
+
+    // Open journal (the directory is created)
+    QVERIFY(journal.open(directory));
+    QVERIFY(journal.isOpen());
+    QCOMPARE(journal.directory(), directory);
+    QVERIFY(!journal.open(directory));
+    QCOMPARE(journal.lastSequence(), static_cast<std::uint64_t>(0U));
+    QCOMPARE(journal.checkpoint(), static_cast<std::uint64_t>(0U));
+
+    QVERIFY(journal.close());
+    QVERIFY(!journal.isOpen());
+    QVERIFY(journal.directory().isEmpty());
+}
+
+// Test: Appending and replaying of the events -----------------------------------------------------
+
+void TestEventJournal::testAppendAndReplay()
+{
+    QTemporaryDir temporaryDir;
+    QVERIFY(temporaryDir.isValid());
+
+    {
+        EventJournal journal;
+        QVERIFY(journal.open(temporaryDir.path()));
+
+        for (int i = 1; i <= 10; i++)
+        {
+            const std::uint64_t sequence =
+                    ((i % 2) == 0) ? journal.append(Event("journal_value", EventParameter<int>(i)))
+                                   : journal.append(Event("journal_empty"));
+            QCOMPARE(sequence, static_cast<std::uint64_t>(i));
+        }
+
+        QCOMPARE(journal.lastSequence(), static_cast<std::uint64_t>(10U));
+        QVERIFY(journal.sync());
+        QCOMPARE(journal.committedSequence(), static_cast<std::uint64_t>(10U));
+
+        // Events without a parameter are replayed as zero values
+        QCOMPARE(replayValues(journal, 1U), QList<int>({ 0, 2, 0, 4, 0, 6, 0, 8, 0, 10 }));
+        QCOMPARE(replayValues(journal, 6U), QList<int>({ 6, 0, 8, 0, 10 }));
+        QVERIFY(replayValues(journal, 11U).isEmpty());
+
+        // Replay stops when the handler returns false
+        std::uint64_t lastSequence = 0U;
+        QVERIFY(journal.replay(3U, [&](std::uint64_t sequence, Event &&event)
+        {
+            lastSequence = sequence;
+            return (event.name() != QString("journal_value"));
+        }));
+        QCOMPARE(lastSequence, static_cast<std::uint64_t>(4U));
+
+        journal.setCheckpoint(4U);
+        journal.setCheckpoint(2U);
+        QCOMPARE(journal.checkpoint(), static_cast<std::uint64_t>(4U));
+        QVERIFY(journal.close());
+    }
+
+    // Reopened journal continues after the last event
+    EventJournal journal;
+    QVERIFY(journal.open(temporaryDir.path()));
+    QCOMPARE(journal.lastSequence(), static_cast<std::uint64_t>(10U));
+    QCOMPARE(journal.checkpoint(), static_cast<std::uint64_t>(4U));
+
+    QCOMPARE(journal.append(Event("journal_value", EventParameter<int>(11))),
+             static_cast<std::uint64_t>(11U));
+
+    // Parameter with a different type ID is serialized with the serializer of its base type
+    QCOMPARE(journal.append(Event("journal_value",
+                                  std::make_unique<OwnTypeIdIntEventParameter>(12))),
+             static_cast<std::uint64_t>(12U));
+    QCOMPARE(replayValues(journal, 5U), QList<int>({ 0, 6, 0, 8, 0, 10, 11, 12 }));
+}
+
+// Test: Segment files -----------------------------------------------------------------------------
+
+void TestEventJournal::testSegments()
+{
+    QTemporaryDir temporaryDir;
+    QVERIFY(temporaryDir.isValid());
+    const QDir directory(temporaryDir.path());
+    const int eventCount = 1000;
+
+    {
+        EventJournal journal(EventJournal::MinimumSegmentSize, 1);
+        QVERIFY(journal.open(directory.path()));
+
+        for (int i = 1; i <= eventCount; i++)
+        {
+            QCOMPARE(journal.append(Event("journal_value", EventParameter<int>(i))),
+                     static_cast<std::uint64_t>(i));
+        }
+
+        QVERIFY(journal.sync());
+        QVERIFY(directory.entryList(QStringList { "*.segment" }, QDir::Files).size() > 2);
+
+        // All events are replayed in order across the segments
+        QList<int> expectedValues;
+
+        for (int i = 1; i <= eventCount; i++)
+        {
+            expectedValues.append(i);
+        }
+
+        QCOMPARE(replayValues(journal, 1U), expectedValues);
+
+        // Only the segments with processed events are removed
+        QCOMPARE(journal.removeProcessedSegments(), 0);
+
+        journal.setCheckpoint(500U);
+        QVERIFY(journal.sync());
+        QVERIFY(journal.removeProcessedSegments() > 0);
+        QCOMPARE(replayValues(journal, 501U), expectedValues.mid(500));
+
+        QVERIFY(!journal.replay(1U, [&](std::uint64_t, Event &&) { return true; }));
+        QVERIFY(journal.close());
+    }
+
+    // Checkpoint is kept after reopening
+    EventJournal journal(EventJournal::MinimumSegmentSize, 1);
+    QVERIFY(journal.open(directory.path()));
+    QCOMPARE(journal.lastSequence(), static_cast<std::uint64_t>(eventCount));
+    QCOMPARE(journal.checkpoint(), static_cast<std::uint64_t>(500U));
+    QCOMPARE(replayValues(journal, 501U).size(), eventCount - 500);
+
+    // Removing all events except the current segment
+    journal.setCheckpoint(eventCount);
+    QVERIFY(journal.sync());
+    QVERIFY(journal.removeProcessedSegments() > 0);
+    QVERIFY(!journal.replay(eventCount, [&](std::uint64_t, Event &&) { return true; }));
+    QVERIFY(journal.close());
+
+    // Sequence numbers continue after the checkpoint if all segments were removed
+    QVERIFY(journal.open(directory.path()));
+    QCOMPARE(journal.lastSequence(), static_cast<std::uint64_t>(eventCount));
+    QCOMPARE(journal.append(Event("journal_empty")), static_cast<std::uint64_t>(eventCount + 1));
+}
+
+// Test: Event parameter without a serializer ------------------------------------------------------
+
+void TestEventJournal::testUnregisteredParameter()
+{
+    struct Unregistered
+    {
+        int value;
+    };
+
+    QTemporaryDir temporaryDir;
+    QVERIFY(temporaryDir.isValid());
+
+    EventJournal journal;
+    QVERIFY(journal.open(temporaryDir.path()));
+
+    QCOMPARE(journal.append(Event("journal_value", EventParameter<Unregistered>({ 1 }))),
+             static_cast<std::uint64_t>(0U));
+    QCOMPARE(journal.append(Event("journal_value", EventParameter<int>(1))),
+             static_cast<std::uint64_t>(1U));
+    QCOMPARE(journal.lastSequence(), static_cast<std::uint64_t>(1U));
+
+    // Event names that are not registered are rejected
+    QCOMPARE(journal.append(Event("journal_unregistered")), static_cast<std::uint64_t>(0U));
+    QCOMPARE(journal.lastSequence(), static_cast<std::uint64_t>(1U));
+}
+
+// Test: Recovery of a state machine from the journal ----------------------------------------------
+
+void TestEventJournal::testStateMachineRecovery()
+{
+    QTemporaryDir temporaryDir;
+    QVERIFY(temporaryDir.isValid());
+
+    QList<int> processedValues;
+    auto definition = createDefinition(&processedValues);
+    QVERIFY(definition);
+
+    // First instance processes only some of the events
+    {
+        auto journal = std::make_shared<EventJournal>();
+        QVERIFY(journal->open(temporaryDir.path()));
+
+        StateMachineInstance instance(definition);
+        QVERIFY(instance.setJournal(journal));
+        QVERIFY(instance.journal() == journal);
+        QVERIFY(instance.start());
+
+        for (int i = 1; i <= 10; i++)
+        {
+            QVERIFY(instance.addEventToBack(Event("journal_value", EventParameter<int>(i))));
+        }
+
+        // Events added to the front are not journaled
+        QVERIFY(instance.addEventToFront(Event("journal_value", EventParameter<int>(100))));
+
+        for (int i = 0; i < 5; i++)
+        {
+            QVERIFY(instance.processNextEvent());
+        }
+
+        QCOMPARE(processedValues, QList<int>({ 100, 1, 2, 3, 4 }));
+        QCOMPARE(journal->lastSequence(), static_cast<std::uint64_t>(10U));
+        QCOMPARE(journal->checkpoint(), static_cast<std::uint64_t>(4U));
+    }
+
+    // New instance with the reopened journal processes the rest of the events
+    processedValues.clear();
+
+    auto journal = std::make_shared<EventJournal>();
+    QVERIFY(journal->open(temporaryDir.path()));
+
+    StateMachineInstance instance(definition);
+    QVERIFY(instance.setJournal(journal));
+    QVERIFY(instance.start());
+    QVERIFY(instance.hasPendingEvents());
+
+    QVERIFY(instance.poll());
+    QCOMPARE(processedValues, QList<int>({ 5, 6, 7, 8, 9, 10 }));
+    QCOMPARE(journal->checkpoint(), static_cast<std::uint64_t>(10U));
+    QVERIFY(!instance.hasPendingEvents());
+
+    // Events pending at stop are replayed when the state machine is started again
+    processedValues.clear();
+    QVERIFY(instance.addEventToBack(Event("journal_value", EventParameter<int>(11))));
+    QVERIFY(instance.addEventToBack(Event("journal_value", EventParameter<int>(12))));
+    QVERIFY(instance.processNextEvent());
+    QVERIFY(instance.addEventToBack(Event("journal_value", EventParameter<int>(13))));
+    QVERIFY(instance.stop());
+
+    QVERIFY(instance.start());
+    QVERIFY(instance.poll());
+    QCOMPARE(processedValues, QList<int>({ 11, 12, 13 }));
+    QCOMPARE(journal->checkpoint(), static_cast<std::uint64_t>(13U));
+    QCOMPARE(journal->lastSequence(), static_cast<std::uint64_t>(13U));
+
+    // Events that cannot be journaled are rejected
+    struct Unregistered
+    {
+        int value;
+    };
+
+    QVERIFY(!instance.addEventToBack(Event("journal_value", EventParameter<Unregistered>({ 1 }))));
+    QVERIFY(!instance.hasPendingEvents());
+}
+
+// Test: Journal restrictions of a state machine ---------------------------------------------------
+
+void TestEventJournal::testStateMachineRestrictions()
+{
+    QList<int> processedValues;
+    auto definition = createDefinition(&processedValues);
+    QVERIFY(definition);
+
+    auto journal = std::make_shared<EventJournal>();
+    StateMachineInstance instance(definition);
+
+    // Lock-free event queue mode and coalescing rely on a different order of the events
+    QVERIFY(instance.setEventQueueMode(StateMachineInstance::EventQueueMode::LockFree));
+    QVERIFY(!instance.setJournal(journal));
+    QVERIFY(instance.setEventQueueMode(StateMachineInstance::EventQueueMode::Locked));
+
+    QVERIFY(instance.setEventCoalescingPolicy(
+                "journal_value", StateMachineInstance::CoalescingPolicy::ReplaceInPlace));
+    QVERIFY(!instance.setJournal(journal));
+    QVERIFY(instance.setEventCoalescingPolicy("journal_value",
+                                              StateMachineInstance::CoalescingPolicy::None));
+
+    QVERIFY(instance.setJournal(journal));
+    QVERIFY(!instance.setEventQueueMode(StateMachineInstance::EventQueueMode::LockFree));
+    QVERIFY(!instance.setEventCoalescingPolicy(
+                "journal_value", StateMachineInstance::CoalescingPolicy::MoveToBack));
+    QVERIFY(instance.setEventCoalescingPolicy("journal_value",
+                                              StateMachineInstance::CoalescingPolicy::None));
+
+    // Snapshot cannot be restored as the pending events are restored from the journal
+    QVERIFY(!instance.restore(instance.snapshot()));
+
+    // Journal must be open
+    QVERIFY(!instance.start());
+
+    QTemporaryDir temporaryDir;
+    QVERIFY(temporaryDir.isValid());
+    QVERIFY(journal->open(temporaryDir.path()));
+    QVERIFY(instance.start());
+
+    // Journal can be changed only when the state machine is stopped
+    QVERIFY(!instance.setJournal({}));
+    QVERIFY(instance.stop());
+    QVERIFY(instance.setJournal({}));
+    QVERIFY(!instance.journal());
+}
+
+// Helper methods ----------------------------------------------------------------------------------
+
+QList<int> TestEventJournal::replayValues(const EventJournal &journal,
+                                          const std::uint64_t fromSequence)
+{
+    QList<int> values;
+    std::uint64_t expectedSequence = fromSequence;
+
+    const bool result = journal.replay(fromSequence, [&](std::uint64_t sequence, Event &&event)
+    {
+        if (sequence != expectedSequence)
+        {
+            return false;
+        }
+
+        const auto *parameter = event.parameter<EventParameter<int>>();
+        values.append((parameter != nullptr) ? parameter->value() : 0);
+        expectedSequence++;
+        return true;
+    });
+
+    if (!result)
+    {
+        qWarning() << "Failed to replay the journal";
+        return {};
+    }
+
+    return values;
+}
+
+std::shared_ptr<StateMachineDefinition> TestEventJournal::createDefinition(
+        QList<int> *processedValues)
+{
+    auto definition = std::make_shared<StateMachineDefinition>();
+
+    if (!(definition->addState("a") &&
+          definition->setInitialTransition("a") &&
+          definition->addInternalTransition("a",
+                                            "journal_value",
+                                            [processedValues](const Event &event, const QString &)
+    {
+        processedValues->append(event.parameter<EventParameter<int>>()->value());
+    }) &&
+          definition->validate()))
+    {
+        return {};
+    }
+
+    return definition;
+}
+
+// Main function -----------------------------------------------------------------------------------
+
+QTEST_MAIN(TestEventJournal)
+#include "testEventJournal.moc"
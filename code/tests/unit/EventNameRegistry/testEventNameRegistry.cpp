@@ -0,0 +1,176 @@
+/* This file is part of C++ State Machine Framework.
+ *
+ * C++ State Machine Framework is free software: you can redistribute it and/or modify it under the
+ * terms of the GNU Lesser General Public License as published by the Free Software Foundation,
+ * either version 3 of the License, or (at your option) any later version.
+ *
+ * C++ State Machine Framework is distributed in the hope that it will be useful, but WITHOUT ANY
+ * WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR
+ * PURPOSE. See the GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License along with C++ State
+ * Machine Framework. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+/*!
+ * \file
+ *
+ * Contains unit tests for the EventNameRegistry class
+ */
+
+// C++ State Machine Framework includes
+#include <CppStateMachineFramework/EventNameRegistry.hpp>
+
+// Qt includes
+#include <QtCore/QDebug>
+#include <QtTest/QTest>
+
+// System includes
+#include <thread>
+
+// Forward declarations
+
+// Macros
+
+// Test class declaration --------------------------------------------------------------------------
+
+using namespace CppStateMachineFramework;
+
+class TestEventNameRegistry : public QObject
+{
+    Q_OBJECT
+
+private slots:
+    // Functions executed by QtTest before and after test suite
+    void initTestCase();
+    void cleanupTestCase();
+
+    // Functions executed by QtTest before and after each test
+    void init();
+    void cleanup();
+
+    // Test functions
+    void testRegisterName();
+    void testInvalidNames();
+    void testManyNames();
+    void testCachedLookup();
+};
+
+// Test Case init/cleanup methods ------------------------------------------------------------------
+
+void TestEventNameRegistry::initTestCase()
+{
+}
+
+void TestEventNameRegistry::cleanupTestCase()
+{
+}
+
+// Test init/cleanup methods -----------------------------------------------------------------------
+
+void TestEventNameRegistry::init()
+{
+}
+
+void TestEventNameRegistry::cleanup()
+{
+}
+
+// Test: registerName() ----------------------------------------------------------------------------
+
+void TestEventNameRegistry::testRegisterName()
+{
+    // An unregistered name must not have an ID
+    QCOMPARE(EventNameRegistry::id("registry_test1"), InvalidEventId);
+
+    // Register a name
+    const EventId id1 = EventNameRegistry::registerName("registry_test1");
+    QVERIFY(id1 != InvalidEventId);
+    QVERIFY(EventNameRegistry::isRegistered(id1));
+    QCOMPARE(EventNameRegistry::id("registry_test1"), id1);
+    QCOMPARE(EventNameRegistry::name(id1), QString("registry_test1"));
+
+    // Registering the same name again must return the same ID
+    QCOMPARE(EventNameRegistry::registerName("registry_test1"), id1);
+
+    // Register another name, IDs must be dense
+    const EventId id2 = EventNameRegistry::registerName("registry_test2");
+    QCOMPARE(id2, id1 + 1U);
+    QCOMPARE(EventNameRegistry::name(id2), QString("registry_test2"));
+    QVERIFY(EventNameRegistry::count() >= id2);
+}
+
+// Test: Invalid names and IDs ---------------------------------------------------------------------
+
+void TestEventNameRegistry::testInvalidNames()
+{
+    // Empty name must not be registered
+    QCOMPARE(EventNameRegistry::registerName(QString()), InvalidEventId);
+    QCOMPARE(EventNameRegistry::id(QString()), InvalidEventId);
+
+    // Invalid and unregistered IDs must not have a name
+    QVERIFY(!EventNameRegistry::isRegistered(InvalidEventId));
+    QVERIFY(EventNameRegistry::name(InvalidEventId).isEmpty());
+
+    const EventId unregisteredId = EventNameRegistry::count() + 1U;
+    QVERIFY(!EventNameRegistry::isRegistered(unregisteredId));
+    QVERIFY(EventNameRegistry::name(unregisteredId).isEmpty());
+}
+
+// Test: Registration of many names ----------------------------------------------------------------
+
+void TestEventNameRegistry::testManyNames()
+{
+    // Register enough names to use multiple storage chunks
+    const int count = 1000;
+    const EventId firstId = EventNameRegistry::registerName("registry_many_0");
+
+    for (int i = 1; i < count; i++)
+    {
+        const EventId id = EventNameRegistry::registerName(QString("registry_many_%1").arg(i));
+        QCOMPARE(id, firstId + static_cast<EventId>(i));
+    }
+
+    // References to names must stay valid
+    const QString &firstName = EventNameRegistry::name(firstId);
+
+    for (int i = 0; i < count; i++)
+    {
+        const EventId id = firstId + static_cast<EventId>(i);
+        QCOMPARE(EventNameRegistry::name(id), QString("registry_many_%1").arg(i));
+    }
+
+    QCOMPARE(firstName, QString("registry_many_0"));
+}
+
+// Test: Cached lookup -----------------------------------------------------------------------------
+
+void TestEventNameRegistry::testCachedLookup()
+{
+    // Name that was not found must be found after it is registered by another thread
+    QCOMPARE(EventNameRegistry::id("registry_cached"), InvalidEventId);
+    QCOMPARE(EventNameRegistry::id("registry_cached"), InvalidEventId);
+
+    EventId id = InvalidEventId;
+    std::thread thread([&id]() { id = EventNameRegistry::registerName("registry_cached"); });
+    thread.join();
+
+    QVERIFY(id != InvalidEventId);
+    QCOMPARE(EventNameRegistry::id("registry_cached"), id);
+
+    // Lookups of more names than the cache holds must stay correct
+    for (int round = 0; round < 2; round++)
+    {
+        for (int i = 0; i < 1000; i++)
+        {
+            const QString name = QString("registry_many_%1").arg(i);
+            QCOMPARE(EventNameRegistry::name(EventNameRegistry::id(name)), name);
+            QCOMPARE(EventNameRegistry::id(QString("registry_missing_%1").arg(i)), InvalidEventId);
+        }
+    }
+}
+
+// Main function -----------------------------------------------------------------------------------
+
+QTEST_MAIN(TestEventNameRegistry)
+#include "testEventNameRegistry.moc"
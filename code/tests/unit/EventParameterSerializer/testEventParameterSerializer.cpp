@@ -0,0 +1,214 @@
+/* This file is part of C++ State Machine Framework.
+ *
+ * C++ State Machine Framework is free software: you can redistribute it and/or modify it under the
+ * terms of the GNU Lesser General Public License as published by the Free Software Foundation,
+ * either version 3 of the License, or (at your option) any later version.
+ *
+ * C++ State Machine Framework is distributed in the hope that it will be useful, but WITHOUT ANY
+ * WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR
+ * PURPOSE. See the GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License along with C++ State
+ * Machine Framework. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+/*!
+ * \file
+ *
+ * Contains unit tests for the BinaryWriter, BinaryReader and EventParameterSerializer classes
+ */
+
+// C++ State Machine Framework includes
+#include <CppStateMachineFramework/EventParameterSerializer.hpp>
+
+// Qt includes
+#include <QtCore/QDebug>
+#include <QtTest/QTest>
+
+// System includes
+
+// Forward declarations
+
+// Macros
+
+// Test class declaration --------------------------------------------------------------------------
+
+using namespace CppStateMachineFramework;
+
+class OwnTypeIdIntEventParameter : public EventParameter<int>
+{
+public:
+    OwnTypeIdIntEventParameter(int value)
+        : EventParameter<int>(eventParameterTypeId<OwnTypeIdIntEventParameter>(), std::move(value))
+    {
+    }
+};
+
+class TestEventParameterSerializer : public QObject
+{
+    Q_OBJECT
+
+private slots:
+    // Functions executed by QtTest before and after test suite
+    void initTestCase();
+    void cleanupTestCase();
+
+    // Functions executed by QtTest before and after each test
+    void init();
+    void cleanup();
+
+    // Test functions
+    void testWriterAndReader();
+    void testRegistration();
+    void testEventRoundTrip();
+};
+
+// Test Case init/cleanup methods ------------------------------------------------------------------
+
+void TestEventParameterSerializer::initTestCase()
+{
+}
+
+void TestEventParameterSerializer::cleanupTestCase()
+{
+}
+
+// Test init/cleanup methods -----------------------------------------------------------------------
+
+void TestEventParameterSerializer::init()
+{
+}
+
+void TestEventParameterSerializer::cleanup()
+{
+}
+
+// Test: Binary writer and reader ------------------------------------------------------------------
+
+void TestEventParameterSerializer::testWriterAndReader()
+{
+    QByteArray data;
+    BinaryWriter writer(&data);
+
+    writer.writeValue(static_cast<std::uint32_t>(0U));
+    writer.writeString("text");
+    writer.writeValue(static_cast<std::int16_t>(-5));
+    writer.writeString(QString());
+    writer.overwriteValue(0, static_cast<std::uint32_t>(123U));
+    QCOMPARE(writer.size(), 4 + (4 + 4) + 2 + 4);
+
+    BinaryReader reader(data.constData(), static_cast<std::size_t>(data.size()));
+    std::uint32_t number = 0U;
+    std::int16_t smallNumber = 0;
+    QString text;
+
+    QVERIFY(reader.readValue(&number));
+    QCOMPARE(number, static_cast<std::uint32_t>(123U));
+    QVERIFY(reader.readString(&text));
+    QCOMPARE(text, QString("text"));
+    QVERIFY(reader.readValue(&smallNumber));
+    QCOMPARE(smallNumber, static_cast<std::int16_t>(-5));
+    QVERIFY(reader.readString(&text));
+    QVERIFY(text.isEmpty());
+    QVERIFY(reader.atEnd());
+
+    // Reading past the end fails and does not change the output
+    QVERIFY(!reader.readValue(&number));
+    QCOMPARE(number, static_cast<std::uint32_t>(123U));
+
+    // Truncated string
+    BinaryReader truncatedReader(data.constData(), 4U + 4U + 3U);
+    QVERIFY(truncatedReader.skip(4U));
+    QVERIFY(!truncatedReader.readString(&text));
+    QCOMPARE(truncatedReader.remaining(), static_cast<std::size_t>(7U));
+    QVERIFY(!truncatedReader.skip(8U));
+    QVERIFY(truncatedReader.skip(7U));
+    QVERIFY(truncatedReader.atEnd());
+}
+
+// Test: Registration of the serializers -----------------------------------------------------------
+
+void TestEventParameterSerializer::testRegistration()
+{
+    QVERIFY(EventParameterSerializer::handler(eventParameterTypeId<EventParameter<int>>()) ==
+            nullptr);
+    QVERIFY(EventParameterSerializer::handlerByTypeName("serializer_int") == nullptr);
+
+    QVERIFY(!EventParameterSerializer::registerType<int>(QString()));
+    QVERIFY(EventParameterSerializer::registerType<int>("serializer_int"));
+
+    // Type and type name can be registered only once
+    QVERIFY(!EventParameterSerializer::registerType<int>("serializer_int_2"));
+    QVERIFY(!EventParameterSerializer::registerType<double>("serializer_int"));
+
+    const auto *handler =
+            EventParameterSerializer::handler(eventParameterTypeId<EventParameter<int>>());
+    QVERIFY(handler != nullptr);
+    QCOMPARE(handler->typeName, QString("serializer_int"));
+    QVERIFY(EventParameterSerializer::handlerByTypeName("serializer_int") == handler);
+
+    // Parameters are looked up by their type ID first and then with a dynamic cast
+    const EventParameter<int> parameter(1);
+    const OwnTypeIdIntEventParameter ownTypeIdParameter(1);
+    const EventParameter<float> unregisteredParameter(1.0F);
+    QVERIFY(EventParameterSerializer::handler(parameter) == handler);
+    QVERIFY(EventParameterSerializer::handler(ownTypeIdParameter) == handler);
+    QVERIFY(EventParameterSerializer::handler(unregisteredParameter) == nullptr);
+}
+
+// Test: Serialization of an event parameter -------------------------------------------------------
+
+void TestEventParameterSerializer::testEventRoundTrip()
+{
+    struct Sample
+    {
+        std::int64_t timestamp;
+        double value;
+    };
+
+    QVERIFY(EventParameterSerializer::registerType<Sample>("serializer_sample"));
+    QVERIFY(EventParameterSerializer::registerType<QString>(
+                "serializer_string",
+                [](const QString &value, BinaryWriter *writer) { writer->writeString(value); },
+                [](BinaryReader *reader, QString *value) { return reader->readString(value); }));
+
+    const Event sampleEvent("serializer_event", EventParameter<Sample>(Sample { 10, 2.5 }));
+    const Event stringEvent("serializer_event", EventParameter<QString>("value"));
+
+    QByteArray data;
+    BinaryWriter writer(&data);
+
+    const auto *sampleHandler = EventParameterSerializer::handlerByTypeName("serializer_sample");
+    const auto *stringHandler = EventParameterSerializer::handlerByTypeName("serializer_string");
+    QVERIFY(sampleHandler != nullptr);
+    QVERIFY(stringHandler != nullptr);
+    QVERIFY(sampleHandler->typeId == sampleEvent.parameter()->typeId());
+
+    sampleHandler->serialize(*sampleEvent.parameter(), &writer);
+    stringHandler->serialize(*stringEvent.parameter(), &writer);
+    QCOMPARE(data.size(), static_cast<int>(sizeof(Sample) + 4U + 5U));
+
+    // Deserialized events store small parameters inline
+    BinaryReader reader(data.constData(), static_cast<std::size_t>(data.size()));
+    Event event(sampleEvent.name());
+
+    QVERIFY(sampleHandler->deserialize(&reader, &event));
+    QCOMPARE(event.name(), QString("serializer_event"));
+    QVERIFY(event.isParameterInline());
+    QCOMPARE(event.parameter<EventParameter<Sample>>()->value().timestamp,
+             static_cast<std::int64_t>(10));
+    QCOMPARE(event.parameter<EventParameter<Sample>>()->value().value, 2.5);
+
+    QVERIFY(stringHandler->deserialize(&reader, &event));
+    QCOMPARE(event.parameter<EventParameter<QString>>()->value(), QString("value"));
+    QVERIFY(reader.atEnd());
+
+    // Not enough data
+    BinaryReader truncatedReader(data.constData(), sizeof(Sample) - 1U);
+    QVERIFY(!sampleHandler->deserialize(&truncatedReader, &event));
+}
+
+// Main function -----------------------------------------------------------------------------------
+
+QTEST_MAIN(TestEventParameterSerializer)
+#include "testEventParameterSerializer.moc"
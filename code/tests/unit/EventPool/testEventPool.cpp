@@ -0,0 +1,208 @@
+/* This file is part of C++ State Machine Framework.
+ *
+ * C++ State Machine Framework is free software: you can redistribute it and/or modify it under the
+ * terms of the GNU Lesser General Public License as published by the Free Software Foundation,
+ * either version 3 of the License, or (at your option) any later version.
+ *
+ * C++ State Machine Framework is distributed in the hope that it will be useful, but WITHOUT ANY
+ * WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR
+ * PURPOSE. See the GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License along with C++ State
+ * Machine Framework. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+/*!
+ * \file
+ *
+ * Contains unit tests for the EventPool class
+ */
+
+// C++ State Machine Framework includes
+#include <CppStateMachineFramework/EventPool.hpp>
+
+// Qt includes
+#include <QtCore/QDebug>
+#include <QtTest/QTest>
+
+// System includes
+#include <atomic>
+#include <thread>
+#include <vector>
+
+// Forward declarations
+
+// Macros
+
+// Test class declaration --------------------------------------------------------------------------
+
+using namespace CppStateMachineFramework;
+
+class TestEventPool : public QObject
+{
+    Q_OBJECT
+
+private slots:
+    // Functions executed by QtTest before and after test suite
+    void initTestCase();
+    void cleanupTestCase();
+
+    // Functions executed by QtTest before and after each test
+    void init();
+    void cleanup();
+
+    // Test functions
+    void testAllocateAndRelease();
+    void testDisabledPool();
+    void testMultipleThreads();
+};
+
+// Test Case init/cleanup methods ------------------------------------------------------------------
+
+void TestEventPool::initTestCase()
+{
+}
+
+void TestEventPool::cleanupTestCase()
+{
+}
+
+// Test init/cleanup methods -----------------------------------------------------------------------
+
+void TestEventPool::init()
+{
+}
+
+void TestEventPool::cleanup()
+{
+}
+
+// Test: Allocate and release blocks ---------------------------------------------------------------
+
+void TestEventPool::testAllocateAndRelease()
+{
+    // Capacity is rounded up to a power of two
+    EventPool pool(64U, 3);
+    QCOMPARE(pool.blockSize(), static_cast<std::size_t>(64U));
+    QCOMPARE(pool.capacity(), 4);
+
+    // Empty pool takes the blocks from the heap
+    std::vector<void *> blocks;
+
+    for (int i = 0; i < 6; i++)
+    {
+        blocks.push_back(pool.allocate());
+        QVERIFY(blocks.back() != nullptr);
+    }
+
+    auto statistics = pool.statistics();
+    QCOMPARE(statistics.hits, static_cast<std::uint64_t>(0U));
+    QCOMPARE(statistics.misses, static_cast<std::uint64_t>(6U));
+    QCOMPARE(statistics.highWaterMark, static_cast<std::int64_t>(6));
+
+    // Only up to the capacity of the released blocks is kept in the pool
+    for (void *block : blocks)
+    {
+        pool.release(block);
+    }
+
+    blocks.clear();
+
+    // Released blocks are reused
+    for (int i = 0; i < 5; i++)
+    {
+        blocks.push_back(pool.allocate());
+    }
+
+    statistics = pool.statistics();
+    QCOMPARE(statistics.hits, static_cast<std::uint64_t>(4U));
+    QCOMPARE(statistics.misses, static_cast<std::uint64_t>(7U));
+    QCOMPARE(statistics.highWaterMark, static_cast<std::int64_t>(6));
+
+    // Blocks are released back to the pool on release (the rest is released on destruction)
+    pool.release(nullptr);
+
+    for (void *block : blocks)
+    {
+        pool.release(block);
+    }
+}
+
+// Test: Disabled pool -----------------------------------------------------------------------------
+
+void TestEventPool::testDisabledPool()
+{
+    EventPool pool(64U, 0);
+    QCOMPARE(pool.capacity(), 0);
+
+    for (int i = 0; i < 3; i++)
+    {
+        void *block = pool.allocate();
+        QVERIFY(block != nullptr);
+        pool.release(block);
+    }
+
+    const auto statistics = pool.statistics();
+    QCOMPARE(statistics.hits, static_cast<std::uint64_t>(0U));
+    QCOMPARE(statistics.misses, static_cast<std::uint64_t>(3U));
+    QCOMPARE(statistics.highWaterMark, static_cast<std::int64_t>(1));
+}
+
+// Test: Multiple threads --------------------------------------------------------------------------
+
+void TestEventPool::testMultipleThreads()
+{
+    const int threadCount = 8;
+    const int allocationCount = 10000;
+    const int blocksPerAllocation = 4;
+
+    EventPool pool(sizeof(int), threadCount * blocksPerAllocation);
+    std::vector<std::thread> threads;
+    std::atomic<int> sharedBlockCount(0);
+
+    for (int thread = 0; thread < threadCount; thread++)
+    {
+        threads.emplace_back([&pool, &sharedBlockCount, thread]()
+        {
+            int *blocks[blocksPerAllocation] = {};
+
+            for (int i = 0; i < allocationCount; i++)
+            {
+                for (auto &block : blocks)
+                {
+                    block = static_cast<int *>(pool.allocate());
+                    *block = thread;
+                }
+
+                // Blocks must not be shared between the threads
+                for (auto &block : blocks)
+                {
+                    if (*block != thread)
+                    {
+                        sharedBlockCount++;
+                    }
+
+                    pool.release(block);
+                }
+            }
+        });
+    }
+
+    for (auto &thread : threads)
+    {
+        thread.join();
+    }
+
+    QCOMPARE(sharedBlockCount.load(), 0);
+
+    const auto statistics = pool.statistics();
+    QCOMPARE(statistics.hits + statistics.misses,
+             static_cast<std::uint64_t>(threadCount * allocationCount * blocksPerAllocation));
+    QVERIFY(statistics.highWaterMark <= (threadCount * blocksPerAllocation));
+    QVERIFY(statistics.hits > 0U);
+}
+
+// Main function -----------------------------------------------------------------------------------
+
+QTEST_MAIN(TestEventPool)
+#include "testEventPool.moc"
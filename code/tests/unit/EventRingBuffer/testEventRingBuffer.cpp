@@ -0,0 +1,242 @@
+/* This file is part of C++ State Machine Framework.
+ *
+ * C++ State Machine Framework is free software: you can redistribute it and/or modify it under the
+ * terms of the GNU Lesser General Public License as published by the Free Software Foundation,
+ * either version 3 of the License, or (at your option) any later version.
+ *
+ * C++ State Machine Framework is distributed in the hope that it will be useful, but WITHOUT ANY
+ * WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR
+ * PURPOSE. See the GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License along with C++ State
+ * Machine Framework. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+/*!
+ * \file
+ *
+ * Contains unit tests for the EventRingBuffer class
+ */
+
+// C++ State Machine Framework includes
+#include <CppStateMachineFramework/EventRingBuffer.hpp>
+
+// Qt includes
+#include <QtCore/QDebug>
+#include <QtTest/QTest>
+
+// System includes
+
+// Forward declarations
+
+// Macros
+
+// Test class declaration --------------------------------------------------------------------------
+
+using namespace CppStateMachineFramework;
+
+class TestEventRingBuffer : public QObject
+{
+    Q_OBJECT
+
+private slots:
+    // Functions executed by QtTest before and after test suite
+    void initTestCase();
+    void cleanupTestCase();
+
+    // Functions executed by QtTest before and after each test
+    void init();
+    void cleanup();
+
+    // Test functions
+    void testPushPop();
+    void testCapacity();
+    void testInsert();
+
+private:
+    static int value(Event &event);
+};
+
+// Test Case init/cleanup methods ------------------------------------------------------------------
+
+void TestEventRingBuffer::initTestCase()
+{
+}
+
+void TestEventRingBuffer::cleanupTestCase()
+{
+}
+
+// Test init/cleanup methods -----------------------------------------------------------------------
+
+void TestEventRingBuffer::init()
+{
+}
+
+void TestEventRingBuffer::cleanup()
+{
+}
+
+// Test: Add and remove events ---------------------------------------------------------------------
+
+void TestEventRingBuffer::testPushPop()
+{
+    EventRingBuffer queue;
+    QVERIFY(queue.isEmpty());
+    QCOMPARE(queue.size(), static_cast<std::size_t>(0U));
+
+    // Events can be added to both ends of the queue
+    queue.pushBack(Event("ring", EventParameter<int>(2)));
+    queue.pushBack(Event("ring", EventParameter<int>(3)));
+    queue.pushFront(Event("ring", EventParameter<int>(1)));
+    QVERIFY(!queue.isEmpty());
+    QCOMPARE(queue.size(), static_cast<std::size_t>(3U));
+    QCOMPARE(value(queue.front()), 1);
+    QCOMPARE(value(queue[1]), 2);
+    QCOMPARE(value(queue[2]), 3);
+
+    // Events can be removed from both ends of the queue
+    queue.popFront();
+    QCOMPARE(value(queue.front()), 2);
+    queue.popBack();
+    QCOMPARE(queue.size(), static_cast<std::size_t>(1U));
+    QCOMPARE(value(queue.front()), 2);
+
+    // Events must keep their order when the queue wraps around the end of the buffer
+    for (int i = 0; i < 1000; i++)
+    {
+        queue.pushBack(Event("ring", EventParameter<int>(i)));
+        queue.popFront();
+        QCOMPARE(queue.size(), static_cast<std::size_t>(1U));
+        QCOMPARE(value(queue.front()), i);
+    }
+
+    // Moved queue takes over the events
+    EventRingBuffer other(std::move(queue));
+    QVERIFY(queue.isEmpty());
+    QCOMPARE(value(other.front()), 999);
+
+    queue = std::move(other);
+    QVERIFY(other.isEmpty());
+    QCOMPARE(value(queue.front()), 999);
+
+    queue.clear();
+    QVERIFY(queue.isEmpty());
+}
+
+// Test: Capacity ----------------------------------------------------------------------------------
+
+void TestEventRingBuffer::testCapacity()
+{
+    EventRingBuffer queue;
+    QCOMPARE(queue.capacity(), static_cast<std::size_t>(0U));
+
+    // Capacity is rounded up to a power of two
+    queue.reserve(100U);
+    QCOMPARE(queue.capacity(), static_cast<std::size_t>(128U));
+
+    for (int i = 0; i < 128; i++)
+    {
+        queue.pushFront(Event("ring", EventParameter<int>(127 - i)));
+    }
+
+    QCOMPARE(queue.capacity(), static_cast<std::size_t>(128U));
+
+    // Buffer grows when an event is added to a full queue and the events keep their order
+    queue.pushBack(Event("ring", EventParameter<int>(128)));
+    QCOMPARE(queue.capacity(), static_cast<std::size_t>(256U));
+    QCOMPARE(queue.size(), static_cast<std::size_t>(129U));
+
+    for (int i = 0; i <= 128; i++)
+    {
+        QCOMPARE(value(queue[static_cast<std::size_t>(i)]), i);
+    }
+
+    // Buffer is kept when the queue is cleared
+    queue.clear();
+    QCOMPARE(queue.capacity(), static_cast<std::size_t>(256U));
+}
+
+// Test: Insert events -----------------------------------------------------------------------------
+
+void TestEventRingBuffer::testInsert()
+{
+    EventRingBuffer queue;
+    EventRingBuffer other;
+
+    // Insert in the middle of a queue that wraps around the end of the buffer
+    queue.reserve(16U);
+
+    for (int i = 0; i < 10; i++)
+    {
+        queue.pushBack(Event("ring", EventParameter<int>(0)));
+    }
+
+    queue.popFront(10U);
+
+    for (const int i : {0, 1, 5, 6})
+    {
+        queue.pushBack(Event("ring", EventParameter<int>(i)));
+    }
+
+    for (int i = 2; i <= 4; i++)
+    {
+        other.pushBack(Event("ring", EventParameter<int>(i)));
+    }
+
+    queue.insert(2U, other);
+    QVERIFY(other.isEmpty());
+    QCOMPARE(queue.size(), static_cast<std::size_t>(7U));
+
+    for (int i = 0; i < 7; i++)
+    {
+        QCOMPARE(value(queue[static_cast<std::size_t>(i)]), i);
+    }
+
+    // Insert that needs a larger buffer
+    for (int i = 0; i < 20; i++)
+    {
+        other.pushBack(Event("ring", EventParameter<int>(i + 7)));
+    }
+
+    queue.insert(queue.size(), other);
+    QCOMPARE(queue.size(), static_cast<std::size_t>(27U));
+
+    for (int i = 0; i < 27; i++)
+    {
+        QCOMPARE(value(queue[static_cast<std::size_t>(i)]), i);
+    }
+
+    // Insert at the front and close to the front (the head moves around the start of the buffer)
+    queue.clear();
+
+    for (const int i : {2, 4, 5, 6, 7, 8})
+    {
+        queue.pushBack(Event("ring", EventParameter<int>(i)));
+    }
+
+    other.pushBack(Event("ring", EventParameter<int>(0)));
+    other.pushBack(Event("ring", EventParameter<int>(1)));
+    queue.insert(0U, other);
+
+    other.pushBack(Event("ring", EventParameter<int>(3)));
+    queue.insert(3U, other);
+    QCOMPARE(queue.size(), static_cast<std::size_t>(9U));
+
+    for (int i = 0; i < 9; i++)
+    {
+        QCOMPARE(value(queue[static_cast<std::size_t>(i)]), i);
+    }
+}
+
+// Helper methods ----------------------------------------------------------------------------------
+
+int TestEventRingBuffer::value(Event &event)
+{
+    return event.parameter<EventParameter<int>>()->value();
+}
+
+// Main function -----------------------------------------------------------------------------------
+
+QTEST_MAIN(TestEventRingBuffer)
+#include "testEventRingBuffer.moc"
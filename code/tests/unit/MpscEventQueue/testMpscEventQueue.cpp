@@ -0,0 +1,184 @@
+/* This file is part of C++ State Machine Framework.
+ *
+ * C++ State Machine Framework is free software: you can redistribute it and/or modify it under the
+ * terms of the GNU Lesser General Public License as published by the Free Software Foundation,
+ * either version 3 of the License, or (at your option) any later version.
+ *
+ * C++ State Machine Framework is distributed in the hope that it will be useful, but WITHOUT ANY
+ * WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR
+ * PURPOSE. See the GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License along with C++ State
+ * Machine Framework. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+/*!
+ * \file
+ *
+ * Contains unit tests for the MpscEventQueue class
+ */
+
+// C++ State Machine Framework includes
+#include <CppStateMachineFramework/MpscEventQueue.hpp>
+
+// Qt includes
+#include <QtCore/QDebug>
+#include <QtTest/QTest>
+
+// System includes
+#include <thread>
+#include <vector>
+
+// Forward declarations
+
+// Macros
+
+// Test class declaration --------------------------------------------------------------------------
+
+using namespace CppStateMachineFramework;
+
+class TestMpscEventQueue : public QObject
+{
+    Q_OBJECT
+
+private slots:
+    // Functions executed by QtTest before and after test suite
+    void initTestCase();
+    void cleanupTestCase();
+
+    // Functions executed by QtTest before and after each test
+    void init();
+    void cleanup();
+
+    // Test functions
+    void testSingleThread();
+    void testMultipleProducers();
+};
+
+// Test Case init/cleanup methods ------------------------------------------------------------------
+
+void TestMpscEventQueue::initTestCase()
+{
+}
+
+void TestMpscEventQueue::cleanupTestCase()
+{
+}
+
+// Test init/cleanup methods -----------------------------------------------------------------------
+
+void TestMpscEventQueue::init()
+{
+}
+
+void TestMpscEventQueue::cleanup()
+{
+}
+
+// Test: Single thread -----------------------------------------------------------------------------
+
+void TestMpscEventQueue::testSingleThread()
+{
+    MpscEventQueue queue;
+    QVERIFY(queue.isEmpty());
+
+    Event event(InvalidEventId);
+    QVERIFY(!queue.takeNext(&event));
+
+    // Events must be taken in the same order as they were added
+    queue.push(Event("mpsc1"));
+    queue.push(Event("mpsc2", EventParameter<int>::create(2)));
+    QVERIFY(!queue.isEmpty());
+
+    QVERIFY(queue.takeNext(&event));
+    QCOMPARE(event.name(), QString("mpsc1"));
+    QVERIFY(!event.hasParameter());
+
+    QVERIFY(queue.takeNext(&event));
+    QCOMPARE(event.name(), QString("mpsc2"));
+    QCOMPARE(event.parameter<EventParameter<int>>()->value(), 2);
+
+    QVERIFY(queue.isEmpty());
+    QVERIFY(!queue.takeNext(&event));
+
+    // Clear the queue
+    queue.push(Event("mpsc1"));
+    queue.push(Event("mpsc2"));
+    queue.clear();
+    QVERIFY(queue.isEmpty());
+    QVERIFY(!queue.takeNext(&event));
+
+    // Nodes are recycled through the node pool
+    const auto misses = queue.poolStatistics().misses;
+
+    for (int i = 0; i < 10; i++)
+    {
+        queue.push(Event("mpsc1"));
+        QVERIFY(queue.takeNext(&event));
+    }
+
+    QCOMPARE(queue.poolStatistics().misses, misses);
+    QVERIFY(queue.poolStatistics().hits >= 10U);
+
+    // Pending events must be released on destruction
+    queue.push(Event("mpsc1", EventParameter<int>::create(1)));
+}
+
+// Test: Multiple producer threads -----------------------------------------------------------------
+
+void TestMpscEventQueue::testMultipleProducers()
+{
+    const int producerCount = 8;
+    const int eventCount = 10000;
+
+    MpscEventQueue queue;
+    std::vector<std::thread> producers;
+
+    for (int producer = 0; producer < producerCount; producer++)
+    {
+        producers.emplace_back([&queue, producer]()
+        {
+            const EventId eventId = EventNameRegistry::registerName("mpsc_producer");
+
+            for (int i = 0; i < eventCount; i++)
+            {
+                const int value = (producer * eventCount) + i;
+                queue.push(Event(eventId, EventParameter<int>::create(value)));
+            }
+        });
+    }
+
+    // Consume the events while they are being added and check that the events of each producer
+    // are taken in the same order as they were added
+    std::vector<int> nextValues(producerCount, 0);
+    int takenCount = 0;
+    Event event(InvalidEventId);
+
+    while (takenCount < (producerCount * eventCount))
+    {
+        if (!queue.takeNext(&event))
+        {
+            std::this_thread::yield();
+            continue;
+        }
+
+        const int value = event.parameter<EventParameter<int>>()->value();
+        const int producer = value / eventCount;
+        QCOMPARE(value % eventCount, nextValues[producer]);
+        nextValues[producer]++;
+        takenCount++;
+    }
+
+    for (auto &producer : producers)
+    {
+        producer.join();
+    }
+
+    QVERIFY(queue.isEmpty());
+    QVERIFY(!queue.takeNext(&event));
+}
+
+// Main function -----------------------------------------------------------------------------------
+
+QTEST_MAIN(TestMpscEventQueue)
+#include "testMpscEventQueue.moc"
@@ -68,10 +68,13 @@ private slots:
     void testAddDefaultInternalTransition();
     void testAddEventToFront();
     void testAddEventToBack();
+    void testAddEventById();
     void testProcessNextEvent();
     void testPoll();
     void testStateAndTransitionMethods();
     void testStateMachineWithLoop();
+    void testLargeStateMachine();
+    void testValidateLongChain();
     void testAddEventFromAction();
     void testCreateClassMethodsFull();
     void testCreateClassMethodsVoid();
@@ -1002,6 +1005,53 @@ void TestStateMachine::testAddEventToBack()
     QVERIFY(stateMachine.hasPendingEvents());
 }
 
+// Test: addEventToFront() and addEventToBack() with event IDs -------------------------------------
+
+void TestStateMachine::testAddEventById()
+{
+    // Initialize the state machine
+    StateMachine stateMachine;
+
+    QVERIFY(stateMachine.addState("a"));
+    QVERIFY(stateMachine.addState("b"));
+    QVERIFY(stateMachine.addState("c"));
+
+    QVERIFY(stateMachine.setInitialTransition("a"));
+
+    QVERIFY(stateMachine.addStateTransition("a", "id_a_to_b", "b"));
+    QVERIFY(stateMachine.addStateTransition("b", "id_b_to_c", "c"));
+
+    // Adding transitions must register the names of the triggers
+    const EventId aToB = EventNameRegistry::id("id_a_to_b");
+    const EventId bToC = EventNameRegistry::id("id_b_to_c");
+    QVERIFY(aToB != InvalidEventId);
+    QVERIFY(bToC != InvalidEventId);
+
+    QVERIFY(stateMachine.validate());
+    QVERIFY(stateMachine.start());
+
+    // Try to add an invalid event ID
+    QVERIFY(!stateMachine.addEventToBack(InvalidEventId));
+    QVERIFY(!stateMachine.addEventToFront(InvalidEventId));
+    QVERIFY(!stateMachine.hasPendingEvents());
+
+    // Process events added with IDs
+    QVERIFY(stateMachine.addEventToBack(bToC));
+    QVERIFY(stateMachine.addEventToFront(aToB));
+
+    QVERIFY(stateMachine.processNextEvent());
+    QCOMPARE(stateMachine.currentState(), QString("b"));
+
+    QVERIFY(stateMachine.processNextEvent());
+    QCOMPARE(stateMachine.currentState(), QString("c"));
+    QVERIFY(stateMachine.finalStateReached());
+
+    auto event = stateMachine.takeFinalEvent();
+    QVERIFY(event);
+    QCOMPARE(event->id(), bToC);
+    QCOMPARE(event->name(), QString("id_b_to_c"));
+}
+
 // Test: processNextEvent() ------------------------------------------------------------------------
 
 void TestStateMachine::testProcessNextEvent()
@@ -1668,6 +1718,133 @@ void TestStateMachine::testStateMachineWithLoop()
     QCOMPARE(log, expectedLog);
 }
 
+// Test: State machine with a large (sparse) transition table -------------------------------------
+
+void TestStateMachine::testLargeStateMachine()
+{
+    const int stateCount = 600;
+    int internalTransitionCount = 0;
+    int defaultTransitionCount = 0;
+
+    // Initialize and validate the state machine (a chain of states where each state has its own
+    // trigger event so that the transition table is too big to be stored as a dense table)
+    StateMachine stateMachine;
+
+    for (int i = 0; i < stateCount; i++)
+    {
+        QVERIFY(stateMachine.addState(QString("large_%1").arg(i)));
+    }
+
+    QVERIFY(stateMachine.setInitialTransition("large_0"));
+
+    for (int i = 0; i < (stateCount - 1); i++)
+    {
+        QVERIFY(stateMachine.addStateTransition(QString("large_%1").arg(i),
+                                                QString("large_next_%1").arg(i),
+                                                QString("large_%1").arg(i + 1)));
+        QVERIFY(stateMachine.addInternalTransition(QString("large_%1").arg(i),
+                                                   "large_ping",
+                                                   [&](auto &, auto &)
+        {
+            internalTransitionCount++;
+        }));
+    }
+
+    QVERIFY(stateMachine.setDefaultTransition("large_1",
+                                              [&](auto &, auto &)
+    {
+        defaultTransitionCount++;
+    }));
+
+    QVERIFY(stateMachine.validate());
+    QCOMPARE(stateMachine.validationStatus(), StateMachine::ValidationStatus::Valid);
+
+    // Start the state machine
+    QVERIFY(stateMachine.start());
+    QCOMPARE(stateMachine.currentState(), QString("large_0"));
+
+    // Events that don't trigger a transition in the current state must be ignored
+    QVERIFY(stateMachine.addEventToBack("large_next_1"));
+    QVERIFY(stateMachine.addEventToBack("large_unused"));
+    QVERIFY(stateMachine.addEventToBack("large_ping"));
+
+    for (int i = 0; i < 3; i++)
+    {
+        QVERIFY(stateMachine.processNextEvent());
+    }
+
+    QCOMPARE(stateMachine.currentState(), QString("large_0"));
+    QCOMPARE(internalTransitionCount, 1);
+
+    // Events without an explicit transition must trigger the default transition
+    QVERIFY(stateMachine.addEventToBack("large_next_0"));
+    QVERIFY(stateMachine.addEventToBack("large_unused"));
+    QVERIFY(stateMachine.addEventToBack("large_next_5"));
+    QVERIFY(stateMachine.addEventToBack("large_ping"));
+
+    for (int i = 0; i < 4; i++)
+    {
+        QVERIFY(stateMachine.processNextEvent());
+    }
+
+    QCOMPARE(stateMachine.currentState(), QString("large_1"));
+    QCOMPARE(defaultTransitionCount, 2);
+    QCOMPARE(internalTransitionCount, 2);
+
+    // Transition through all the states to the final state
+    for (int i = 1; i < (stateCount - 1); i++)
+    {
+        QVERIFY(stateMachine.addEventToBack(QString("large_next_%1").arg(i)));
+    }
+
+    while (stateMachine.hasPendingEvents() && stateMachine.isStarted())
+    {
+        QVERIFY(stateMachine.processNextEvent());
+    }
+
+    QCOMPARE(stateMachine.currentState(), QString("large_%1").arg(stateCount - 1));
+    QVERIFY(stateMachine.finalStateReached());
+    QVERIFY(!stateMachine.isStarted());
+}
+
+// Test: Validation of a long chain of states ------------------------------------------------------
+
+void TestStateMachine::testValidateLongChain()
+{
+    const int stateCount = 300000;
+
+    // A chain of states that is much deeper than what a recursive traversal could handle
+    StateMachine stateMachine;
+    QStringList stateNames;
+
+    for (int i = 0; i < stateCount; i++)
+    {
+        stateNames.append(QString("chain_%1").arg(i));
+        QVERIFY(stateMachine.addState(stateNames.at(i)));
+    }
+
+    QVERIFY(stateMachine.setInitialTransition(stateNames.at(0)));
+
+    for (int i = 0; i < (stateCount - 1); i++)
+    {
+        QVERIFY(stateMachine.addStateTransition(stateNames.at(i),
+                                                "chain_next",
+                                                stateNames.at(i + 1)));
+    }
+
+    QVERIFY(stateMachine.validate());
+
+    // A state after the end of the chain cannot be reached
+    QVERIFY(stateMachine.addState("chain_unreachable"));
+    QVERIFY(!stateMachine.validate());
+    QCOMPARE(stateMachine.validationStatus(), StateMachine::ValidationStatus::Invalid);
+
+    QVERIFY(stateMachine.addStateTransition(stateNames.at(stateCount - 1),
+                                            "chain_next",
+                                            "chain_unreachable"));
+    QVERIFY(stateMachine.validate());
+}
+
 // Test: Adding of tests during execution of an action ---------------------------------------------
 
 void TestStateMachine::testAddEventFromAction()
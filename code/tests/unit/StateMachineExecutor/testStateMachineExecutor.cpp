@@ -0,0 +1,469 @@
+/* This file is part of C++ State Machine Framework.
+ *
+ * C++ State Machine Framework is free software: you can redistribute it and/or modify it under the
+ * terms of the GNU Lesser General Public License as published by the Free Software Foundation,
+ * either version 3 of the License, or (at your option) any later version.
+ *
+ * C++ State Machine Framework is distributed in the hope that it will be useful, but WITHOUT ANY
+ * WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR
+ * PURPOSE. See the GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License along with C++ State
+ * Machine Framework. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+/*!
+ * \file
+ *
+ * Contains unit tests for the StateMachineExecutor class
+ */
+
+// C++ State Machine Framework includes
+#include <CppStateMachineFramework/StateMachine.hpp>
+#include <CppStateMachineFramework/StateMachineExecutor.hpp>
+
+// Qt includes
+#include <QtCore/QDebug>
+#include <QtTest/QTest>
+
+// System includes
+#include <atomic>
+#include <thread>
+#include <vector>
+
+// Forward declarations
+
+// Macros
+
+// Test class declaration --------------------------------------------------------------------------
+
+using namespace CppStateMachineFramework;
+
+class TestStateMachineExecutor : public QObject
+{
+    Q_OBJECT
+
+private slots:
+    // Functions executed by QtTest before and after test suite
+    void initTestCase();
+    void cleanupTestCase();
+
+    // Functions executed by QtTest before and after each test
+    void init();
+    void cleanup();
+
+    // Test functions
+    void testStartStop();
+    void testProcessEvents();
+    void testEventsAddedFromActions();
+    void testRemoveInstance();
+    void testRemoveInstanceWhileAddingEvents();
+    void testStateMachine();
+
+private:
+    //! Holds the counters of an instance
+    struct Counters
+    {
+        //! Holds the number of processed events
+        int processedCount = 0;
+
+        //! Holds the number of actions that were executed concurrently with another action
+        std::atomic<int> concurrentCount{0};
+
+        //! Holds the flag that is set while an action is being executed
+        std::atomic<bool> busy{false};
+    };
+
+private:
+    std::shared_ptr<StateMachineDefinition> createDefinition();
+};
+
+// Test Case init/cleanup methods ------------------------------------------------------------------
+
+void TestStateMachineExecutor::initTestCase()
+{
+}
+
+void TestStateMachineExecutor::cleanupTestCase()
+{
+}
+
+// Test init/cleanup methods -----------------------------------------------------------------------
+
+void TestStateMachineExecutor::init()
+{
+}
+
+void TestStateMachineExecutor::cleanup()
+{
+}
+
+// Test: Start and stop ----------------------------------------------------------------------------
+
+void TestStateMachineExecutor::testStartStop()
+{
+    StateMachineExecutor executor(2);
+    QCOMPARE(executor.workerCount(), 2);
+    QVERIFY(!executor.isRunning());
+    QVERIFY(!executor.stop());
+
+    QCOMPARE(executor.batchSize(), StateMachineExecutor::DefaultBatchSize);
+    QVERIFY(!executor.setBatchSize(-1));
+    QVERIFY(executor.setBatchSize(0));
+    QCOMPARE(executor.batchSize(), 0);
+
+    QVERIFY(StateMachineExecutor().workerCount() > 0);
+
+    // Events added while the executor is stopped are processed after it is started
+    int counter = 0;
+    auto definition = std::make_shared<StateMachineDefinition>();
+    QVERIFY(definition->addState("a"));
+    QVERIFY(definition->setInitialTransition("a"));
+    QVERIFY(definition->addInternalTransition("a", "executor_event", [&](auto &, auto &)
+    {
+        counter++;
+    }));
+    QVERIFY(definition->validate());
+
+    StateMachineInstance instance(definition);
+    QVERIFY(instance.start());
+    QVERIFY(instance.addEventToBack("executor_event"));
+
+    QVERIFY(!executor.addInstance(nullptr));
+    QVERIFY(executor.addInstance(&instance));
+    QVERIFY(!executor.addInstance(&instance));
+    QVERIFY(instance.addEventToBack("executor_event"));
+    QVERIFY(!executor.waitForIdle(0));
+
+    QVERIFY(executor.start());
+    QVERIFY(executor.isRunning());
+    QVERIFY(!executor.start());
+    QVERIFY(executor.waitForIdle(5000));
+    QCOMPARE(counter, 2);
+    QVERIFY(!instance.hasPendingEvents());
+
+    QVERIFY(executor.stop());
+    QVERIFY(!executor.isRunning());
+    QVERIFY(executor.removeInstance(&instance));
+    QVERIFY(!executor.removeInstance(&instance));
+}
+
+// Test: Process events of many instances from many producers --------------------------------------
+
+void TestStateMachineExecutor::testProcessEvents()
+{
+    const int instanceCount = 100;
+    const int producerCount = 4;
+    const int eventCount = 50;
+
+    auto definition = createDefinition();
+    QVERIFY(definition);
+
+    std::vector<std::unique_ptr<StateMachineInstance>> instances;
+    std::vector<std::unique_ptr<Counters>> counters;
+
+    StateMachineExecutor executor(4);
+    QVERIFY(executor.setBatchSize(8));
+
+    for (int i = 0; i < instanceCount; i++)
+    {
+        instances.push_back(std::make_unique<StateMachineInstance>(definition));
+        counters.push_back(std::make_unique<Counters>());
+
+        if ((i % 2) == 1)
+        {
+            QVERIFY(instances.back()->setExecutionMode(
+                        StateMachineInstance::ExecutionMode::SingleOwner));
+            QVERIFY(instances.back()->setEventQueueMode(
+                        StateMachineInstance::EventQueueMode::LockFree));
+        }
+
+        QVERIFY(instances.back()->start());
+        QVERIFY(executor.addInstance(instances.back().get()));
+    }
+
+    QVERIFY(executor.start());
+
+    // Add the events from multiple threads (the counters are passed as event parameters)
+    std::vector<std::thread> producers;
+
+    for (int producer = 0; producer < producerCount; producer++)
+    {
+        producers.emplace_back([&]()
+        {
+            const EventId eventId = EventNameRegistry::id("executor_count");
+
+            for (int event = 0; event < eventCount; event++)
+            {
+                for (int i = 0; i < instanceCount; i++)
+                {
+                    instances[i]->addEventToBack(
+                                Event(eventId, EventParameter<Counters *>(counters[i].get())));
+                }
+            }
+        });
+    }
+
+    for (auto &producer : producers)
+    {
+        producer.join();
+    }
+
+    QVERIFY(executor.waitForIdle(30000));
+
+    // Each instance must process all of its events and never concurrently
+    for (int i = 0; i < instanceCount; i++)
+    {
+        QCOMPARE(counters[i]->processedCount, producerCount * eventCount);
+        QCOMPARE(counters[i]->concurrentCount.load(), 0);
+        QVERIFY(!instances[i]->hasPendingEvents());
+    }
+
+    QVERIFY(executor.stop());
+
+    for (auto &instance : instances)
+    {
+        QVERIFY(executor.removeInstance(instance.get()));
+    }
+}
+
+// Test: Events added from the actions -------------------------------------------------------------
+
+void TestStateMachineExecutor::testEventsAddedFromActions()
+{
+    const int chainLength = 1000;
+
+    int counter = 0;
+    auto definition = std::make_shared<StateMachineDefinition>();
+    StateMachineInstance instance(definition);
+
+    // Each event adds the next event to the event queue until the chain is finished
+    QVERIFY(definition->addState("a"));
+    QVERIFY(definition->addState("b"));
+    QVERIFY(definition->setInitialTransition("a"));
+    QVERIFY(definition->addInternalTransition("a", "executor_chain", [&](auto &, auto &)
+    {
+        counter++;
+
+        if (counter < chainLength)
+        {
+            instance.addEventToBack("executor_chain");
+        }
+        else
+        {
+            instance.addEventToFront("executor_finish");
+        }
+    }));
+    QVERIFY(definition->addStateTransition("a", "executor_finish", "b"));
+    QVERIFY(definition->validate());
+
+    StateMachineExecutor executor(2);
+    QVERIFY(executor.setBatchSize(1));
+    QVERIFY(executor.addInstance(&instance));
+    QVERIFY(executor.start());
+
+    QVERIFY(instance.start());
+    QVERIFY(instance.addEventToBack("executor_chain"));
+    QVERIFY(executor.waitForIdle(30000));
+
+    QCOMPARE(counter, chainLength);
+    QVERIFY(!instance.isStarted());
+    QVERIFY(instance.finalStateReached());
+}
+
+// Test: Remove an instance ------------------------------------------------------------------------
+
+void TestStateMachineExecutor::testRemoveInstance()
+{
+    auto definition = createDefinition();
+    QVERIFY(definition);
+
+    Counters counters;
+    StateMachineExecutor executor(2);
+    QVERIFY(executor.start());
+
+    {
+        StateMachineInstance instance(definition);
+        QVERIFY(instance.start());
+        QVERIFY(executor.addInstance(&instance));
+
+        const EventId eventId = EventNameRegistry::id("executor_count");
+
+        for (int i = 0; i < 1000; i++)
+        {
+            QVERIFY(instance.addEventToBack(Event(eventId, EventParameter<Counters *>(&counters))));
+        }
+
+        // Instance can be removed (and destroyed) while it is being processed
+        QVERIFY(executor.removeInstance(&instance));
+
+        // Events of a removed instance are not processed by the executor
+        const int processedCount = counters.processedCount;
+        QVERIFY(instance.addEventToBack(Event(eventId, EventParameter<Counters *>(&counters))));
+        QVERIFY(executor.waitForIdle(5000));
+        QCOMPARE(counters.processedCount, processedCount);
+        QVERIFY(instance.hasPendingEvents());
+    }
+
+    QVERIFY(executor.waitForIdle(5000));
+    QCOMPARE(counters.concurrentCount.load(), 0);
+}
+
+// Test: Remove and add instances while events are added ------------------------------------------
+
+void TestStateMachineExecutor::testRemoveInstanceWhileAddingEvents()
+{
+    const int instanceCount = 8;
+    const int producerCount = 4;
+    const int iterationCount = 200;
+    const int maxRoundCount = 2000;
+
+    auto definition = createDefinition();
+    QVERIFY(definition);
+
+    std::vector<std::unique_ptr<StateMachineInstance>> instances;
+    std::vector<std::unique_ptr<Counters>> counters;
+    std::vector<std::unique_ptr<std::atomic<int>>> addedCounts;
+
+    StateMachineExecutor executor(4);
+    QVERIFY(executor.start());
+
+    for (int i = 0; i < instanceCount; i++)
+    {
+        instances.push_back(std::make_unique<StateMachineInstance>(definition));
+        counters.push_back(std::make_unique<Counters>());
+        addedCounts.push_back(std::make_unique<std::atomic<int>>(0));
+
+        if ((i % 2) == 1)
+        {
+            QVERIFY(instances.back()->setExecutionMode(
+                        StateMachineInstance::ExecutionMode::SingleOwner));
+            QVERIFY(instances.back()->setEventQueueMode(
+                        StateMachineInstance::EventQueueMode::LockFree));
+        }
+
+        QVERIFY(instances.back()->start());
+        QVERIFY(executor.addInstance(instances.back().get()));
+    }
+
+    // Producers keep adding events (and calling the event notifiers) while the instances are
+    // removed from the executor and added back. The number of added events is limited so that
+    // processing them does not depend on how long the instances were being removed and added.
+    std::atomic<bool> running(true);
+    std::vector<std::thread> producers;
+
+    for (int producer = 0; producer < producerCount; producer++)
+    {
+        producers.emplace_back([&]()
+        {
+            const EventId eventId = EventNameRegistry::id("executor_count");
+
+            for (int round = 0; (round < maxRoundCount) && running.load(); round++)
+            {
+                for (int i = 0; i < instanceCount; i++)
+                {
+                    if (instances[i]->addEventToBack(
+                            Event(eventId, EventParameter<Counters *>(counters[i].get()))))
+                    {
+                        (*addedCounts[i])++;
+                    }
+                }
+            }
+        });
+    }
+
+    for (int iteration = 0; iteration < iterationCount; iteration++)
+    {
+        for (auto &instance : instances)
+        {
+            QVERIFY(executor.removeInstance(instance.get()));
+            QVERIFY(executor.addInstance(instance.get()));
+        }
+    }
+
+    running.store(false);
+
+    for (auto &producer : producers)
+    {
+        producer.join();
+    }
+
+    // All added events are processed once the instances stay in the executor
+    QVERIFY(executor.waitForIdle(30000));
+
+    for (int i = 0; i < instanceCount; i++)
+    {
+        QCOMPARE(counters[i]->processedCount, addedCounts[i]->load());
+        QCOMPARE(counters[i]->concurrentCount.load(), 0);
+    }
+
+    QVERIFY(executor.stop());
+
+    for (auto &instance : instances)
+    {
+        QVERIFY(executor.removeInstance(instance.get()));
+    }
+}
+
+// Test: State machine -----------------------------------------------------------------------------
+
+void TestStateMachineExecutor::testStateMachine()
+{
+    int counter = 0;
+    StateMachine stateMachine;
+    QVERIFY(stateMachine.addState("a"));
+    QVERIFY(stateMachine.setInitialTransition("a"));
+    QVERIFY(stateMachine.addInternalTransition("a", "executor_event", [&](auto &, auto &)
+    {
+        counter++;
+    }));
+    QVERIFY(stateMachine.validate());
+    QVERIFY(stateMachine.start());
+
+    StateMachineExecutor executor(1);
+    QVERIFY(executor.addInstance(&stateMachine.instance()));
+    QVERIFY(executor.start());
+
+    for (int i = 0; i < 10; i++)
+    {
+        QVERIFY(stateMachine.addEventToBack("executor_event"));
+    }
+
+    QVERIFY(executor.waitForIdle(5000));
+    QCOMPARE(counter, 10);
+}
+
+// Helper methods ----------------------------------------------------------------------------------
+
+std::shared_ptr<StateMachineDefinition> TestStateMachineExecutor::createDefinition()
+{
+    auto definition = std::make_shared<StateMachineDefinition>();
+
+    const auto countEvent = [](const Event &event, const QString &)
+    {
+        auto *counters = event.parameter<EventParameter<Counters *>>()->value();
+
+        if (counters->busy.exchange(true))
+        {
+            counters->concurrentCount++;
+        }
+
+        counters->processedCount++;
+        counters->busy.store(false);
+    };
+
+    if (!(definition->addState("a") &&
+          definition->setInitialTransition("a") &&
+          definition->addInternalTransition("a", "executor_count", countEvent) &&
+          definition->validate()))
+    {
+        return {};
+    }
+
+    return definition;
+}
+
+// Main function -----------------------------------------------------------------------------------
+
+QTEST_MAIN(TestStateMachineExecutor)
+#include "testStateMachineExecutor.moc"
@@ -0,0 +1,1470 @@
+/* This file is part of C++ State Machine Framework.
+ *
+ * C++ State Machine Framework is free software: you can redistribute it and/or modify it under the
+ * terms of the GNU Lesser General Public License as published by the Free Software Foundation,
+ * either version 3 of the License, or (at your option) any later version.
+ *
+ * C++ State Machine Framework is distributed in the hope that it will be useful, but WITHOUT ANY
+ * WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR
+ * PURPOSE. See the GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License along with C++ State
+ * Machine Framework. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+/*!
+ * \file
+ *
+ * Contains unit tests for the StateMachineDefinition and StateMachineInstance classes
+ */
+
+// C++ State Machine Framework includes
+#include <CppStateMachineFramework/EventNameRegistry.hpp>
+#include <CppStateMachineFramework/EventParameterSerializer.hpp>
+#include <CppStateMachineFramework/StateMachineInstance.hpp>
+#include <CppStateMachineFramework/TimerWheel.hpp>
+
+// Qt includes
+#include <QtCore/QDebug>
+#include <QtTest/QTest>
+
+// System includes
+#include <chrono>
+#include <thread>
+#include <vector>
+
+// Forward declarations
+
+// Macros
+
+// Test class declaration --------------------------------------------------------------------------
+
+using namespace CppStateMachineFramework;
+
+//! Observer that logs the hooks with the names of the states, transitions and events
+class LoggingObserver : public IStateMachineObserver
+{
+public:
+    void onEventDequeued(const StateMachineInstance &instance,
+                         const int stateIndex,
+                         const EventId eventId) override
+    {
+        log.append(QString("dequeued:%1:%2").arg(state(instance, stateIndex), event(eventId)));
+    }
+
+    void onGuardRejected(const StateMachineInstance &instance,
+                         const int transitionIndex,
+                         const EventId eventId) override
+    {
+        log.append(QString("rejected:%1:%2").arg(transition(instance, transitionIndex),
+                                                 event(eventId)));
+    }
+
+    void onExit(const StateMachineInstance &instance,
+                const int stateIndex,
+                const EventId eventId) override
+    {
+        log.append(QString("exit:%1:%2").arg(state(instance, stateIndex), event(eventId)));
+    }
+
+    void onTransition(const StateMachineInstance &instance,
+                      const int transitionIndex,
+                      const EventId eventId) override
+    {
+        log.append(QString("transition:%1:%2").arg(transition(instance, transitionIndex),
+                                                   event(eventId)));
+    }
+
+    void onEntry(const StateMachineInstance &instance,
+                 const int stateIndex,
+                 const EventId eventId) override
+    {
+        log.append(QString("entry:%1:%2").arg(state(instance, stateIndex), event(eventId)));
+    }
+
+    void onFinal(const StateMachineInstance &instance,
+                 const int stateIndex,
+                 const EventId eventId) override
+    {
+        log.append(QString("final:%1:%2").arg(state(instance, stateIndex), event(eventId)));
+    }
+
+    void onIgnored(const StateMachineInstance &instance,
+                   const int stateIndex,
+                   const EventId eventId) override
+    {
+        log.append(QString("ignored:%1:%2").arg(state(instance, stateIndex), event(eventId)));
+    }
+
+    QStringList log;
+
+private:
+    static QString state(const StateMachineInstance &instance, const int stateIndex)
+    {
+        return instance.definition()->state(stateIndex).name;
+    }
+
+    static QString transition(const StateMachineInstance &instance, const int transitionIndex)
+    {
+        const auto &info = instance.definition()->transitionInfo(transitionIndex);
+        return QString("%1>%2").arg(state(instance, info.fromState),
+                                    (info.toState < 0) ? QString() : state(instance, info.toState));
+    }
+
+    static QString event(const EventId eventId)
+    {
+        return EventNameRegistry::name(eventId);
+    }
+};
+
+// -------------------------------------------------------------------------------------------------
+
+class TestStateMachineInstance : public QObject
+{
+    Q_OBJECT
+
+private slots:
+    // Functions executed by QtTest before and after test suite
+    void initTestCase();
+    void cleanupTestCase();
+
+    // Functions executed by QtTest before and after each test
+    void init();
+    void cleanup();
+
+    // Test functions
+    void testDefinition();
+    void testInvalidDefinition();
+    void testSharedDefinition();
+    void testMoveInstance();
+    void testOptionalFeatureDefaults();
+    void testLockFreeEventQueue();
+    void testLockFreeEventQueueMultipleProducers();
+    void testPollBatch();
+    void testEventPool();
+    void testSingleOwnerExecutionMode();
+    void testWaitForEvents();
+    void testEventCoalescing();
+    void testBoundedEventQueue();
+    void testEventPriorities();
+    void testDelayedEvents();
+    void testObserver();
+    void testSnapshot();
+
+private:
+    std::shared_ptr<StateMachineDefinition> createDefinition(QStringList *log);
+};
+
+// Test Case init/cleanup methods ------------------------------------------------------------------
+
+void TestStateMachineInstance::initTestCase()
+{
+}
+
+void TestStateMachineInstance::cleanupTestCase()
+{
+}
+
+// Test init/cleanup methods -----------------------------------------------------------------------
+
+void TestStateMachineInstance::init()
+{
+}
+
+void TestStateMachineInstance::cleanup()
+{
+}
+
+// Test: StateMachineDefinition --------------------------------------------------------------------
+
+void TestStateMachineInstance::testDefinition()
+{
+    StateMachineDefinition definition;
+    QCOMPARE(definition.validationStatus(), StateMachineDefinition::ValidationStatus::Unvalidated);
+    QCOMPARE(definition.stateCount(), 0);
+    QVERIFY(definition.initialState().isEmpty());
+
+    QVERIFY(definition.addState("a"));
+    QVERIFY(definition.addState("b"));
+    QVERIFY(!definition.addState("a"));
+    QCOMPARE(definition.stateCount(), 2);
+    QCOMPARE(definition.stateIndex("a"), 0);
+    QCOMPARE(definition.stateIndex("b"), 1);
+    QVERIFY(definition.stateIndex("c") < 0);
+    QCOMPARE(definition.state(1).name, QString("b"));
+
+    QVERIFY(definition.setInitialTransition("a"));
+    QCOMPARE(definition.initialState(), QString("a"));
+    QCOMPARE(definition.initialTransition().state, 0);
+
+    QVERIFY(definition.addStateTransition("a", "def_a_to_b", "b"));
+    QVERIFY(!definition.addStateTransition("a", "def_a_to_b", "b"));
+
+    QVERIFY(definition.validate());
+    QCOMPARE(definition.validationStatus(), StateMachineDefinition::ValidationStatus::Valid);
+    QVERIFY(!definition.isFinalState(0));
+    QVERIFY(definition.isFinalState(1));
+
+    // Check the compiled transitions
+    const EventId eventId = EventNameRegistry::id("def_a_to_b");
+
+    const auto &transition = definition.findTransition(0, eventId);
+    QVERIFY(transition.stateTransition != nullptr);
+    QVERIFY(transition.internalTransition == nullptr);
+    QCOMPARE(transition.stateTransition->state, 1);
+
+    const auto &noTransition = definition.findTransition(1, eventId);
+    QVERIFY(noTransition.stateTransition == nullptr);
+    QVERIFY(noTransition.internalTransition == nullptr);
+
+    // Changing the definition must invalidate it
+    QVERIFY(definition.addInternalTransition("b", "def_b", [](auto &, auto &) {}));
+    QCOMPARE(definition.validationStatus(), StateMachineDefinition::ValidationStatus::Unvalidated);
+}
+
+// Test: Instance of an invalid definition ---------------------------------------------------------
+
+void TestStateMachineInstance::testInvalidDefinition()
+{
+    // Instance without a definition
+    StateMachineInstance instance;
+    QVERIFY(!instance.definition());
+    QVERIFY(!instance.isStarted());
+    QVERIFY(!instance.start());
+    QVERIFY(instance.currentState().isEmpty());
+    QVERIFY(instance.currentStateIndex() < 0);
+
+    // Instance with an unvalidated definition
+    auto definition = std::make_shared<StateMachineDefinition>();
+    QVERIFY(definition->addState("a"));
+    QVERIFY(definition->setInitialTransition("a"));
+
+    StateMachineInstance unvalidatedInstance(definition);
+    QVERIFY(!unvalidatedInstance.start());
+
+    // After validation the instance can be started
+    QVERIFY(definition->validate());
+    QVERIFY(unvalidatedInstance.start());
+    QCOMPARE(unvalidatedInstance.currentState(), QString("a"));
+    QVERIFY(unvalidatedInstance.finalStateReached());
+}
+
+// Test: Multiple instances sharing the same definition --------------------------------------------
+
+void TestStateMachineInstance::testSharedDefinition()
+{
+    QStringList log;
+    std::shared_ptr<const StateMachineDefinition> definition = createDefinition(&log);
+    QVERIFY(definition);
+
+    // Create the instances
+    const int instanceCount = 100;
+    std::vector<StateMachineInstance> instances;
+    instances.reserve(instanceCount);
+
+    for (int i = 0; i < instanceCount; i++)
+    {
+        instances.emplace_back(definition);
+        QVERIFY(instances.back().definition() == definition);
+        QVERIFY(instances.back().start());
+        QCOMPARE(instances.back().currentState(), QString("a"));
+    }
+
+    QCOMPARE(log.size(), instanceCount);
+
+    // Each instance must hold its own state
+    for (int i = 0; i < instanceCount; i += 2)
+    {
+        QVERIFY(instances[i].addEventToBack("inst_a_to_b"));
+        QVERIFY(instances[i].processNextEvent());
+    }
+
+    for (int i = 0; i < instanceCount; i++)
+    {
+        QCOMPARE(instances[i].currentState(), QString(((i % 2) == 0) ? "b" : "a"));
+        QCOMPARE(instances[i].currentStateIndex(), ((i % 2) == 0) ? 1 : 0);
+        QVERIFY(!instances[i].hasPendingEvents());
+    }
+
+    // Only one instance reaches the final state
+    QVERIFY(instances[0].addEventToBack("inst_b_to_c", EventParameter<int>::create(0)));
+    QVERIFY(instances[0].poll());
+    QCOMPARE(instances[0].currentState(), QString("c"));
+    QVERIFY(instances[0].finalStateReached());
+    QVERIFY(!instances[0].isStarted());
+    QVERIFY(instances[0].hasFinalEvent());
+    QCOMPARE(instances[0].takeFinalEvent()->name(), QString("inst_b_to_c"));
+
+    QVERIFY(!instances[2].finalStateReached());
+    QVERIFY(instances[2].isStarted());
+    QVERIFY(!instances[2].hasFinalEvent());
+
+    // A stopped instance can be restarted
+    QVERIFY(instances[0].start());
+    QCOMPARE(instances[0].currentState(), QString("a"));
+}
+
+// Test: Move constructor and move assignment operator ---------------------------------------------
+
+void TestStateMachineInstance::testMoveInstance()
+{
+    QStringList log;
+    std::shared_ptr<const StateMachineDefinition> definition = createDefinition(&log);
+    QVERIFY(definition);
+
+    StateMachineInstance instance(definition);
+    QVERIFY(instance.start());
+    QVERIFY(instance.addEventToBack("inst_a_to_b"));
+
+    // Move constructor
+    StateMachineInstance movedInstance(std::move(instance));
+    QVERIFY(movedInstance.definition() == definition);
+    QVERIFY(movedInstance.isStarted());
+    QVERIFY(movedInstance.hasPendingEvents());
+    QVERIFY(movedInstance.processNextEvent());
+    QCOMPARE(movedInstance.currentState(), QString("b"));
+
+    // Move assignment operator
+    StateMachineInstance assignedInstance;
+    assignedInstance = std::move(movedInstance);
+    QVERIFY(assignedInstance.definition() == definition);
+    QVERIFY(assignedInstance.isStarted());
+    QCOMPARE(assignedInstance.currentState(), QString("b"));
+
+    // Optional features are moved together with the instance
+    using BackpressurePolicy = StateMachineInstance::BackpressurePolicy;
+
+    StateMachineInstance boundedInstance(definition);
+    QVERIFY(boundedInstance.setEventQueueCapacity(2));
+    QVERIFY(boundedInstance.setBackpressurePolicy(BackpressurePolicy::DropNewest));
+    QVERIFY(boundedInstance.setTraceMachineId(7U));
+
+    StateMachineInstance movedBoundedInstance(std::move(boundedInstance));
+    QCOMPARE(movedBoundedInstance.eventQueueCapacity(), 2);
+    QCOMPARE(movedBoundedInstance.backpressurePolicy(), BackpressurePolicy::DropNewest);
+    QCOMPARE(movedBoundedInstance.traceMachineId(), static_cast<std::uint64_t>(7U));
+
+    assignedInstance = std::move(movedBoundedInstance);
+    QCOMPARE(assignedInstance.eventQueueCapacity(), 2);
+    QVERIFY(assignedInstance.start());
+    QVERIFY(assignedInstance.addEventToBack("inst_a_to_b"));
+    QVERIFY(assignedInstance.addEventToBack("inst_b_to_c"));
+    QVERIFY(assignedInstance.addEventToBack("inst_a_to_b"));
+    QCOMPARE(assignedInstance.backpressureStatistics().dropped, static_cast<std::uint64_t>(1U));
+}
+
+// Test: Defaults of the optional features --------------------------------------------------------
+
+void TestStateMachineInstance::testOptionalFeatureDefaults()
+{
+    QStringList log;
+    std::shared_ptr<const StateMachineDefinition> definition = createDefinition(&log);
+    QVERIFY(definition);
+
+    // Optional features which were never enabled or which were disabled report their defaults
+    StateMachineInstance instance(definition);
+    QVERIFY(instance.setEventQueueCapacity(0));
+    QVERIFY(instance.setEventCoalescingPolicy("inst_a_to_b",
+                                              StateMachineInstance::CoalescingPolicy::None));
+    QVERIFY(instance.setTimerWheel(nullptr));
+    QVERIFY(instance.setMetricsEnabled(false));
+    QVERIFY(instance.setObserver(nullptr));
+    QVERIFY(instance.setTraceMachineId(0U));
+    QVERIFY(instance.setJournal(nullptr));
+
+    QCOMPARE(instance.eventQueueCapacity(), StateMachineInstance::DefaultEventQueueCapacity);
+    QCOMPARE(instance.backpressurePolicy(), StateMachineInstance::BackpressurePolicy::Reject);
+    QCOMPARE(instance.backpressureTimeout(), -1);
+    QCOMPARE(instance.backpressureStatistics().rejected, static_cast<std::uint64_t>(0U));
+    QCOMPARE(instance.eventCoalescingPolicy("inst_a_to_b"),
+             StateMachineInstance::CoalescingPolicy::None);
+    QVERIFY(!instance.timerWheel());
+    QVERIFY(!instance.metricsEnabled());
+    QVERIFY(instance.metrics().states.empty());
+    QVERIFY(!instance.observer());
+    QCOMPARE(instance.traceMachineId(), static_cast<std::uint64_t>(0U));
+    QVERIFY(!instance.journal());
+    QVERIFY(!instance.cancelDelayedEvent(1U));
+
+    // Events are processed without any of the optional features
+    QVERIFY(instance.start());
+    QVERIFY(instance.addEventToBack("inst_a_to_b"));
+    QVERIFY(instance.poll());
+    QCOMPARE(instance.currentState(), QString("b"));
+    QVERIFY(instance.metrics().states.empty());
+
+    // Delayed events can be added after the events were processed
+    QVERIFY(instance.addStateEventAfter(100000, "inst_b_to_c") != InvalidTimerId);
+    QVERIFY(instance.timerWheel());
+    QVERIFY(instance.stop());
+}
+
+// Test: Lock-free event queue mode ---------------------------------------------------------------
+
+void TestStateMachineInstance::testLockFreeEventQueue()
+{
+    auto definition = std::make_shared<StateMachineDefinition>();
+    StateMachineInstance instance(definition);
+
+    QVERIFY(definition->addState("a"));
+    QVERIFY(definition->addState("b"));
+    QVERIFY(definition->addState("c"));
+    QVERIFY(definition->setInitialTransition("a"));
+    QVERIFY(definition->addStateTransition("a", "lf_a_to_b", "b"));
+    QVERIFY(definition->addStateTransition("b", "lf_b_to_c", "c"));
+    QVERIFY(definition->setStateEntryAction("b",
+                                            [&](auto &, auto &, auto &)
+    {
+        // Event added to the front must be processed before the already queued events
+        instance.addEventToFront("lf_b_to_c");
+    }));
+    QVERIFY(definition->validate());
+
+    // Event queue mode can be changed only when the instance is stopped
+    QCOMPARE(instance.eventQueueMode(), StateMachineInstance::EventQueueMode::Locked);
+    QVERIFY(instance.setEventQueueMode(StateMachineInstance::EventQueueMode::LockFree));
+    QCOMPARE(instance.eventQueueMode(), StateMachineInstance::EventQueueMode::LockFree);
+
+    QVERIFY(!instance.addEventToBack("lf_a_to_b"));
+    QVERIFY(!instance.hasPendingEvents());
+
+    QVERIFY(instance.start());
+    QVERIFY(!instance.setEventQueueMode(StateMachineInstance::EventQueueMode::Locked));
+    QVERIFY(!instance.addEventToBack(QString()));
+
+    QVERIFY(instance.addEventToBack("lf_a_to_b"));
+    QVERIFY(instance.addEventToBack("lf_ignored"));
+    QVERIFY(instance.hasPendingEvents());
+
+    QVERIFY(instance.processNextEvent());
+    QCOMPARE(instance.currentState(), QString("b"));
+    QVERIFY(instance.hasPendingEvents());
+
+    QVERIFY(instance.processNextEvent());
+    QCOMPARE(instance.currentState(), QString("c"));
+    QVERIFY(instance.finalStateReached());
+    QVERIFY(!instance.isStarted());
+
+    // Restart must discard the pending events
+    QVERIFY(instance.start());
+    QVERIFY(!instance.hasPendingEvents());
+    QCOMPARE(instance.currentState(), QString("a"));
+
+    QVERIFY(instance.stop());
+    QVERIFY(instance.setEventQueueMode(StateMachineInstance::EventQueueMode::Locked));
+    QCOMPARE(instance.eventQueueMode(), StateMachineInstance::EventQueueMode::Locked);
+}
+
+// Test: Lock-free event queue mode with multiple producers ----------------------------------------
+
+void TestStateMachineInstance::testLockFreeEventQueueMultipleProducers()
+{
+    const int producerCount = 16;
+    const int eventCount = 1000;
+    int processedCount = 0;
+
+    auto definition = std::make_shared<StateMachineDefinition>();
+
+    QVERIFY(definition->addState("a"));
+    QVERIFY(definition->setInitialTransition("a"));
+    QVERIFY(definition->addInternalTransition("a",
+                                              "lf_count",
+                                              [&](auto &, auto &) { processedCount++; }));
+    QVERIFY(definition->validate());
+
+    StateMachineInstance instance(definition);
+    QVERIFY(instance.setEventQueueMode(StateMachineInstance::EventQueueMode::LockFree));
+    QVERIFY(instance.start());
+
+    // Add events from multiple threads while processing them
+    const EventId eventId = EventNameRegistry::id("lf_count");
+    std::vector<std::thread> producers;
+
+    for (int producer = 0; producer < producerCount; producer++)
+    {
+        producers.emplace_back([&instance, eventId]()
+        {
+            for (int i = 0; i < eventCount; i++)
+            {
+                instance.addEventToBack(eventId);
+            }
+        });
+    }
+
+    while (processedCount < (producerCount * eventCount))
+    {
+        QVERIFY(instance.poll());
+        std::this_thread::yield();
+    }
+
+    for (auto &producer : producers)
+    {
+        producer.join();
+    }
+
+    QCOMPARE(processedCount, producerCount * eventCount);
+    QVERIFY(!instance.hasPendingEvents());
+}
+
+// Test: Poll events in batches -------------------------------------------------------------------
+
+void TestStateMachineInstance::testPollBatch()
+{
+    QStringList log;
+    auto definition = std::make_shared<StateMachineDefinition>();
+    StateMachineInstance instance(definition);
+
+    const auto logEvent = [&](const Event &event, const QString &) { log.append(event.name()); };
+
+    QVERIFY(definition->addState("a"));
+    QVERIFY(definition->setInitialTransition("a"));
+    QVERIFY(definition->addInternalTransition("a", "batch1", logEvent));
+    QVERIFY(definition->addInternalTransition("a",
+                                              "batch2",
+                                              [&](const Event &event, const QString &state)
+    {
+        // Event added to the front must be processed before the rest of the batch
+        logEvent(event, state);
+        instance.addEventToFront("batch_front");
+    }));
+    QVERIFY(definition->addInternalTransition("a", "batch3", logEvent));
+    QVERIFY(definition->addInternalTransition("a", "batch4", logEvent));
+    QVERIFY(definition->addInternalTransition("a", "batch5", logEvent));
+    QVERIFY(definition->addInternalTransition("a", "batch_front", logEvent));
+
+    int longEventCount = 0;
+    int longFrontEventCount = 0;
+    bool longOrderValid = true;
+
+    QVERIFY(definition->addInternalTransition("a", "batch_long", [&](auto &, auto &)
+    {
+        // Each event adds an event to the front of a long queue of pending events
+        longOrderValid = longOrderValid && (longEventCount == longFrontEventCount);
+        longEventCount++;
+        instance.addEventToFront("batch_long_front");
+    }));
+    QVERIFY(definition->addInternalTransition("a", "batch_long_front", [&](auto &, auto &)
+    {
+        longFrontEventCount++;
+        longOrderValid = longOrderValid && (longEventCount == longFrontEventCount);
+    }));
+    QVERIFY(definition->validate());
+
+    QCOMPARE(instance.pollBatchSize(), StateMachineInstance::DefaultPollBatchSize);
+    QVERIFY(!instance.setPollBatchSize(-1));
+    QCOMPARE(instance.pollBatchSize(), StateMachineInstance::DefaultPollBatchSize);
+
+    const QStringList expectedLog = {
+        "batch1", "batch2", "batch_front", "batch3", "batch4", "batch5"
+    };
+
+    for (const int batchSize : {0, 1, 2, 3, 10})
+    {
+        QVERIFY(instance.setPollBatchSize(batchSize));
+        QCOMPARE(instance.pollBatchSize(), batchSize);
+
+        log.clear();
+        QVERIFY(instance.start());
+
+        QVERIFY(instance.addEventToBack("batch1"));
+        QVERIFY(instance.addEventToBack("batch2"));
+        QVERIFY(instance.addEventToBack("batch3"));
+        QVERIFY(instance.addEventToBack("batch4"));
+        QVERIFY(instance.addEventToBack("batch5"));
+
+        QVERIFY(instance.poll());
+        QCOMPARE(log, expectedLog);
+        QVERIFY(!instance.hasPendingEvents());
+
+        QVERIFY(instance.stop());
+    }
+
+    // Events added to the front during a batch are put in front of a long queue of pending events
+    // without moving the pending events
+    const int longQueueSize = 100000;
+    QVERIFY(instance.setPollBatchSize(16));
+    QVERIFY(instance.start());
+
+    for (int i = 0; i < longQueueSize; i++)
+    {
+        QVERIFY(instance.addEventToBack("batch_long"));
+    }
+
+    QVERIFY(instance.poll());
+    QCOMPARE(longEventCount, longQueueSize);
+    QCOMPARE(longFrontEventCount, longQueueSize);
+    QVERIFY(longOrderValid);
+    QVERIFY(instance.stop());
+}
+
+// Test: Event pool --------------------------------------------------------------------------------
+
+void TestStateMachineInstance::testEventPool()
+{
+    auto definition = std::make_shared<StateMachineDefinition>();
+    StateMachineInstance instance(definition);
+
+    int counter = 0;
+    QVERIFY(definition->addState("a"));
+    QVERIFY(definition->setInitialTransition("a"));
+    QVERIFY(definition->addInternalTransition("a", "pool_event", [&](auto &, auto &)
+    {
+        counter++;
+    }));
+    QVERIFY(definition->validate());
+
+    QCOMPARE(instance.eventPoolCapacity(), StateMachineInstance::DefaultEventPoolCapacity);
+    QVERIFY(!instance.setEventPoolCapacity(-1));
+    QCOMPARE(instance.eventPoolCapacity(), StateMachineInstance::DefaultEventPoolCapacity);
+
+    // Only the lock-free event queue uses the event pool, the locked one holds the events in a
+    // ring buffer and its pending events are kept
+    QVERIFY(instance.start());
+    QVERIFY(instance.addEventToBack(Event("pool_event")));
+    QVERIFY(instance.stop());
+    QVERIFY(instance.setEventPoolCapacity(32));
+    QVERIFY(instance.hasPendingEvents());
+
+    QVERIFY(instance.setEventQueueMode(StateMachineInstance::EventQueueMode::LockFree));
+    QVERIFY(instance.setEventPoolCapacity(64));
+    QCOMPARE(instance.eventPoolCapacity(), 64);
+
+    QVERIFY(instance.start());
+    QVERIFY(!instance.setEventPoolCapacity(32));
+
+    // After a warm-up a steady stream of events must not need any new memory blocks
+    const EventId eventId = EventNameRegistry::id("pool_event");
+    std::uint64_t warmUpMisses = 0U;
+
+    for (int i = 0; i < 100; i++)
+    {
+        if (i == 10)
+        {
+            warmUpMisses = instance.eventPoolStatistics().misses;
+        }
+
+        for (int j = 0; j < 20; j++)
+        {
+            QVERIFY(instance.addEventToBack(eventId));
+        }
+
+        QVERIFY(instance.poll());
+    }
+
+    QCOMPARE(counter, 2000);
+
+    const auto statistics = instance.eventPoolStatistics();
+    QCOMPARE(statistics.misses, warmUpMisses);
+    QVERIFY(statistics.hits > 0U);
+    QVERIFY(statistics.highWaterMark > 0);
+    QVERIFY(instance.stop());
+
+    // Locked event queue does not have any event pool statistics
+    QVERIFY(instance.setEventQueueMode(StateMachineInstance::EventQueueMode::Locked));
+    QVERIFY(instance.start());
+    QVERIFY(instance.addEventToBack(eventId));
+    QVERIFY(instance.poll());
+    QCOMPARE(instance.eventPoolStatistics().hits, static_cast<std::uint64_t>(0U));
+    QVERIFY(instance.stop());
+    QVERIFY(instance.setEventQueueMode(StateMachineInstance::EventQueueMode::LockFree));
+
+    // Pooling can be disabled
+    QVERIFY(instance.setEventPoolCapacity(0));
+    QVERIFY(instance.start());
+    QVERIFY(instance.addEventToBack("pool_event"));
+    QVERIFY(instance.poll());
+    QCOMPARE(instance.eventPoolStatistics().hits, static_cast<std::uint64_t>(0U));
+    QVERIFY(instance.stop());
+}
+
+// Test: Single-owner execution mode ---------------------------------------------------------------
+
+void TestStateMachineInstance::testSingleOwnerExecutionMode()
+{
+    const int producerCount = 4;
+    const int eventCount = 5000;
+
+    auto definition = std::make_shared<StateMachineDefinition>();
+    StateMachineInstance instance(definition);
+
+    int counter = 0;
+    QVERIFY(definition->addState("a"));
+    QVERIFY(definition->addState("b"));
+    QVERIFY(definition->setInitialTransition("a"));
+    QVERIFY(definition->addInternalTransition("a", "owner_event", [&](auto &, auto &)
+    {
+        counter++;
+    }));
+    QVERIFY(definition->addStateTransition("a", "owner_stop", "b"));
+    QVERIFY(definition->validate());
+
+    QCOMPARE(instance.executionMode(), StateMachineInstance::ExecutionMode::Locked);
+    QVERIFY(instance.setExecutionMode(StateMachineInstance::ExecutionMode::SingleOwner));
+    QCOMPARE(instance.executionMode(), StateMachineInstance::ExecutionMode::SingleOwner);
+
+    for (const auto mode : {StateMachineInstance::EventQueueMode::Locked,
+                            StateMachineInstance::EventQueueMode::LockFree})
+    {
+        QVERIFY(instance.setEventQueueMode(mode));
+        QVERIFY(instance.start());
+        QVERIFY(!instance.setExecutionMode(StateMachineInstance::ExecutionMode::Locked));
+
+        // Events can be added from any thread while the owner thread processes them
+        counter = 0;
+        std::vector<std::thread> producers;
+
+        for (int producer = 0; producer < producerCount; producer++)
+        {
+            producers.emplace_back([&instance]()
+            {
+                const EventId eventId = EventNameRegistry::id("owner_event");
+
+                for (int i = 0; i < eventCount; i++)
+                {
+                    instance.addEventToBack(eventId);
+                }
+            });
+        }
+
+        while (counter < (producerCount * eventCount))
+        {
+            QVERIFY(instance.poll());
+            std::this_thread::yield();
+        }
+
+        for (auto &producer : producers)
+        {
+            producer.join();
+        }
+
+        QCOMPARE(counter, producerCount * eventCount);
+        QVERIFY(!instance.hasPendingEvents());
+        QCOMPARE(instance.currentState(), QString("a"));
+
+        // Transition to a final state stops the state machine
+        QVERIFY(instance.addEventToBack("owner_stop"));
+        QVERIFY(instance.poll());
+        QVERIFY(!instance.isStarted());
+        QVERIFY(instance.finalStateReached());
+    }
+
+    QVERIFY(instance.setExecutionMode(StateMachineInstance::ExecutionMode::Locked));
+    QCOMPARE(instance.executionMode(), StateMachineInstance::ExecutionMode::Locked);
+}
+
+// Test: Wait for events ---------------------------------------------------------------------------
+
+void TestStateMachineInstance::testWaitForEvents()
+{
+    const int eventCount = 1000;
+
+    auto definition = std::make_shared<StateMachineDefinition>();
+    StateMachineInstance instance(definition);
+
+    int counter = 0;
+    QVERIFY(definition->addState("a"));
+    QVERIFY(definition->addState("b"));
+    QVERIFY(definition->setInitialTransition("a"));
+    QVERIFY(definition->addInternalTransition("a", "wait_event", [&](auto &, auto &)
+    {
+        counter++;
+    }));
+    QVERIFY(definition->addStateTransition("a", "wait_stop", "b"));
+    QVERIFY(definition->validate());
+
+    QCOMPARE(instance.waitSpinCount(), StateMachineInstance::DefaultWaitSpinCount);
+    QVERIFY(!instance.setWaitSpinCount(-1));
+
+    // Waiting is possible only while the state machine is started
+    QVERIFY(!instance.waitForEvents(0));
+    QVERIFY(!instance.runUntilStopped());
+
+    QVERIFY(instance.start());
+    QVERIFY(!instance.waitForEvents(10));
+    QVERIFY(instance.addEventToBack("wait_event"));
+    QVERIFY(instance.waitForEvents(0));
+    QVERIFY(instance.poll());
+    QCOMPARE(counter, 1);
+
+    // Waiting thread is woken up when the state machine is stopped
+    std::thread stopper([&instance]()
+    {
+        std::this_thread::sleep_for(std::chrono::milliseconds(20));
+        instance.stop();
+    });
+
+    QVERIFY(!instance.waitForEvents());
+    stopper.join();
+
+    // Events are processed until a final state is reached (with and without spinning)
+    for (const int spinCount : {0, 100})
+    {
+        for (const auto mode : {StateMachineInstance::EventQueueMode::Locked,
+                                StateMachineInstance::EventQueueMode::LockFree})
+        {
+            QVERIFY(instance.setEventQueueMode(mode));
+            QVERIFY(instance.setWaitSpinCount(spinCount));
+            QCOMPARE(instance.waitSpinCount(), spinCount);
+            QVERIFY(instance.start());
+
+            counter = 0;
+            std::thread producer([&instance]()
+            {
+                const EventId eventId = EventNameRegistry::id("wait_event");
+
+                for (int i = 0; i < eventCount; i++)
+                {
+                    instance.addEventToBack(eventId);
+
+                    if ((i % 100) == 0)
+                    {
+                        std::this_thread::sleep_for(std::chrono::milliseconds(1));
+                    }
+                }
+
+                instance.addEventToBack("wait_stop");
+            });
+
+            QVERIFY(instance.runUntilStopped());
+            producer.join();
+
+            QCOMPARE(counter, eventCount);
+            QVERIFY(instance.finalStateReached());
+        }
+    }
+}
+
+// Test: Event coalescing -------------------------------------------------------------------------
+
+void TestStateMachineInstance::testEventCoalescing()
+{
+    using CoalescingPolicy = StateMachineInstance::CoalescingPolicy;
+
+    QStringList log;
+    auto definition = std::make_shared<StateMachineDefinition>();
+    StateMachineInstance instance(definition);
+
+    const auto logEvent = [&](const Event &event, const QString &)
+    {
+        log.append(QString("%1:%2").arg(event.name())
+                                   .arg(event.parameter<EventParameter<int>>()->value()));
+    };
+
+    QVERIFY(definition->addState("a"));
+    QVERIFY(definition->setInitialTransition("a"));
+    QVERIFY(definition->addInternalTransition("a", "coalesce_a", logEvent));
+    QVERIFY(definition->addInternalTransition("a", "coalesce_b", logEvent));
+    QVERIFY(definition->addInternalTransition("a", "coalesce_c", logEvent));
+    QVERIFY(definition->addInternalTransition("a",
+                                              "coalesce_front",
+                                              [&](const Event &event, const QString &state)
+    {
+        // Events added to the front are not replaced by the coalesced events
+        logEvent(event, state);
+        instance.addEventToFront(Event("coalesce_a", EventParameter<int>(7)));
+        instance.addEventToBack(Event("coalesce_a", EventParameter<int>(8)));
+    }));
+    QVERIFY(definition->validate());
+
+    const auto addEvent = [&](const QString &name, const int value)
+    {
+        return instance.addEventToBack(Event(name, EventParameter<int>(value)));
+    };
+
+    // Coalescing policy can be set only while the state machine is stopped
+    QCOMPARE(instance.eventCoalescingPolicy("coalesce_a"), CoalescingPolicy::None);
+    QVERIFY(!instance.setEventCoalescingPolicy(QString(), CoalescingPolicy::ReplaceInPlace));
+    QVERIFY(instance.setEventCoalescingPolicy("coalesce_a", CoalescingPolicy::ReplaceInPlace));
+    QVERIFY(instance.setEventCoalescingPolicy("coalesce_b", CoalescingPolicy::MoveToBack));
+    QCOMPARE(instance.eventCoalescingPolicy("coalesce_a"), CoalescingPolicy::ReplaceInPlace);
+    QCOMPARE(instance.eventCoalescingPolicy("coalesce_b"), CoalescingPolicy::MoveToBack);
+    QCOMPARE(instance.eventCoalescingPolicy("coalesce_c"), CoalescingPolicy::None);
+
+    QVERIFY(instance.start());
+    QVERIFY(!instance.setEventCoalescingPolicy("coalesce_c", CoalescingPolicy::MoveToBack));
+
+    for (const int batchSize : {0, 1, 2})
+    {
+        QVERIFY(instance.setPollBatchSize(batchSize));
+
+        // Replaced event keeps its position or it is moved to the back
+        log.clear();
+        QVERIFY(addEvent("coalesce_a", 1));
+        QVERIFY(addEvent("coalesce_b", 1));
+        QVERIFY(addEvent("coalesce_c", 1));
+        QVERIFY(addEvent("coalesce_a", 2));
+        QVERIFY(addEvent("coalesce_b", 2));
+        QVERIFY(addEvent("coalesce_c", 2));
+        QVERIFY(addEvent("coalesce_a", 3));
+        QVERIFY(instance.poll());
+        QCOMPARE(log, QStringList({
+                     "coalesce_a:3", "coalesce_c:1", "coalesce_b:2", "coalesce_c:2"
+                 }));
+        QVERIFY(!instance.hasPendingEvents());
+
+        // Events that were already taken from the event queue are not replaced
+        log.clear();
+        QVERIFY(addEvent("coalesce_front", 0));
+        QVERIFY(instance.poll());
+        QCOMPARE(log, QStringList({"coalesce_front:0", "coalesce_a:7", "coalesce_a:8"}));
+
+        log.clear();
+        QVERIFY(addEvent("coalesce_a", 1));
+        QVERIFY(instance.processNextEvent());
+        QVERIFY(addEvent("coalesce_a", 2));
+        QVERIFY(instance.poll());
+        QCOMPARE(log, QStringList({"coalesce_a:1", "coalesce_a:2"}));
+    }
+
+    // Number of pending events is bounded by the number of coalesced event names
+    log.clear();
+
+    for (int i = 0; i < 10000; i++)
+    {
+        QVERIFY(addEvent(((i % 2) == 0) ? "coalesce_b" : "coalesce_a", i));
+    }
+
+    QVERIFY(instance.hasPendingEvents());
+    QVERIFY(instance.processNextEvent());
+    QVERIFY(instance.processNextEvent());
+    QVERIFY(!instance.hasPendingEvents());
+    QCOMPARE(log, QStringList({"coalesce_a:9999", "coalesce_b:9998"}));
+
+    // Events cannot be coalesced in the lock-free event queue mode
+    QVERIFY(instance.stop());
+    QVERIFY(!instance.setEventQueueMode(StateMachineInstance::EventQueueMode::LockFree));
+    QVERIFY(instance.setEventCoalescingPolicy("coalesce_a", CoalescingPolicy::None));
+    QVERIFY(instance.setEventCoalescingPolicy("coalesce_b", CoalescingPolicy::None));
+    QVERIFY(instance.setEventQueueMode(StateMachineInstance::EventQueueMode::LockFree));
+    QVERIFY(!instance.setEventCoalescingPolicy("coalesce_a", CoalescingPolicy::ReplaceInPlace));
+    QVERIFY(instance.setEventCoalescingPolicy("coalesce_a", CoalescingPolicy::None));
+    QVERIFY(instance.start());
+
+    log.clear();
+    QVERIFY(addEvent("coalesce_a", 1));
+    QVERIFY(addEvent("coalesce_a", 2));
+    QVERIFY(instance.poll());
+    QCOMPARE(log, QStringList({"coalesce_a:1", "coalesce_a:2"}));
+}
+
+// Test: Bounded event queue ----------------------------------------------------------------------
+
+void TestStateMachineInstance::testBoundedEventQueue()
+{
+    using BackpressurePolicy = StateMachineInstance::BackpressurePolicy;
+
+    QList<int> log;
+    auto definition = std::make_shared<StateMachineDefinition>();
+    StateMachineInstance instance(definition);
+
+    QVERIFY(definition->addState("a"));
+    QVERIFY(definition->setInitialTransition("a"));
+    QVERIFY(definition->addInternalTransition("a",
+                                              "bounded_event",
+                                              [&](const Event &event, const QString &)
+    {
+        log.append(event.parameter<EventParameter<int>>()->value());
+    }));
+    QVERIFY(definition->validate());
+
+    const EventId eventId = EventNameRegistry::id("bounded_event");
+    const auto addEvent = [&](const int value)
+    {
+        return instance.addEventToBack(Event(eventId, EventParameter<int>(value)));
+    };
+
+    // Capacity and policy can be changed only while the state machine is stopped
+    QCOMPARE(instance.eventQueueCapacity(), StateMachineInstance::DefaultEventQueueCapacity);
+    QCOMPARE(instance.backpressurePolicy(), BackpressurePolicy::Reject);
+    QCOMPARE(instance.backpressureTimeout(), -1);
+    QVERIFY(!instance.setEventQueueCapacity(-1));
+    QVERIFY(instance.setEventQueueCapacity(2));
+    QCOMPARE(instance.eventQueueCapacity(), 2);
+
+    QVERIFY(instance.start());
+    QVERIFY(!instance.setEventQueueCapacity(3));
+    QVERIFY(!instance.setBackpressurePolicy(BackpressurePolicy::Block));
+
+    // Reject: the event is not added
+    QVERIFY(addEvent(1));
+    QVERIFY(addEvent(2));
+    QVERIFY(!addEvent(3));
+    QVERIFY(instance.poll());
+    QCOMPARE(log, QList<int>({1, 2}));
+    QCOMPARE(instance.backpressureStatistics().rejected, static_cast<std::uint64_t>(1U));
+
+    // Events added to the front are always added
+    log.clear();
+    QVERIFY(addEvent(2));
+    QVERIFY(addEvent(3));
+    QVERIFY(instance.addEventToFront(Event(eventId, EventParameter<int>(1))));
+    QVERIFY(!addEvent(4));
+    QVERIFY(instance.poll());
+    QCOMPARE(log, QList<int>({1, 2, 3}));
+
+    // Drop newest: the event is dropped but the adding succeeds
+    QVERIFY(instance.stop());
+    QVERIFY(instance.setBackpressurePolicy(BackpressurePolicy::DropNewest));
+    QCOMPARE(instance.backpressurePolicy(), BackpressurePolicy::DropNewest);
+    QVERIFY(instance.start());
+
+    log.clear();
+    QVERIFY(addEvent(1));
+    QVERIFY(addEvent(2));
+    QVERIFY(addEvent(3));
+    QVERIFY(instance.poll());
+    QCOMPARE(log, QList<int>({1, 2}));
+    QCOMPARE(instance.backpressureStatistics().dropped, static_cast<std::uint64_t>(1U));
+
+    // Drop oldest: the event at the front of the event queue is dropped
+    QVERIFY(instance.stop());
+    QVERIFY(instance.setBackpressurePolicy(BackpressurePolicy::DropOldest));
+    QVERIFY(instance.start());
+
+    log.clear();
+
+    for (int i = 1; i <= 5; i++)
+    {
+        QVERIFY(addEvent(i));
+    }
+
+    QVERIFY(instance.poll());
+    QCOMPARE(log, QList<int>({4, 5}));
+    QCOMPARE(instance.backpressureStatistics().dropped, static_cast<std::uint64_t>(4U));
+
+    // Block with a timeout: the event is rejected when the timeout expires
+    QVERIFY(instance.stop());
+    QVERIFY(instance.setBackpressurePolicy(BackpressurePolicy::Block, 10));
+    QCOMPARE(instance.backpressureTimeout(), 10);
+    QVERIFY(instance.start());
+
+    log.clear();
+    QVERIFY(addEvent(1));
+    QVERIFY(addEvent(2));
+    QVERIFY(!addEvent(3));
+    QVERIFY(instance.poll());
+    QCOMPARE(log, QList<int>({1, 2}));
+    QCOMPARE(instance.backpressureStatistics().rejected, static_cast<std::uint64_t>(3U));
+    QCOMPARE(instance.backpressureStatistics().blocked, static_cast<std::uint64_t>(1U));
+
+    // Block: the producer is blocked until the events are taken from the event queue
+    const int eventCount = 1000;
+
+    QVERIFY(instance.stop());
+    QVERIFY(instance.setBackpressurePolicy(BackpressurePolicy::Block));
+    QVERIFY(instance.start());
+
+    log.clear();
+    std::thread producer([&]()
+    {
+        for (int i = 0; i < eventCount; i++)
+        {
+            addEvent(i);
+        }
+    });
+
+    while (log.size() < eventCount)
+    {
+        QVERIFY(instance.waitForEvents(5000));
+        QVERIFY(instance.poll());
+    }
+
+    producer.join();
+
+    for (int i = 0; i < eventCount; i++)
+    {
+        QCOMPARE(log.at(i), i);
+    }
+
+    // Blocked producer is woken up when the state machine is stopped
+    QVERIFY(addEvent(1));
+    QVERIFY(addEvent(2));
+
+    std::thread stopper([&instance]()
+    {
+        std::this_thread::sleep_for(std::chrono::milliseconds(20));
+        instance.stop();
+    });
+
+    QVERIFY(!addEvent(3));
+    stopper.join();
+    QVERIFY(!instance.isStarted());
+
+    // Lock-free event queue cannot be bounded
+    QVERIFY(!instance.setEventQueueMode(StateMachineInstance::EventQueueMode::LockFree));
+    QVERIFY(instance.setEventQueueCapacity(0));
+    QVERIFY(!instance.setEventQueueMode(StateMachineInstance::EventQueueMode::LockFree));
+    QVERIFY(instance.setBackpressurePolicy(BackpressurePolicy::Reject));
+    QVERIFY(instance.setEventQueueMode(StateMachineInstance::EventQueueMode::LockFree));
+    QVERIFY(!instance.setEventQueueCapacity(2));
+    QVERIFY(!instance.setBackpressurePolicy(BackpressurePolicy::DropOldest));
+    QVERIFY(instance.setBackpressurePolicy(BackpressurePolicy::Reject));
+    QCOMPARE(instance.eventQueueCapacity(), 0);
+}
+
+// Test: Event priorities -------------------------------------------------------------------------
+
+void TestStateMachineInstance::testEventPriorities()
+{
+    QStringList log;
+    auto definition = std::make_shared<StateMachineDefinition>();
+    StateMachineInstance instance(definition);
+
+    const auto logEvent = [&](const Event &event, const QString &)
+    {
+        log.append(QString("%1:%2").arg(event.name())
+                                   .arg(event.parameter<EventParameter<int>>()->value()));
+    };
+
+    QVERIFY(definition->addState("a"));
+    QVERIFY(definition->setInitialTransition("a"));
+    QVERIFY(definition->addInternalTransition("a", "priority_low", logEvent));
+    QVERIFY(definition->addInternalTransition("a", "priority_high", logEvent));
+    QVERIFY(definition->addInternalTransition("a",
+                                              "priority_urgent",
+                                              [&](const Event &event, const QString &state)
+    {
+        // Events added while a batch is being processed preempt the rest of the batch
+        logEvent(event, state);
+
+        if (event.parameter<EventParameter<int>>()->value() == 0)
+        {
+            instance.addEvent(Event("priority_high", EventParameter<int>(9)), 2);
+            instance.addEventToFront(Event("priority_urgent", EventParameter<int>(1)));
+        }
+    }));
+    QVERIFY(definition->validate());
+
+    const auto addEvent = [&](const QString &name, const int value, const int priority)
+    {
+        return instance.addEvent(Event(name, EventParameter<int>(value)), priority);
+    };
+
+    QVERIFY(!addEvent("priority_low", 0, 0));
+    QVERIFY(instance.start());
+    QVERIFY(!addEvent("priority_low", 0, -1));
+    QVERIFY(!addEvent("priority_low", 0, StateMachineInstance::EventPriorityCount));
+
+    for (const auto mode : {StateMachineInstance::EventQueueMode::Locked,
+                            StateMachineInstance::EventQueueMode::LockFree})
+    {
+        QVERIFY(instance.stop());
+        QVERIFY(instance.setEventQueueMode(mode));
+        QVERIFY(instance.setPollBatchSize(2));
+        QVERIFY(instance.start());
+
+        // Highest priority lane that is not empty is always drained first (FIFO within a lane)
+        log.clear();
+        QVERIFY(addEvent("priority_low", 1, StateMachineInstance::NormalEventPriority));
+        QVERIFY(addEvent("priority_high", 1, 2));
+        QVERIFY(addEvent("priority_low", 2, StateMachineInstance::NormalEventPriority));
+        QVERIFY(addEvent("priority_high", 2, 1));
+        QVERIFY(addEvent("priority_high", 3, 2));
+        QVERIFY(addEvent("priority_high", 4, StateMachineInstance::HighestEventPriority));
+        QVERIFY(instance.addEventToFront(Event("priority_urgent", EventParameter<int>(2))));
+
+        QVERIFY(instance.processNextEvent());
+        QVERIFY(instance.processNextEvent());
+        QVERIFY(instance.poll());
+        QVERIFY(!instance.hasPendingEvents());
+        QCOMPARE(log, QStringList({
+                                      "priority_urgent:2",
+                                      "priority_high:4",
+                                      "priority_high:1",
+                                      "priority_high:3",
+                                      "priority_high:2",
+                                      "priority_low:1",
+                                      "priority_low:2"
+                                  }));
+
+        // Events with a higher priority added during a batch are processed before its rest
+        QVERIFY(instance.setPollBatchSize(0));
+        log.clear();
+        QVERIFY(addEvent("priority_low", 1, StateMachineInstance::NormalEventPriority));
+        QVERIFY(addEvent("priority_urgent", 0, StateMachineInstance::NormalEventPriority));
+        QVERIFY(addEvent("priority_low", 2, StateMachineInstance::NormalEventPriority));
+        QVERIFY(instance.poll());
+        QCOMPARE(log, QStringList({
+                                      "priority_low:1",
+                                      "priority_urgent:0",
+                                      "priority_urgent:1",
+                                      "priority_high:9",
+                                      "priority_low:2"
+                                  }));
+    }
+}
+
+// Test: Delayed events ---------------------------------------------------------------------------
+
+void TestStateMachineInstance::testDelayedEvents()
+{
+    QStringList log;
+    auto definition = std::make_shared<StateMachineDefinition>();
+    StateMachineInstance instance(definition);
+    TimerId stateTimer = InvalidTimerId;
+
+    QVERIFY(definition->addState("a"));
+    QVERIFY(definition->addState("b"));
+    QVERIFY(definition->setInitialTransition("a"));
+    QVERIFY(definition->addStateTransition("a", "delayed_a_to_b", "b"));
+    QVERIFY(definition->addStateTransition("b", "delayed_b_to_a", "a"));
+    QVERIFY(definition->addInternalTransition("a",
+                                              "delayed_log",
+                                              [&](const Event &event, const QString &)
+    {
+        log.append(event.name());
+    }));
+    QVERIFY(definition->setStateEntryAction("b",
+                                            [&](auto &, auto &, auto &)
+    {
+        // State-scoped timeout belongs to the entered state
+        stateTimer = instance.addStateEventAfter(0, Event("delayed_b_to_a"));
+    }));
+    QVERIFY(definition->validate());
+
+    // Timing wheel is driven manually so that the timers expire deterministically
+    auto timerWheel = std::make_shared<TimerWheel>();
+    QVERIFY(instance.timerWheel() == nullptr);
+    QVERIFY(instance.setTimerWheel(timerWheel));
+    QVERIFY(instance.timerWheel() == timerWheel);
+
+    // Delayed events can be added only to a started instance
+    QCOMPARE(instance.addEventAfter(0, "delayed_log"), InvalidTimerId);
+    QVERIFY(instance.start());
+    QVERIFY(!instance.setTimerWheel({}));
+    QCOMPARE(instance.addEventAfter(-1, "delayed_log"), InvalidTimerId);
+    QCOMPARE(instance.addEventAfter(0, Event("delayed_log"), -1), InvalidTimerId);
+
+    // Expired events are added to the event queue, cancelled events are not
+    const TimerId timer1 = instance.addEventAfter(0, "delayed_log");
+    const TimerId timer2 = instance.addEventAfter(0, "delayed_log");
+    const TimerId timer3 = instance.addEventAfter(100000, "delayed_log");
+    QVERIFY(timer1 != InvalidTimerId);
+    QVERIFY(timer2 != InvalidTimerId);
+    QVERIFY(timer3 != InvalidTimerId);
+    QVERIFY(instance.cancelDelayedEvent(timer2));
+    QVERIFY(!instance.cancelDelayedEvent(timer2));
+
+    std::this_thread::sleep_for(std::chrono::milliseconds(5));
+    QVERIFY(!instance.hasPendingEvents());
+    QCOMPARE(timerWheel->processTimers(), 1);
+    QVERIFY(!instance.cancelDelayedEvent(timer1));
+    QVERIFY(instance.poll());
+    QCOMPARE(log, QStringList({"delayed_log"}));
+
+    // State-scoped event is cancelled when its state is exited before the delay elapsed
+    QVERIFY(instance.addEventToBack("delayed_a_to_b"));
+    QVERIFY(instance.processNextEvent());
+    QCOMPARE(instance.currentState(), QString("b"));
+    QVERIFY(timerWheel->isTimerActive(stateTimer));
+
+    QVERIFY(instance.addEventToBack("delayed_b_to_a"));
+    QVERIFY(instance.processNextEvent());
+    QCOMPARE(instance.currentState(), QString("a"));
+    QVERIFY(!timerWheel->isTimerActive(stateTimer));
+    QVERIFY(timerWheel->isTimerActive(timer3));
+
+    // State-scoped event is added if the delay elapsed while the state was active
+    QVERIFY(instance.addEventToBack("delayed_a_to_b"));
+    QVERIFY(instance.processNextEvent());
+    std::this_thread::sleep_for(std::chrono::milliseconds(5));
+    QCOMPARE(timerWheel->processTimers(), 1);
+    QVERIFY(instance.processNextEvent());
+    QCOMPARE(instance.currentState(), QString("a"));
+
+    // Stopping the instance cancels all of its delayed events
+    QVERIFY(instance.stop());
+    QVERIFY(!timerWheel->isTimerActive(timer3));
+    QCOMPARE(timerWheel->timerCount(), 0);
+}
+
+// Test: Observer ---------------------------------------------------------------------------------
+
+void TestStateMachineInstance::testObserver()
+{
+    auto definition = std::make_shared<StateMachineDefinition>();
+    StateMachineInstance instance(definition);
+    bool guardResult = false;
+
+    QVERIFY(definition->addState("a"));
+    QVERIFY(definition->addState("b"));
+    QVERIFY(definition->addState("c"));
+    QVERIFY(definition->setInitialTransition("a"));
+    QVERIFY(definition->addStateTransition("a",
+                                           "observer_a_to_b",
+                                           "b",
+                                           {},
+                                           [&](auto &, auto &, auto &) { return guardResult; }));
+    QVERIFY(definition->addStateTransition("b", "observer_b_to_c", "c"));
+    QVERIFY(definition->addInternalTransition("a", "observer_tick", [](auto &, auto &) {}));
+    QVERIFY(definition->validate());
+
+    auto observer = std::make_shared<LoggingObserver>();
+    QVERIFY(instance.observer() == nullptr);
+    QVERIFY(instance.setObserver(observer));
+    QVERIFY(instance.observer() == observer);
+
+    QVERIFY(instance.start());
+    QVERIFY(!instance.setObserver({}));
+    QVERIFY(instance.addEventToBack("observer_tick"));
+    QVERIFY(instance.addEventToBack("observer_unknown"));
+    QVERIFY(instance.addEventToBack("observer_a_to_b"));
+    QVERIFY(instance.poll());
+
+    guardResult = true;
+    QVERIFY(instance.addEventToBack("observer_a_to_b"));
+    QVERIFY(instance.addEventToBack("observer_b_to_c"));
+    QVERIFY(instance.processNextEvent());
+    QVERIFY(instance.processNextEvent());
+    QVERIFY(instance.finalStateReached());
+
+    // Names of the events that are not used by the definition are not registered
+    QCOMPARE(observer->log, QStringList({
+                                            "entry:a:",
+                                            "dequeued:a:observer_tick",
+                                            "transition:a>:observer_tick",
+                                            "dequeued:a:",
+                                            "ignored:a:",
+                                            "dequeued:a:observer_a_to_b",
+                                            "rejected:a>b:observer_a_to_b",
+                                            "dequeued:a:observer_a_to_b",
+                                            "exit:a:observer_a_to_b",
+                                            "transition:a>b:observer_a_to_b",
+                                            "entry:b:observer_a_to_b",
+                                            "dequeued:b:observer_b_to_c",
+                                            "exit:b:observer_b_to_c",
+                                            "transition:b>c:observer_b_to_c",
+                                            "entry:c:observer_b_to_c",
+                                            "final:c:observer_b_to_c"
+                                        }));
+
+    // Observer can be removed when the instance is stopped
+    QVERIFY(instance.setObserver({}));
+    QVERIFY(instance.observer() == nullptr);
+}
+
+// Test: Snapshot and restore ----------------------------------------------------------------------
+
+void TestStateMachineInstance::testSnapshot()
+{
+    struct Position
+    {
+        std::int32_t x;
+        std::int32_t y;
+    };
+
+    QVERIFY(EventParameterSerializer::registerType<Position>("snapshot_position"));
+    QVERIFY(EventParameterSerializer::registerType<QString>(
+                "snapshot_string",
+                [](const QString &value, BinaryWriter *writer) { writer->writeString(value); },
+                [](BinaryReader *reader, QString *value) { return reader->readString(value); }));
+
+    auto definition = std::make_shared<StateMachineDefinition>();
+    QStringList log;
+
+    QVERIFY(definition->addState("a"));
+    QVERIFY(definition->addState("b"));
+    QVERIFY(definition->addState("c"));
+    QVERIFY(definition->setInitialTransition("a", [&](auto &, auto &) { log.append("initial"); }));
+    QVERIFY(definition->addStateTransition("a", "snapshot_a_to_b", "b"));
+    QVERIFY(definition->addStateTransition("b", "snapshot_b_to_c", "c"));
+    QVERIFY(definition->addInternalTransition("b",
+                                              "snapshot_move",
+                                              [&](auto &event, auto &)
+    {
+        const auto *parameter = event.template parameter<EventParameter<Position>>();
+        log.append(QString("move:%1,%2").arg(parameter->value().x).arg(parameter->value().y));
+    }));
+    QVERIFY(definition->addInternalTransition("b",
+                                              "snapshot_say",
+                                              [&](auto &event, auto &)
+    {
+        log.append("say:" + event.template parameter<EventParameter<QString>>()->value());
+    }));
+    QVERIFY(definition->validate());
+
+    // Snapshot of a started state machine with pending events of different priorities
+    StateMachineInstance instance(definition);
+    QVERIFY(instance.start());
+    QVERIFY(instance.addEventToBack("snapshot_a_to_b"));
+    QVERIFY(instance.poll());
+    QVERIFY(instance.addEventToBack(Event("snapshot_move",
+                                          EventParameter<Position>(Position { 1, 2 }))));
+    QVERIFY(instance.addEventToBack(Event("snapshot_unknown", EventParameter<QString>("x"))));
+    QVERIFY(instance.addEventToBack("snapshot_b_to_c"));
+    QVERIFY(instance.addEvent(Event("snapshot_say", EventParameter<QString>("hello")), 2));
+    QVERIFY(instance.addEventToFront(Event("snapshot_move",
+                                           EventParameter<Position>(Position { 3, 4 }))));
+
+    const QByteArray snapshot = instance.snapshot();
+    QVERIFY(!snapshot.isEmpty());
+
+    // Restored state machine continues without executing the initial transition
+    StateMachineInstance restoredInstance(definition);
+    log.clear();
+    QVERIFY(!instance.restore(snapshot));
+    QVERIFY(restoredInstance.restore(snapshot));
+    QVERIFY(restoredInstance.isStarted());
+    QCOMPARE(EventNameRegistry::id("snapshot_unknown"), InvalidEventId);
+    QCOMPARE(restoredInstance.currentState(), QString("b"));
+    QVERIFY(restoredInstance.hasPendingEvents());
+    QVERIFY(log.isEmpty());
+
+    QVERIFY(restoredInstance.poll());
+    QCOMPARE(log, QStringList({ "move:3,4", "say:hello", "move:1,2" }));
+    QVERIFY(restoredInstance.finalStateReached());
+    QVERIFY(!restoredInstance.isStarted());
+
+    // Original state machine is not changed by the snapshot
+    log.clear();
+    QVERIFY(instance.poll());
+    QCOMPARE(log, QStringList({ "move:3,4", "say:hello", "move:1,2" }));
+
+    // Final event is included in the snapshot of a stopped state machine
+    const QByteArray finalSnapshot = restoredInstance.snapshot();
+    StateMachineInstance finalInstance(definition);
+    QVERIFY(finalInstance.restore(finalSnapshot));
+    QVERIFY(!finalInstance.isStarted());
+    QCOMPARE(finalInstance.currentState(), QString("c"));
+    QVERIFY(finalInstance.hasFinalEvent());
+    QCOMPARE(finalInstance.takeFinalEvent()->name(), QString("snapshot_b_to_c"));
+
+    // Invalid snapshots do not change the state machine
+    StateMachineInstance invalidInstance(definition);
+    QVERIFY(!invalidInstance.restore(QByteArray()));
+    QVERIFY(!invalidInstance.restore(snapshot.left(snapshot.size() - 1)));
+    QVERIFY(!invalidInstance.restore(snapshot + QByteArray(1, '\0')));
+    QVERIFY(!invalidInstance.isStarted());
+    QCOMPARE(invalidInstance.currentStateIndex(), -1);
+
+    // Event parameters without a registered serializer cannot be included in a snapshot
+    QVERIFY(invalidInstance.start());
+    QVERIFY(invalidInstance.addEventToBack(Event("snapshot_a_to_b", EventParameter<double>(1.0))));
+    QVERIFY(invalidInstance.snapshot().isEmpty());
+}
+
+// Helper methods ----------------------------------------------------------------------------------
+
+std::shared_ptr<StateMachineDefinition> TestStateMachineInstance::createDefinition(QStringList *log)
+{
+    auto definition = std::make_shared<StateMachineDefinition>();
+
+    if (!(definition->addState("a") &&
+          definition->addState("b") &&
+          definition->addState("c") &&
+          definition->setInitialTransition("a",
+                                           [log](auto &, auto &) { log->append("initial"); }) &&
+          definition->addStateTransition("a", "inst_a_to_b", "b") &&
+          definition->addStateTransition("b", "inst_b_to_c", "c") &&
+          definition->validate()))
+    {
+        return {};
+    }
+
+    return definition;
+}
+
+// Main function -----------------------------------------------------------------------------------
+
+QTEST_MAIN(TestStateMachineInstance)
+#include "testStateMachineInstance.moc"
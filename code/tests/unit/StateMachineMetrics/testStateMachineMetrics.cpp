@@ -0,0 +1,286 @@
+/* This file is part of C++ State Machine Framework.
+ *
+ * C++ State Machine Framework is free software: you can redistribute it and/or modify it under the
+ * terms of the GNU Lesser General Public License as published by the Free Software Foundation,
+ * either version 3 of the License, or (at your option) any later version.
+ *
+ * C++ State Machine Framework is distributed in the hope that it will be useful, but WITHOUT ANY
+ * WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR
+ * PURPOSE. See the GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License along with C++ State
+ * Machine Framework. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+/*!
+ * \file
+ *
+ * Contains unit tests for the LatencyHistogram and StateMachineMetrics classes
+ */
+
+// C++ State Machine Framework includes
+#include <CppStateMachineFramework/StateMachineInstance.hpp>
+#include <CppStateMachineFramework/StateMachineMetrics.hpp>
+
+// Qt includes
+#include <QtCore/QDebug>
+#include <QtCore/QJsonArray>
+#include <QtTest/QTest>
+
+// System includes
+#include <limits>
+
+// Forward declarations
+
+// Macros
+
+// Test class declaration --------------------------------------------------------------------------
+
+using namespace CppStateMachineFramework;
+
+class TestStateMachineMetrics : public QObject
+{
+    Q_OBJECT
+
+private slots:
+    // Functions executed by QtTest before and after test suite
+    void initTestCase();
+    void cleanupTestCase();
+
+    // Functions executed by QtTest before and after each test
+    void init();
+    void cleanup();
+
+    // Test functions
+    void testLatencyHistogramBuckets();
+    void testLatencyHistogram();
+    void testInstanceMetrics();
+
+private:
+    static const StateMachineMetrics::TransitionMetrics *findTransition(
+            const StateMachineMetrics::Snapshot &snapshot,
+            const QString &fromState,
+            const QString &trigger);
+};
+
+// Test Case init/cleanup methods ------------------------------------------------------------------
+
+void TestStateMachineMetrics::initTestCase()
+{
+}
+
+void TestStateMachineMetrics::cleanupTestCase()
+{
+}
+
+// Test init/cleanup methods -----------------------------------------------------------------------
+
+void TestStateMachineMetrics::init()
+{
+}
+
+void TestStateMachineMetrics::cleanup()
+{
+}
+
+// Test: Latency histogram buckets -----------------------------------------------------------------
+
+void TestStateMachineMetrics::testLatencyHistogramBuckets()
+{
+    // Small latencies get a bucket each
+    for (std::uint64_t latency = 0U; latency < 16U; latency++)
+    {
+        QCOMPARE(LatencyHistogram::bucketIndex(latency), static_cast<int>(latency));
+        QCOMPARE(LatencyHistogram::bucketUpperBound(static_cast<int>(latency)), latency);
+    }
+
+    // Each latency is within the bounds of its bucket and the relative error is at most 12.5%
+    for (std::uint64_t latency = 16U; latency < (static_cast<std::uint64_t>(1U) << 40U);
+         latency = (latency * 3U) / 2U)
+    {
+        const int index = LatencyHistogram::bucketIndex(latency);
+        const std::uint64_t lowerBound = LatencyHistogram::bucketUpperBound(index - 1) + 1U;
+        const std::uint64_t upperBound = LatencyHistogram::bucketUpperBound(index);
+
+        QVERIFY(index < LatencyHistogram::BucketCount);
+        QVERIFY(lowerBound <= latency);
+        QVERIFY(latency <= upperBound);
+        QVERIFY((upperBound - lowerBound) <= (lowerBound / 8U));
+    }
+
+    // Very large latencies are put in the last bucket
+    QCOMPARE(LatencyHistogram::bucketIndex(static_cast<std::uint64_t>(1U) << 40U),
+             LatencyHistogram::BucketCount - 1);
+    QCOMPARE(LatencyHistogram::bucketIndex(std::numeric_limits<std::uint64_t>::max()),
+             LatencyHistogram::BucketCount - 1);
+}
+
+// Test: Latency histogram -------------------------------------------------------------------------
+
+void TestStateMachineMetrics::testLatencyHistogram()
+{
+    LatencyHistogram histogram;
+
+    auto snapshot = histogram.snapshot();
+    QCOMPARE(snapshot.count, static_cast<std::uint64_t>(0U));
+    QVERIFY(snapshot.buckets.empty());
+    QCOMPARE(snapshot.percentile(50.0), static_cast<std::uint64_t>(0U));
+    QCOMPARE(snapshot.mean(), 0.0);
+
+    for (std::uint64_t latency = 1U; latency <= 1000U; latency++)
+    {
+        histogram.record(latency * 1000U);
+    }
+
+    snapshot = histogram.snapshot();
+    QCOMPARE(snapshot.count, static_cast<std::uint64_t>(1000U));
+    QCOMPARE(snapshot.sum, static_cast<std::uint64_t>(500500000U));
+    QCOMPARE(snapshot.max, static_cast<std::uint64_t>(1000000U));
+    QCOMPARE(snapshot.mean(), 500500.0);
+    QCOMPARE(snapshot.percentile(100.0), static_cast<std::uint64_t>(1000000U));
+
+    // Percentiles are reported as the upper bound of their buckets
+    const std::uint64_t median = snapshot.percentile(50.0);
+    QVERIFY(median >= 500000U);
+    QVERIFY(median <= 562500U);
+
+    const std::uint64_t p99 = snapshot.percentile(99.0);
+    QVERIFY(p99 >= 990000U);
+    QVERIFY(p99 <= 1000000U);
+
+    histogram.reset();
+    QCOMPARE(histogram.snapshot().count, static_cast<std::uint64_t>(0U));
+}
+
+// Test: Metrics of a state machine instance -------------------------------------------------------
+
+void TestStateMachineMetrics::testInstanceMetrics()
+{
+    auto definition = std::make_shared<StateMachineDefinition>();
+    StateMachineInstance instance(definition);
+    bool guardResult = false;
+
+    QVERIFY(definition->addState("a"));
+    QVERIFY(definition->addState("b"));
+    QVERIFY(definition->setInitialTransition("a"));
+    QVERIFY(definition->setStateEntryAction("a", [](auto &, auto &, auto &) {}));
+    QVERIFY(definition->setStateExitAction("a", [](auto &, auto &, auto &) {}));
+    QVERIFY(definition->addStateTransition("a",
+                                           "metrics_a_to_b",
+                                           "b",
+                                           {},
+                                           [&](auto &, auto &, auto &) { return guardResult; }));
+    QVERIFY(definition->addStateTransition("b", "metrics_b_to_a", "a"));
+    QVERIFY(definition->addInternalTransition("a", "metrics_tick", [](auto &, auto &) {}));
+    QVERIFY(definition->validate());
+    QCOMPARE(definition->transitionCount(), 3);
+
+    // Metrics are empty until they are enabled and the instance is started
+    QVERIFY(!instance.metricsEnabled());
+    QVERIFY(instance.metrics().states.empty());
+    QVERIFY(instance.setMetricsEnabled(true));
+    QVERIFY(instance.metricsEnabled());
+    QVERIFY(instance.metrics().states.empty());
+
+    QVERIFY(instance.start());
+    QVERIFY(!instance.setMetricsEnabled(false));
+
+    QVERIFY(instance.addEventToBack("metrics_tick"));
+    QVERIFY(instance.addEventToBack("metrics_tick"));
+    QVERIFY(instance.addEventToBack("metrics_unknown"));
+    QVERIFY(instance.addEventToBack("metrics_a_to_b"));
+    QVERIFY(instance.poll());
+    QCOMPARE(instance.currentState(), QString("a"));
+
+    guardResult = true;
+    QVERIFY(instance.addEventToBack("metrics_a_to_b"));
+    QVERIFY(instance.addEventToBack("metrics_b_to_a"));
+    QVERIFY(instance.poll());
+    QCOMPARE(instance.currentState(), QString("a"));
+
+    // States
+    auto snapshot = instance.metrics();
+    QCOMPARE(snapshot.states.size(), static_cast<std::size_t>(2));
+    QCOMPARE(snapshot.transitions.size(), static_cast<std::size_t>(3));
+
+    const auto &stateA = snapshot.states[0];
+    QCOMPARE(stateA.name, QString("a"));
+    QCOMPARE(stateA.entered, static_cast<std::uint64_t>(2U));
+    QCOMPARE(stateA.exited, static_cast<std::uint64_t>(1U));
+    QCOMPARE(stateA.ignoredEvents, static_cast<std::uint64_t>(1U));
+    QCOMPARE(stateA.entryActionLatency.count, static_cast<std::uint64_t>(2U));
+    QCOMPARE(stateA.exitActionLatency.count, static_cast<std::uint64_t>(1U));
+
+    const auto &stateB = snapshot.states[1];
+    QCOMPARE(stateB.name, QString("b"));
+    QCOMPARE(stateB.entered, static_cast<std::uint64_t>(1U));
+    QCOMPARE(stateB.exited, static_cast<std::uint64_t>(1U));
+    QCOMPARE(stateB.ignoredEvents, static_cast<std::uint64_t>(0U));
+    QCOMPARE(stateB.entryActionLatency.count, static_cast<std::uint64_t>(0U));
+
+    // Transitions
+    const auto *aToB = findTransition(snapshot, "a", "metrics_a_to_b");
+    QVERIFY(aToB != nullptr);
+    QCOMPARE(aToB->toState, QString("b"));
+    QCOMPARE(aToB->fired, static_cast<std::uint64_t>(1U));
+    QCOMPARE(aToB->guardRejected, static_cast<std::uint64_t>(1U));
+    QCOMPARE(aToB->actionLatency.count, static_cast<std::uint64_t>(0U));
+
+    const auto *bToA = findTransition(snapshot, "b", "metrics_b_to_a");
+    QVERIFY(bToA != nullptr);
+    QCOMPARE(bToA->fired, static_cast<std::uint64_t>(1U));
+    QCOMPARE(bToA->guardRejected, static_cast<std::uint64_t>(0U));
+
+    const auto *tick = findTransition(snapshot, "a", "metrics_tick");
+    QVERIFY(tick != nullptr);
+    QVERIFY(tick->toState.isEmpty());
+    QCOMPARE(tick->fired, static_cast<std::uint64_t>(2U));
+    QCOMPARE(tick->actionLatency.count, static_cast<std::uint64_t>(2U));
+
+    const QJsonObject json = snapshot.toJson();
+    QCOMPARE(json.value("states").toArray().size(), 2);
+    QCOMPARE(json.value("transitions").toArray().size(), 3);
+
+    // Metrics can be cleared and they are also cleared when the instance is started again
+    instance.resetMetrics();
+    QCOMPARE(instance.metrics().states[0].entered, static_cast<std::uint64_t>(0U));
+
+    QVERIFY(instance.addEventToBack("metrics_tick"));
+    QVERIFY(instance.poll());
+    QVERIFY(instance.stop());
+    QCOMPARE(findTransition(instance.metrics(), "a", "metrics_tick")->fired,
+             static_cast<std::uint64_t>(1U));
+
+    QVERIFY(instance.start());
+    QCOMPARE(findTransition(instance.metrics(), "a", "metrics_tick")->fired,
+             static_cast<std::uint64_t>(0U));
+    QCOMPARE(instance.metrics().states[0].entered, static_cast<std::uint64_t>(1U));
+
+    // Disabled metrics are discarded
+    QVERIFY(instance.stop());
+    QVERIFY(instance.setMetricsEnabled(false));
+    QVERIFY(instance.metrics().states.empty());
+}
+
+// Helper methods ----------------------------------------------------------------------------------
+
+const StateMachineMetrics::TransitionMetrics *TestStateMachineMetrics::findTransition(
+        const StateMachineMetrics::Snapshot &snapshot,
+        const QString &fromState,
+        const QString &trigger)
+{
+    for (const auto &transition : snapshot.transitions)
+    {
+        if ((transition.fromState == fromState) && (transition.trigger == trigger))
+        {
+            return &transition;
+        }
+    }
+
+    return nullptr;
+}
+
+// Main function -----------------------------------------------------------------------------------
+
+QTEST_MAIN(TestStateMachineMetrics)
+#include "testStateMachineMetrics.moc"
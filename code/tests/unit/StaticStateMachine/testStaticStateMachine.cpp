@@ -0,0 +1,309 @@
+/* This file is part of C++ State Machine Framework.
+ *
+ * C++ State Machine Framework is free software: you can redistribute it and/or modify it under the
+ * terms of the GNU Lesser General Public License as published by the Free Software Foundation,
+ * either version 3 of the License, or (at your option) any later version.
+ *
+ * C++ State Machine Framework is distributed in the hope that it will be useful, but WITHOUT ANY
+ * WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR
+ * PURPOSE. See the GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License along with C++ State
+ * Machine Framework. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+/*!
+ * \file
+ *
+ * Contains unit tests for the StaticStateMachine class template
+ */
+
+// C++ State Machine Framework includes
+#include <CppStateMachineFramework/StaticStateMachine.hpp>
+
+// Qt includes
+#include <QtCore/QDebug>
+#include <QtCore/QStringList>
+#include <QtTest/QTest>
+
+// System includes
+
+// Forward declarations
+
+// Macros
+
+// Test state machine ------------------------------------------------------------------------------
+
+using namespace CppStateMachineFramework;
+
+namespace
+{
+
+//! Context of the test state machine
+struct Context
+{
+    QStringList log;
+    int byteCount = 0;
+    bool allowEnd = true;
+};
+
+// States
+struct Idle {};
+struct Receiving {};
+struct Done {};
+
+// Events
+struct Start { int id; };
+struct Byte { char value; };
+struct End {};
+struct Unknown {};
+
+//! Logs the action with the given name
+template<char Name>
+struct Log
+{
+    template<typename Event>
+    void operator()(Context &context, const Event &) const
+    {
+        const char name[] = { Name, '\0' };
+        context.log.append(QString(name));
+    }
+};
+
+//! Logs the start event
+struct StartAction
+{
+    void operator()(Context &context, const Start &event) const
+    {
+        context.log.append(QString("start:%1").arg(event.id));
+    }
+};
+
+//! Counts the bytes
+struct CountByte
+{
+    void operator()(Context &context, const Byte &) const
+    {
+        context.byteCount++;
+    }
+};
+
+//! Logs the events without an explicit transition
+struct LogDefault
+{
+    template<typename Event>
+    void operator()(Context &context, const Event &) const
+    {
+        context.log.append("default");
+    }
+};
+
+//! Allows the end event only if enabled in the context
+struct AllowEnd
+{
+    bool operator()(const Context &context, const End &) const
+    {
+        return context.allowEnd;
+    }
+};
+
+//! Logs the state action
+struct StateAction
+{
+    void operator()(Context &context) const
+    {
+        context.log.append("state");
+    }
+};
+
+using TestStateMachine = StaticStateMachine<
+        Context,
+        StaticStates<StaticState<Idle, Log<'E'>, Log<'X'>>,
+                     StaticState<Receiving, Log<'e'>, Log<'x'>, StateAction>,
+                     StaticState<Done, Log<'F'>>>,
+        StaticInitialTransition<Idle, Log<'I'>>,
+        StaticTransitions<StaticStateTransition<Idle, Start, Receiving, StartAction>,
+                          StaticInternalTransition<Receiving, Byte, CountByte>,
+                          StaticInternalTransition<Receiving, StaticAnyEvent, LogDefault>,
+                          StaticStateTransition<Receiving, End, Done, Log<'T'>, AllowEnd>>>;
+
+static_assert(TestStateMachine::StateCount == 3, "Invalid state count");
+static_assert(TestStateMachine::stateIndex<Receiving>() == 1, "Invalid state index");
+static_assert(TestStateMachine::stateIndex<Unknown>() == -1, "Invalid state index");
+static_assert(!TestStateMachine::isFinalState(0), "Invalid final state");
+static_assert(TestStateMachine::isFinalState(2), "Invalid final state");
+static_assert(TestStateMachine::allStatesReachable(), "Invalid reachability");
+
+//! State machine whose final state can be reached only with a default transition
+template<typename Event>
+using ReachabilityStateMachine = StaticStateMachine<
+        Context,
+        StaticStates<StaticState<Idle>, StaticState<Receiving>, StaticState<Done>>,
+        StaticInitialTransition<Idle>,
+        StaticTransitions<StaticStateTransition<Idle, Start, Receiving>,
+                          StaticStateTransition<Receiving, Event, Done>>>;
+
+static_assert(ReachabilityStateMachine<End>::allStatesReachable(), "Invalid reachability");
+static_assert(!ReachabilityStateMachine<StaticAnyEvent>::allStatesReachable(),
+              "Default transitions must not be followed for the reachability");
+
+} // namespace
+
+// Test class declaration --------------------------------------------------------------------------
+
+class TestStaticStateMachine : public QObject
+{
+    Q_OBJECT
+
+private slots:
+    // Functions executed by QtTest before and after test suite
+    void initTestCase();
+    void cleanupTestCase();
+
+    // Functions executed by QtTest before and after each test
+    void init();
+    void cleanup();
+
+    // Test functions
+    void testStartStop();
+    void testTransitions();
+    void testGuardCondition();
+    void testFinalInitialState();
+};
+
+// Test Case init/cleanup methods ------------------------------------------------------------------
+
+void TestStaticStateMachine::initTestCase()
+{
+}
+
+void TestStaticStateMachine::cleanupTestCase()
+{
+}
+
+// Test init/cleanup methods -----------------------------------------------------------------------
+
+void TestStaticStateMachine::init()
+{
+}
+
+void TestStaticStateMachine::cleanup()
+{
+}
+
+// Test: Start and stop ----------------------------------------------------------------------------
+
+void TestStaticStateMachine::testStartStop()
+{
+    TestStateMachine stateMachine;
+    QVERIFY(!stateMachine.isStarted());
+    QCOMPARE(stateMachine.currentStateIndex(), -1);
+    QVERIFY(!stateMachine.finalStateReached());
+    QVERIFY(!stateMachine.processEvent(Start { 1 }));
+    QVERIFY(!stateMachine.executeStateAction());
+    QVERIFY(!stateMachine.stop());
+
+    // Initial transition's action is executed before the entry action of the initial state
+    QVERIFY(stateMachine.start());
+    QVERIFY(stateMachine.isStarted());
+    QVERIFY(stateMachine.isInState<Idle>());
+    QVERIFY(!stateMachine.start());
+    QCOMPARE(stateMachine.context().log, QStringList({"I", "E"}));
+
+    QVERIFY(stateMachine.stop());
+    QVERIFY(!stateMachine.isStarted());
+    QVERIFY(!stateMachine.finalStateReached());
+}
+
+// Test: Transitions -------------------------------------------------------------------------------
+
+void TestStaticStateMachine::testTransitions()
+{
+    Context context;
+    context.log.append("context");
+
+    TestStateMachine stateMachine(context);
+    QVERIFY(stateMachine.start());
+
+    // Events without a transition are ignored
+    QVERIFY(stateMachine.processEvent(Byte { 'a' }));
+    QVERIFY(stateMachine.isInState<Idle>());
+    QVERIFY(stateMachine.executeStateAction());
+
+    // State transition: exit action, transition action and entry action
+    QVERIFY(stateMachine.processEvent(Start { 7 }));
+    QVERIFY(stateMachine.isInState<Receiving>());
+    QCOMPARE(stateMachine.context().log, QStringList({"context", "I", "E", "X", "start:7", "e"}));
+
+    // Internal transitions (explicit and default)
+    stateMachine.context().log.clear();
+
+    for (char value = 'a'; value <= 'z'; value++)
+    {
+        QVERIFY(stateMachine.processEvent(Byte { value }));
+    }
+
+    QVERIFY(stateMachine.processEvent(Unknown()));
+    QVERIFY(stateMachine.processEvent(Start { 8 }));
+    QVERIFY(stateMachine.executeStateAction());
+    QVERIFY(stateMachine.isInState<Receiving>());
+    QCOMPARE(stateMachine.context().byteCount, 26);
+    QCOMPARE(stateMachine.context().log, QStringList({"default", "default", "state"}));
+
+    // Transition to a final state stops the state machine
+    stateMachine.context().log.clear();
+    QVERIFY(stateMachine.processEvent(End()));
+    QVERIFY(stateMachine.isInState<Done>());
+    QVERIFY(!stateMachine.isStarted());
+    QVERIFY(stateMachine.finalStateReached());
+    QCOMPARE(stateMachine.context().log, QStringList({"x", "T", "F"}));
+    QVERIFY(!stateMachine.processEvent(Byte { 'a' }));
+
+    // State machine can be started again
+    QVERIFY(stateMachine.start());
+    QVERIFY(stateMachine.isInState<Idle>());
+    QVERIFY(!stateMachine.finalStateReached());
+}
+
+// Test: Guard condition ---------------------------------------------------------------------------
+
+void TestStaticStateMachine::testGuardCondition()
+{
+    TestStateMachine stateMachine;
+    stateMachine.context().allowEnd = false;
+
+    QVERIFY(stateMachine.start());
+    QVERIFY(stateMachine.processEvent(Start { 1 }));
+    stateMachine.context().log.clear();
+
+    // Blocked transition does not execute any actions
+    QVERIFY(stateMachine.processEvent(End()));
+    QVERIFY(stateMachine.isInState<Receiving>());
+    QVERIFY(stateMachine.isStarted());
+    QVERIFY(stateMachine.context().log.isEmpty());
+
+    stateMachine.context().allowEnd = true;
+    QVERIFY(stateMachine.processEvent(End()));
+    QVERIFY(stateMachine.isInState<Done>());
+}
+
+// Test: Initial state that is also a final state --------------------------------------------------
+
+void TestStaticStateMachine::testFinalInitialState()
+{
+    using FinalStateMachine = StaticStateMachine<Context,
+                                                 StaticStates<StaticState<Done, Log<'F'>>>,
+                                                 StaticInitialTransition<Done>,
+                                                 StaticTransitions<>>;
+
+    FinalStateMachine stateMachine;
+    QVERIFY(stateMachine.start(Start { 1 }));
+    QVERIFY(!stateMachine.isStarted());
+    QVERIFY(stateMachine.finalStateReached());
+    QCOMPARE(stateMachine.context().log, QStringList({"F"}));
+}
+
+// Main function -----------------------------------------------------------------------------------
+
+QTEST_MAIN(TestStaticStateMachine)
+#include "testStaticStateMachine.moc"
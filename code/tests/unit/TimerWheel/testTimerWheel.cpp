@@ -0,0 +1,339 @@
+/* This file is part of C++ State Machine Framework.
+ *
+ * C++ State Machine Framework is free software: you can redistribute it and/or modify it under the
+ * terms of the GNU Lesser General Public License as published by the Free Software Foundation,
+ * either version 3 of the License, or (at your option) any later version.
+ *
+ * C++ State Machine Framework is distributed in the hope that it will be useful, but WITHOUT ANY
+ * WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR
+ * PURPOSE. See the GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License along with C++ State
+ * Machine Framework. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+/*!
+ * \file
+ *
+ * Contains unit tests for the TimerWheel class
+ */
+
+// C++ State Machine Framework includes
+#include <CppStateMachineFramework/StateMachineInstance.hpp>
+#include <CppStateMachineFramework/TimerWheel.hpp>
+
+// Qt includes
+#include <QtCore/QDebug>
+#include <QtCore/QStringList>
+#include <QtTest/QTest>
+
+// System includes
+#include <chrono>
+#include <thread>
+
+// Forward declarations
+
+// Macros
+
+// Test class declaration --------------------------------------------------------------------------
+
+using namespace CppStateMachineFramework;
+
+class TestTimerWheel : public QObject
+{
+    Q_OBJECT
+
+private slots:
+    // Functions executed by QtTest before and after test suite
+    void initTestCase();
+    void cleanupTestCase();
+
+    // Functions executed by QtTest before and after each test
+    void init();
+    void cleanup();
+
+    // Test functions
+    void testAddCancel();
+    void testProcessTimers();
+    void testWorkerThread();
+    void testCancelInstanceTimers();
+
+private:
+    std::shared_ptr<StateMachineDefinition> createDefinition(QStringList *log);
+    static TimerId addTimer(TimerWheel *timerWheel,
+                            StateMachineInstance *instance,
+                            int delay,
+                            int value,
+                            bool stateScoped = false);
+    static void processEvents(StateMachineInstance *instance);
+};
+
+// Test Case init/cleanup methods ------------------------------------------------------------------
+
+void TestTimerWheel::initTestCase()
+{
+}
+
+void TestTimerWheel::cleanupTestCase()
+{
+}
+
+// Test init/cleanup methods -----------------------------------------------------------------------
+
+void TestTimerWheel::init()
+{
+}
+
+void TestTimerWheel::cleanup()
+{
+}
+
+// Test: Arm and cancel timers ---------------------------------------------------------------------
+
+void TestTimerWheel::testAddCancel()
+{
+    QStringList log;
+    StateMachineInstance instance(createDefinition(&log));
+    QVERIFY(instance.start());
+
+    TimerWheel timerWheel(5);
+    QCOMPARE(timerWheel.tickInterval(), 5);
+    QVERIFY(!timerWheel.isRunning());
+    QCOMPARE(timerWheel.timerCount(), 0);
+
+    // Invalid timers
+    QCOMPARE(timerWheel.addTimer(nullptr, 10, Event("timer"), 0, false), InvalidTimerId);
+    QCOMPARE(timerWheel.addTimer(&instance, -1, Event("timer"), 0, false), InvalidTimerId);
+    QCOMPARE(timerWheel.addTimer(&instance, 10, Event(InvalidEventId), 0, false), InvalidTimerId);
+    QVERIFY(!timerWheel.isTimerActive(InvalidTimerId));
+    QVERIFY(!timerWheel.cancelTimer(InvalidTimerId));
+
+    // Cancelled timer is released and its ID is not reused
+    const TimerId timer1 = timerWheel.addTimer(&instance, 10, Event("timer"), 0, false);
+    const TimerId timer2 = timerWheel.addTimer(&instance, 100000, Event("timer"), 0, false);
+    QVERIFY(timer1 != InvalidTimerId);
+    QVERIFY(timer2 != InvalidTimerId);
+    QVERIFY(timer1 != timer2);
+    QCOMPARE(timerWheel.timerCount(), 2);
+    QVERIFY(timerWheel.isTimerActive(timer1));
+
+    QVERIFY(timerWheel.cancelTimer(timer1));
+    QVERIFY(!timerWheel.cancelTimer(timer1));
+    QVERIFY(!timerWheel.isTimerActive(timer1));
+    QCOMPARE(timerWheel.timerCount(), 1);
+
+    const TimerId timer3 = timerWheel.addTimer(&instance, 10, Event("timer"), 0, false);
+    QVERIFY(timer3 != timer1);
+    QVERIFY(!timerWheel.cancelTimer(timer1));
+    QVERIFY(timerWheel.isTimerActive(timer3));
+
+    QVERIFY(timerWheel.cancelTimer(timer2));
+    QVERIFY(timerWheel.cancelTimer(timer3));
+    QCOMPARE(timerWheel.timerCount(), 0);
+
+    // Manual processing is not possible while the worker thread is running
+    QVERIFY(timerWheel.start());
+    QVERIFY(timerWheel.isRunning());
+    QVERIFY(!timerWheel.start());
+    QCOMPARE(timerWheel.processTimers(), 0);
+    QVERIFY(timerWheel.stop());
+    QVERIFY(!timerWheel.stop());
+}
+
+// Test: Process the timers manually ---------------------------------------------------------------
+
+void TestTimerWheel::testProcessTimers()
+{
+    QStringList log;
+    StateMachineInstance instance(createDefinition(&log));
+    QVERIFY(instance.start());
+
+    TimerWheel timerWheel;
+    const auto start = std::chrono::steady_clock::now();
+
+    // Timers in the lowest and in the second level of the timing wheel
+    QVERIFY(addTimer(&timerWheel, &instance, 150, 4));
+    QVERIFY(addTimer(&timerWheel, &instance, 0, 1));
+    QVERIFY(addTimer(&timerWheel, &instance, 80, 3));
+    QVERIFY(addTimer(&timerWheel, &instance, 20, 2));
+    QCOMPARE(timerWheel.processTimers(), 0);
+
+    // Timers never expire early
+    int expectedCount = 0;
+
+    while (timerWheel.timerCount() > 0)
+    {
+        std::this_thread::sleep_for(std::chrono::milliseconds(5));
+        timerWheel.processTimers();
+        processEvents(&instance);
+
+        const auto elapsed = std::chrono::duration_cast<std::chrono::milliseconds>(
+                    std::chrono::steady_clock::now() - start).count();
+
+        if (elapsed < 20)
+        {
+            expectedCount = 1;
+        }
+        else if (elapsed < 80)
+        {
+            expectedCount = 2;
+        }
+        else if (elapsed < 150)
+        {
+            expectedCount = 3;
+        }
+        else
+        {
+            expectedCount = 4;
+        }
+
+        QVERIFY(log.size() <= expectedCount);
+        QVERIFY(elapsed < 5000);
+    }
+
+    QCOMPARE(log, QStringList({"timer:1", "timer:2", "timer:3", "timer:4"}));
+}
+
+// Test: Worker thread -----------------------------------------------------------------------------
+
+void TestTimerWheel::testWorkerThread()
+{
+    QStringList log;
+    StateMachineInstance instance(createDefinition(&log));
+    QVERIFY(instance.start());
+
+    TimerWheel timerWheel;
+    QVERIFY(timerWheel.start());
+
+    // Timers that expire together are all added in the same order in which they were armed
+    for (int i = 0; i < 1000; i++)
+    {
+        QVERIFY(addTimer(&timerWheel, &instance, 20, i));
+    }
+
+    while (log.size() < 1000)
+    {
+        QVERIFY(instance.waitForEvents(5000));
+        processEvents(&instance);
+    }
+
+    QCOMPARE(timerWheel.timerCount(), 0);
+
+    for (int i = 0; i < 1000; i++)
+    {
+        QCOMPARE(log.at(i), QString("timer:%1").arg(i));
+    }
+
+    // A timer that expires earlier than the one the worker thread sleeps for wakes it up
+    log.clear();
+    QVERIFY(addTimer(&timerWheel, &instance, 60000, 2));
+    QVERIFY(addTimer(&timerWheel, &instance, 10, 1));
+    QVERIFY(instance.waitForEvents(5000));
+    processEvents(&instance);
+    QCOMPARE(log, QStringList({"timer:1"}));
+    QCOMPARE(timerWheel.timerCount(), 1);
+
+    timerWheel.cancelTimers(&instance);
+    QCOMPARE(timerWheel.timerCount(), 0);
+    QVERIFY(timerWheel.stop());
+}
+
+// Test: Cancel the timers of an instance ----------------------------------------------------------
+
+void TestTimerWheel::testCancelInstanceTimers()
+{
+    QStringList log1;
+    QStringList log2;
+    StateMachineInstance instance1(createDefinition(&log1));
+    StateMachineInstance instance2(createDefinition(&log2));
+    QVERIFY(instance1.start());
+    QVERIFY(instance2.start());
+
+    TimerWheel timerWheel;
+
+    for (int i = 0; i < 3; i++)
+    {
+        QVERIFY(addTimer(&timerWheel, &instance1, 10, i));
+        QVERIFY(addTimer(&timerWheel, &instance1, 10, i, true));
+        QVERIFY(addTimer(&timerWheel, &instance2, 10, i, true));
+    }
+
+    QCOMPARE(timerWheel.timerCount(), 9);
+
+    // Only the state-scoped timers of the instance are cancelled
+    timerWheel.cancelStateTimers(&instance1);
+    QCOMPARE(timerWheel.timerCount(), 6);
+
+    // All timers of the instance are cancelled (also the expired ones)
+    std::this_thread::sleep_for(std::chrono::milliseconds(20));
+    timerWheel.cancelTimers(&instance2);
+    QCOMPARE(timerWheel.timerCount(), 3);
+
+    while (timerWheel.timerCount() > 0)
+    {
+        std::this_thread::sleep_for(std::chrono::milliseconds(5));
+        timerWheel.processTimers();
+    }
+
+    processEvents(&instance1);
+    processEvents(&instance2);
+    QCOMPARE(log1, QStringList({"timer:0", "timer:1", "timer:2"}));
+    QVERIFY(log2.isEmpty());
+
+    // Expired events are dropped if the instance was stopped in the meantime
+    QVERIFY(addTimer(&timerWheel, &instance2, 0, 0));
+    QVERIFY(instance2.stop());
+    std::this_thread::sleep_for(std::chrono::milliseconds(10));
+    QCOMPARE(timerWheel.processTimers(), 0);
+    QCOMPARE(timerWheel.timerCount(), 0);
+}
+
+// Helper methods ----------------------------------------------------------------------------------
+
+std::shared_ptr<StateMachineDefinition> TestTimerWheel::createDefinition(QStringList *log)
+{
+    auto definition = std::make_shared<StateMachineDefinition>();
+
+    if (!(definition->addState("a") &&
+          definition->setInitialTransition("a") &&
+          definition->addInternalTransition(
+              "a",
+              "timer",
+              [log](const Event &event, const QString &)
+              {
+                  log->append(QString("%1:%2").arg(event.name())
+                              .arg(event.parameter<EventParameter<int>>()->value()));
+              }) &&
+          definition->validate()))
+    {
+        return {};
+    }
+
+    return definition;
+}
+
+TimerId TestTimerWheel::addTimer(TimerWheel *timerWheel,
+                                 StateMachineInstance *instance,
+                                 const int delay,
+                                 const int value,
+                                 const bool stateScoped)
+{
+    return timerWheel->addTimer(instance,
+                                delay,
+                                Event("timer", EventParameter<int>(value)),
+                                StateMachineInstance::NormalEventPriority,
+                                stateScoped);
+}
+
+void TestTimerWheel::processEvents(StateMachineInstance *instance)
+{
+    while (instance->hasPendingEvents())
+    {
+        instance->processNextEvent();
+    }
+}
+
+// Main function -----------------------------------------------------------------------------------
+
+QTEST_MAIN(TestTimerWheel)
+#include "testTimerWheel.moc"
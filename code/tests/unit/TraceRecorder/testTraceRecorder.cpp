@@ -0,0 +1,361 @@
+/* This file is part of C++ State Machine Framework.
+ *
+ * C++ State Machine Framework is free software: you can redistribute it and/or modify it under the
+ * terms of the GNU Lesser General Public License as published by the Free Software Foundation,
+ * either version 3 of the License, or (at your option) any later version.
+ *
+ * C++ State Machine Framework is distributed in the hope that it will be useful, but WITHOUT ANY
+ * WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR
+ * PURPOSE. See the GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License along with C++ State
+ * Machine Framework. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+/*!
+ * \file
+ *
+ * Contains unit tests for the TraceRecorder class
+ */
+
+// C++ State Machine Framework includes
+#include <CppStateMachineFramework/StateMachineInstance.hpp>
+#include <CppStateMachineFramework/TraceRecorder.hpp>
+
+// Qt includes
+#include <QtCore/QDebug>
+#include <QtCore/QJsonArray>
+#include <QtCore/QJsonDocument>
+#include <QtCore/QJsonObject>
+#include <QtTest/QTest>
+
+// System includes
+#include <thread>
+
+// Forward declarations
+
+// Macros
+
+// Test class declaration --------------------------------------------------------------------------
+
+using namespace CppStateMachineFramework;
+
+class TestTraceRecorder : public QObject
+{
+    Q_OBJECT
+
+private slots:
+    // Functions executed by QtTest before and after test suite
+    void initTestCase();
+    void cleanupTestCase();
+
+    // Functions executed by QtTest before and after each test
+    void init();
+    void cleanup();
+
+    // Test functions
+    void testWriteAndDump();
+    void testRingBufferWrapAround();
+    void testExitedThreads();
+    void testSerialization();
+    void testChromeTrace();
+    void testInstanceRecording();
+
+private:
+    static TraceRecorder::Record makeRecord(std::uint64_t machineId, std::int64_t startTime);
+    static std::vector<TraceRecorder::Record> machineRecords(std::uint64_t machineId);
+};
+
+// Test Case init/cleanup methods ------------------------------------------------------------------
+
+void TestTraceRecorder::initTestCase()
+{
+}
+
+void TestTraceRecorder::cleanupTestCase()
+{
+}
+
+// Test init/cleanup methods -----------------------------------------------------------------------
+
+void TestTraceRecorder::init()
+{
+    TraceRecorder::clear();
+}
+
+void TestTraceRecorder::cleanup()
+{
+}
+
+// Test: Write and dump records --------------------------------------------------------------------
+
+void TestTraceRecorder::testWriteAndDump()
+{
+    QVERIFY(TraceRecorder::dump().empty());
+
+    TraceRecorder::write(makeRecord(1U, 300));
+    TraceRecorder::write(makeRecord(1U, 100));
+
+    std::thread thread([]() { TraceRecorder::write(makeRecord(2U, 200)); });
+    thread.join();
+
+    // Records of all threads are merged and sorted by their start time
+    const auto records = TraceRecorder::dump();
+    QCOMPARE(records.size(), static_cast<std::size_t>(3));
+    QCOMPARE(records[0].startTime, static_cast<std::int64_t>(100));
+    QCOMPARE(records[1].startTime, static_cast<std::int64_t>(200));
+    QCOMPARE(records[2].startTime, static_cast<std::int64_t>(300));
+    QCOMPARE(records[1].machineId, static_cast<std::uint64_t>(2U));
+    QVERIFY(records[0].threadIndex == records[2].threadIndex);
+    QVERIFY(records[0].threadIndex != records[1].threadIndex);
+
+    // Records of the exited threads are also discarded
+    TraceRecorder::clear();
+    QVERIFY(TraceRecorder::dump().empty());
+}
+
+// Test: Ring buffer wrap-around -------------------------------------------------------------------
+
+void TestTraceRecorder::testRingBufferWrapAround()
+{
+    QVERIFY(!TraceRecorder::setCapacity(0));
+    QVERIFY(TraceRecorder::setCapacity(5));
+    QCOMPARE(TraceRecorder::capacity(), 8);
+
+    // Capacity is applied to the ring buffer of a new thread
+    std::thread thread([]()
+    {
+        for (std::int64_t index = 0; index < 20; index++)
+        {
+            TraceRecorder::write(makeRecord(3U, index));
+        }
+    });
+    thread.join();
+
+    QVERIFY(TraceRecorder::setCapacity(TraceRecorder::DefaultCapacity));
+
+    // Only the last records are kept
+    const auto records = machineRecords(3U);
+    QCOMPARE(records.size(), static_cast<std::size_t>(8));
+
+    for (std::size_t index = 0U; index < records.size(); index++)
+    {
+        QCOMPARE(records[index].startTime, static_cast<std::int64_t>(12U + index));
+    }
+}
+
+// Test: Ring buffers of the exited threads --------------------------------------------------------
+
+void TestTraceRecorder::testExitedThreads()
+{
+    const int threadCount = TraceRecorder::MaxExitedThreadCount + 10;
+
+    for (int i = 0; i < threadCount; i++)
+    {
+        std::thread thread([i]()
+        {
+            TraceRecorder::write(makeRecord(static_cast<std::uint64_t>(i), i));
+        });
+        thread.join();
+    }
+
+    // Only the ring buffers of the last exited threads are kept
+    auto records = TraceRecorder::dump();
+    QCOMPARE(records.size(), static_cast<std::size_t>(TraceRecorder::MaxExitedThreadCount));
+    QCOMPARE(records.front().machineId, static_cast<std::uint64_t>(10U));
+    QCOMPARE(records.back().machineId, static_cast<std::uint64_t>(threadCount - 1));
+
+    // Ring buffers of the exited threads are freed by clear() and their thread indexes are reused
+    const std::uint16_t lastThreadIndex = records.back().threadIndex;
+    TraceRecorder::clear();
+
+    std::thread thread([]() { TraceRecorder::write(makeRecord(1U, 1)); });
+    thread.join();
+
+    records = TraceRecorder::dump();
+    QCOMPARE(records.size(), static_cast<std::size_t>(1));
+    QCOMPARE(records.front().threadIndex, lastThreadIndex);
+}
+
+// Test: Serialization -----------------------------------------------------------------------------
+
+void TestTraceRecorder::testSerialization()
+{
+    std::vector<TraceRecorder::Record> records = { makeRecord(4U, 10), makeRecord(5U, 20) };
+    records[1].type = TraceRecorder::RecordType::Ignored;
+
+    const QByteArray data = TraceRecorder::serialize(records);
+
+    std::vector<TraceRecorder::Record> result;
+    QVERIFY(TraceRecorder::deserialize(data, &result));
+    QCOMPARE(result.size(), records.size());
+    QCOMPARE(result[0].machineId, static_cast<std::uint64_t>(4U));
+    QCOMPARE(result[1].startTime, static_cast<std::int64_t>(20));
+    QVERIFY(result[1].type == TraceRecorder::RecordType::Ignored);
+
+    // Empty dump
+    QVERIFY(TraceRecorder::deserialize(TraceRecorder::serialize({}), &result));
+    QVERIFY(result.empty());
+
+    // Invalid dumps
+    QVERIFY(!TraceRecorder::deserialize(QByteArray(), &result));
+    QVERIFY(!TraceRecorder::deserialize(QByteArray("not a trace dump at all"), &result));
+    QVERIFY(!TraceRecorder::deserialize(data.left(data.size() - 1), &result));
+    QVERIFY(!TraceRecorder::deserialize(data, nullptr));
+}
+
+// Test: Chrome trace event JSON -------------------------------------------------------------------
+
+void TestTraceRecorder::testChromeTrace()
+{
+    const EventId eventId = EventNameRegistry::registerName("trace_chrome");
+
+    TraceRecorder::Record transition = makeRecord(6U, 1000);
+    transition.eventId = eventId;
+    transition.guardTime = 2000;
+    transition.exitTime = 3000;
+    transition.actionTime = 4000;
+    transition.entryTime = 5000;
+
+    TraceRecorder::Record ignored = makeRecord(6U, 6000);
+    ignored.type = TraceRecorder::RecordType::Ignored;
+    ignored.eventId = InvalidEventId;
+
+    const auto document = QJsonDocument::fromJson(
+                              TraceRecorder::toChromeTrace({ transition, ignored }));
+    const QJsonArray events = document.object().value("traceEvents").toArray();
+
+    // State transition has a slice for the event and a slice for each of its phases
+    QCOMPARE(events.size(), 6);
+
+    const QJsonObject eventSlice = events.at(0).toObject();
+    QCOMPARE(eventSlice.value("name").toString(), QString("trace_chrome"));
+    QCOMPARE(eventSlice.value("ph").toString(), QString("X"));
+    QCOMPARE(eventSlice.value("ts").toDouble(), 0.0);
+    QCOMPARE(eventSlice.value("dur").toDouble(), 4.0);
+    QCOMPARE(eventSlice.value("pid").toInt(), 6);
+    QCOMPARE(eventSlice.value("args").toObject().value("fromState").toInt(), 0);
+    QCOMPARE(eventSlice.value("args").toObject().value("toState").toInt(), 1);
+
+    const QJsonObject actionSlice = events.at(3).toObject();
+    QCOMPARE(actionSlice.value("name").toString(), QString("action"));
+    QCOMPARE(actionSlice.value("ts").toDouble(), 2.0);
+    QCOMPARE(actionSlice.value("dur").toDouble(), 1.0);
+
+    // Events that are not registered are shown by their ID
+    const QJsonObject ignoredSlice = events.at(5).toObject();
+    QCOMPARE(ignoredSlice.value("name").toString(), QString("event #0"));
+    QCOMPARE(ignoredSlice.value("ts").toDouble(), 5.0);
+    QCOMPARE(ignoredSlice.value("dur").toDouble(), 0.0);
+}
+
+// Test: Recording of a state machine instance -----------------------------------------------------
+
+void TestTraceRecorder::testInstanceRecording()
+{
+    auto definition = std::make_shared<StateMachineDefinition>();
+    StateMachineInstance instance(definition);
+    bool guardResult = false;
+
+    QVERIFY(definition->addState("a"));
+    QVERIFY(definition->addState("b"));
+    QVERIFY(definition->setInitialTransition("a"));
+    QVERIFY(definition->addStateTransition("a",
+                                           "trace_a_to_b",
+                                           "b",
+                                           [](auto &, auto &, auto &) {},
+                                           [&](auto &, auto &, auto &) { return guardResult; }));
+    QVERIFY(definition->addInternalTransition("b", "trace_tick", [](auto &, auto &) {}));
+    QVERIFY(definition->validate());
+
+    // Events are not recorded by default
+    QCOMPARE(instance.traceMachineId(), static_cast<std::uint64_t>(0U));
+    QVERIFY(instance.start());
+    QVERIFY(!instance.setTraceMachineId(7U));
+    QVERIFY(instance.addEventToBack("trace_a_to_b"));
+    QVERIFY(instance.poll());
+    QVERIFY(instance.stop());
+    QVERIFY(TraceRecorder::dump().empty());
+
+    QVERIFY(instance.setTraceMachineId(7U));
+    QCOMPARE(instance.traceMachineId(), static_cast<std::uint64_t>(7U));
+    QVERIFY(instance.start());
+
+    QVERIFY(instance.addEventToBack("trace_a_to_b"));
+    QVERIFY(instance.poll());
+    guardResult = true;
+    QVERIFY(instance.addEventToBack("trace_a_to_b"));
+    QVERIFY(instance.addEventToBack("trace_tick"));
+    QVERIFY(instance.addEventToBack("trace_unknown"));
+    QVERIFY(instance.poll());
+    QCOMPARE(instance.currentState(), QString("b"));
+
+    const auto records = machineRecords(7U);
+    QCOMPARE(records.size(), static_cast<std::size_t>(4));
+
+    QVERIFY(records[0].type == TraceRecorder::RecordType::GuardRejected);
+    QCOMPARE(records[0].fromState, 0);
+    QCOMPARE(records[0].toState, 1);
+    QCOMPARE(records[0].eventId, EventNameRegistry::id("trace_a_to_b"));
+
+    QVERIFY(records[1].type == TraceRecorder::RecordType::StateTransition);
+    QCOMPARE(records[1].fromState, 0);
+    QCOMPARE(records[1].toState, 1);
+    QVERIFY(records[1].startTime <= records[1].guardTime);
+    QVERIFY(records[1].guardTime <= records[1].exitTime);
+    QVERIFY(records[1].exitTime <= records[1].actionTime);
+    QVERIFY(records[1].actionTime <= records[1].entryTime);
+
+    QVERIFY(records[2].type == TraceRecorder::RecordType::InternalTransition);
+    QCOMPARE(records[2].fromState, 1);
+    QCOMPARE(records[2].toState, -1);
+    QCOMPARE(records[2].eventId, EventNameRegistry::id("trace_tick"));
+
+    QVERIFY(records[3].type == TraceRecorder::RecordType::Ignored);
+    QCOMPARE(records[3].fromState, 1);
+    QCOMPARE(records[3].eventId, EventNameRegistry::id("trace_unknown"));
+
+    QVERIFY(instance.stop());
+}
+
+// Helper methods ----------------------------------------------------------------------------------
+
+TraceRecorder::Record TestTraceRecorder::makeRecord(const std::uint64_t machineId,
+                                                    const std::int64_t startTime)
+{
+    TraceRecorder::Record record;
+    record.machineId = machineId;
+    record.startTime = startTime;
+    record.guardTime = startTime;
+    record.exitTime = startTime;
+    record.actionTime = startTime;
+    record.entryTime = startTime;
+    record.fromState = 0;
+    record.toState = 1;
+    record.eventId = InvalidEventId;
+    record.type = TraceRecorder::RecordType::StateTransition;
+    record.threadIndex = 0U;
+    return record;
+}
+
+// -------------------------------------------------------------------------------------------------
+
+std::vector<TraceRecorder::Record> TestTraceRecorder::machineRecords(const std::uint64_t machineId)
+{
+    std::vector<TraceRecorder::Record> records;
+
+    for (const auto &record : TraceRecorder::dump())
+    {
+        if (record.machineId == machineId)
+        {
+            records.push_back(record);
+        }
+    }
+
+    return records;
+}
+
+// Main function -----------------------------------------------------------------------------------
+
+QTEST_MAIN(TestTraceRecorder)
+#include "testTraceRecorder.moc"